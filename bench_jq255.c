@@ -0,0 +1,1328 @@
+/*
+ * Benchmark program for jq255e and jq255s.
+ *
+ * This program includes jq255.c (compiled for the curve selected by the
+ * JQ macro), so that internal primitives (field and point operations)
+ * can be measured along with the public API. Each benchmark runs a
+ * fixed number of operations per sample; after some warmup samples,
+ * the distribution of the per-operation cost over all samples is
+ * reported as the median and the first and third quartiles, in clock
+ * cycles (read with rdtsc, see test_jq255.c for caveats on frequency
+ * scaling and SMT).
+ *
+ * Usage:
+ *
+ *    bench_jq255e [ options ] [ name... ]
+ *
+ * Options:
+ *    -csv           output in CSV format
+ *    -json          output in JSON format
+ *    -cpu num       pin the benchmark thread to CPU num (default: the
+ *                   CPU on which the program starts); -cpu -1 disables
+ *                   pinning
+ *    -samples num   number of measured samples per benchmark (default:
+ *                   101)
+ *    -list          list the benchmark names and exit
+ *    -threads num   throughput mode (see below) with 1 to num threads
+ *    -duration ms   throughput mode: duration of each run (default:
+ *                   1000 ms)
+ *    -keys num      throughput mode: size of the key set (default: 4096)
+ *    -clone         throughput mode: each thread uses its own copy of
+ *                   the base point tables (see jq255e_tables_clone())
+ *    -baseline file compare the medians with those of a previous run
+ *                   (CSV output of this program); the exit status is
+ *                   non-zero if any benchmark is slower than its
+ *                   baseline by more than the threshold
+ *    -threshold pct regression threshold, in percent (default: 10)
+ *
+ * If benchmark names are provided, then only these benchmarks are run;
+ * a name ending with '*' selects all benchmarks with that prefix (e.g.
+ * "gf_*" for all field operations).
+ *
+ * The baseline file may contain the results for both curves (only the
+ * lines for the benchmarked curve are used), and need not list all
+ * benchmarks: benchmarks missing from the file are not checked. The
+ * checked-in file bench_baseline.csv is used by 'make bench-check';
+ * cycle counts depend on the CPU and the compiler, hence a warning is
+ * printed if the backend or compiler of the baseline differs.
+ *
+ * In throughput mode, the operations "sign", "verify" and "ECDH" of the
+ * public API are run by 1, 2,... num threads concurrently, for a fixed
+ * duration each time; every thread cycles through its own part of a
+ * shared set of key pairs, large enough (about 280 bytes per key) not
+ * to fit in the L1 and L2 caches. The aggregate number of operations
+ * per second is reported, along with the scaling efficiency (aggregate
+ * throughput divided by the number of threads times the single-thread
+ * throughput). With pinning enabled, thread i runs on CPU (cpu+i) modulo
+ * the number of online CPUs, cpu being the value of -cpu (0 by default).
+ * With -clone, every thread first maps memory for a copy of the base
+ * point tables (with huge pages if possible) and fills it after
+ * pinning, so that the copy ends up on the thread's local NUMA node
+ * (first touch); comparing with and without -clone shows the cost of
+ * accessing the shared built-in tables.
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE   1
+#include <sched.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#if !(defined __x86_64__ || defined __i386__)
+#error bench_jq255.c requires an x86 CPU (rdtsc)
+#endif
+
+#include "jq255.c"
+
+#include <immintrin.h>
+
+static inline uint64_t
+core_cycles(void)
+{
+#if defined __GNUC__ && !defined __clang__
+	uint32_t hi, lo;
+
+	_mm_lfence();
+	__asm__ __volatile__ ("rdtsc" : "=d" (hi), "=a" (lo) : : );
+	return ((uint64_t)hi << 32) | (uint64_t)lo;
+#else
+	_mm_lfence();
+	return __rdtsc();
+#endif
+}
+
+static int
+cmp_u64(const void *p1, const void *p2)
+{
+	uint64_t v1, v2;
+
+	v1 = *(const uint64_t *)p1;
+	v2 = *(const uint64_t *)p2;
+	if (v1 < v2) {
+		return -1;
+	} else if (v1 == v2) {
+		return 0;
+	} else {
+		return 1;
+	}
+}
+
+/*
+ * Shared benchmark state. All benchmarks update bench_sink with some
+ * of their results, so that the compiler cannot optimize the measured
+ * code away.
+ */
+#define NUM_KEYS   64
+
+/*
+ * Number of points for the multi-scalar multiplication benchmarks
+ * (largest size).
+ */
+#define NUM_MSM   1024
+
+static volatile uint32_t bench_sink;
+
+static gf bx, by;
+static point bp;
+static scalar bs, bv;
+static uint32_t bu[4];
+static uint8_t bdata[4096];
+static jq_keypair bjk;
+static jq_signer bsg;
+static jq_public_key_expanded bepk;
+static uint8_t bpub[NUM_KEYS][32];
+static jq_public_key bpk[NUM_KEYS];
+static uint8_t bhv[NUM_KEYS][32];
+static const void *bhvp[NUM_KEYS];
+static size_t bhv_len[NUM_KEYS];
+static uint8_t bsig[NUM_KEYS][48];
+static jq_verify_item bitems[NUM_KEYS];
+static jq_verify_job bjobs[NUM_KEYS];
+static jq_verify_queue bvq;
+static jq_verify_queue_slot bvq_slots[NUM_KEYS];
+static jq_ECDH_self bes;
+static jq_ECDH_peer bep;
+static point bmsm_p[NUM_MSM];
+static scalar bmsm_s[NUM_MSM];
+
+static void
+bench_job_done(void *ctx, int ok)
+{
+	(void)ctx;
+	bench_sink ^= (uint32_t)ok;
+}
+
+static void
+bench_init(void)
+{
+	uint8_t tmp[64];
+
+	for (size_t u = 0; u < sizeof bdata; u ++) {
+		bdata[u] = (uint8_t)(u * 17 + (u >> 8));
+	}
+	blake2s(tmp, 32, NULL, 0, "bench-x", 7);
+	gf_decode(&bx, tmp);
+	blake2s(tmp, 32, NULL, 0, "bench-y", 7);
+	gf_decode(&by, tmp);
+	blake2s(tmp, 32, NULL, 0, "bench-s", 7);
+	blake2s(tmp + 32, 32, NULL, 0, "bench-v", 7);
+	scalar_decode_reduce(&bs, tmp, 32);
+	scalar_decode_reduce(&bv, tmp + 32, 32);
+	for (int i = 0; i < 4; i ++) {
+		bu[i] = dec32le(tmp + 4 * i) ^ 0xA5A5A5A5;
+	}
+	point_mulgen(&bp, &bs);
+	for (int i = 0; i < NUM_MSM; i ++) {
+		blake2s(tmp, 32, &i, sizeof i, "bench-msm-p", 11);
+		blake2s(tmp + 32, 32, &i, sizeof i, "bench-msm-s", 11);
+		scalar_decode_reduce(&bmsm_s[i], tmp, 32);
+		point_mulgen(&bmsm_p[i], &bmsm_s[i]);
+		scalar_decode_reduce(&bmsm_s[i], tmp + 32, 32);
+	}
+
+	jq_generate_keypair(&bjk, "bench-key", 9);
+	jq_signer_init(&bsg, &bjk);
+	jq_expand_public_key(&bepk, &bjk.public_key);
+	jq_ECDH_prepare_self(&bes, &bjk);
+	for (int i = 0; i < NUM_KEYS; i ++) {
+		jq_keypair jk;
+
+		tmp[0] = (uint8_t)i;
+		jq_generate_keypair(&jk, tmp, 16);
+		bpk[i] = jk.public_key;
+		jq_encode_public_key(bpub[i], &jk.public_key);
+		blake2s(bhv[i], 32, NULL, 0, tmp, 16);
+		bhvp[i] = bhv[i];
+		bhv_len[i] = 32;
+		jq_sign(bsig[i], &bjk, JQ255_HASHNAME_BLAKE2S, bhv[i], 32);
+		bitems[i].sig = bsig[i];
+		bitems[i].sig_len = 48;
+		bitems[i].pk = &bjk.public_key;
+		bitems[i].hash_name = JQ255_HASHNAME_BLAKE2S;
+		bitems[i].hv = bhv[i];
+		bitems[i].hv_len = 32;
+		bjobs[i].sig = bsig[i];
+		bjobs[i].sig_len = 48;
+		bjobs[i].pk = &bjk.public_key;
+		bjobs[i].hash_name = JQ255_HASHNAME_BLAKE2S;
+		bjobs[i].hv = bhv[i];
+		bjobs[i].hv_len = 32;
+		bjobs[i].done = &bench_job_done;
+		bjobs[i].ctx = NULL;
+	}
+	jq_ECDH_prepare_peer(&bep, &bpk[0]);
+	jq_verify_queue_init(&bvq, bvq_slots, NUM_KEYS, 16, 1000);
+}
+
+/*
+ * Primitives.
+ */
+
+static void
+run_gf_mul(void)
+{
+	for (int i = 0; i < 1000; i ++) {
+		gf_mul(&bx, &bx, &by);
+	}
+	bench_sink ^= (uint32_t)gf_is_zero(&bx);
+}
+
+static void
+run_gf_square(void)
+{
+	for (int i = 0; i < 1000; i ++) {
+		gf_square(&bx, &bx);
+	}
+	bench_sink ^= (uint32_t)gf_is_zero(&bx);
+}
+
+static void
+run_gf_inv(void)
+{
+	for (int i = 0; i < 100; i ++) {
+		gf_inv(&bx, &bx);
+	}
+	bench_sink ^= (uint32_t)gf_is_zero(&bx);
+}
+
+static void
+run_gf_sqrt(void)
+{
+	for (int i = 0; i < 100; i ++) {
+		bench_sink ^= gf_sqrt(&by, &bx);
+		gf_add(&bx, &bx, &by);
+	}
+}
+
+static void
+run_point_mul(void)
+{
+	for (int i = 0; i < 10; i ++) {
+		point_mul(&bp, &bp, &bs);
+	}
+	bench_sink ^= point_is_neutral(&bp);
+}
+
+static void
+run_point_mulgen(void)
+{
+	for (int i = 0; i < 10; i ++) {
+		point_mulgen(&bp, &bs);
+		bs.v[0] ^= (uint32_t)i;
+	}
+	bench_sink ^= point_is_neutral(&bp);
+}
+
+static void
+run_point_mul_vartime(void)
+{
+	for (int i = 0; i < 10; i ++) {
+		point_mul_vartime(&bp, &bp, &bs);
+	}
+	bench_sink ^= point_is_neutral(&bp);
+}
+
+static void
+run_point_mulgen_vartime(void)
+{
+	for (int i = 0; i < 10; i ++) {
+		point_mulgen_vartime(&bp, &bs);
+		bs.v[0] ^= (uint32_t)i;
+	}
+	bench_sink ^= point_is_neutral(&bp);
+}
+
+static void
+run_point_msm_vartime(size_t n)
+{
+	point p;
+
+	point_msm_vartime(&p, bmsm_p, bmsm_s, n);
+	bench_sink ^= point_is_neutral(&p);
+}
+
+static void
+run_point_msm_16(void)
+{
+	run_point_msm_vartime(16);
+}
+
+static void
+run_point_msm_128(void)
+{
+	run_point_msm_vartime(128);
+}
+
+static void
+run_point_msm_1024(void)
+{
+	run_point_msm_vartime(1024);
+}
+
+static void
+run_point_mul128_add_mulgen_vartime(void)
+{
+	for (int i = 0; i < 10; i ++) {
+		uint32_t u[4];
+
+		memcpy(u, bu, sizeof u);
+		u[0] ^= (uint32_t)i;
+		point_mul128_add_mulgen_vartime(&bp, &bp, u, &bv);
+	}
+	bench_sink ^= point_is_neutral(&bp);
+}
+
+static void
+run_blake2s(void)
+{
+	uint8_t tmp[32];
+
+	blake2s(tmp, 32, NULL, 0, bdata, sizeof bdata);
+	bench_sink ^= tmp[0];
+	bdata[0] ^= tmp[1];
+}
+
+/*
+ * Public API.
+ */
+
+static void
+run_keygen(void)
+{
+	for (int i = 0; i < 10; i ++) {
+		jq_keypair jk;
+
+		jq_generate_keypair(&jk, bhv[i], 32);
+		bench_sink ^= jk.public_key.w32[0];
+	}
+}
+
+static void
+run_keygen_batch(void)
+{
+	jq_keypair jk[NUM_KEYS];
+
+	jq_generate_keypairs(jk, bhvp, bhv_len, NUM_KEYS);
+	bench_sink ^= jk[0].public_key.w32[0];
+}
+
+static void
+run_pubkey_decode(void)
+{
+	for (int i = 0; i < NUM_KEYS; i ++) {
+		bench_sink ^= jq_decode_public_key(&bpk[i], bpub[i], 32);
+	}
+}
+
+static void
+run_pubkey_decode_batch(void)
+{
+	uint8_t ok[NUM_KEYS / 8];
+
+	bench_sink ^= jq_decode_public_keys(bpk, bpub, NUM_KEYS, ok);
+}
+
+static void
+run_sign(void)
+{
+	for (int i = 0; i < 10; i ++) {
+		jq_sign(bsig[i], &bjk, JQ255_HASHNAME_BLAKE2S, bhv[i], 32);
+	}
+	bench_sink ^= bsig[0][0];
+}
+
+static void
+run_signer_sign(void)
+{
+	for (int i = 0; i < 10; i ++) {
+		jq_signer_sign(bsig[i], &bsg, JQ255_HASHNAME_BLAKE2S,
+			bhv[i], 32, NULL, 0);
+	}
+	bench_sink ^= bsig[0][0];
+}
+
+static void
+run_sign_many(void)
+{
+	jq_sign_many(bsig, &bjk, JQ255_HASHNAME_BLAKE2S,
+		bhvp, bhv_len, NUM_KEYS, NULL);
+	bench_sink ^= bsig[0][0];
+}
+
+static void
+run_sign_stream(void)
+{
+	jq_sign_ctx sc;
+	uint8_t sig[48];
+
+	jq_sign_init(&sc, &bjk);
+	jq_sign_update(&sc, bdata, sizeof bdata);
+	jq_sign_final(&sc, sig, NULL, 0);
+	bench_sink ^= sig[0];
+}
+
+static void
+run_verify(void)
+{
+	for (int i = 0; i < 10; i ++) {
+		bench_sink ^= jq_verify(bsig[i], 48, &bjk.public_key,
+			JQ255_HASHNAME_BLAKE2S, bhv[i], 32);
+	}
+}
+
+static void
+run_verify_batch(void)
+{
+	bench_sink ^= jq_verify_batch(NULL, bitems, NUM_KEYS);
+}
+
+/*
+ * Verification queue: each request is submitted then the queue is
+ * polled, as a server would do; batches of 16 are processed as they
+ * complete.
+ */
+static void
+run_verify_queue(void)
+{
+	for (int i = 0; i < NUM_KEYS; i ++) {
+		jq_verify_submit(&bvq, &bjobs[i], 0);
+		jq_verify_poll(&bvq, 0);
+	}
+	jq_verify_flush(&bvq);
+}
+
+static void
+run_verify_expanded(void)
+{
+	for (int i = 0; i < 10; i ++) {
+		bench_sink ^= jq_verify_expanded(bsig[i], 48, &bepk,
+			JQ255_HASHNAME_BLAKE2S, bhv[i], 32);
+	}
+}
+
+static void
+run_ECDH(void)
+{
+	uint8_t tmp[32];
+
+	for (int i = 0; i < 10; i ++) {
+		bench_sink ^= jq_ECDH(tmp, &bjk, &bpk[i]);
+		bench_sink ^= tmp[0];
+	}
+}
+
+static void
+run_ECDH_many(void)
+{
+	static uint8_t tmp[NUM_KEYS][32];
+
+	bench_sink ^= jq_ECDH_many(tmp, &bjk, bpk, NUM_KEYS, NULL);
+	bench_sink ^= tmp[0][0];
+}
+
+static void
+run_ECDH_prepared(void)
+{
+	uint8_t tmp[32];
+
+	for (int i = 0; i < 10; i ++) {
+		bench_sink ^= jq_ECDH_prepared(tmp, &bes, &bep);
+		bench_sink ^= tmp[0];
+	}
+}
+
+/*
+ * Benchmark list: name, unit, number of units per sample, and the
+ * function that runs one sample.
+ */
+typedef struct {
+	const char *name;
+	const char *unit;
+	size_t ops;
+	void (*run)(void);
+} bench_def;
+
+static const bench_def BENCHES[] = {
+	{ "gf_mul", "op", 1000, &run_gf_mul },
+	{ "gf_square", "op", 1000, &run_gf_square },
+	{ "gf_inv", "op", 100, &run_gf_inv },
+	{ "gf_sqrt", "op", 100, &run_gf_sqrt },
+	{ "point_mul", "op", 10, &run_point_mul },
+	{ "point_mulgen", "op", 10, &run_point_mulgen },
+	{ "point_mul_vartime", "op", 10, &run_point_mul_vartime },
+	{ "point_mulgen_vartime", "op", 10, &run_point_mulgen_vartime },
+	{ "point_mul128_add_mulgen_vartime", "op", 10,
+		&run_point_mul128_add_mulgen_vartime },
+	{ "point_msm_vartime_16", "point", 16, &run_point_msm_16 },
+	{ "point_msm_vartime_128", "point", 128, &run_point_msm_128 },
+	{ "point_msm_vartime_1024", "point", 1024, &run_point_msm_1024 },
+	{ "blake2s", "byte", sizeof bdata, &run_blake2s },
+	{ "keygen", "op", 10, &run_keygen },
+	{ "keygen_batch", "op", NUM_KEYS, &run_keygen_batch },
+	{ "pubkey_decode", "op", NUM_KEYS, &run_pubkey_decode },
+	{ "pubkey_decode_batch", "op", NUM_KEYS, &run_pubkey_decode_batch },
+	{ "sign", "op", 10, &run_sign },
+	{ "signer_sign", "op", 10, &run_signer_sign },
+	{ "sign_many", "op", NUM_KEYS, &run_sign_many },
+	{ "sign_stream_4k", "op", 1, &run_sign_stream },
+	{ "verify", "op", 10, &run_verify },
+	{ "verify_batch", "op", NUM_KEYS, &run_verify_batch },
+	{ "verify_queue", "op", NUM_KEYS, &run_verify_queue },
+	{ "verify_expanded", "op", 10, &run_verify_expanded },
+	{ "ECDH", "op", 10, &run_ECDH },
+	{ "ECDH_many", "op", NUM_KEYS, &run_ECDH_many },
+	{ "ECDH_prepared", "op", 10, &run_ECDH_prepared },
+	{ NULL, NULL, 0, NULL }
+};
+
+#define NUM_WARMUP   10
+
+typedef enum { OUT_TEXT, OUT_CSV, OUT_JSON } out_format;
+
+static const char *
+curve_name(void)
+{
+	return JQ == JQ255E ? "jq255e" : "jq255s";
+}
+
+/*
+ * Backend description: field backend, and optional features enabled
+ * at compile time.
+ */
+static const char *
+backend_name(void)
+{
+	static char buf[64];
+
+	snprintf(buf, sizeof buf, "%s%s%s%s",
+		W64 ? "w64" : "w32",
+		MULGEN_LARGE ? "+mulgen_large" : "",
+		JQ_IFMA ? "+ifma" : "",
+		JQ_LOOKUP == 1 ? "+avx2" : JQ_LOOKUP == 2 ? "+neon" : "");
+	return buf;
+}
+
+static const char *
+compiler_name(void)
+{
+#if defined __clang__
+	return "clang " __clang_version__;
+#elif defined __GNUC__
+	return "gcc " __VERSION__;
+#else
+	return "unknown";
+#endif
+}
+
+/*
+ * Baseline medians, from a CSV output of this program.
+ */
+typedef struct {
+	char name[64];
+	double median;
+} baseline_entry;
+
+static baseline_entry *baseline;
+static size_t baseline_num;
+
+/*
+ * Split a CSV output line "curve,backend,compiler,name,unit,median,q1,q3"
+ * (the compiler field may contain commas, hence the fields are located
+ * from both ends). Returned value is 1 on success, 0 if the line is not
+ * a result line.
+ */
+static int
+split_result_line(char *line, char **backend, char **compiler,
+	char **name, char **median)
+{
+	char *f[5];
+	char *p, *q;
+
+	p = line + strlen(line);
+	while (p > line && (p[-1] == '\n' || p[-1] == '\r')) {
+		*-- p = 0;
+	}
+	for (int k = 4; k >= 0; k --) {
+		while (p > line && p[-1] != ',') {
+			p --;
+		}
+		if (p == line) {
+			return 0;
+		}
+		f[k] = p;
+		*-- p = 0;
+	}
+	p = strchr(line, ',');
+	if (p == NULL) {
+		return 0;
+	}
+	*p ++ = 0;
+	q = strchr(p, ',');
+	if (q == NULL) {
+		return 0;
+	}
+	*q ++ = 0;
+	*backend = p;
+	*compiler = q;
+	*name = f[0];
+	*median = f[2];
+	return 1;
+}
+
+static void
+load_baseline(const char *fname)
+{
+	FILE *f;
+	char line[512];
+	size_t cap;
+	int warned;
+
+	f = fopen(fname, "r");
+	if (f == NULL) {
+		perror(fname);
+		exit(EXIT_FAILURE);
+	}
+	cap = 0;
+	warned = 0;
+	while (fgets(line, sizeof line, f) != NULL) {
+		char *backend, *compiler, *name, *median;
+		baseline_entry *e;
+
+		if (!split_result_line(line, &backend, &compiler,
+			&name, &median) || strcmp(line, curve_name()) != 0)
+		{
+			continue;
+		}
+		if (!warned && (strcmp(backend, backend_name()) != 0
+			|| strncmp(compiler + 1, compiler_name(),
+			strlen(compiler_name())) != 0))
+		{
+			fprintf(stderr, "warning: baseline is for %s, %s\n",
+				backend, compiler);
+			warned = 1;
+		}
+		if (baseline_num == cap) {
+			cap = cap == 0 ? 32 : 2 * cap;
+			baseline = realloc(baseline, cap * sizeof *baseline);
+			if (baseline == NULL) {
+				fprintf(stderr, "out of memory\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		e = &baseline[baseline_num ++];
+		snprintf(e->name, sizeof e->name, "%s", name);
+		e->median = atof(median);
+	}
+	fclose(f);
+}
+
+/*
+ * Check a result against the baseline; returned value is 1 on a
+ * regression (reported on stderr), 0 otherwise.
+ */
+static int
+check_baseline(const char *name, double med, double threshold)
+{
+	for (size_t i = 0; i < baseline_num; i ++) {
+		double lim;
+
+		if (strcmp(baseline[i].name, name) != 0) {
+			continue;
+		}
+		lim = baseline[i].median * (1.0 + threshold / 100.0);
+		if (med > lim) {
+			fprintf(stderr, "REGRESSION: %s: %.2f, baseline %.2f"
+				" (+%.1f%%)\n", name, med, baseline[i].median,
+				100.0 * (med / baseline[i].median - 1.0));
+			return 1;
+		}
+		return 0;
+	}
+	return 0;
+}
+
+static int
+name_matches(const char *name, int argc, char *argv[], const int *sel)
+{
+	int any = 0;
+
+	for (int i = 1; i < argc; i ++) {
+		size_t n;
+
+		if (!sel[i]) {
+			continue;
+		}
+		any = 1;
+		n = strlen(argv[i]);
+		if (n > 0 && argv[i][n - 1] == '*') {
+			if (strncmp(name, argv[i], n - 1) == 0) {
+				return 1;
+			}
+		} else if (strcmp(name, argv[i]) == 0) {
+			return 1;
+		}
+	}
+	return !any;
+}
+
+static int
+pin_cpu(int cpu)
+{
+#ifdef __linux__
+	cpu_set_t cs;
+
+	if (cpu < 0) {
+		cpu = sched_getcpu();
+		if (cpu < 0) {
+			return -1;
+		}
+	}
+	CPU_ZERO(&cs);
+	CPU_SET(cpu, &cs);
+	if (sched_setaffinity(0, sizeof cs, &cs) != 0) {
+		return -1;
+	}
+	return cpu;
+#else
+	(void)cpu;
+	return -1;
+#endif
+}
+
+/*
+ * Throughput mode.
+ */
+
+typedef enum { TP_SIGN, TP_VERIFY, TP_ECDH } tp_op;
+
+static const struct {
+	const char *name;
+	tp_op op;
+} TP_OPS[] = {
+	{ "sign", TP_SIGN },
+	{ "verify", TP_VERIFY },
+	{ "ECDH", TP_ECDH },
+	{ NULL, TP_SIGN }
+};
+
+/*
+ * Shared key set: key pair i signed message hash i, giving signature i.
+ */
+typedef struct {
+	size_t num;
+	jq_keypair *kp;
+	uint8_t (*hv)[32];
+	uint8_t (*sig)[48];
+} tp_keys;
+
+/*
+ * Start gate: all threads of a run wait until the gate opens, then run
+ * until the stop flag is set.
+ */
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int open;
+	volatile int stop;
+} tp_gate;
+
+typedef struct {
+	const tp_keys *keys;
+	tp_gate *gate;
+	tp_op op;
+	int cpu;
+	size_t start;
+	uint64_t count;
+	double elapsed;
+	uint32_t sink;
+	pthread_t th;
+} tp_thread;
+
+/*
+ * Set by -clone: each thread uses its own copy of the base point tables.
+ */
+static int tp_clone;
+
+/*
+ * Map memory for a copy of the base point tables, with huge pages if
+ * available (explicit huge pages, then transparent huge pages). NULL is
+ * returned on failure.
+ */
+static void *
+tp_map_tables(size_t len)
+{
+	void *mem;
+
+#ifdef MAP_HUGETLB
+	mem = mmap(NULL, len, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (mem != MAP_FAILED) {
+		return mem;
+	}
+#endif
+	mem = mmap(NULL, len, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED) {
+		return NULL;
+	}
+#ifdef MADV_HUGEPAGE
+	(void)madvise(mem, len, MADV_HUGEPAGE);
+#endif
+	return mem;
+}
+
+static double
+now_seconds(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void
+pin_thread(int cpu)
+{
+#ifdef __linux__
+	cpu_set_t cs;
+
+	CPU_ZERO(&cs);
+	CPU_SET(cpu, &cs);
+	(void)pthread_setaffinity_np(pthread_self(), sizeof cs, &cs);
+#else
+	(void)cpu;
+#endif
+}
+
+static void *
+tp_thread_main(void *arg)
+{
+	tp_thread *t = arg;
+	const tp_keys *k = t->keys;
+	size_t j, n;
+	uint64_t count;
+	uint32_t sink;
+	uint8_t tmp[48];
+	double begin;
+	void *tables_mem;
+	size_t tables_len;
+
+	if (t->cpu >= 0) {
+		pin_thread(t->cpu);
+	}
+	tables_mem = NULL;
+	tables_len = jq_tables_size();
+	if (tp_clone) {
+		tables_mem = tp_map_tables(tables_len);
+		if (tables_mem == NULL) {
+			fprintf(stderr, "cannot map tables\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_tables_use(jq_tables_clone(tables_mem, tables_len));
+	}
+	pthread_mutex_lock(&t->gate->lock);
+	while (!t->gate->open) {
+		pthread_cond_wait(&t->gate->cond, &t->gate->lock);
+	}
+	pthread_mutex_unlock(&t->gate->lock);
+
+	n = k->num;
+	j = t->start;
+	count = 0;
+	sink = 0;
+	begin = now_seconds();
+	while (!t->gate->stop) {
+		switch (t->op) {
+		case TP_SIGN:
+			jq_sign(tmp, &k->kp[j], JQ255_HASHNAME_BLAKE2S,
+				k->hv[j], 32);
+			sink ^= tmp[0];
+			break;
+		case TP_VERIFY:
+			sink ^= (uint32_t)jq_verify(k->sig[j], 48,
+				&k->kp[j].public_key,
+				JQ255_HASHNAME_BLAKE2S, k->hv[j], 32);
+			break;
+		case TP_ECDH:
+			sink ^= (uint32_t)jq_ECDH(tmp, &k->kp[j],
+				&k->kp[(j + 1) % n].public_key);
+			sink ^= tmp[0];
+			break;
+		}
+		count ++;
+		if (++ j == n) {
+			j = 0;
+		}
+	}
+	t->elapsed = now_seconds() - begin;
+	t->count = count;
+	t->sink = sink;
+	if (tables_mem != NULL) {
+		jq_tables_use(NULL);
+		munmap(tables_mem, tables_len);
+	}
+	return NULL;
+}
+
+/*
+ * Run one operation with num_threads threads for the given duration;
+ * the aggregate throughput (operations per second) is returned.
+ */
+static double
+tp_run(const tp_keys *keys, tp_op op, int num_threads,
+	int cpu_base, int ncpu, long duration_ms)
+{
+	tp_thread *th;
+	tp_gate gate;
+	struct timespec ts;
+	double rate;
+
+	th = calloc((size_t)num_threads, sizeof *th);
+	if (th == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	pthread_mutex_init(&gate.lock, NULL);
+	pthread_cond_init(&gate.cond, NULL);
+	gate.open = 0;
+	gate.stop = 0;
+	for (int i = 0; i < num_threads; i ++) {
+		th[i].keys = keys;
+		th[i].gate = &gate;
+		th[i].op = op;
+		th[i].cpu = cpu_base < 0 ? -1 : (cpu_base + i) % ncpu;
+		th[i].start = (keys->num * (size_t)i) / (size_t)num_threads;
+		if (pthread_create(&th[i].th, NULL, &tp_thread_main, &th[i])
+			!= 0)
+		{
+			fprintf(stderr, "could not create thread\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	pthread_mutex_lock(&gate.lock);
+	gate.open = 1;
+	pthread_cond_broadcast(&gate.cond);
+	pthread_mutex_unlock(&gate.lock);
+	ts.tv_sec = duration_ms / 1000;
+	ts.tv_nsec = (duration_ms % 1000) * 1000000L;
+	nanosleep(&ts, NULL);
+	gate.stop = 1;
+
+	rate = 0.0;
+	for (int i = 0; i < num_threads; i ++) {
+		pthread_join(th[i].th, NULL);
+		if (th[i].elapsed > 0.0) {
+			rate += (double)th[i].count / th[i].elapsed;
+		}
+		bench_sink ^= th[i].sink;
+	}
+	pthread_cond_destroy(&gate.cond);
+	pthread_mutex_destroy(&gate.lock);
+	free(th);
+	return rate;
+}
+
+static void
+run_throughput(out_format fmt, int cpu, int nopin, int max_threads,
+	long duration_ms, size_t num_keys, int argc, char *argv[],
+	const int *sel)
+{
+	tp_keys keys;
+	int ncpu, cpu_base, first;
+	long nc;
+
+	keys.num = num_keys;
+	keys.kp = malloc(num_keys * sizeof *keys.kp);
+	keys.hv = malloc(num_keys * sizeof *keys.hv);
+	keys.sig = malloc(num_keys * sizeof *keys.sig);
+	if (keys.kp == NULL || keys.hv == NULL || keys.sig == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	for (size_t i = 0; i < num_keys; i ++) {
+		uint8_t seed[8];
+
+		for (int j = 0; j < 8; j ++) {
+			seed[j] = (uint8_t)((uint64_t)i >> (8 * j));
+		}
+		jq_generate_keypair(&keys.kp[i], seed, sizeof seed);
+		blake2s(keys.hv[i], 32, "msg", 3, seed, sizeof seed);
+		jq_sign(keys.sig[i], &keys.kp[i],
+			JQ255_HASHNAME_BLAKE2S, keys.hv[i], 32);
+	}
+
+	nc = sysconf(_SC_NPROCESSORS_ONLN);
+	ncpu = nc < 1 ? 1 : (int)nc;
+	if (nopin) {
+		cpu_base = -1;
+	} else {
+		cpu_base = cpu < 0 ? 0 : cpu % ncpu;
+	}
+
+	switch (fmt) {
+	case OUT_TEXT:
+		printf("curve: %s  backend: %s  compiler: %s\n",
+			curve_name(), backend_name(), compiler_name());
+		printf("throughput, %lu keys, %ld ms per run, %d online CPUs%s:\n",
+			(unsigned long)num_keys, duration_ms, ncpu,
+			tp_clone ? ", cloned tables" : "");
+		printf("%-10s %8s %14s %14s %11s\n",
+			"name", "threads", "ops/s", "ops/s/thread", "efficiency");
+		break;
+	case OUT_CSV:
+		printf("curve,backend,compiler,name,threads,ops_per_sec,"
+			"efficiency\n");
+		break;
+	case OUT_JSON:
+		printf("{\n  \"curve\": \"%s\",\n  \"backend\": \"%s\",\n"
+			"  \"compiler\": \"%s\",\n  \"keys\": %lu,\n"
+			"  \"duration_ms\": %ld,\n  \"cpus\": %d,\n"
+			"  \"throughput\": [",
+			curve_name(), backend_name(), compiler_name(),
+			(unsigned long)num_keys, duration_ms, ncpu);
+		break;
+	}
+	fflush(stdout);
+
+	first = 1;
+	for (int j = 0; TP_OPS[j].name != NULL; j ++) {
+		double rate1;
+
+		if (!name_matches(TP_OPS[j].name, argc, argv, sel)) {
+			continue;
+		}
+		rate1 = 0.0;
+		for (int t = 1; t <= max_threads; t ++) {
+			double rate, eff;
+
+			rate = tp_run(&keys, TP_OPS[j].op, t,
+				cpu_base, ncpu, duration_ms);
+			if (t == 1) {
+				rate1 = rate;
+			}
+			eff = rate1 > 0.0 ? rate / (rate1 * t) : 0.0;
+			switch (fmt) {
+			case OUT_TEXT:
+				printf("%-10s %8d %14.1f %14.1f %10.1f%%\n",
+					TP_OPS[j].name, t, rate, rate / t,
+					100.0 * eff);
+				break;
+			case OUT_CSV:
+				printf("%s,%s,\"%s\",%s,%d,%.1f,%.4f\n",
+					curve_name(), backend_name(),
+					compiler_name(), TP_OPS[j].name,
+					t, rate, eff);
+				break;
+			case OUT_JSON:
+				printf("%s\n    { \"name\": \"%s\","
+					" \"threads\": %d,"
+					" \"ops_per_sec\": %.1f,"
+					" \"efficiency\": %.4f }",
+					first ? "" : ",", TP_OPS[j].name,
+					t, rate, eff);
+				break;
+			}
+			fflush(stdout);
+			first = 0;
+		}
+	}
+	if (fmt == OUT_JSON) {
+		printf("\n  ]\n}\n");
+	}
+
+	free(keys.kp);
+	free(keys.hv);
+	free(keys.sig);
+}
+
+static void
+usage(void)
+{
+	fprintf(stderr,
+"usage: bench_%s [ -csv | -json ] [ -cpu num ] [ -samples num ] [ -list ]\n"
+"       [ -threads num [ -duration ms ] [ -keys num ] [ -clone ] ]\n"
+"       [ -baseline file [ -threshold pct ] ] [ name... ]\n",
+		curve_name());
+	exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char *argv[])
+{
+	out_format fmt;
+	int cpu, nopin, samples, first, threads;
+	long duration_ms;
+	size_t num_keys;
+	int *sel;
+	uint64_t *tt;
+	const char *baseline_file;
+	double threshold;
+	int regressions;
+
+	fmt = OUT_TEXT;
+	cpu = -1;
+	nopin = 0;
+	samples = 101;
+	threads = 0;
+	duration_ms = 1000;
+	num_keys = 4096;
+	baseline_file = NULL;
+	threshold = 10.0;
+	regressions = 0;
+	sel = calloc((size_t)argc + 1, sizeof *sel);
+	if (sel == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	for (int i = 1; i < argc; i ++) {
+		const char *a = argv[i];
+
+		if (strcmp(a, "-csv") == 0) {
+			fmt = OUT_CSV;
+		} else if (strcmp(a, "-json") == 0) {
+			fmt = OUT_JSON;
+		} else if (strcmp(a, "-cpu") == 0) {
+			if (++ i >= argc) {
+				usage();
+			}
+			cpu = atoi(argv[i]);
+			nopin = (cpu < 0);
+		} else if (strcmp(a, "-samples") == 0) {
+			if (++ i >= argc) {
+				usage();
+			}
+			samples = atoi(argv[i]);
+			if (samples < 1) {
+				usage();
+			}
+		} else if (strcmp(a, "-threads") == 0) {
+			if (++ i >= argc) {
+				usage();
+			}
+			threads = atoi(argv[i]);
+			if (threads < 1) {
+				usage();
+			}
+		} else if (strcmp(a, "-duration") == 0) {
+			if (++ i >= argc) {
+				usage();
+			}
+			duration_ms = atol(argv[i]);
+			if (duration_ms < 1) {
+				usage();
+			}
+		} else if (strcmp(a, "-keys") == 0) {
+			if (++ i >= argc) {
+				usage();
+			}
+			if (atol(argv[i]) < 2) {
+				usage();
+			}
+			num_keys = (size_t)atol(argv[i]);
+		} else if (strcmp(a, "-clone") == 0) {
+			tp_clone = 1;
+		} else if (strcmp(a, "-baseline") == 0) {
+			if (++ i >= argc) {
+				usage();
+			}
+			baseline_file = argv[i];
+		} else if (strcmp(a, "-threshold") == 0) {
+			if (++ i >= argc) {
+				usage();
+			}
+			threshold = atof(argv[i]);
+			if (threshold <= 0.0) {
+				usage();
+			}
+		} else if (strcmp(a, "-list") == 0) {
+			for (int j = 0; BENCHES[j].name != NULL; j ++) {
+				printf("%s\n", BENCHES[j].name);
+			}
+			for (int j = 0; TP_OPS[j].name != NULL; j ++) {
+				printf("%s (-threads)\n", TP_OPS[j].name);
+			}
+			return 0;
+		} else if (a[0] == '-') {
+			usage();
+		} else {
+			sel[i] = 1;
+		}
+	}
+	if (threads > 0) {
+		run_throughput(fmt, cpu, nopin, threads, duration_ms,
+			num_keys, argc, argv, sel);
+		free(sel);
+		return (int)(bench_sink & 0);
+	}
+
+	if (baseline_file != NULL) {
+		load_baseline(baseline_file);
+	}
+
+	tt = malloc((size_t)samples * sizeof *tt);
+	if (tt == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (!nopin) {
+		cpu = pin_cpu(cpu);
+		if (cpu < 0) {
+			fprintf(stderr, "warning: could not pin to a CPU\n");
+		}
+	}
+
+	bench_init();
+
+	switch (fmt) {
+	case OUT_TEXT:
+		printf("curve: %s  backend: %s  compiler: %s  cpu: %d\n",
+			curve_name(), backend_name(), compiler_name(), cpu);
+		printf("cycles per unit, %d samples:\n", samples);
+		printf("%-32s %12s %12s %12s\n",
+			"name", "median", "q1", "q3");
+		break;
+	case OUT_CSV:
+		printf("curve,backend,compiler,name,unit,median,q1,q3\n");
+		break;
+	case OUT_JSON:
+		printf("{\n  \"curve\": \"%s\",\n  \"backend\": \"%s\",\n"
+			"  \"compiler\": \"%s\",\n  \"cpu\": %d,\n"
+			"  \"samples\": %d,\n  \"results\": [",
+			curve_name(), backend_name(), compiler_name(),
+			cpu, samples);
+		break;
+	}
+	fflush(stdout);
+
+	first = 1;
+	for (int j = 0; BENCHES[j].name != NULL; j ++) {
+		const bench_def *bd = &BENCHES[j];
+		double med, q1, q3;
+
+		if (!name_matches(bd->name, argc, argv, sel)) {
+			continue;
+		}
+		for (int u = 0; u < NUM_WARMUP + samples; u ++) {
+			uint64_t begin, end;
+
+			begin = core_cycles();
+			bd->run();
+			end = core_cycles();
+			if (u >= NUM_WARMUP) {
+				tt[u - NUM_WARMUP] = end - begin;
+			}
+		}
+		qsort(tt, (size_t)samples, sizeof tt[0], &cmp_u64);
+		med = (double)tt[samples / 2] / (double)bd->ops;
+		q1 = (double)tt[samples / 4] / (double)bd->ops;
+		q3 = (double)tt[(3 * samples) / 4] / (double)bd->ops;
+
+		switch (fmt) {
+		case OUT_TEXT:
+			if (strcmp(bd->unit, "op") == 0) {
+				printf("%-32s %12.2f %12.2f %12.2f\n",
+					bd->name, med, q1, q3);
+			} else {
+				printf("%-32s %12.2f %12.2f %12.2f (per %s)\n",
+					bd->name, med, q1, q3, bd->unit);
+			}
+			break;
+		case OUT_CSV:
+			printf("%s,%s,\"%s\",%s,%s,%.2f,%.2f,%.2f\n",
+				curve_name(), backend_name(), compiler_name(),
+				bd->name, bd->unit, med, q1, q3);
+			break;
+		case OUT_JSON:
+			printf("%s\n    { \"name\": \"%s\", \"unit\": \"%s\","
+				" \"median\": %.2f, \"q1\": %.2f,"
+				" \"q3\": %.2f }",
+				first ? "" : ",", bd->name, bd->unit,
+				med, q1, q3);
+			break;
+		}
+		fflush(stdout);
+		first = 0;
+		regressions += check_baseline(bd->name, med, threshold);
+	}
+	if (fmt == OUT_JSON) {
+		printf("\n  ]\n}\n");
+	}
+
+	free(tt);
+	free(sel);
+	free(baseline);
+	if (regressions > 0) {
+		fprintf(stderr, "%d regression(s) over %.1f%%\n",
+			regressions, threshold);
+		return EXIT_FAILURE;
+	}
+	return (int)(bench_sink & 0);
+}
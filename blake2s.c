@@ -820,6 +820,9 @@ process_block(uint32_t *h, const uint8_t *data, uint64_t t, int f)
  * we know whether this is the final block or not).
  *
  * If a key is injected, then it counts as a first full block.
+ *
+ * After blake2s_flush() processed a full buffered block, flushed is 1
+ * and buf[] is empty even though ctr > 0; the next update clears it.
  */
 
 /* see blake2.h */
@@ -830,6 +833,7 @@ blake2s_init(blake2s_context *bc, size_t out_len)
 	bc->h[0] ^= 0x01010000 ^ (uint32_t)out_len;
 	bc->ctr = 0;
 	bc->out_len = out_len;
+	bc->flushed = 0;
 }
 
 /* see blake2.h */
@@ -862,10 +866,11 @@ blake2s_update(blake2s_context *bc, const void *data, size_t len)
 
 	/* First complete the current block, if not already full. */
 	p = (size_t)ctr & ((sizeof bc->buf) - 1);
-	if (ctr == 0 || p != 0) {
+	if (ctr == 0 || p != 0 || bc->flushed) {
 		/* buffer is not full */
 		size_t clen;
 
+		bc->flushed = 0;
 		clen = sizeof bc->buf - p;
 		if (clen >= len) {
 			memcpy(bc->buf + p, data, len);
@@ -894,6 +899,19 @@ blake2s_update(blake2s_context *bc, const void *data, size_t len)
 	bc->ctr = ctr + len;
 }
 
+/* see blake2.h */
+void
+blake2s_flush(blake2s_context *bc)
+{
+	if (bc->ctr == 0 || ((size_t)bc->ctr & ((sizeof bc->buf) - 1)) != 0
+		|| bc->flushed)
+	{
+		return;
+	}
+	process_block(bc->h, bc->buf, bc->ctr, 0);
+	bc->flushed = 1;
+}
+
 /* see blake2.h */
 void
 blake2s_final(blake2s_context *bc, void *dst)
@@ -934,3 +952,226 @@ blake2s(void *dst, size_t dst_len, const void *key, size_t key_len,
 	blake2s_update(&bc, src, src_len);
 	blake2s_final(&bc, dst);
 }
+
+#if BLAKE2_AVX2
+
+/*
+ * Transpose the 8x8 matrix of 32-bit words x[0..7] (row i is x[i]).
+ */
+TARGET_AVX2
+static inline void
+transpose_x8(__m256i *x)
+{
+	__m256i t0, t1, t2, t3, t4, t5, t6, t7;
+	__m256i u0, u1, u2, u3, u4, u5, u6, u7;
+
+	t0 = _mm256_unpacklo_epi32(x[0], x[1]);
+	t1 = _mm256_unpackhi_epi32(x[0], x[1]);
+	t2 = _mm256_unpacklo_epi32(x[2], x[3]);
+	t3 = _mm256_unpackhi_epi32(x[2], x[3]);
+	t4 = _mm256_unpacklo_epi32(x[4], x[5]);
+	t5 = _mm256_unpackhi_epi32(x[4], x[5]);
+	t6 = _mm256_unpacklo_epi32(x[6], x[7]);
+	t7 = _mm256_unpackhi_epi32(x[6], x[7]);
+	u0 = _mm256_unpacklo_epi64(t0, t2);
+	u1 = _mm256_unpackhi_epi64(t0, t2);
+	u2 = _mm256_unpacklo_epi64(t1, t3);
+	u3 = _mm256_unpackhi_epi64(t1, t3);
+	u4 = _mm256_unpacklo_epi64(t4, t6);
+	u5 = _mm256_unpackhi_epi64(t4, t6);
+	u6 = _mm256_unpacklo_epi64(t5, t7);
+	u7 = _mm256_unpackhi_epi64(t5, t7);
+	x[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+	x[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+	x[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+	x[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+	x[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+	x[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+	x[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+	x[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/*
+ * Compute up to 8 unkeyed BLAKE2s hashes in parallel. Each hash is
+ * computed in its own 32-bit lane of the AVX2 registers ("vertical"
+ * vectorization); lane i takes its input from src[i] (src_len[i]
+ * bytes), and its output goes to dst[i] (dst_len bytes). Only the
+ * first n lanes are used (1 <= n <= 8).
+ */
+TARGET_AVX2
+static void
+blake2s_x8(void *const *dst, size_t dst_len,
+	const void *const *src, const size_t *src_len, size_t n)
+{
+	static const uint8_t SIGMA[10][16] = {
+		{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+		{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+		{ 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+		{  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+		{  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+		{  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+		{ 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+		{ 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+		{  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+		{ 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 }
+	};
+
+	ALIGNED_AVX2 uint8_t blk[8][64];
+	ALIGNED_AVX2 uint32_t ctr[8], ctrh[8], fin[8], act[8];
+	__m256i h[8], v[16], m[16], xror8, xror16;
+	size_t num_blocks[8], max_blocks;
+
+	xror8 = _mm256_setr_epi8(
+		1, 2, 3, 0, 5, 6, 7, 4,
+		9, 10, 11, 8, 13, 14, 15, 12,
+		1, 2, 3, 0, 5, 6, 7, 4,
+		9, 10, 11, 8, 13, 14, 15, 12);
+	xror16 = _mm256_setr_epi8(
+		2, 3, 0, 1, 6, 7, 4, 5,
+		10, 11, 8, 9, 14, 15, 12, 13,
+		2, 3, 0, 1, 6, 7, 4, 5,
+		10, 11, 8, 9, 14, 15, 12, 13);
+
+	/* Each input uses at least one block (even if empty). Unused
+	   lanes use zero blocks and are never active. */
+	max_blocks = 0;
+	for (size_t i = 0; i < 8; i ++) {
+		if (i < n) {
+			size_t nb = (src_len[i] + 63) >> 6;
+			num_blocks[i] = nb == 0 ? 1 : nb;
+		} else {
+			num_blocks[i] = 0;
+		}
+		if (num_blocks[i] > max_blocks) {
+			max_blocks = num_blocks[i];
+		}
+	}
+
+	for (int j = 0; j < 8; j ++) {
+		h[j] = _mm256_set1_epi32((int32_t)IV[j]);
+	}
+	h[0] = _mm256_xor_si256(h[0],
+		_mm256_set1_epi32((int32_t)(0x01010000 ^ (uint32_t)dst_len)));
+
+	for (size_t b = 0; b < max_blocks; b ++) {
+		__m256i xt, xth, xf, xa;
+
+		/* Gather the current block of each lane, with the
+		   counter (low and high words) and finalization flag. */
+		for (size_t i = 0; i < 8; i ++) {
+			size_t off = b << 6;
+
+			if (b >= num_blocks[i]) {
+				memset(blk[i], 0, 64);
+				ctr[i] = 0;
+				ctrh[i] = 0;
+				fin[i] = 0;
+				act[i] = 0;
+				continue;
+			}
+			if (b + 1 < num_blocks[i]) {
+				memcpy(blk[i], (const uint8_t *)src[i] + off, 64);
+				ctr[i] = (uint32_t)((uint64_t)off + 64);
+				ctrh[i] = (uint32_t)(((uint64_t)off + 64) >> 32);
+				fin[i] = 0;
+			} else {
+				size_t clen = src_len[i] - off;
+				memcpy(blk[i], (const uint8_t *)src[i] + off, clen);
+				memset(blk[i] + clen, 0, 64 - clen);
+				ctr[i] = (uint32_t)src_len[i];
+				ctrh[i] = (uint32_t)((uint64_t)src_len[i] >> 32);
+				fin[i] = (uint32_t)-1;
+			}
+			act[i] = (uint32_t)-1;
+		}
+		for (int j = 0; j < 8; j ++) {
+			m[j] = _mm256_load_si256((const void *)(blk[j] + 0));
+			m[j + 8] = _mm256_load_si256((const void *)(blk[j] + 32));
+		}
+		transpose_x8(m);
+		transpose_x8(m + 8);
+		xt = _mm256_load_si256((const void *)ctr);
+		xth = _mm256_load_si256((const void *)ctrh);
+		xf = _mm256_load_si256((const void *)fin);
+		xa = _mm256_load_si256((const void *)act);
+
+		for (int j = 0; j < 8; j ++) {
+			v[j] = h[j];
+			v[j + 8] = _mm256_set1_epi32((int32_t)IV[j]);
+		}
+		v[12] = _mm256_xor_si256(v[12], xt);
+		v[13] = _mm256_xor_si256(v[13], xth);
+		v[14] = _mm256_xor_si256(v[14], xf);
+
+#define ROR_X8(x, n)   _mm256_or_si256( \
+		_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+#define G_X8(a, b, c, d, x, y)   do { \
+		v[a] = _mm256_add_epi32(v[a], _mm256_add_epi32(v[b], x)); \
+		v[d] = _mm256_shuffle_epi8( \
+			_mm256_xor_si256(v[d], v[a]), xror16); \
+		v[c] = _mm256_add_epi32(v[c], v[d]); \
+		v[b] = ROR_X8(_mm256_xor_si256(v[b], v[c]), 12); \
+		v[a] = _mm256_add_epi32(v[a], _mm256_add_epi32(v[b], y)); \
+		v[d] = _mm256_shuffle_epi8( \
+			_mm256_xor_si256(v[d], v[a]), xror8); \
+		v[c] = _mm256_add_epi32(v[c], v[d]); \
+		v[b] = ROR_X8(_mm256_xor_si256(v[b], v[c]), 7); \
+	} while (0)
+
+		for (int r = 0; r < 10; r ++) {
+			const uint8_t *s = SIGMA[r];
+
+			G_X8(0, 4,  8, 12, m[s[ 0]], m[s[ 1]]);
+			G_X8(1, 5,  9, 13, m[s[ 2]], m[s[ 3]]);
+			G_X8(2, 6, 10, 14, m[s[ 4]], m[s[ 5]]);
+			G_X8(3, 7, 11, 15, m[s[ 6]], m[s[ 7]]);
+			G_X8(0, 5, 10, 15, m[s[ 8]], m[s[ 9]]);
+			G_X8(1, 6, 11, 12, m[s[10]], m[s[11]]);
+			G_X8(2, 7,  8, 13, m[s[12]], m[s[13]]);
+			G_X8(3, 4,  9, 14, m[s[14]], m[s[15]]);
+		}
+
+#undef ROR_X8
+#undef G_X8
+
+		/* Update the state of the active lanes only. */
+		for (int j = 0; j < 8; j ++) {
+			__m256i nh = _mm256_xor_si256(h[j],
+				_mm256_xor_si256(v[j], v[j + 8]));
+			h[j] = _mm256_blendv_epi8(h[j], nh, xa);
+		}
+	}
+
+	/* Transpose the state back, so that each lane's output words
+	   are contiguous. */
+	transpose_x8(h);
+	for (size_t i = 0; i < n; i ++) {
+		ALIGNED_AVX2 uint32_t out[8];
+
+		_mm256_store_si256((void *)out, h[i]);
+		memcpy(dst[i], out, dst_len);
+	}
+}
+
+#endif
+
+/* see blake2.h */
+void
+blake2s_multi(void *const *dst, size_t dst_len,
+	const void *const *src, const size_t *src_len, size_t n)
+{
+#if BLAKE2_AVX2
+	while (n >= 2) {
+		size_t m = n < 8 ? n : 8;
+		blake2s_x8(dst, dst_len, src, src_len, m);
+		dst += m;
+		src += m;
+		src_len += m;
+		n -= m;
+	}
+#endif
+	for (size_t i = 0; i < n; i ++) {
+		blake2s(dst[i], dst_len, NULL, 0, src[i], src_len[i]);
+	}
+}
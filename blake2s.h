@@ -21,6 +21,7 @@ typedef struct {
 	uint32_t h[8];
 	uint64_t ctr;
 	size_t out_len;
+	uint32_t flushed;
 } blake2s_context;
 
 /*
@@ -52,6 +53,21 @@ void blake2s_init_key(blake2s_context *bc, size_t out_len,
  */
 void blake2s_update(blake2s_context *bc, const void *data, size_t len);
 
+/*
+ * Process buffered data early. When the bytes injected so far make up
+ * a whole number of blocks (64 bytes each), the last block is normally
+ * kept until it is known whether it is the final one. If the caller
+ * knows that more data will follow, this function processes it
+ * immediately; this is meant for saving a "midstate" after a common
+ * prefix, so that copies of the context do not process that block
+ * again. If the injected length is not a multiple of 64, or no byte
+ * was injected yet, this function does nothing.
+ *
+ * After a call that processed a block, at least one more byte MUST be
+ * injected before blake2s_final() is called.
+ */
+void blake2s_flush(blake2s_context *bc);
+
 /*
  * Finalize a running computation and produce the output, which is
  * written into `dst`. The output length was configured when the
@@ -70,6 +86,22 @@ void blake2s_final(blake2s_context *bc, void *dst);
 void blake2s(void *dst, size_t dst_len, const void *key, size_t key_len,
 	const void *src, size_t src_len);
 
+/*
+ * Multi-buffer BLAKE2s: compute `n` independent unkeyed BLAKE2s hashes,
+ * all with the same output length `dst_len` (in bytes). Input i is
+ * src[i] (of length src_len[i] bytes), and its output is written
+ * into dst[i]. The results are identical to calling blake2s() on each
+ * input separately.
+ *
+ * When AVX2 support is enabled, up to eight inputs are processed in
+ * parallel in the lanes of the vector registers; this is most
+ * efficient when the inputs have similar lengths (e.g. short inputs
+ * of one or two blocks). Otherwise, the inputs are processed one by
+ * one.
+ */
+void blake2s_multi(void *const *dst, size_t dst_len,
+	const void *const *src, const size_t *src_len, size_t n);
+
 #ifdef __cplusplus
 }
 #endif
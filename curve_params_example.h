@@ -0,0 +1,55 @@
+/*
+ * Example parameter file for a custom curve build of jq255.c (see the
+ * JQ_PARAMS option in jq255.c, and 'make custom' in the Makefile).
+ *
+ * The values below are those of jq255e, so that the complete build
+ * path (table generation included) can be checked against the jq255e
+ * test vectors ('make test_custom').
+ *
+ * The curve equation is y^2 = x*(x^2 + a*x + b) over GF(2^255-MQ). The
+ * point formulas are specialized to the (a, b) values of the two
+ * families, and JQ selects one:
+ *
+ *    JQ255E   a = 0, b = -2; the group order r must be lower than
+ *             2^254 (r = 2^254 - R0), and the GLV endomorphism
+ *             constants must be provided
+ *    JQ255S   a = -1, b = 1/2; the group order r must be greater than
+ *             2^254 (r = 2^254 + R0)
+ *
+ * In both cases, the curve must have order 2*r with r prime, and
+ * 0 < R0 < 2^127. MQ must follow the field rules listed in jq255.c.
+ * Field elements are written with the LGF() macro (eight 32-bit limbs,
+ * little-endian order, fully reduced).
+ */
+
+/* Curve family. */
+#define JQ           JQ255E
+
+/* The field modulus is q = 2^255 - MQ. */
+#define MQ           18651
+
+/* R0 = |r - 2^254|, four 32-bit limbs, little-endian order. */
+#define JQ_R0_0      0x8B27BADB
+#define JQ_R0_1      0xE0AD3751
+#define JQ_R0_2      0xABF873AC
+#define JQ_R0_3      0x62F36CF0
+
+/*
+ * Generator, in affine extended (E, U, T) coordinates: U = x/y,
+ * T = U^2, and E^2 = (a^2-4*b)*U^4 - 2*a*U^2 + 1.
+ */
+#define JQ_GEN       LGF(3, 0, 0, 0, 0, 0, 0, 0), \
+                     LGF(1, 0, 0, 0, 0, 0, 0, 0), \
+                     LGF(1, 0, 0, 0, 0, 0, 0, 0)
+
+/*
+ * JQ255E family only: the endomorphism (x, y) -> (-x, ETA*y), with ETA
+ * a square root of -1 in the field, multiplies points by mu, a square
+ * root of -1 modulo r. The scalar split uses the lattice basis (u, v),
+ * (-v, u) with u^2 + v^2 = r and u = v*mu mod r (u and v over four
+ * 32-bit limbs, less than 2^127).
+ */
+#define JQ_SPLIT_U   0xC93F6111, 0x2ACCF9DE, 0x53C2C6E6, 0x1A509F7A
+#define JQ_SPLIT_V   0x5466F77E, 0x0B7A3130, 0xFFBB3A93, 0x7D440C6A
+#define JQ_ETA       LGF(0xAA938AEE, 0xD99E0F1B, 0xB30E6336, 0xA60D864F, \
+                         0xE53688E3, 0xE414983F, 0x3C69B85F, 0x10ED2DB3)
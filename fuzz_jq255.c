@@ -0,0 +1,664 @@
+/*
+ * Differential fuzzing harness for jq255e and jq255s.
+ *
+ * The program links two builds of jq255.c for the same curve: the build
+ * under test, compiled with the normal options (64-bit backend, safegcd
+ * inversion, MULX/ADX with -march=native, large tables with
+ * MULGEN_TABLE=large...), and a reference build of the portable 32-bit
+ * backend (W64=0, portable window lookups with JQ_LOOKUP=0, default
+ * tables), whose public functions have the suffix _w32. Each input
+ * selects an operation (key decoding, signature generation, signature
+ * verification, ECDH, and their batch variants) and its parameters; the
+ * operation is performed with the reference build, and with every path
+ * of the build under test that computes the same thing (e.g. single,
+ * batch and expanded-key verification). All outcomes must be identical;
+ * any mismatch is reported and the program aborts, so that the fuzzer
+ * keeps the input.
+ *
+ * Input format: the first byte selects the operation (modulo 7); the
+ * rest of the input provides the parameters, in order (missing bytes
+ * are read as zeros):
+ *
+ *    0  decode    count byte (2 to 7 keys), encoded keys (32 bytes
+ *                 each), decoded as public keys (one by one and with
+ *                 the batch decoder) and as private keys
+ *    1  sign      mode byte (bit 0: BLAKE2s hash instead of the raw
+ *                 message; bits 1-4: seed length), key pair seed (32
+ *                 bytes), signature seed, message (rest of the input)
+ *    2  verify    mode byte (bit 0: raw public key and signature from
+ *                 the input, otherwise a signature made by the reference
+ *                 build with one bit flipped; bits 1-3: batch size
+ *                 minus 1), flipped bit index (2 bytes, little-endian,
+ *                 modulo 512; no flip if 384 or more), key pair seed or
+ *                 encoded public key (32 bytes), signature (48 bytes,
+ *                 raw mode only), message (rest of the input)
+ *    3  ECDH      mode byte (bit 0: raw peer key from the input,
+ *                 otherwise a generated valid key), key pair seed (32
+ *                 bytes), peer key or peer key pair seed (32 bytes)
+ *    4  keygen    count byte (4 to 16 key pairs), seed material (48
+ *       batch     bytes), seed lengths (one byte per key pair); seed i
+ *                 starts at offset i of the seed material
+ *    5  sign      count byte (4 to 16 signatures), key pair seed (32
+ *       many      bytes), message material (rest of the input); message
+ *                 i is the material truncated by i bytes (or empty)
+ *    6  ECDH      count byte (4 to 16 peers), raw key mask (2 bytes,
+ *       many      little-endian; bit i: peer i is a raw key from the
+ *                 input, otherwise a generated valid key), key pair
+ *                 seed (32 bytes), then for each peer, in order: a raw
+ *                 key or a peer key pair seed (32 bytes)
+ *
+ * The batch operations use at least 4 items, so that the 8-way AVX-512
+ * IFMA code (when supported by the CPU) is exercised, and compare each
+ * item against the reference build.
+ *
+ * Usage ('make fuzz_jq255e fuzz_jq255s'):
+ *
+ *    fuzz_jq255e file...    run each file as one input (this is the
+ *                           AFL convention: afl-fuzz ... -- fuzz_jq255e @@)
+ *    fuzz_jq255e            run one input read from standard input
+ *    fuzz_jq255e -random num [ seed ]
+ *                           run num pseudo-random inputs (derived
+ *                           from the seed string, "jq255" by default);
+ *                           this is what 'make fuzz-check' does
+ *
+ * For libFuzzer, compile with JQ_LIBFUZZER defined (the main() function
+ * is then omitted) and with the instrumentation options, e.g.:
+ *
+ *    make CC=clang LD=clang \
+ *        FUZZ_CFLAGS='-DJQ_LIBFUZZER -fsanitize=fuzzer-no-link,address' \
+ *        FUZZ_LDFLAGS='-fsanitize=fuzzer,address' fuzz_jq255e
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "blake2s.h"
+#include "jq255.h"
+
+#ifndef JQ
+#define JQ   JQ255E
+#endif
+
+#define JQ255E   1
+#define JQ255S   2
+
+/*
+ * The API functions used by the harness (names without the curve
+ * prefix).
+ */
+#define FUZZ_API(X) \
+	X(generate_keypair) \
+	X(generate_keypairs) \
+	X(decode_private_key) \
+	X(decode_public_key) \
+	X(decode_public_keys) \
+	X(encode_private_key) \
+	X(encode_public_key) \
+	X(sign_seeded) \
+	X(sign_many) \
+	X(signer_init) \
+	X(signer_sign) \
+	X(verify) \
+	X(verify_batch) \
+	X(expand_public_key) \
+	X(verify_expanded) \
+	X(ECDH) \
+	X(ECDH_many) \
+	X(ECDH_prepare_self) \
+	X(ECDH_prepare_peer) \
+	X(ECDH_prepared)
+
+#if JQ == JQ255E
+
+#define CURVE_NAME                "jq255e"
+#define jq_private_key            jq255e_private_key
+#define jq_public_key             jq255e_public_key
+#define jq_public_key_expanded    jq255e_public_key_expanded
+#define jq_keypair                jq255e_keypair
+#define jq_signer                 jq255e_signer
+#define jq_verify_item            jq255e_verify_item
+#define jq_ECDH_self              jq255e_ECDH_self
+#define jq_ECDH_peer              jq255e_ECDH_peer
+#define FUZZ_FN(name)             jq255e_ ## name
+#define REF_FN(name)              jq255e_ ## name ## _w32
+
+#elif JQ == JQ255S
+
+#define CURVE_NAME                "jq255s"
+#define jq_private_key            jq255s_private_key
+#define jq_public_key             jq255s_public_key
+#define jq_public_key_expanded    jq255s_public_key_expanded
+#define jq_keypair                jq255s_keypair
+#define jq_signer                 jq255s_signer
+#define jq_verify_item            jq255s_verify_item
+#define jq_ECDH_self              jq255s_ECDH_self
+#define jq_ECDH_peer              jq255s_ECDH_peer
+#define FUZZ_FN(name)             jq255s_ ## name
+#define REF_FN(name)              jq255s_ ## name ## _w32
+
+#else
+#error Unknown curve
+#endif
+
+/*
+ * The reference functions have the same prototypes as the ones under
+ * test.
+ */
+#define REF_DECL(name)   __typeof__(FUZZ_FN(name)) REF_FN(name);
+FUZZ_API(REF_DECL)
+
+#define jq(name)    FUZZ_FN(name)
+#define ref(name)   REF_FN(name)
+
+static void
+fuzz_fail(const char *what)
+{
+	fprintf(stderr, "MISMATCH (%s): %s\n", CURVE_NAME, what);
+	fflush(stderr);
+	abort();
+}
+
+#define CHECK(cond, what)   do { \
+		if (!(cond)) { \
+			fuzz_fail(what); \
+		} \
+	} while (0)
+
+/*
+ * Input reader; bytes beyond the end of the input are zeros.
+ */
+typedef struct {
+	const uint8_t *buf;
+	size_t len;
+} fuzz_input;
+
+static void
+fuzz_take(void *dst, size_t len, fuzz_input *in)
+{
+	size_t clen;
+
+	clen = len < in->len ? len : in->len;
+	memcpy(dst, in->buf, clen);
+	memset((uint8_t *)dst + clen, 0, len - clen);
+	in->buf += clen;
+	in->len -= clen;
+}
+
+static unsigned
+fuzz_byte(fuzz_input *in)
+{
+	uint8_t b;
+
+	fuzz_take(&b, 1, in);
+	return b;
+}
+
+/*
+ * Generate the same key pair with both builds; the encodings must
+ * match.
+ */
+static void
+fuzz_keypairs(jq_keypair *jk, jq_keypair *rk, const uint8_t *seed)
+{
+	uint8_t e1[32], e2[32];
+
+	jq(generate_keypair)(jk, seed, 32);
+	ref(generate_keypair)(rk, seed, 32);
+	jq(encode_private_key)(e1, &jk->private_key);
+	ref(encode_private_key)(e2, &rk->private_key);
+	CHECK(memcmp(e1, e2, 32) == 0, "keygen: private key");
+	jq(encode_public_key)(e1, &jk->public_key);
+	ref(encode_public_key)(e2, &rk->public_key);
+	CHECK(memcmp(e1, e2, 32) == 0, "keygen: public key");
+}
+
+/*
+ * Decode a public key with both builds; the status and the re-encoded
+ * key must match. The status is returned.
+ */
+static int
+fuzz_decode_pub(jq_public_key *pk, jq_public_key *rpk, const uint8_t *src)
+{
+	uint8_t e1[32], e2[32];
+	int r1, r2;
+
+	r1 = jq(decode_public_key)(pk, src, 32);
+	r2 = ref(decode_public_key)(rpk, src, 32);
+	CHECK(r1 == r2, "decode public key: status");
+	jq(encode_public_key)(e1, pk);
+	ref(encode_public_key)(e2, rpk);
+	CHECK(memcmp(e1, e2, 32) == 0, "decode public key: value");
+	return r1;
+}
+
+/*
+ * Maximum number of items in the batch operations.
+ */
+#define FUZZ_MAX_BATCH   16
+
+static size_t
+fuzz_count(fuzz_input *in, size_t min, size_t max)
+{
+	return min + fuzz_byte(in) % (max - min + 1);
+}
+
+static void
+fuzz_decode(fuzz_input *in)
+{
+	uint8_t src[7][32], e1[32], e2[32], ok;
+	jq_public_key pk[7], rpk, pk2;
+	jq_private_key sk, rsk;
+	size_t num;
+	int r1, r2, all;
+
+	/* The batch decoder processes the keys in pairs; odd counts
+	   also use the single-key path for the last key. */
+	num = fuzz_count(in, 2, 7);
+	fuzz_take(src, 32 * num, in);
+	ok = 0;
+	r1 = jq(decode_public_keys)(pk, src, num, &ok);
+	all = 1;
+	for (size_t i = 0; i < num; i ++) {
+		r2 = fuzz_decode_pub(&pk2, &rpk, src[i]);
+		CHECK(((ok >> i) & 1) == (unsigned)r2,
+			"decode public key: status (batch)");
+		jq(encode_public_key)(e1, &pk[i]);
+		ref(encode_public_key)(e2, &rpk);
+		CHECK(memcmp(e1, e2, 32) == 0,
+			"decode public key: value (batch)");
+		all &= r2;
+	}
+	CHECK(r1 == all, "decode public key: batch status");
+	CHECK((ok >> num) == 0, "decode public key: batch bitmap");
+
+	r1 = jq(decode_private_key)(&sk, src[0], 32);
+	r2 = ref(decode_private_key)(&rsk, src[0], 32);
+	CHECK(r1 == r2, "decode private key: status");
+	jq(encode_private_key)(e1, &sk);
+	ref(encode_private_key)(e2, &rsk);
+	CHECK(memcmp(e1, e2, 32) == 0, "decode private key: value");
+}
+
+/*
+ * Prepare the message from the rest of the input: either the raw
+ * message, or its BLAKE2s hash.
+ */
+static void
+fuzz_message(uint8_t *hv, const char **hash_name, const void **msg,
+	size_t *msg_len, int hashed, fuzz_input *in)
+{
+	if (hashed) {
+		blake2s(hv, 32, NULL, 0, in->buf, in->len);
+		*hash_name = JQ255_HASHNAME_BLAKE2S;
+		*msg = hv;
+		*msg_len = 32;
+	} else {
+		*hash_name = "";
+		*msg = in->buf;
+		*msg_len = in->len;
+	}
+}
+
+static void
+fuzz_sign(fuzz_input *in)
+{
+	unsigned mode;
+	uint8_t kseed[32], sseed[15], hv[32];
+	uint8_t s1[48], s2[48], s3[48];
+	size_t sseed_len, msg_len;
+	const char *hash_name;
+	const void *msg;
+	jq_keypair jk, rk;
+	jq_signer sg;
+
+	mode = fuzz_byte(in);
+	fuzz_take(kseed, 32, in);
+	sseed_len = (mode >> 1) & 15;
+	if (sseed_len > sizeof sseed) {
+		sseed_len = sizeof sseed;
+	}
+	fuzz_take(sseed, sseed_len, in);
+	fuzz_message(hv, &hash_name, &msg, &msg_len, mode & 1, in);
+
+	fuzz_keypairs(&jk, &rk, kseed);
+	jq(sign_seeded)(s1, &jk, hash_name, msg, msg_len,
+		sseed, sseed_len);
+	ref(sign_seeded)(s2, &rk, hash_name, msg, msg_len,
+		sseed, sseed_len);
+	CHECK(memcmp(s1, s2, 48) == 0, "sign: signature");
+	jq(signer_init)(&sg, &jk);
+	jq(signer_sign)(s3, &sg, hash_name, msg, msg_len,
+		sseed, sseed_len);
+	CHECK(memcmp(s1, s3, 48) == 0, "sign: signature (signer)");
+	CHECK(ref(verify)(s1, 48, &rk.public_key, hash_name, msg, msg_len),
+		"sign: verification");
+}
+
+static void
+fuzz_verify(fuzz_input *in)
+{
+	unsigned mode, flip;
+	uint8_t src[32], sig[48], hv[32], results;
+	size_t msg_len, num;
+	const char *hash_name;
+	const void *msg;
+	jq_public_key pk, rpk;
+	jq_public_key_expanded epk;
+	jq_verify_item items[8];
+	int r0, r1, r2, r3;
+
+	mode = fuzz_byte(in);
+	flip = fuzz_byte(in);
+	flip = (flip | (fuzz_byte(in) << 8)) & 511;
+	fuzz_take(src, 32, in);
+	if (mode & 1) {
+		fuzz_take(sig, 48, in);
+		fuzz_message(hv, &hash_name, &msg, &msg_len, 0, in);
+	} else {
+		jq_keypair jk, rk;
+
+		fuzz_message(hv, &hash_name, &msg, &msg_len, 0, in);
+		fuzz_keypairs(&jk, &rk, src);
+		ref(sign_seeded)(sig, &rk, hash_name, msg, msg_len, NULL, 0);
+		ref(encode_public_key)(src, &rk.public_key);
+		if (flip < 384) {
+			sig[flip >> 3] ^= (uint8_t)(1u << (flip & 7));
+		}
+	}
+	fuzz_decode_pub(&pk, &rpk, src);
+
+	r0 = ref(verify)(sig, 48, &rpk, hash_name, msg, msg_len);
+	r1 = jq(verify)(sig, 48, &pk, hash_name, msg, msg_len);
+	CHECK(r0 == r1, "verify");
+	jq(expand_public_key)(&epk, &pk);
+	r2 = jq(verify_expanded)(sig, 48, &epk, hash_name, msg, msg_len);
+	CHECK(r0 == r2, "verify (expanded)");
+	num = 1 + ((mode >> 1) & 7);
+	for (size_t i = 0; i < num; i ++) {
+		items[i].sig = sig;
+		items[i].sig_len = 48;
+		items[i].pk = &pk;
+		items[i].hash_name = hash_name;
+		items[i].hv = msg;
+		items[i].hv_len = msg_len;
+	}
+	results = 0;
+	r3 = jq(verify_batch)(&results, items, num);
+	CHECK(r0 == r3, "verify (batch)");
+	CHECK(results == (r0 ? (1u << num) - 1 : 0),
+		"verify (batch results)");
+}
+
+static void
+fuzz_ECDH(fuzz_input *in)
+{
+	unsigned mode;
+	uint8_t kseed[32], src[32], k1[32], k2[32], k3[32];
+	jq_keypair jk, rk;
+	jq_public_key pk, rpk;
+	jq_ECDH_self es;
+	jq_ECDH_peer ep;
+	int r1, r2, r3;
+
+	mode = fuzz_byte(in);
+	fuzz_take(kseed, 32, in);
+	fuzz_take(src, 32, in);
+	fuzz_keypairs(&jk, &rk, kseed);
+	if (!(mode & 1)) {
+		jq_keypair jk2, rk2;
+
+		fuzz_keypairs(&jk2, &rk2, src);
+		ref(encode_public_key)(src, &rk2.public_key);
+	}
+	fuzz_decode_pub(&pk, &rpk, src);
+
+	r1 = jq(ECDH)(k1, &jk, &pk);
+	r2 = ref(ECDH)(k2, &rk, &rpk);
+	CHECK(r1 == r2, "ECDH: status");
+	CHECK(memcmp(k1, k2, 32) == 0, "ECDH: key");
+	jq(ECDH_prepare_self)(&es, &jk);
+	jq(ECDH_prepare_peer)(&ep, &pk);
+	r3 = jq(ECDH_prepared)(k3, &es, &ep);
+	CHECK(r1 == r3, "ECDH: status (prepared)");
+	CHECK(memcmp(k1, k3, 32) == 0, "ECDH: key (prepared)");
+}
+
+static void
+fuzz_keygen_batch(fuzz_input *in)
+{
+	uint8_t mat[48 + FUZZ_MAX_BATCH], e1[64], e2[64];
+	const void *seeds[FUZZ_MAX_BATCH];
+	size_t seed_len[FUZZ_MAX_BATCH], num;
+	jq_keypair jk[FUZZ_MAX_BATCH], rk;
+
+	num = fuzz_count(in, 4, FUZZ_MAX_BATCH);
+	fuzz_take(mat, 48, in);
+	memset(mat + 48, 0, sizeof mat - 48);
+	for (size_t i = 0; i < num; i ++) {
+		seeds[i] = mat + i;
+		seed_len[i] = fuzz_byte(in) % 49;
+	}
+	jq(generate_keypairs)(jk, seeds, seed_len, num);
+	for (size_t i = 0; i < num; i ++) {
+		ref(generate_keypair)(&rk, seeds[i], seed_len[i]);
+		jq(encode_private_key)(e1, &jk[i].private_key);
+		jq(encode_public_key)(e1 + 32, &jk[i].public_key);
+		ref(encode_private_key)(e2, &rk.private_key);
+		ref(encode_public_key)(e2 + 32, &rk.public_key);
+		CHECK(memcmp(e1, e2, 64) == 0, "keygen (batch)");
+	}
+}
+
+static void
+fuzz_sign_many(fuzz_input *in)
+{
+	uint8_t kseed[32], s1[FUZZ_MAX_BATCH][48], s2[48];
+	const void *msg[FUZZ_MAX_BATCH];
+	size_t msg_len[FUZZ_MAX_BATCH], num;
+	jq_keypair jk, rk;
+
+	num = fuzz_count(in, 4, FUZZ_MAX_BATCH);
+	fuzz_take(kseed, 32, in);
+	fuzz_keypairs(&jk, &rk, kseed);
+	for (size_t i = 0; i < num; i ++) {
+		msg[i] = in->buf;
+		msg_len[i] = i < in->len ? in->len - i : 0;
+	}
+	CHECK(jq(sign_many)(s1, &jk, "", msg, msg_len, num, NULL)
+		== 48 * num, "sign (many): length");
+	for (size_t i = 0; i < num; i ++) {
+		ref(sign_seeded)(s2, &rk, "", msg[i], msg_len[i], NULL, 0);
+		CHECK(memcmp(s1[i], s2, 48) == 0, "sign (many)");
+	}
+}
+
+static void
+fuzz_ECDH_many(fuzz_input *in)
+{
+	uint8_t kseed[32], src[32], k1[FUZZ_MAX_BATCH][32], k2[32];
+	uint8_t ok[(FUZZ_MAX_BATCH + 7) >> 3];
+	unsigned raw;
+	size_t num;
+	jq_keypair jk, rk;
+	jq_public_key pk[FUZZ_MAX_BATCH], rpk[FUZZ_MAX_BATCH];
+	int r, all;
+
+	num = fuzz_count(in, 4, FUZZ_MAX_BATCH);
+	raw = fuzz_byte(in);
+	raw |= fuzz_byte(in) << 8;
+	fuzz_take(kseed, 32, in);
+	fuzz_keypairs(&jk, &rk, kseed);
+	for (size_t i = 0; i < num; i ++) {
+		fuzz_take(src, 32, in);
+		if (!((raw >> i) & 1)) {
+			jq_keypair jk2, rk2;
+
+			src[0] ^= (uint8_t)i;
+			fuzz_keypairs(&jk2, &rk2, src);
+			ref(encode_public_key)(src, &rk2.public_key);
+		}
+		fuzz_decode_pub(&pk[i], &rpk[i], src);
+	}
+
+	memset(ok, 0, sizeof ok);
+	r = jq(ECDH_many)(k1, &jk, pk, num, ok);
+	all = 1;
+	for (size_t i = 0; i < num; i ++) {
+		int r2 = ref(ECDH)(k2, &rk, &rpk[i]);
+
+		CHECK(((ok[i >> 3] >> (i & 7)) & 1) == (unsigned)r2,
+			"ECDH (many): status");
+		CHECK(memcmp(k1[i], k2, 32) == 0, "ECDH (many): key");
+		all &= r2;
+	}
+	CHECK(r == all, "ECDH (many): global status");
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/* libFuzzer entry point (also used by the standalone driver). */
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	fuzz_input in;
+
+	if (size == 0) {
+		return 0;
+	}
+	in.buf = data + 1;
+	in.len = size - 1;
+	switch (data[0] % 7) {
+	case 0:
+		fuzz_decode(&in);
+		break;
+	case 1:
+		fuzz_sign(&in);
+		break;
+	case 2:
+		fuzz_verify(&in);
+		break;
+	case 3:
+		fuzz_ECDH(&in);
+		break;
+	case 4:
+		fuzz_keygen_batch(&in);
+		break;
+	case 5:
+		fuzz_sign_many(&in);
+		break;
+	default:
+		fuzz_ECDH_many(&in);
+		break;
+	}
+	return 0;
+}
+
+#ifndef JQ_LIBFUZZER
+
+#define FUZZ_MAX_INPUT   (1u << 20)
+
+static size_t
+read_input(uint8_t *buf, const char *fname)
+{
+	FILE *f;
+	size_t len;
+
+	f = (fname == NULL) ? stdin : fopen(fname, "rb");
+	if (f == NULL) {
+		perror(fname);
+		exit(EXIT_FAILURE);
+	}
+	len = fread(buf, 1, FUZZ_MAX_INPUT, f);
+	if (ferror(f)) {
+		perror(fname == NULL ? "stdin" : fname);
+		exit(EXIT_FAILURE);
+	}
+	if (fname != NULL) {
+		fclose(f);
+	}
+	return len;
+}
+
+/*
+ * Pseudo-random inputs: input i is made of BLAKE2s outputs keyed with
+ * the seed string, over i and a block counter; its length is 1 to 256
+ * bytes.
+ */
+static void
+run_random(unsigned long num, const char *seed)
+{
+	uint8_t buf[256];
+
+	for (unsigned long i = 0; i < num; i ++) {
+		uint8_t ctr[9];
+		size_t len;
+
+		for (int j = 0; j < 8; j ++) {
+			ctr[j] = (uint8_t)((uint64_t)i >> (8 * j));
+		}
+		for (int j = 0; j < 8; j ++) {
+			ctr[8] = (uint8_t)j;
+			blake2s(buf + 32 * j, 32, seed, strlen(seed),
+				ctr, sizeof ctr);
+		}
+		len = 1 + (size_t)buf[255];
+		LLVMFuzzerTestOneInput(buf, len);
+		if ((i + 1) % 1000 == 0) {
+			printf(".");
+			fflush(stdout);
+		}
+	}
+}
+
+static void
+usage(void)
+{
+	fprintf(stderr,
+"usage: fuzz_%s [ file... ]\n"
+"       fuzz_%s -random num [ seed ]\n", CURVE_NAME, CURVE_NAME);
+	exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char *argv[])
+{
+	uint8_t *buf;
+
+	if (argc >= 2 && strcmp(argv[1], "-random") == 0) {
+		unsigned long num;
+
+		if (argc < 3 || argc > 4) {
+			usage();
+		}
+		num = strtoul(argv[2], NULL, 0);
+		printf("Differential fuzzing (%s), %lu random inputs: ",
+			CURVE_NAME, num);
+		fflush(stdout);
+		run_random(num, argc == 4 ? argv[3] : "jq255");
+		printf(" done.\n");
+		return 0;
+	}
+	if (argc >= 2 && argv[1][0] == '-') {
+		usage();
+	}
+
+	buf = malloc(FUZZ_MAX_INPUT);
+	if (buf == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	if (argc < 2) {
+		LLVMFuzzerTestOneInput(buf, read_input(buf, NULL));
+	} else {
+		for (int i = 1; i < argc; i ++) {
+			LLVMFuzzerTestOneInput(buf, read_input(buf, argv[i]));
+		}
+	}
+	free(buf);
+	return 0;
+}
+
+#endif
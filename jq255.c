@@ -14,12 +14,77 @@
  * W64    If defined to 1, uses 64-bit words.
  *        If defined to 0, uses 32-bit words.
  *        If undefined, then it autodetects the arch abilities.
+ *
+ * MULGEN_LARGE
+ *        If defined to 1, multiplication of the base point (used in key
+ *        pair generation and signature generation) uses larger
+ *        precomputed tables, with fewer point doublings. The tables are
+ *        included from the file jq255e_mulgen.h (or jq255s_mulgen.h),
+ *        produced by the mkmulgen tool (see mkmulgen.c).
+ *        If undefined or defined to 0, then the built-in tables are used.
+ *
+ * JQ_IFMA
+ *        If defined to 1, batch operations (e.g. jq255e_sign_many())
+ *        use an 8-way implementation with AVX-512 IFMA instructions,
+ *        when a runtime check shows that the CPU supports them.
+ *        If undefined, then it is enabled on 64-bit x86 with GCC or
+ *        Clang (and W64 = 1).
+ *
+ * JQ_LOOKUP
+ *        Selects the implementation of the constant-time window lookups
+ *        (which read all entries of a window for each scalar digit):
+ *          0   portable code (masked selections over the field limbs)
+ *          1   AVX2, when a runtime check shows that the CPU supports
+ *              it (no check if the compiler already targets AVX2)
+ *          2   NEON
+ *        If undefined, then AVX2 is used on 64-bit x86 with GCC or
+ *        Clang, NEON on 64-bit ARM, and the portable code otherwise.
+ *
+ * JQ_SAFEGCD
+ *        If defined to 1, field inversions (e.g. in point encoding) use
+ *        the constant-time safegcd algorithm of Bernstein and Yang,
+ *        instead of an exponentiation (Fermat's little theorem). This
+ *        requires W64 = 1 and a compiler with 128-bit integers. If
+ *        undefined, then it is enabled when these conditions are met.
+ *
+ * JQ255_STATS
+ *        If defined to 1, per-thread counters and cycle accumulators are
+ *        maintained for some internal stages (see jq255e_stats_snapshot()
+ *        in jq255.h). If undefined or defined to 0, then no
+ *        instrumentation code is compiled, and the snapshot function
+ *        reports zeros.
+ *
+ * JQ_PARAMS
+ *        If defined, this is the name of a header file (with its quotes)
+ *        that provides the parameters of a custom curve: the family (JQ,
+ *        which selects the curve equation and formulas), the modulus,
+ *        the group order, the generator, and, for the JQ255E family, the
+ *        endomorphism constants. The parameters are compile-time
+ *        constants, so that the code is specialized exactly as for the
+ *        built-in curves. The base point windows are included from
+ *        the file named by JQ_TABLES, generated by mkmulgen; if
+ *        JQ_TABLES is not defined, then the windows hold only the
+ *        generator (this is meant only for running mkmulgen). With
+ *        MULGEN_LARGE, the large tables are included from the file
+ *        named by JQ_MULGEN. See curve_params_example.h for the
+ *        format, and the Makefile for the build steps.
  */
 
+#ifdef JQ_PARAMS
+#include JQ_PARAMS
+#ifndef JQ
+#error JQ_PARAMS: JQ (curve family) is not defined
+#endif
+#endif
+
 #ifndef JQ
 #define JQ   JQ255E
 #endif
 
+#ifndef MULGEN_LARGE
+#define MULGEN_LARGE   0
+#endif
+
 #ifndef W64
 #if defined _MSC_VER && defined _M_X64 \
 	|| (((ULONG_MAX >> 31) >> 31) == 3 \
@@ -30,9 +95,96 @@
 #endif
 #endif
 
+#ifndef JQ_IFMA
+#if W64 && defined __x86_64__ && (defined __GNUC__ || defined __clang__)
+#define JQ_IFMA   1
+#else
+#define JQ_IFMA   0
+#endif
+#endif
+
+#ifndef JQ_LOOKUP
+#if defined __x86_64__ && (defined __GNUC__ || defined __clang__)
+#define JQ_LOOKUP   1
+#elif defined __aarch64__ && defined __ARM_NEON
+#define JQ_LOOKUP   2
+#else
+#define JQ_LOOKUP   0
+#endif
+#endif
+
+#ifndef JQ_SAFEGCD
+#if W64 && defined __SIZEOF_INT128__
+#define JQ_SAFEGCD   1
+#else
+#define JQ_SAFEGCD   0
+#endif
+#endif
+#if JQ_SAFEGCD && !W64
+#error JQ_SAFEGCD requires W64
+#endif
+
+#ifndef JQ255_STATS
+#define JQ255_STATS   0
+#endif
+
 #define JQ255E   1
 #define JQ255S   2
 
+/*
+ * Thread-local storage, for the instrumentation counters and the base
+ * point tables selection. Without compiler support, these variables
+ * are global.
+ */
+#if defined __GNUC__ || defined __clang__
+#define JQ_TLS   __thread
+#elif defined _MSC_VER
+#define JQ_TLS   __declspec(thread)
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 201112L
+#define JQ_TLS   _Thread_local
+#else
+#define JQ_TLS
+#endif
+
+/* ===================================================================== */
+/*
+ * Instrumentation. A stage is bracketed by STATS_BEGIN(t) (which
+ * declares the variable t) and STATS_END(t, id, n), which adds n to the
+ * count of stage id and the elapsed cycles to its accumulator. The
+ * counters are thread-local. Without JQ255_STATS, both macros expand
+ * to nothing.
+ */
+#if JQ255_STATS
+
+#include "jq255.h"
+
+#if (defined __x86_64__ || defined __i386__) \
+	&& (defined __GNUC__ || defined __clang__)
+#include <x86intrin.h>
+#define stats_cycles()   ((uint64_t)__rdtsc())
+#elif defined _MSC_VER && (defined _M_X64 || defined _M_IX86)
+#include <intrin.h>
+#define stats_cycles()   ((uint64_t)__rdtsc())
+#else
+/* No cycle counter: only the counts are maintained. */
+#define stats_cycles()   ((uint64_t)0)
+#endif
+
+static JQ_TLS jq255_stats jq_stats_tls;
+
+#define STATS_BEGIN(t)   uint64_t t = stats_cycles()
+#define STATS_END(t, id, n)   do { \
+		jq_stats_tls.count[id] += (n); \
+		jq_stats_tls.cycles[id] += stats_cycles() - (t); \
+	} while (0)
+
+#else
+
+#define STATS_BEGIN(t)        do { } while (0)
+#define STATS_END(t, id, n)   do { } while (0)
+
+#endif
+
 /* ===================================================================== */
 /*
  * We work in the finite field GF(2^255-MQ).
@@ -42,7 +194,11 @@
  *    MQ != 7 mod 8
  *    2^255 - MQ is a prime integer
  */
-#if JQ == JQ255E
+#if defined JQ_PARAMS
+#ifndef MQ
+#error JQ_PARAMS: MQ is not defined
+#endif
+#elif JQ == JQ255E
 #define MQ   18651
 #elif JQ == JQ255S
 #define MQ   3957
@@ -295,7 +451,7 @@ gf_lsh(gf *d, const gf *a, unsigned n)
 	cc = adc(cc, d1, 0, &d->v1);
 	cc = adc(cc, d2, 0, &d->v2);
 	cc = adc(cc, d3, 0, &d->v3);
-	(void)adc(cc, d0, -(uint64_t)cc & (2 * MQ), &d->v0);
+	(void)adc(0, d0, -(uint64_t)cc & (2 * MQ), &d->v0);
 }
 
 /*
@@ -726,6 +882,310 @@ gf_encode(void *dst, const gf *a)
 	enc64le(buf + 24, x.v3);
 }
 
+#if JQ_SAFEGCD
+/*
+ * Constant-time inversion with the Bernstein-Yang "safegcd" algorithm
+ * (https://eprint.iacr.org/2019/266), in the variant with the improved
+ * (half-delta) divstep definition and the bound of 590 divsteps for
+ * 256-bit moduli, following the libsecp256k1 implementation
+ * (modinv64_impl.h, MIT license). Values are represented in base 2^62,
+ * over five signed limbs; the divsteps are applied in 10 batches of 59,
+ * each batch working on the low limbs only and yielding a 2x2
+ * transition matrix (scaled by 2^62) which is then applied to the full
+ * values. The sequence of operations does not depend on the input.
+ */
+typedef struct {
+	int64_t v[5];
+} gf_s62;
+
+typedef struct {
+	int64_t u, v, q, r;
+} gf_trans2x2;
+
+#define GF_M62   ((uint64_t)-1 >> 2)
+
+/* q = 2^255 - MQ in base 2^62 (limbs may be negative) */
+static const gf_s62 gf_q_s62 = { { -(int64_t)MQ, 0, 0, 0, 128 } };
+
+/*
+ * Return 1/q mod 2^62. The operands are compile-time constants, hence
+ * this function is normally evaluated by the compiler.
+ */
+static inline uint64_t
+gf_q_inv62(void)
+{
+	uint64_t q0, y;
+
+	/* Newton iteration: each step doubles the number of valid bits
+	   (3 initially, since y*y = 1 mod 8 for any odd y). */
+	q0 = -(uint64_t)MQ;
+	y = q0;
+	for (int i = 0; i < 5; i ++) {
+		y *= 2 - q0 * y;
+	}
+	return y & GF_M62;
+}
+
+/*
+ * Apply 59 divsteps on the low 62 bits of f and g (f0 and g0), starting
+ * with the value zeta = -(delta+1/2); the new zeta is returned, and the
+ * transition matrix (multiplied by 2^62) is written in t.
+ */
+static int64_t
+gf_divsteps_59(int64_t zeta, uint64_t f0, uint64_t g0, gf_trans2x2 *t)
+{
+	uint64_t u, v, q, r, f, g;
+
+	u = 8;
+	v = 0;
+	q = 0;
+	r = 8;
+	f = f0;
+	g = g0;
+	for (int i = 3; i < 62; i ++) {
+		uint64_t mask1, mask2, x, y, z;
+
+		/* mask1 = -1 if zeta < 0, mask2 = -1 if g is odd */
+		mask1 = (uint64_t)(zeta >> 63);
+		mask2 = -(g & 1);
+
+		/* If zeta < 0, negate f, u and v (conditionally swapped
+		   below); then, if g is odd, add them to g, q and r. */
+		x = (f ^ mask1) - mask1;
+		y = (u ^ mask1) - mask1;
+		z = (v ^ mask1) - mask1;
+		g += x & mask2;
+		q += y & mask2;
+		r += z & mask2;
+
+		/* If zeta < 0 and g was odd, then the swap takes place:
+		   update zeta and add back g, q and r into f, u and v. */
+		mask1 &= mask2;
+		zeta = (zeta ^ (int64_t)mask1) - 1;
+		f += g & mask1;
+		u += q & mask1;
+		v += r & mask1;
+
+		g >>= 1;
+		u <<= 1;
+		v <<= 1;
+	}
+	t->u = (int64_t)u;
+	t->v = (int64_t)v;
+	t->q = (int64_t)q;
+	t->r = (int64_t)r;
+	return zeta;
+}
+
+/*
+ * (d, e) <- t*(d, e) / 2^62 mod q
+ * On input and output, d and e are in the -2*q to q range (exclusive);
+ * the division is exact, since appropriate multiples of q are added.
+ */
+static void
+gf_update_de_62(gf_s62 *d, gf_s62 *e, const gf_trans2x2 *t)
+{
+	int64_t d0, d1, d2, d3, d4, e0, e1, e2, e3, e4;
+	int64_t u, v, q, r, md, me, sd, se;
+	__int128 cd, ce;
+	uint64_t qinv;
+
+	d0 = d->v[0];
+	d1 = d->v[1];
+	d2 = d->v[2];
+	d3 = d->v[3];
+	d4 = d->v[4];
+	e0 = e->v[0];
+	e1 = e->v[1];
+	e2 = e->v[2];
+	e3 = e->v[3];
+	e4 = e->v[4];
+	u = t->u;
+	v = t->v;
+	q = t->q;
+	r = t->r;
+	qinv = gf_q_inv62();
+
+	/* If d or e is negative, then add u or v (hence t*(d, e) is
+	   computed as if on the non-negative representatives d+q and
+	   e+q); md and me are the multiples of q to add to make the low
+	   62 bits zero. */
+	sd = d4 >> 63;
+	se = e4 >> 63;
+	md = (u & sd) + (v & se);
+	me = (q & sd) + (r & se);
+	cd = (__int128)u * d0 + (__int128)v * e0;
+	ce = (__int128)q * d0 + (__int128)r * e0;
+	md -= (int64_t)((qinv * (uint64_t)cd + (uint64_t)md) & GF_M62);
+	me -= (int64_t)((qinv * (uint64_t)ce + (uint64_t)me) & GF_M62);
+	cd += (__int128)gf_q_s62.v[0] * md;
+	ce += (__int128)gf_q_s62.v[0] * me;
+	cd >>= 62;
+	ce >>= 62;
+
+	/* Limbs 1 to 3 of q are zero. */
+	cd += (__int128)u * d1 + (__int128)v * e1;
+	ce += (__int128)q * d1 + (__int128)r * e1;
+	d->v[0] = (int64_t)((uint64_t)cd & GF_M62);
+	e->v[0] = (int64_t)((uint64_t)ce & GF_M62);
+	cd >>= 62;
+	ce >>= 62;
+	cd += (__int128)u * d2 + (__int128)v * e2;
+	ce += (__int128)q * d2 + (__int128)r * e2;
+	d->v[1] = (int64_t)((uint64_t)cd & GF_M62);
+	e->v[1] = (int64_t)((uint64_t)ce & GF_M62);
+	cd >>= 62;
+	ce >>= 62;
+	cd += (__int128)u * d3 + (__int128)v * e3;
+	ce += (__int128)q * d3 + (__int128)r * e3;
+	d->v[2] = (int64_t)((uint64_t)cd & GF_M62);
+	e->v[2] = (int64_t)((uint64_t)ce & GF_M62);
+	cd >>= 62;
+	ce >>= 62;
+	cd += (__int128)u * d4 + (__int128)v * e4;
+	ce += (__int128)q * d4 + (__int128)r * e4;
+	cd += (__int128)gf_q_s62.v[4] * md;
+	ce += (__int128)gf_q_s62.v[4] * me;
+	d->v[3] = (int64_t)((uint64_t)cd & GF_M62);
+	e->v[3] = (int64_t)((uint64_t)ce & GF_M62);
+	cd >>= 62;
+	ce >>= 62;
+	d->v[4] = (int64_t)cd;
+	e->v[4] = (int64_t)ce;
+}
+
+/*
+ * (f, g) <- t*(f, g) / 2^62
+ * The division is exact (the low 62 bits of the products are zero).
+ */
+static void
+gf_update_fg_62(gf_s62 *f, gf_s62 *g, const gf_trans2x2 *t)
+{
+	int64_t u, v, q, r;
+	__int128 cf, cg;
+
+	u = t->u;
+	v = t->v;
+	q = t->q;
+	r = t->r;
+	cf = (__int128)u * f->v[0] + (__int128)v * g->v[0];
+	cg = (__int128)q * f->v[0] + (__int128)r * g->v[0];
+	cf >>= 62;
+	cg >>= 62;
+	for (int i = 1; i < 5; i ++) {
+		cf += (__int128)u * f->v[i] + (__int128)v * g->v[i];
+		cg += (__int128)q * f->v[i] + (__int128)r * g->v[i];
+		f->v[i - 1] = (int64_t)((uint64_t)cf & GF_M62);
+		g->v[i - 1] = (int64_t)((uint64_t)cg & GF_M62);
+		cf >>= 62;
+		cg >>= 62;
+	}
+	f->v[4] = (int64_t)cf;
+	g->v[4] = (int64_t)cg;
+}
+
+/*
+ * Reduce r (in the -2*q to q range) into the 0 to q-1 range, after
+ * negating it if sign is negative. Limbs are normalized to 62 bits.
+ */
+static void
+gf_normalize_62(gf_s62 *r, int64_t sign)
+{
+	int64_t r0, r1, r2, r3, r4, cond_add, cond_negate;
+	const int64_t m62 = (int64_t)GF_M62;
+
+	r0 = r->v[0];
+	r1 = r->v[1];
+	r2 = r->v[2];
+	r3 = r->v[3];
+	r4 = r->v[4];
+
+	/* If r < 0, add q (the result is then in the -q to q range). */
+	cond_add = r4 >> 63;
+	r0 += gf_q_s62.v[0] & cond_add;
+	r4 += gf_q_s62.v[4] & cond_add;
+
+	/* Negate if required, then normalize the limbs. */
+	cond_negate = sign >> 63;
+	r0 = (r0 ^ cond_negate) - cond_negate;
+	r1 = (r1 ^ cond_negate) - cond_negate;
+	r2 = (r2 ^ cond_negate) - cond_negate;
+	r3 = (r3 ^ cond_negate) - cond_negate;
+	r4 = (r4 ^ cond_negate) - cond_negate;
+	r1 += r0 >> 62;
+	r0 &= m62;
+	r2 += r1 >> 62;
+	r1 &= m62;
+	r3 += r2 >> 62;
+	r2 &= m62;
+	r4 += r3 >> 62;
+	r3 &= m62;
+
+	/* If the value is still negative, add q once more. */
+	cond_add = r4 >> 63;
+	r0 += gf_q_s62.v[0] & cond_add;
+	r4 += gf_q_s62.v[4] & cond_add;
+	r1 += r0 >> 62;
+	r0 &= m62;
+	r2 += r1 >> 62;
+	r1 &= m62;
+	r3 += r2 >> 62;
+	r2 &= m62;
+	r4 += r3 >> 62;
+	r3 &= m62;
+
+	r->v[0] = r0;
+	r->v[1] = r1;
+	r->v[2] = r2;
+	r->v[3] = r3;
+	r->v[4] = r4;
+}
+
+/*
+ * d <- 1/a (zero if a == 0)
+ * Input: full range
+ * Output: d is fully reduced
+ */
+static void
+gf_inv_safegcd(gf *d, const gf *a)
+{
+	gf x;
+	gf_s62 f, g, dd, ee;
+	int64_t zeta;
+
+	/* Convert a (normalized) into base 2^62. */
+	gf_normalize(&x, a);
+	g.v[0] = (int64_t)(x.v0 & GF_M62);
+	g.v[1] = (int64_t)(((x.v0 >> 62) | (x.v1 << 2)) & GF_M62);
+	g.v[2] = (int64_t)(((x.v1 >> 60) | (x.v2 << 4)) & GF_M62);
+	g.v[3] = (int64_t)(((x.v2 >> 58) | (x.v3 << 6)) & GF_M62);
+	g.v[4] = (int64_t)(x.v3 >> 56);
+	f = gf_q_s62;
+	memset(&dd, 0, sizeof dd);
+	memset(&ee, 0, sizeof ee);
+	ee.v[0] = 1;
+
+	/* At the end, f = +/-1 (or +/- q if a = 0, and then dd = 0),
+	   and dd = +/- 1/a mod q, with the same sign as f. */
+	zeta = -1;
+	for (int i = 0; i < 10; i ++) {
+		gf_trans2x2 t;
+
+		zeta = gf_divsteps_59(zeta, (uint64_t)f.v[0],
+			(uint64_t)g.v[0], &t);
+		gf_update_de_62(&dd, &ee, &t);
+		gf_update_fg_62(&f, &g, &t);
+	}
+	gf_normalize_62(&dd, f.v[4]);
+
+	/* Convert back. */
+	d->v0 = (uint64_t)dd.v[0] | ((uint64_t)dd.v[1] << 62);
+	d->v1 = ((uint64_t)dd.v[1] >> 2) | ((uint64_t)dd.v[2] << 60);
+	d->v2 = ((uint64_t)dd.v[2] >> 4) | ((uint64_t)dd.v[3] << 58);
+	d->v3 = ((uint64_t)dd.v[3] >> 6) | ((uint64_t)dd.v[4] << 56);
+}
+#endif
+
 #else /* W64 */
 
 /* --------------------------------------------------------------------- */
@@ -1274,10 +1734,13 @@ gf_prep240(gf *a240, gf *win, const gf *a)
 static void
 gf_inv(gf *d, const gf *a)
 {
+#if JQ_SAFEGCD
+	gf_inv_safegcd(d, a);
+#else
 	/*
 	 * This is a perfunctory division with Fermat's little theorem.
-	 * An optimized implementation may use a binary GCD or a
-	 * similar plus/minus algorithm.
+	 * The 64-bit code uses instead the safegcd algorithm (see
+	 * gf_inv_safegcd()), when the compiler supports 128-bit integers.
 	 */
 	gf x, win[3];
 	uint32_t e;
@@ -1297,6 +1760,39 @@ gf_inv(gf *d, const gf *a)
 	}
 	gf_square(&x, &x);
 	gf_mul(d, &x, &win[0]);
+#endif
+}
+
+/*
+ * d[i] <- 1/a[i] for i = 0 to n-1 (n > 0)
+ * This uses Montgomery's trick, so that only a single inversion is
+ * computed, at the cost of three multiplications per element. If any
+ * a[i] is zero, then all d[i] are set to zero.
+ * Arrays d and a MUST NOT overlap.
+ * Input: full range
+ * Output: d[i] are partially reduced
+ */
+static void
+gf_inv_batch(gf *d, const gf *a, size_t n)
+{
+	gf x, y;
+
+	/* d[i] <- a[0]*a[1]*...*a[i] */
+	d[0] = a[0];
+	for (size_t i = 1; i < n; i ++) {
+		gf_mul(&d[i], &d[i - 1], &a[i]);
+	}
+
+	/* x <- 1/(a[0]*a[1]*...*a[n-1]) */
+	gf_inv(&x, &d[n - 1]);
+
+	/* Walk back the products; at each step, x = 1/(a[0]*...*a[i]). */
+	for (size_t i = n - 1; i > 0; i --) {
+		gf_mul(&y, &x, &d[i - 1]);
+		gf_mul(&x, &x, &a[i]);
+		d[i] = y;
+	}
+	d[0] = x;
 }
 
 /*
@@ -1369,6 +1865,138 @@ gf_sqrt(gf *d, const gf *a)
 	return r;
 }
 
+/*
+ * Two-way interleaved versions of gf_xsquare(), gf_prep240() and
+ * gf_sqrt(). A square root is a long chain of dependent operations, which
+ * leaves most of the CPU execution units idle; computing two independent
+ * roots side by side lets the CPU overlap both chains. These functions
+ * operate on arrays of two elements, with the same conventions as the
+ * one-way functions.
+ */
+static void
+gf_xsquare_x2(gf *d, const gf *a, unsigned n)
+{
+	if (n == 0) {
+		memmove(d, a, 2 * sizeof *a);
+		return;
+	}
+	gf_square(&d[0], &a[0]);
+	gf_square(&d[1], &a[1]);
+	while (n -- > 1) {
+		gf_square(&d[0], &d[0]);
+		gf_square(&d[1], &d[1]);
+	}
+}
+
+static void
+gf_prep240_x2(gf *a240, gf (*win)[3], const gf *a)
+{
+	gf x[2], y[2];
+
+	for (int j = 0; j < 2; j ++) {
+		win[j][0] = a[j];
+		gf_square(&win[j][1], &win[j][0]);
+		gf_mul(&win[j][2], &win[j][0], &win[j][1]);
+		x[j] = win[j][2];
+	}
+
+	/* y <- a^(2^4-1) */
+	gf_xsquare_x2(x, x, 2);
+	for (int j = 0; j < 2; j ++) {
+		gf_mul(&y[j], &x[j], &win[j][2]);
+	}
+
+	/* y <- a^(2^5-1) */
+	for (int j = 0; j < 2; j ++) {
+		gf_square(&x[j], &y[j]);
+		gf_mul(&y[j], &x[j], &win[j][0]);
+	}
+
+	/* y <- a^(2^15-1) */
+	gf_xsquare_x2(x, y, 5);
+	for (int j = 0; j < 2; j ++) {
+		gf_mul(&x[j], &x[j], &y[j]);
+	}
+	gf_xsquare_x2(x, x, 5);
+	for (int j = 0; j < 2; j ++) {
+		gf_mul(&y[j], &y[j], &x[j]);
+	}
+
+	/* y <- a^(2^30-1), then a^(2^60-1), then a^(2^120-1) */
+	for (unsigned n = 15; n <= 60; n <<= 1) {
+		gf_xsquare_x2(x, y, n);
+		for (int j = 0; j < 2; j ++) {
+			gf_mul(&y[j], &y[j], &x[j]);
+		}
+	}
+
+	/* a240 <- a^(2^240-1) */
+	gf_xsquare_x2(x, y, 120);
+	for (int j = 0; j < 2; j ++) {
+		gf_mul(&a240[j], &y[j], &x[j]);
+	}
+}
+
+static void
+gf_sqrt_x2(gf *d, uint32_t *r, const gf *a)
+{
+	gf x[2], y[2], win[2][3];
+	uint32_t e;
+
+#if (MQ & 7) == 3
+	gf_mul2(&x[0], &a[0]);
+	gf_mul2(&x[1], &a[1]);
+#else
+	x[0] = a[0];
+	x[1] = a[1];
+#endif
+	gf_prep240_x2(x, win, x);
+
+#if (MQ & 3) == 1
+	e = (1 - (uint32_t)MQ) >> 2;
+	for (int i = 11; i >= 1; i -= 2) {
+		unsigned k = (e >> i) & 3;
+		gf_xsquare_x2(x, x, 2);
+		if (k != 0) {
+			gf_mul(&x[0], &x[0], &win[0][k - 1]);
+			gf_mul(&x[1], &x[1], &win[1][k - 1]);
+		}
+	}
+	gf_square(&x[0], &x[0]);
+	gf_square(&x[1], &x[1]);
+	if (e & 1) {
+		gf_mul(&x[0], &x[0], &win[0][0]);
+		gf_mul(&x[1], &x[1], &win[1][0]);
+	}
+#elif (MQ & 7) == 3
+	e = (-(uint32_t)MQ - 5) >> 3;
+	for (int i = 10; i >= 0; i -= 2) {
+		unsigned k = (e >> i) & 3;
+		gf_xsquare_x2(x, x, 2);
+		if (k != 0) {
+			gf_mul(&x[0], &x[0], &win[0][k - 1]);
+			gf_mul(&x[1], &x[1], &win[1][k - 1]);
+		}
+	}
+	for (int j = 0; j < 2; j ++) {
+		gf_mul(&y[j], &x[j], &a[j]);
+		gf_mul(&x[j], &y[j], &x[j]);
+		gf_mul2(&x[j], &x[j]);
+		gf_sub(&x[j], &x[j], &gf_one);
+		gf_mul(&x[j], &y[j], &x[j]);
+	}
+#else
+#error unimplemented sqrt for this modulus
+#endif
+
+	for (int j = 0; j < 2; j ++) {
+		gf_condneg(&x[j], &x[j], gf_is_negative(&x[j]));
+		gf_square(&y[j], &x[j]);
+		r[j] = gf_equals(&y[j], &a[j]);
+		gf_select(&d[j], &gf_zero, &x[j], r[j]);
+	}
+}
+
 /* ===================================================================== */
 /*
  * SECTION 2: SCALARS
@@ -1386,37 +2014,71 @@ typedef struct {
  * R = group order r
  * R0 = |R - 2^254|  (R0 < 2^127)
  * Note: r = 2^254 - R0 for jq255e, r = 2^254 + R0 for jq255s
+ *
+ * All other constants related to r are derived from the four limbs of
+ * R0, so that a custom curve (JQ_PARAMS) only has to provide them.
  */
+#if defined JQ_PARAMS
+#ifndef JQ_R0_3
+#error JQ_PARAMS: JQ_R0_0 to JQ_R0_3 are not defined
+#endif
+#elif JQ == JQ255E
+#define JQ_R0_0   0x8B27BADB
+#define JQ_R0_1   0xE0AD3751
+#define JQ_R0_2   0xABF873AC
+#define JQ_R0_3   0x62F36CF0
+#elif JQ == JQ255S
+#define JQ_R0_0   0x396152C7
+#define JQ_R0_1   0xDCF2AC65
+#define JQ_R0_2   0x912B7F03
+#define JQ_R0_3   0x2ACF567A
+#else
+#error Unknown curve
+#endif
+
+static const uint32_t R0[4] = {
+	JQ_R0_0, JQ_R0_1, JQ_R0_2, JQ_R0_3
+};
+
 #if JQ == JQ255E
 
+/*
+ * r = 2^254 - R0; R0 is odd (since r is odd), hence the low 128 bits
+ * of r are ~R0 + 1 without any carry out of the low limb.
+ */
+#define JQ_R_0   ((uint32_t)~(uint32_t)JQ_R0_0 + 1)
+#define JQ_R_1   ((uint32_t)~(uint32_t)JQ_R0_1)
+#define JQ_R_2   ((uint32_t)~(uint32_t)JQ_R0_2)
+#define JQ_R_3   ((uint32_t)~(uint32_t)JQ_R0_3)
+
 static const uint32_t R[8] = {
-        0x74D84525, 0x1F52C8AE, 0x54078C53, 0x9D0C930F,
-        0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x3FFFFFFF
-};
-static const uint32_t R0[4] = {
-        0x8B27BADB, 0xE0AD3751, 0xABF873AC, 0x62F36CF0
+	JQ_R_0, JQ_R_1, JQ_R_2, JQ_R_3,
+	0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x3FFFFFFF
 };
 
 /* (r-1)/2 */
 static const uint32_t HR[8] = {
-	0x3A6C2292, 0x8FA96457, 0xAA03C629, 0xCE864987,
+	(JQ_R_0 >> 1) | (JQ_R_1 << 31),
+	(JQ_R_1 >> 1) | (JQ_R_2 << 31),
+	(JQ_R_2 >> 1) | (JQ_R_3 << 31),
+	(JQ_R_3 >> 1) | ((uint32_t)1 << 31),
 	0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x1FFFFFFF
 };
 
 #elif JQ == JQ255S
 
 static const uint32_t R[8] = {
-        0x396152C7, 0xDCF2AC65, 0x912B7F03, 0x2ACF567A,
+	JQ_R0_0, JQ_R0_1, JQ_R0_2, JQ_R0_3,
 	0x00000000, 0x00000000, 0x00000000, 0x40000000
 };
-static const uint32_t R0[4] = {
-        0x396152C7, 0xDCF2AC65, 0x912B7F03, 0x2ACF567A
-};
 
 /* 4*r mod 2^256 */
 static const uint32_t R_x4[8] = {
-	0xE5854B1C, 0x73CAB194, 0x44ADFC0F, 0xAB3D59EA,
-	0x00000000, 0x00000000, 0x00000000, 0x00000000
+	(uint32_t)JQ_R0_0 << 2,
+	((uint32_t)JQ_R0_1 << 2) | ((uint32_t)JQ_R0_0 >> 30),
+	((uint32_t)JQ_R0_2 << 2) | ((uint32_t)JQ_R0_1 >> 30),
+	((uint32_t)JQ_R0_3 << 2) | ((uint32_t)JQ_R0_2 >> 30),
+	(uint32_t)JQ_R0_3 >> 30, 0x00000000, 0x00000000, 0x00000000
 };
 
 #else
@@ -1803,6 +2465,30 @@ scalar_add(scalar *d, const scalar *a, const scalar *b)
 	modr_inner_reduce(d->v);
 }
 
+/* d <- -a */
+static void
+scalar_neg(scalar *d, const scalar *a)
+{
+	/* r - a is in the 1 to r range; it must be set to 0 when a = 0. */
+	uint32_t m = ~scalar_is_zero(a);
+	uint32_t cc = 0;
+	for (int i = 0; i < 8; i ++) {
+		uint64_t w = (uint64_t)R[i] - (uint64_t)a->v[i] - (uint64_t)cc;
+		d->v[i] = (uint32_t)w & m;
+		cc = -(uint32_t)(w >> 32);
+	}
+}
+
+/* d <- a - b */
+static void
+scalar_sub(scalar *d, const scalar *a, const scalar *b)
+{
+	scalar nb;
+
+	scalar_neg(&nb, b);
+	scalar_add(d, a, &nb);
+}
+
 /* d <- a*b */
 static void
 scalar_mul(scalar *d, const scalar *a, const scalar *b)
@@ -1905,6 +2591,7 @@ scalar_recode(int8_t *sd, const scalar *s)
 static void
 uint_recode_wNAF(int8_t *sd, size_t sd_len, const uint32_t *u, size_t u_len)
 {
+	STATS_BEGIN(st);
 	size_t lim = (u_len << 5) - 4;
 	uint32_t x = u[0] & 0x0000FFFF;
 	for (size_t j = 0; j < sd_len; j ++) {
@@ -1924,6 +2611,7 @@ uint_recode_wNAF(int8_t *sd, size_t sd_len, const uint32_t *u, size_t u_len)
 		sd[j] = (int8_t)d;
 		x = (x - (uint32_t)d) >> 1;
 	}
+	STATS_END(st, JQ255_STAT_RECODE_WNAF, 1);
 }
 
 /*
@@ -1937,6 +2625,23 @@ scalar_recode_wNAF(int8_t *sd, const scalar *s)
 
 #if JQ == JQ255E
 
+/*
+ * Endomorphism constants: scalar_split() uses the lattice basis
+ * (eU, eV), (-eV, eU) with eU^2 + eV^2 = r (JQ_SPLIT_U and JQ_SPLIT_V,
+ * 4 limbs each), and the endomorphism is applied on points with ETA,
+ * a square root of -1 in the field (JQ_ETA). A custom curve of this
+ * family provides them in its parameter file.
+ */
+#if !defined JQ_PARAMS
+#define JQ_SPLIT_U   0xC93F6111, 0x2ACCF9DE, 0x53C2C6E6, 0x1A509F7A
+#define JQ_SPLIT_V   0x5466F77E, 0x0B7A3130, 0xFFBB3A93, 0x7D440C6A
+#define JQ_ETA       LGF( \
+	0xAA938AEE, 0xD99E0F1B, 0xB30E6336, 0xA60D864F, \
+	0xE53688E3, 0xE414983F, 0x3C69B85F, 0x10ED2DB3)
+#elif !defined JQ_SPLIT_U || !defined JQ_SPLIT_V || !defined JQ_ETA
+#error JQ_PARAMS: JQ_SPLIT_U, JQ_SPLIT_V and JQ_ETA must be defined
+#endif
+
 /*
  * d <- a - b
  * a, b and d are over 4 limbs
@@ -2056,12 +2761,8 @@ abs128(uint32_t *d)
 static uint32_t
 scalar_split(uint32_t *k0, uint32_t *k1, const scalar *k)
 {
-	static const uint32_t eU[] = {
-		0xC93F6111, 0x2ACCF9DE, 0x53C2C6E6, 0x1A509F7A
-	};
-	static const uint32_t eV[] = {
-		0x5466F77E, 0x0B7A3130, 0xFFBB3A93, 0x7D440C6A
-	};
+	static const uint32_t eU[] = { JQ_SPLIT_U };
+	static const uint32_t eV[] = { JQ_SPLIT_V };
 
 	uint32_t c[4], d[4], t[4];
 	uint32_t r;
@@ -2155,74 +2856,188 @@ static const point_affine point_affine_neutral = {
 };
 
 /*
- * Decode a point from exactly 32 bytes. If the source is a validly
- * encoded point, then d is set to that point, and 0xFFFFFFFF is
- * returned; otherwise, d is set to the neutral, and 0x00000000 is
- * returned.
- *
- * Note: decoding returns a point in affine coordinates (Z == 1),
- * and the e coordinate is non-negative.
+ * First half of point decoding: decode u from the source bytes into u,
+ * set uu = u^2 and ee = (a^2-4*b)*u^4 - 2*a*u^2 + 1 (the square of the
+ * e coordinate). Returned value is 0xFFFFFFFF if the source is a
+ * canonical encoding of a field element, 0x00000000 otherwise.
  */
 static uint32_t
-point_decode(point *d, const void *src)
+point_decode_prep(gf *u, gf *uu, gf *ee, const void *src)
 {
-	gf e, u, ee, uu;
 	uint32_t r;
 
 	/* Decode the source as the field element u. */
-	r = gf_decode(&u, src);
+	r = gf_decode(u, src);
 
 	/* Compute ee = (a^2-4*b)*u^4 - 2*a*u^2 + 1. */
-	gf_square(&uu, &u);
-	gf_square(&ee, &uu);
+	gf_square(uu, u);
+	gf_square(ee, uu);
 #if JQ == JQ255E
 	/* jq255e: a = 0, b = -2 */
-	gf_lsh(&ee, &ee, 3);
+	gf_lsh(ee, ee, 3);
 #elif JQ == JQ255S
 	/* jq255e: a = -1, b = 1/2 */
-	gf_sub(&ee, &uu, &ee);
-	gf_add(&ee, &ee, &uu);
+	gf_sub(ee, uu, ee);
+	gf_add(ee, ee, uu);
 #else
 #error Unknown curve
 #endif
-	gf_add(&ee, &ee, &gf_one);
-
-	/* Extract e as a square root of ee. The gf_sqrt() function already
-	   takes care to return the non-negative root. */
-	r &= gf_sqrt(&e, &ee);
-
-	/* Set d to (e:1:u:u^2) on success, to (-1:1:0:0) on error. */
-	gf_select(&d->E, &gf_minus_one, &e, r);
-	d->Z = gf_one;
-	gf_select(&d->U, &gf_zero, &u, r);
-	gf_select(&d->T, &gf_zero, &uu, r);
+	gf_add(ee, ee, &gf_one);
 	return r;
 }
 
 /*
- * Encode a point p into exactly 32 bytes.
+ * Second half of point decoding: set d to (e:1:u:u^2) if r is
+ * 0xFFFFFFFF, to (-1:1:0:0) if r is 0x00000000.
  */
 static void
-point_encode(void *dst, const point *p)
+point_decode_finish(point *d, const gf *e, const gf *u, const gf *uu,
+	uint32_t r)
 {
-	gf iZ, e, u;
-
-	/* Get the affine (e,u) coordinates. If e is negative, then
-	   choose the other representant P+N = (-e,-u). */
-	gf_inv(&iZ, &p->Z);
-	gf_mul(&e, &p->E, &iZ);
-	gf_mul(&u, &p->U, &iZ);
-	gf_condneg(&u, &u, gf_is_negative(&e));
-	gf_encode(dst, &u);
+	gf_select(&d->E, &gf_minus_one, e, r);
+	d->Z = gf_one;
+	gf_select(&d->U, &gf_zero, u, r);
+	gf_select(&d->T, &gf_zero, uu, r);
 }
 
 /*
- * Add two points together: P3 <- P1 + P2.
- */
-static void
-point_add(point *p3, const point *p1, const point *p2)
-{
-	const gf *E1 = &p1->E, *Z1 = &p1->Z, *U1 = &p1->U, *T1 = &p1->T;
+ * Decode a point from exactly 32 bytes. If the source is a validly
+ * encoded point, then d is set to that point, and 0xFFFFFFFF is
+ * returned; otherwise, d is set to the neutral, and 0x00000000 is
+ * returned.
+ *
+ * Note: decoding returns a point in affine coordinates (Z == 1),
+ * and the e coordinate is non-negative.
+ */
+static uint32_t
+point_decode(point *d, const void *src)
+{
+	gf e, u, ee, uu;
+	uint32_t r;
+	STATS_BEGIN(st);
+
+	/* Decode u and compute ee = e^2. */
+	r = point_decode_prep(&u, &uu, &ee, src);
+
+	/* Extract e as a square root of ee. The gf_sqrt() function already
+	   takes care to return the non-negative root. */
+	r &= gf_sqrt(&e, &ee);
+
+	/* Set d to (e:1:u:u^2) on success, to (-1:1:0:0) on error. */
+	point_decode_finish(d, &e, &u, &uu, r);
+	STATS_END(st, JQ255_STAT_POINT_DECODE, 1);
+	return r;
+}
+
+/*
+ * Decode two points, with interleaved square root computations. Source
+ * encodings are src[0..31] and src[32..63]. Each r[j] is set to
+ * 0xFFFFFFFF on success, 0x00000000 on failure (in which case d[j] is
+ * set to the neutral).
+ */
+static void
+point_decode_x2(point *d, uint32_t *r, const void *src)
+{
+	const uint8_t *buf = src;
+	gf e[2], u[2], uu[2], ee[2];
+	uint32_t rs[2];
+	STATS_BEGIN(st);
+
+	r[0] = point_decode_prep(&u[0], &uu[0], &ee[0], buf);
+	r[1] = point_decode_prep(&u[1], &uu[1], &ee[1], buf + 32);
+	gf_sqrt_x2(e, rs, ee);
+	for (int j = 0; j < 2; j ++) {
+		r[j] &= rs[j];
+		point_decode_finish(&d[j], &e[j], &u[j], &uu[j], r[j]);
+	}
+	STATS_END(st, JQ255_STAT_POINT_DECODE, 2);
+}
+
+/*
+ * Encode a point p into exactly 32 bytes.
+ */
+static void
+point_encode(void *dst, const point *p)
+{
+	gf iZ, e, u;
+
+	/* Get the affine (e,u) coordinates. If e is negative, then
+	   choose the other representant P+N = (-e,-u). */
+	gf_inv(&iZ, &p->Z);
+	gf_mul(&e, &p->E, &iZ);
+	gf_mul(&u, &p->U, &iZ);
+	gf_condneg(&u, &u, gf_is_negative(&e));
+	gf_encode(dst, &u);
+}
+
+/*
+ * Maximum number of points that are processed together by batch
+ * operations; the per-batch temporaries are allocated on the stack.
+ */
+#define POINT_BATCH   16
+
+/*
+ * Encode n points p[0..n-1] into dst (32*n bytes). The n inversions of
+ * the Z coordinates are shared with Montgomery's trick. This function
+ * is constant-time (but the number of points is not hidden).
+ * Constraint: 0 < n <= POINT_BATCH
+ */
+static void
+point_encode_batch(void *dst, const point *p, size_t n)
+{
+	gf zz[POINT_BATCH], iZ[POINT_BATCH];
+	uint8_t *buf = dst;
+
+	if (n == 0) {
+		return;
+	}
+	memset(zz, 0, sizeof zz);
+	for (size_t i = 0; i < n; i ++) {
+		zz[i] = p[i].Z;
+	}
+	gf_inv_batch(iZ, zz, n);
+	for (size_t i = 0; i < n; i ++) {
+		gf e, u;
+
+		gf_mul(&e, &p[i].E, &iZ[i]);
+		gf_mul(&u, &p[i].U, &iZ[i]);
+		gf_condneg(&u, &u, gf_is_negative(&e));
+		gf_encode(buf + 32 * i, &u);
+	}
+}
+
+/*
+ * Normalize n points p[0..n-1] to affine coordinates into d[0..n-1],
+ * with a single shared inversion.
+ * Constraint: 0 < n <= POINT_BATCH
+ */
+static void
+point_to_affine_batch(point_affine *d, const point *p, size_t n)
+{
+	gf zz[POINT_BATCH], iZ[POINT_BATCH];
+
+	if (n == 0) {
+		return;
+	}
+	memset(zz, 0, sizeof zz);
+	for (size_t i = 0; i < n; i ++) {
+		zz[i] = p[i].Z;
+	}
+	gf_inv_batch(iZ, zz, n);
+	for (size_t i = 0; i < n; i ++) {
+		gf_mul(&d[i].E, &p[i].E, &iZ[i]);
+		gf_mul(&d[i].U, &p[i].U, &iZ[i]);
+		gf_mul(&d[i].T, &p[i].T, &iZ[i]);
+	}
+}
+
+/*
+ * Add two points together: P3 <- P1 + P2.
+ */
+static void
+point_add(point *p3, const point *p1, const point *p2)
+{
+	const gf *E1 = &p1->E, *Z1 = &p1->Z, *U1 = &p1->U, *T1 = &p1->T;
 	const gf *E2 = &p2->E, *Z2 = &p2->Z, *U2 = &p2->U, *T2 = &p2->T;
 	gf *E3 = &p3->E, *Z3 = &p3->Z, *U3 = &p3->U, *T3 = &p3->T;
 	gf e1e2, u1u2, z1z2, t1t2, eu, zt, hd, g1, g2, g3;
@@ -2596,8 +3411,6 @@ point_is_neutral(const point *p)
 	return gf_is_zero(&p->U);
 }
 
-#if 0
-/* unused */
 /*
  * Test whether two points represent the same group element.
  * Output: 0xFFFFFFFF is the two group elements are equal to each other,
@@ -2612,7 +3425,6 @@ point_equals(const point *p1, const point *p2)
 	gf_mul(&g2, &p1->E, &p2->U);
 	return gf_equals(&g1, &g2);
 }
-#endif
 
 /*
  * If ctl == 0x00000000, then d <- p0.
@@ -2628,6 +3440,167 @@ point_select(point *d, const point *p0, const point *p1, uint32_t ctl)
 	gf_select(&d->T, &p0->T, &p1->T, ctl);
 }
 
+/*
+ * SIMD window scans. Each coordinate of a window entry is a 32-byte
+ * field element, i.e. one 256-bit vector (two 128-bit vectors with
+ * NEON), so the entries are read with contiguous vector loads; the
+ * selection depends only on the field element representation size,
+ * not on the limb format, hence this code is shared by the W64 = 0
+ * and W64 = 1 builds. The accumulators are kept in registers for the
+ * whole scan. These functions return the entry of index m-1 in win,
+ * or the neutral if m == 0 (0 <= m <= 16); the caller adjusts the sign.
+ */
+
+#if JQ_LOOKUP == 1
+
+#include <immintrin.h>
+
+#define TARGET_AVX2   __attribute__((target("avx2")))
+
+/*
+ * Return 1 if the CPU supports AVX2, 0 otherwise.
+ */
+#ifdef __AVX2__
+#define avx2_available()   1
+#else
+static inline int
+avx2_available(void)
+{
+	return __builtin_cpu_supports("avx2");
+}
+#endif
+
+TARGET_AVX2
+static void
+point_lookup_avx2(point *p2, const point *win, uint32_t m)
+{
+	const __m256i *w = (const __m256i *)(const void *)win;
+	__m256i mm, e, z, u, t;
+
+	e = _mm256_loadu_si256((const __m256i *)(const void *)&point_neutral.E);
+	z = _mm256_loadu_si256((const __m256i *)(const void *)&point_neutral.Z);
+	u = _mm256_setzero_si256();
+	t = _mm256_setzero_si256();
+	mm = _mm256_set1_epi32((int)m);
+	for (int j = 0; j < 16; j ++, w += 4) {
+		__m256i c = _mm256_cmpeq_epi32(mm, _mm256_set1_epi32(j + 1));
+
+		e = _mm256_blendv_epi8(e, _mm256_loadu_si256(w + 0), c);
+		z = _mm256_blendv_epi8(z, _mm256_loadu_si256(w + 1), c);
+		u = _mm256_blendv_epi8(u, _mm256_loadu_si256(w + 2), c);
+		t = _mm256_blendv_epi8(t, _mm256_loadu_si256(w + 3), c);
+	}
+	_mm256_storeu_si256((__m256i *)(void *)&p2->E, e);
+	_mm256_storeu_si256((__m256i *)(void *)&p2->Z, z);
+	_mm256_storeu_si256((__m256i *)(void *)&p2->U, u);
+	_mm256_storeu_si256((__m256i *)(void *)&p2->T, t);
+}
+
+TARGET_AVX2
+static void
+point_affine_lookup_avx2(point_affine *p2,
+	const point_affine *win, uint32_t m)
+{
+	const __m256i *w = (const __m256i *)(const void *)win;
+	__m256i mm, e, u, t;
+
+	e = _mm256_loadu_si256(
+		(const __m256i *)(const void *)&point_affine_neutral.E);
+	u = _mm256_setzero_si256();
+	t = _mm256_setzero_si256();
+	mm = _mm256_set1_epi32((int)m);
+	for (int j = 0; j < 16; j ++, w += 3) {
+		__m256i c = _mm256_cmpeq_epi32(mm, _mm256_set1_epi32(j + 1));
+
+		e = _mm256_blendv_epi8(e, _mm256_loadu_si256(w + 0), c);
+		u = _mm256_blendv_epi8(u, _mm256_loadu_si256(w + 1), c);
+		t = _mm256_blendv_epi8(t, _mm256_loadu_si256(w + 2), c);
+	}
+	_mm256_storeu_si256((__m256i *)(void *)&p2->E, e);
+	_mm256_storeu_si256((__m256i *)(void *)&p2->U, u);
+	_mm256_storeu_si256((__m256i *)(void *)&p2->T, t);
+}
+
+#elif JQ_LOOKUP == 2
+
+#include <arm_neon.h>
+
+#define NEON_LOAD(p, off) \
+	vld1q_u8((const uint8_t *)(const void *)(p) + (off))
+#define NEON_STORE(p, off, a) \
+	vst1q_u8((uint8_t *)(void *)(p) + (off), a)
+
+static void
+point_lookup_neon(point *p2, const point *win, uint32_t m)
+{
+	const point *w;
+	uint8x16_t e0, e1, z0, z1, u0, u1, t0, t1;
+	uint32x4_t mm;
+
+	e0 = NEON_LOAD(&point_neutral, 0);
+	e1 = NEON_LOAD(&point_neutral, 16);
+	z0 = NEON_LOAD(&point_neutral, 32);
+	z1 = NEON_LOAD(&point_neutral, 48);
+	u0 = u1 = t0 = t1 = vdupq_n_u8(0);
+	mm = vdupq_n_u32(m);
+	w = win;
+	for (uint32_t j = 0; j < 16; j ++, w ++) {
+		uint8x16_t c = vreinterpretq_u8_u32(
+			vceqq_u32(mm, vdupq_n_u32(j + 1)));
+
+		e0 = vbslq_u8(c, NEON_LOAD(w, 0), e0);
+		e1 = vbslq_u8(c, NEON_LOAD(w, 16), e1);
+		z0 = vbslq_u8(c, NEON_LOAD(w, 32), z0);
+		z1 = vbslq_u8(c, NEON_LOAD(w, 48), z1);
+		u0 = vbslq_u8(c, NEON_LOAD(w, 64), u0);
+		u1 = vbslq_u8(c, NEON_LOAD(w, 80), u1);
+		t0 = vbslq_u8(c, NEON_LOAD(w, 96), t0);
+		t1 = vbslq_u8(c, NEON_LOAD(w, 112), t1);
+	}
+	NEON_STORE(p2, 0, e0);
+	NEON_STORE(p2, 16, e1);
+	NEON_STORE(p2, 32, z0);
+	NEON_STORE(p2, 48, z1);
+	NEON_STORE(p2, 64, u0);
+	NEON_STORE(p2, 80, u1);
+	NEON_STORE(p2, 96, t0);
+	NEON_STORE(p2, 112, t1);
+}
+
+static void
+point_affine_lookup_neon(point_affine *p2,
+	const point_affine *win, uint32_t m)
+{
+	const point_affine *w;
+	uint8x16_t e0, e1, u0, u1, t0, t1;
+	uint32x4_t mm;
+
+	e0 = NEON_LOAD(&point_affine_neutral, 0);
+	e1 = NEON_LOAD(&point_affine_neutral, 16);
+	u0 = u1 = t0 = t1 = vdupq_n_u8(0);
+	mm = vdupq_n_u32(m);
+	w = win;
+	for (uint32_t j = 0; j < 16; j ++, w ++) {
+		uint8x16_t c = vreinterpretq_u8_u32(
+			vceqq_u32(mm, vdupq_n_u32(j + 1)));
+
+		e0 = vbslq_u8(c, NEON_LOAD(w, 0), e0);
+		e1 = vbslq_u8(c, NEON_LOAD(w, 16), e1);
+		u0 = vbslq_u8(c, NEON_LOAD(w, 32), u0);
+		u1 = vbslq_u8(c, NEON_LOAD(w, 48), u1);
+		t0 = vbslq_u8(c, NEON_LOAD(w, 64), t0);
+		t1 = vbslq_u8(c, NEON_LOAD(w, 80), t1);
+	}
+	NEON_STORE(p2, 0, e0);
+	NEON_STORE(p2, 16, e1);
+	NEON_STORE(p2, 32, u0);
+	NEON_STORE(p2, 48, u1);
+	NEON_STORE(p2, 64, t0);
+	NEON_STORE(p2, 80, t1);
+}
+
+#endif
+
 /*
  * Lookup a point from a window, with sign management.
  * Input:
@@ -2649,15 +3622,26 @@ point_lookup(point *p2, const point *win, int8_t k)
 	/*
 	 * Constant-time lookup through the window.
 	 */
-	*p2 = point_neutral;
-	for (uint32_t j = 0; j < 16; j ++) {
-		uint32_t c = m - j - 1;
-		c = ((c | -c) >> 31) - 1;
-		gf_select(&p2->E, &p2->E, &win[j].E, c);
-		gf_select(&p2->Z, &p2->Z, &win[j].Z, c);
-		gf_select(&p2->U, &p2->U, &win[j].U, c);
-		gf_select(&p2->T, &p2->T, &win[j].T, c);
+#if JQ_LOOKUP == 1
+	if (avx2_available()) {
+		point_lookup_avx2(p2, win, m);
+	} else
+#endif
+#if JQ_LOOKUP == 2
+	point_lookup_neon(p2, win, m);
+#else
+	{
+		*p2 = point_neutral;
+		for (uint32_t j = 0; j < 16; j ++) {
+			uint32_t c = m - j - 1;
+			c = ((c | -c) >> 31) - 1;
+			gf_select(&p2->E, &p2->E, &win[j].E, c);
+			gf_select(&p2->Z, &p2->Z, &win[j].Z, c);
+			gf_select(&p2->U, &p2->U, &win[j].U, c);
+			gf_select(&p2->T, &p2->T, &win[j].T, c);
+		}
 	}
+#endif
 
 	/*
 	 * Adjust the sign.
@@ -2686,14 +3670,25 @@ point_affine_lookup(point_affine *p2, const point_affine *win, int8_t k)
 	/*
 	 * Constant-time lookup through the window.
 	 */
-	*p2 = point_affine_neutral;
-	for (uint32_t j = 0; j < 16; j ++) {
-		uint32_t c = m - j - 1;
-		c = ((c | -c) >> 31) - 1;
-		gf_select(&p2->E, &p2->E, &win[j].E, c);
-		gf_select(&p2->U, &p2->U, &win[j].U, c);
-		gf_select(&p2->T, &p2->T, &win[j].T, c);
+#if JQ_LOOKUP == 1
+	if (avx2_available()) {
+		point_affine_lookup_avx2(p2, win, m);
+	} else
+#endif
+#if JQ_LOOKUP == 2
+	point_affine_lookup_neon(p2, win, m);
+#else
+	{
+		*p2 = point_affine_neutral;
+		for (uint32_t j = 0; j < 16; j ++) {
+			uint32_t c = m - j - 1;
+			c = ((c | -c) >> 31) - 1;
+			gf_select(&p2->E, &p2->E, &win[j].E, c);
+			gf_select(&p2->U, &p2->U, &win[j].U, c);
+			gf_select(&p2->T, &p2->T, &win[j].T, c);
+		}
 	}
+#endif
 
 	/*
 	 * Adjust the sign.
@@ -2701,6 +3696,11 @@ point_affine_lookup(point_affine *p2, const point_affine *win, int8_t k)
 	gf_condneg(&p2->U, &p2->U, sk);
 }
 
+#if JQ == JQ255E
+/* Square root of -1 in the field (for the jq255e endomorphism). */
+static const gf ETA = JQ_ETA;
+#endif
+
 /*
  * Point multiplication by a scalar (general case).
  * P2 <- s*P1
@@ -2719,11 +3719,6 @@ point_mul(point *p2, const point *p1, const scalar *s)
 	 * the signs of the scalars k0 and k1.
 	 */
 
-	/* Square root of -1 in the field. */
-	static const gf ETA = LGF(
-		0xAA938AEE, 0xD99E0F1B, 0xB30E6336, 0xA60D864F,
-		0xE53688E3, 0xE414983F, 0x3C69B85F, 0x10ED2DB3);
-
 	uint32_t k0[5], k1[5];
 	uint32_t sk;
 	point win[16], p;
@@ -2816,12 +3811,171 @@ point_mul(point *p2, const point *p1, const scalar *s)
 #endif
 }
 
+/*
+ * Point multiplication with precomputed operands (see point_mul()),
+ * split in three steps so that the per-point and per-scalar work can
+ * be cached and reused across many multiplications:
+ *
+ *   point_mul_prepare_window()   window win[i] = (i+1)*P1, affine
+ *   point_mul_prepare_scalar()   recoded digits (52 bytes) and signs
+ *   point_mul_prepared()         the double-and-add loop itself
+ *
+ * The result is the same as with point_mul(). All three functions are
+ * constant-time.
+ */
+static void
+point_mul_prepare_window(point_affine *win, const point *p1)
+{
+	point tt[16];
+
+	tt[0] = *p1;
+	for (int i = 1; i < 15; i += 2) {
+		point_double(&tt[i], &tt[i >> 1]);
+		point_add(&tt[i + 1], &tt[i], &tt[0]);
+	}
+	point_double(&tt[15], &tt[7]);
+	point_to_affine_batch(win, tt, 16);
+}
+
+static uint32_t
+point_mul_prepare_scalar(int8_t *sd, const scalar *s)
+{
+#if JQ == JQ255E
+	/*
+	 * Digits of k0 go to sd[0..25], digits of k1 to sd[26..51]; the
+	 * signs of k0 and k1 are returned (as in scalar_split()).
+	 */
+	uint32_t k0[5], k1[5];
+	uint32_t sk;
+
+	sk = scalar_split(k0, k1, s);
+	k0[4] = 0;
+	k1[4] = 0;
+	uint_recode(sd, 26, k0);
+	uint_recode(sd + 26, 26, k1);
+	return sk;
+#else
+	scalar_recode(sd, s);
+	sd[51] = 0;
+	return 0;
+#endif
+}
+
+static void
+point_mul_prepared(point *p2, const point_affine *win,
+	const int8_t *sd, uint32_t sk)
+{
+	point_affine qa;
+
+#if JQ == JQ255E
+	/*
+	 * The window is over P1 itself, not over +/-P1 as in point_mul():
+	 * the sign of k0 is applied on each looked-up point, and the sign
+	 * of k1 is merged into the square root of -1 used for the
+	 * endomorphism (zeta(-Q) = -zeta(Q)).
+	 */
+	uint32_t m0;
+	gf eta;
+
+	m0 = -(sk & 1);
+	gf_condneg(&eta, &ETA, -((sk >> 1) & 1));
+
+	point_affine_lookup(&qa, win, sd[25]);
+	p2->E = qa.E;
+	p2->Z = gf_one;
+	gf_condneg(&p2->U, &qa.U, m0);
+	p2->T = qa.T;
+	point_affine_lookup(&qa, win, sd[51]);
+	gf_mul(&qa.U, &qa.U, &eta);
+	gf_neg(&qa.T, &qa.T);
+	point_add_affine(p2, p2, &qa);
+	for (int i = 24; i >= 0; i --) {
+		point_xdouble(p2, p2, 5);
+		point_affine_lookup(&qa, win, sd[i]);
+		gf_condneg(&qa.U, &qa.U, m0);
+		point_add_affine(p2, p2, &qa);
+		point_affine_lookup(&qa, win, sd[i + 26]);
+		gf_mul(&qa.U, &qa.U, &eta);
+		gf_neg(&qa.T, &qa.T);
+		point_add_affine(p2, p2, &qa);
+	}
+#else
+	(void)sk;
+	point_affine_lookup(&qa, win, sd[50]);
+	p2->E = qa.E;
+	p2->Z = gf_one;
+	p2->U = qa.U;
+	p2->T = qa.T;
+	for (int i = 49; i >= 0; i --) {
+		point_xdouble(p2, p2, 5);
+		point_affine_lookup(&qa, win, sd[i]);
+		point_add_affine(p2, p2, &qa);
+	}
+#endif
+}
+
 /* Forward declaration of the precomputed point tables. */
 static const point_affine point_win_base[];
 static const point_affine point_win_base65[];
 static const point_affine point_win_base130[];
 static const point_affine point_win_base195[];
 
+#if MULGEN_LARGE
+#if defined JQ_PARAMS
+#ifndef JQ_MULGEN
+#error JQ_PARAMS with MULGEN_LARGE: JQ_MULGEN (tables file) is not defined
+#endif
+#include JQ_MULGEN
+#elif JQ == JQ255E
+#include "jq255e_mulgen.h"
+#elif JQ == JQ255S
+#include "jq255s_mulgen.h"
+#endif
+#endif
+
+/*
+ * Base point tables used by the multiplication routines. By default,
+ * the built-in tables are used; a thread may switch to a copy (see
+ * jq255e_tables_clone() and jq255e_tables_use() in jq255.h), e.g. in
+ * memory local to its NUMA node. The selection is a thread-local
+ * pointer, read once per multiplication.
+ */
+typedef struct {
+	const point_affine *base;
+	const point_affine *base65;
+	const point_affine *base130;
+	const point_affine *base195;
+#if MULGEN_LARGE
+	const point_affine *mulgen;
+#endif
+} base_tables;
+
+/* Number of points in a copy of the tables. */
+#if MULGEN_LARGE
+#define BASE_TABLES_NUM   (64 + 16 * MULGEN_NUM_WIN)
+#else
+#define BASE_TABLES_NUM   64
+#endif
+
+static const base_tables base_tables_builtin = {
+	point_win_base,
+	point_win_base65,
+	point_win_base130,
+	point_win_base195,
+#if MULGEN_LARGE
+	point_win_mulgen
+#endif
+};
+
+static JQ_TLS const base_tables *base_tables_tls;
+
+static inline const base_tables *
+base_tables_get(void)
+{
+	const base_tables *bt = base_tables_tls;
+	return bt != NULL ? bt : &base_tables_builtin;
+}
+
 /*
  * Multiplication of the fixed base point by a scalar.
  * P <- s*G
@@ -2829,6 +3983,7 @@ static const point_affine point_win_base195[];
 static void
 point_mulgen(point *p, const scalar *s)
 {
+	const base_tables *bt = base_tables_get();
 	int8_t sd[51];
 	point_affine qa;
 
@@ -2837,1482 +3992,5139 @@ point_mulgen(point *p, const scalar *s)
 	 */
 	scalar_recode(sd, s);
 
+#if MULGEN_LARGE
+	/*
+	 * Comb with MULGEN_NUM_WIN windows: digit i+MULGEN_SPACING*k
+	 * uses window k. The loop bounds depend only on the table
+	 * parameters, hence the process is constant-time.
+	 */
+	for (int i = MULGEN_SPACING - 1; i >= 0; i --) {
+		if (i != MULGEN_SPACING - 1) {
+			point_xdouble(p, p, 5);
+		}
+		for (int k = 0; k < MULGEN_NUM_WIN; k ++) {
+			int j = i + MULGEN_SPACING * k;
+
+			if (j >= 51) {
+				break;
+			}
+			point_affine_lookup(&qa,
+				bt->mulgen + 16 * k, sd[j]);
+			if (i == MULGEN_SPACING - 1 && k == 0) {
+				p->E = qa.E;
+				p->Z = gf_one;
+				p->U = qa.U;
+				p->T = qa.T;
+			} else {
+				point_add_affine(p, p, &qa);
+			}
+		}
+	}
+#else
+
 	/*
 	 * Perform a double-and-add algorithm with the four precomputed
 	 * 5-bit windows (affine).
 	 */
-	point_affine_lookup(&qa, point_win_base, sd[12]);
+	point_affine_lookup(&qa, bt->base, sd[12]);
 	p->E = qa.E;
 	p->Z = gf_one;
 	p->U = qa.U;
 	p->T = qa.T;
-	point_affine_lookup(&qa, point_win_base65, sd[25]);
+	point_affine_lookup(&qa, bt->base65, sd[25]);
 	point_add_affine(p, p, &qa);
-	point_affine_lookup(&qa, point_win_base130, sd[38]);
+	point_affine_lookup(&qa, bt->base130, sd[38]);
 	point_add_affine(p, p, &qa);
 	for (int i = 11; i >= 0; i --) {
 		point_xdouble(p, p, 5);
-		point_affine_lookup(&qa, point_win_base, sd[i]);
+		point_affine_lookup(&qa, bt->base, sd[i]);
 		point_add_affine(p, p, &qa);
-		point_affine_lookup(&qa, point_win_base65, sd[i + 13]);
+		point_affine_lookup(&qa, bt->base65, sd[i + 13]);
 		point_add_affine(p, p, &qa);
-		point_affine_lookup(&qa, point_win_base130, sd[i + 26]);
+		point_affine_lookup(&qa, bt->base130, sd[i + 26]);
 		point_add_affine(p, p, &qa);
-		point_affine_lookup(&qa, point_win_base195, sd[i + 39]);
+		point_affine_lookup(&qa, bt->base195, sd[i + 39]);
 		point_add_affine(p, p, &qa);
 	}
+#endif
 }
 
+#if JQ_IFMA
+/* --------------------------------------------------------------------- */
 /*
- * Signature verification helper: given point P1, 128-bit integer `u`
- * (expressed over 4 limbs), and scalar `v`, compute:
- * P2 <- u*P1 + v*G
- * THIS FUNCTION IS NOT CONSTANT-TIME. It is assumed that it will be used
- * in signature verification, and that signature verification uses only
- * public data.
+ * 8-way implementation with AVX-512 IFMA.
+ *
+ * A gf8 holds eight independent field elements, one per 64-bit lane
+ * of ZMM registers, over five 52-bit limbs (vertical layout: v[i]
+ * contains limb i of all eight elements). Multiplications use the
+ * vpmadd52luq and vpmadd52huq instructions, which require all limbs
+ * to be lower than 2^52. Every function returns "normalized" values:
+ * limbs 0 to 3 are lower than 2^52 and limb 4 is lower than 2^48 (the
+ * value is then lower than 2^256, but not necessarily reduced modulo q).
+ *
+ * This code is compiled with a target attribute and used only after a
+ * runtime check of the CPU abilities (ifma_available()). It implements
+ * only what batch operations need (currently, multiplication of the
+ * base point, and multiplication of several points by the same
+ * scalar); all functions are constant-time.
  */
-static void
-point_mul128_add_mulgen_vartime(point *p2,
-	const point *p1, uint32_t *u, const scalar *v)
-{
-	point win[8];
-	int8_t sdu[130], sdv[256];
-
-	/*
-	 * Make a wNAF window: win[i] = (2*i+1)*P1
-	 */
-	point_double(&win[0], p1);
-	point_add(&win[1], &win[0], p1);
-	for (int i = 2; i < 8; i ++) {
-		point_add(&win[i], &win[i - 1], &win[0]);
-	}
-	win[0] = *p1;
 
-	/*
-	 * Recode u and v into wNAF.
-	 */
-	uint_recode_wNAF(sdu, 130, u, 4);
-	scalar_recode_wNAF(sdv, v);
+#if !W64
+#error JQ_IFMA requires W64
+#endif
 
-	/*
-	 * zz = 1 when the accumulator is still the neutral, 0 afterwards.
-	 * ndbl is the number of pending doublings.
-	 */
-	int zz = 1;
-	unsigned ndbl = 0;
-	for (int i = 129; i >= 0; i --) {
-		/* Schedule one more doubling. */
-		ndbl ++;
+#define TARGET_IFMA   __attribute__((target("avx512f,avx512ifma")))
 
-		/* Get next digits; if all three are zeros, then skip
-		   to the next iteration. */
-		int eu = sdu[i];
-		int ev0 = sdv[i];
-		int ev1 = i < 126 ? sdv[i + 130] : 0;
-		if ((eu | ev0 | ev1) == 0) {
-			continue;
+/*
+ * Minimum number of scalars for which point_mulgen_batch() uses the
+ * 8-way implementation (padding the group).
+ */
+#define MULGEN_X8_MIN   4
+
+typedef struct {
+	__m512i v[5];
+} gf8;
+
+typedef struct {
+	gf8 E, Z, U, T;
+} point8;
+
+typedef struct {
+	gf8 E, U, T;
+} point8_affine;
+
+#define M52   (((uint64_t)1 << 52) - 1)
+#define M47   (((uint64_t)1 << 47) - 1)
+
+/*
+ * Return 1 if the CPU supports the 8-way implementation, 0 otherwise.
+ */
+static int
+ifma_available(void)
+{
+	return __builtin_cpu_supports("avx512f")
+		&& __builtin_cpu_supports("avx512ifma");
+}
+
+/*
+ * Propagate carries and fold the bits beyond 2^255 into limb 0.
+ * Input limbs must be lower than 2^63.
+ */
+TARGET_IFMA
+static inline void
+gf8_norm(gf8 *d, const __m512i *a)
+{
+	__m512i m52 = _mm512_set1_epi64(M52);
+	__m512i l0, l1, l2, l3, l4, t;
+
+	l0 = a[0];
+	l1 = _mm512_add_epi64(a[1], _mm512_srli_epi64(l0, 52));
+	l0 = _mm512_and_si512(l0, m52);
+	l2 = _mm512_add_epi64(a[2], _mm512_srli_epi64(l1, 52));
+	l1 = _mm512_and_si512(l1, m52);
+	l3 = _mm512_add_epi64(a[3], _mm512_srli_epi64(l2, 52));
+	l2 = _mm512_and_si512(l2, m52);
+	l4 = _mm512_add_epi64(a[4], _mm512_srli_epi64(l3, 52));
+	l3 = _mm512_and_si512(l3, m52);
+
+	/* 2^255 = MQ mod q */
+	t = _mm512_srli_epi64(l4, 47);
+	l4 = _mm512_and_si512(l4, _mm512_set1_epi64(M47));
+	l0 = _mm512_madd52lo_epu64(l0, t, _mm512_set1_epi64(MQ));
+
+	l1 = _mm512_add_epi64(l1, _mm512_srli_epi64(l0, 52));
+	d->v[0] = _mm512_and_si512(l0, m52);
+	l2 = _mm512_add_epi64(l2, _mm512_srli_epi64(l1, 52));
+	d->v[1] = _mm512_and_si512(l1, m52);
+	l3 = _mm512_add_epi64(l3, _mm512_srli_epi64(l2, 52));
+	d->v[2] = _mm512_and_si512(l2, m52);
+	d->v[4] = _mm512_add_epi64(l4, _mm512_srli_epi64(l3, 52));
+	d->v[3] = _mm512_and_si512(l3, m52);
+}
+
+/*
+ * 16*q = 2^259 - 16*MQ, over limbs that are all large enough to allow
+ * subtracting any normalized value without a borrow.
+ */
+static const uint64_t Q16_52[5] = {
+	((uint64_t)1 << 53) - 16 * MQ,
+	((uint64_t)1 << 53) - 2,
+	((uint64_t)1 << 53) - 2,
+	((uint64_t)1 << 53) - 2,
+	((uint64_t)1 << 51) - 2
+};
+
+/*
+ * q, over normalized limbs.
+ */
+static const uint64_t Q_52[5] = {
+	((uint64_t)1 << 52) - MQ, M52, M52, M52, M47
+};
+
+static const uint64_t ONE_52[5] = { 1, 0, 0, 0, 0 };
+
+TARGET_IFMA
+static inline void
+gf8_add(gf8 *d, const gf8 *a, const gf8 *b)
+{
+	__m512i t[5];
+
+	for (int i = 0; i < 5; i ++) {
+		t[i] = _mm512_add_epi64(a->v[i], b->v[i]);
+	}
+	gf8_norm(d, t);
+}
+
+TARGET_IFMA
+static inline void
+gf8_sub(gf8 *d, const gf8 *a, const gf8 *b)
+{
+	__m512i t[5];
+
+	for (int i = 0; i < 5; i ++) {
+		t[i] = _mm512_sub_epi64(
+			_mm512_add_epi64(a->v[i], _mm512_set1_epi64(Q16_52[i])),
+			b->v[i]);
+	}
+	gf8_norm(d, t);
+}
+
+TARGET_IFMA
+static inline void
+gf8_mul2(gf8 *d, const gf8 *a)
+{
+	gf8_add(d, a, a);
+}
+
+/*
+ * d <- a*2^n, for 1 <= n <= 8.
+ */
+TARGET_IFMA
+static inline void
+gf8_lsh(gf8 *d, const gf8 *a, unsigned n)
+{
+	__m512i t[5];
+
+	for (int i = 0; i < 5; i ++) {
+		t[i] = _mm512_slli_epi64(a->v[i], n);
+	}
+	gf8_norm(d, t);
+}
+
+/*
+ * d <- a/2
+ */
+TARGET_IFMA
+static inline void
+gf8_half(gf8 *d, const gf8 *a)
+{
+	__m512i t[5];
+	__mmask8 odd;
+
+	/* Add q if the value is odd; propagate carries (without folding:
+	   the value is lower than 2^257), then shift right. */
+	odd = _mm512_test_epi64_mask(a->v[0], _mm512_set1_epi64(1));
+	for (int i = 0; i < 5; i ++) {
+		t[i] = _mm512_mask_add_epi64(a->v[i], odd,
+			a->v[i], _mm512_set1_epi64(Q_52[i]));
+	}
+	for (int i = 0; i < 4; i ++) {
+		t[i + 1] = _mm512_add_epi64(t[i + 1],
+			_mm512_srli_epi64(t[i], 52));
+		t[i] = _mm512_and_si512(t[i], _mm512_set1_epi64(M52));
+	}
+	for (int i = 0; i < 4; i ++) {
+		d->v[i] = _mm512_or_si512(_mm512_srli_epi64(t[i], 1),
+			_mm512_slli_epi64(_mm512_and_si512(t[i + 1],
+				_mm512_set1_epi64(1)), 51));
+	}
+	d->v[4] = _mm512_srli_epi64(t[4], 1);
+}
+
+/*
+ * d <- a*b
+ */
+TARGET_IFMA
+static inline void
+gf8_mul(gf8 *d, const gf8 *a, const gf8 *b)
+{
+	__m512i c[10], r[5], k, m52;
+
+	for (int i = 0; i < 10; i ++) {
+		c[i] = _mm512_setzero_si512();
+	}
+	for (int i = 0; i < 5; i ++) {
+		for (int j = 0; j < 5; j ++) {
+			c[i + j] = _mm512_madd52lo_epu64(c[i + j],
+				a->v[i], b->v[j]);
+			c[i + j + 1] = _mm512_madd52hi_epu64(c[i + j + 1],
+				a->v[i], b->v[j]);
 		}
+	}
 
-		/* Apply pending doublings. */
-		if (zz) {
-			zz = 0;
-			*p2 = point_neutral;
-		} else {
-			point_xdouble(p2, p2, ndbl);
+	/* Normalize the high half (the product is lower than 2^512, so
+	   no carry goes out of c[9]). */
+	m52 = _mm512_set1_epi64(M52);
+	for (int i = 0; i < 9; i ++) {
+		c[i + 1] = _mm512_add_epi64(c[i + 1],
+			_mm512_srli_epi64(c[i], 52));
+		c[i] = _mm512_and_si512(c[i], m52);
+	}
+
+	/* 2^260 = 32*MQ mod q; the hi part of c[9]*32*MQ, at weight
+	   2^260, is folded again (it is small). */
+	k = _mm512_set1_epi64(32 * MQ);
+	r[0] = _mm512_madd52lo_epu64(c[0], c[5], k);
+	for (int i = 1; i < 5; i ++) {
+		r[i] = _mm512_madd52lo_epu64(c[i], c[i + 5], k);
+		r[i] = _mm512_madd52hi_epu64(r[i], c[i + 4], k);
+	}
+	r[0] = _mm512_madd52lo_epu64(r[0],
+		_mm512_madd52hi_epu64(_mm512_setzero_si512(), c[9], k), k);
+	gf8_norm(d, r);
+}
+
+TARGET_IFMA
+static inline void
+gf8_square(gf8 *d, const gf8 *a)
+{
+	gf8_mul(d, a, a);
+}
+
+/*
+ * d <- -a for the lanes selected by mask m; other lanes are copied.
+ */
+TARGET_IFMA
+static inline void
+gf8_condneg(gf8 *d, const gf8 *a, __mmask8 m)
+{
+	__m512i t[5];
+	gf8 n;
+
+	for (int i = 0; i < 5; i ++) {
+		t[i] = _mm512_sub_epi64(_mm512_set1_epi64(Q16_52[i]), a->v[i]);
+	}
+	gf8_norm(&n, t);
+	for (int i = 0; i < 5; i ++) {
+		d->v[i] = _mm512_mask_blend_epi64(m, a->v[i], n.v[i]);
+	}
+}
+
+/*
+ * Set all lanes of d to the limbs x[].
+ */
+TARGET_IFMA
+static inline void
+gf8_set1(gf8 *d, const uint64_t *x)
+{
+	for (int i = 0; i < 5; i ++) {
+		d->v[i] = _mm512_set1_epi64(x[i]);
+	}
+}
+
+/*
+ * Split a (full range) field element into five 52-bit limbs.
+ */
+static inline void
+gf_to_limbs52(uint64_t *x, const gf *a)
+{
+	x[0] = a->v0 & M52;
+	x[1] = ((a->v0 >> 52) | (a->v1 << 12)) & M52;
+	x[2] = ((a->v1 >> 40) | (a->v2 << 24)) & M52;
+	x[3] = ((a->v2 >> 28) | (a->v3 << 36)) & M52;
+	x[4] = a->v3 >> 16;
+}
+
+/*
+ * Extract the eight field elements from a gf8.
+ */
+TARGET_IFMA
+static inline void
+gf8_store(gf *d, const gf8 *a)
+{
+	uint64_t x[5][8];
+
+	for (int i = 0; i < 5; i ++) {
+		_mm512_storeu_si512((void *)x[i], a->v[i]);
+	}
+	for (int j = 0; j < 8; j ++) {
+		d[j].v0 = x[0][j] | (x[1][j] << 52);
+		d[j].v1 = (x[1][j] >> 12) | (x[2][j] << 40);
+		d[j].v2 = (x[2][j] >> 24) | (x[3][j] << 28);
+		d[j].v3 = (x[3][j] >> 36) | (x[4][j] << 16);
+	}
+}
+
+/*
+ * Store the eight points of a point8 into p[0..7].
+ */
+TARGET_IFMA
+static void
+point8_store(point *p, const point8 *q)
+{
+	gf tmp[8];
+
+	gf8_store(tmp, &q->E);
+	for (int j = 0; j < 8; j ++) {
+		p[j].E = tmp[j];
+	}
+	gf8_store(tmp, &q->Z);
+	for (int j = 0; j < 8; j ++) {
+		p[j].Z = tmp[j];
+	}
+	gf8_store(tmp, &q->U);
+	for (int j = 0; j < 8; j ++) {
+		p[j].U = tmp[j];
+	}
+	gf8_store(tmp, &q->T);
+	for (int j = 0; j < 8; j ++) {
+		p[j].T = tmp[j];
+	}
+}
+
+/*
+ * Set lane j of d to the affine point p[j*stride], for j = 0 to 7.
+ */
+TARGET_IFMA
+static void
+point8_affine_set(point8_affine *d, const point_affine *p, size_t stride)
+{
+	uint64_t x[3][5][8];
+
+	for (int j = 0; j < 8; j ++) {
+		const point_affine *q = &p[(size_t)j * stride];
+		uint64_t y[5];
+
+		gf_to_limbs52(y, &q->E);
+		for (int i = 0; i < 5; i ++) {
+			x[0][i][j] = y[i];
 		}
-		ndbl = 0;
+		gf_to_limbs52(y, &q->U);
+		for (int i = 0; i < 5; i ++) {
+			x[1][i][j] = y[i];
+		}
+		gf_to_limbs52(y, &q->T);
+		for (int i = 0; i < 5; i ++) {
+			x[2][i][j] = y[i];
+		}
+	}
+	for (int i = 0; i < 5; i ++) {
+		d->E.v[i] = _mm512_loadu_si512((const void *)x[0][i]);
+		d->U.v[i] = _mm512_loadu_si512((const void *)x[1][i]);
+		d->T.v[i] = _mm512_loadu_si512((const void *)x[2][i]);
+	}
+}
 
-		/* Process digits. */
-		if (eu != 0) {
-			if (eu > 0) {
-				point_add(p2, p2, &win[eu >> 1]);
-			} else {
-				point_sub(p2, p2, &win[(-eu) >> 1]);
-			}
+/*
+ * Point addition P3 <- P1 + P2, with P2 in affine coordinates. This
+ * uses the same formulas as point_add_affine().
+ */
+TARGET_IFMA
+static void
+point8_add_affine(point8 *p3, const point8 *p1, const point8_affine *p2)
+{
+	gf8 e1e2, u1u2, t1t2, eu, zt, hd, g1, g2, g3;
+
+	gf8_mul(&e1e2, &p1->E, &p2->E);
+	gf8_mul(&u1u2, &p1->U, &p2->U);
+	gf8_mul(&t1t2, &p1->T, &p2->T);
+
+	/* eu <- E1*U2 + E2*U1 */
+	gf8_add(&g1, &p1->E, &p1->U);
+	gf8_add(&g2, &p2->E, &p2->U);
+	gf8_mul(&eu, &g1, &g2);
+	gf8_add(&g3, &e1e2, &u1u2);
+	gf8_sub(&eu, &eu, &g3);
+
+	/* zt <- Z1*T2 + T1 */
+	gf8_mul(&g1, &p1->Z, &p2->T);
+	gf8_add(&zt, &g1, &p1->T);
+
+#if JQ == JQ255E
+	gf8_lsh(&g1, &t1t2, 3);
+	gf8_sub(&hd, &p1->Z, &g1);
+	gf8_add(&g1, &p1->Z, &g1);
+	gf8_mul(&g1, &g1, &e1e2);
+	gf8_lsh(&g2, &u1u2, 4);
+	gf8_mul(&g2, &g2, &zt);
+	gf8_add(&p3->E, &g1, &g2);
+#elif JQ == JQ255S
+	gf8_add(&hd, &p1->Z, &t1t2);
+	gf8_sub(&g1, &p1->Z, &t1t2);
+	gf8_mul2(&g2, &u1u2);
+	gf8_add(&g3, &e1e2, &g2);
+	gf8_mul(&g1, &g3, &g1);
+	gf8_mul(&g2, &g2, &zt);
+	gf8_sub(&p3->E, &g1, &g2);
+#else
+#error Unknown curve
+#endif
+
+	gf8_square(&p3->Z, &hd);
+	gf8_square(&p3->T, &eu);
+	gf8_mul(&p3->U, &hd, &eu);
+}
+
+/*
+ * Double a point repeatedly: d <- 2^n*P (n >= 1). This uses the same
+ * formulas as point_xdouble().
+ */
+TARGET_IFMA
+static void
+point8_xdouble(point8 *d, const point8 *p, unsigned n)
+{
+#if JQ == JQ255E
+	gf8 X, W, J, g1, g2, ww;
+
+	gf8_square(&g1, &p->E);
+	gf8_mul(&J, &p->E, &p->U);
+	gf8_square(&X, &g1);
+	gf8_square(&W, &p->Z);
+	gf8_mul2(&J, &J);
+	gf8_mul2(&W, &W);
+	gf8_sub(&W, &W, &g1);
+
+	while (n -- > 1) {
+		gf8_square(&ww, &W);
+		gf8_mul2(&g1, &X);
+		gf8_sub(&g1, &ww, &g1);
+		gf8_square(&g2, &g1);
+		gf8_mul(&g1, &g1, &W);
+		gf8_mul2(&g1, &g1);
+		gf8_mul(&J, &J, &g1);
+		gf8_square(&ww, &ww);
+		gf8_mul2(&ww, &ww);
+		gf8_sub(&W, &g2, &ww);
+		gf8_square(&X, &g2);
+	}
+
+	gf8_square(&d->Z, &W);
+	gf8_square(&d->T, &J);
+	gf8_mul(&d->U, &W, &J);
+	gf8_mul2(&g1, &X);
+	gf8_sub(&d->E, &g1, &d->Z);
+#elif JQ == JQ255S
+	gf8 X, W, J, g1, g2, g3;
+
+	gf8_square(&g1, &p->U);
+	gf8_mul(&J, &p->E, &p->U);
+	gf8_mul2(&J, &J);
+	gf8_square(&X, &g1);
+	gf8_lsh(&X, &X, 3);
+	gf8_add(&g2, &p->T, &p->Z);
+	gf8_mul2(&W, &g1);
+	gf8_square(&g2, &g2);
+	gf8_sub(&W, &W, &g2);
+
+	while (n -- > 1) {
+		gf8_mul(&g1, &W, &J);
+		gf8_add(&g3, &W, &J);
+		gf8_mul2(&g2, &g1);
+		gf8_square(&g3, &g3);
+		gf8_mul2(&J, &X);
+		gf8_sub(&g3, &g3, &g2);
+		gf8_sub(&J, &J, &g3);
+		gf8_square(&g2, &g1);
+		gf8_mul(&J, &J, &g1);
+		gf8_square(&g3, &g3);
+		gf8_square(&X, &g2);
+		gf8_half(&g3, &g3);
+		gf8_mul2(&X, &X);
+		gf8_sub(&W, &g2, &g3);
+	}
+
+	gf8_square(&d->Z, &W);
+	gf8_square(&d->T, &J);
+	gf8_mul(&d->U, &W, &J);
+	gf8_mul2(&g1, &X);
+	gf8_sub(&g1, &g1, &d->Z);
+	gf8_sub(&d->E, &g1, &d->T);
+#else
+#error Unknown curve
+#endif
+}
+
+/*
+ * Lookup points from a window of affine points shared by all lanes,
+ * with sign management (as point_affine_lookup()).
+ * Input:
+ *   win[i] = (i+1)*P1
+ *   k[j] is the digit for lane j, -16 <= k[j] <= 16
+ * Output:
+ *   P2 <- k*P1 (in each lane)
+ */
+TARGET_IFMA
+static void
+point8_affine_lookup(point8_affine *p2, const point_affine *win,
+	const int8_t *k)
+{
+	__m512i kv, m;
+	__mmask8 sk;
+
+	kv = _mm512_set_epi64(k[7], k[6], k[5], k[4],
+		k[3], k[2], k[1], k[0]);
+	sk = _mm512_cmplt_epi64_mask(kv, _mm512_setzero_si512());
+	m = _mm512_abs_epi64(kv);
+
+	/* Start from the neutral (1, 0, 0), then scan the whole window. */
+	for (int i = 0; i < 5; i ++) {
+		p2->E.v[i] = _mm512_set1_epi64(i == 0);
+		p2->U.v[i] = _mm512_setzero_si512();
+		p2->T.v[i] = _mm512_setzero_si512();
+	}
+	for (int j = 0; j < 16; j ++) {
+		__mmask8 c;
+		uint64_t x[5];
+
+		c = _mm512_cmpeq_epi64_mask(m, _mm512_set1_epi64(j + 1));
+		gf_to_limbs52(x, &win[j].E);
+		for (int i = 0; i < 5; i ++) {
+			p2->E.v[i] = _mm512_mask_blend_epi64(c,
+				p2->E.v[i], _mm512_set1_epi64(x[i]));
 		}
-		if (ev0 != 0) {
-			if (ev0 > 0) {
-				point_add_affine(p2, p2,
-					&point_win_base[ev0 - 1]);
-			} else {
-				point_sub_affine(p2, p2,
-					&point_win_base[-ev0 - 1]);
-			}
+		gf_to_limbs52(x, &win[j].U);
+		for (int i = 0; i < 5; i ++) {
+			p2->U.v[i] = _mm512_mask_blend_epi64(c,
+				p2->U.v[i], _mm512_set1_epi64(x[i]));
 		}
-		if (ev1 != 0) {
-			if (ev1 > 0) {
-				point_add_affine(p2, p2,
-					&point_win_base130[ev1 - 1]);
+		gf_to_limbs52(x, &win[j].T);
+		for (int i = 0; i < 5; i ++) {
+			p2->T.v[i] = _mm512_mask_blend_epi64(c,
+				p2->T.v[i], _mm512_set1_epi64(x[i]));
+		}
+	}
+	gf8_condneg(&p2->U, &p2->U, sk);
+}
+
+/*
+ * Multiplication of the fixed base point by eight scalars:
+ * P[j] <- s[j]*G for j = 0 to 7. This follows the same steps as
+ * point_mulgen(). Caller must check ifma_available() first.
+ */
+TARGET_IFMA
+static void
+point_mulgen_x8(point *p, const scalar *s)
+{
+	const base_tables *bt = base_tables_get();
+	int8_t sd[51][8];
+	point8 q;
+	point8_affine qa;
+
+	for (int j = 0; j < 8; j ++) {
+		int8_t sj[51];
+
+		scalar_recode(sj, &s[j]);
+		for (int i = 0; i < 51; i ++) {
+			sd[i][j] = sj[i];
+		}
+	}
+
+#define MULGEN8_ADD(win, digit)   do { \
+		point8_affine_lookup(&qa, (win), sd[digit]); \
+		point8_add_affine(&q, &q, &qa); \
+	} while (0)
+
+#if MULGEN_LARGE
+	for (int i = MULGEN_SPACING - 1; i >= 0; i --) {
+		if (i != MULGEN_SPACING - 1) {
+			point8_xdouble(&q, &q, 5);
+		}
+		for (int k = 0; k < MULGEN_NUM_WIN; k ++) {
+			int j = i + MULGEN_SPACING * k;
+
+			if (j >= 51) {
+				break;
+			}
+			if (i == MULGEN_SPACING - 1 && k == 0) {
+				point8_affine_lookup(&qa,
+					bt->mulgen, sd[j]);
+				q.E = qa.E;
+				gf8_set1(&q.Z, ONE_52);
+				q.U = qa.U;
+				q.T = qa.T;
 			} else {
-				point_sub_affine(p2, p2,
-					&point_win_base130[-ev1 - 1]);
+				MULGEN8_ADD(bt->mulgen + 16 * k, j);
 			}
 		}
 	}
-
-	if (zz) {
-		*p2 = point_neutral;
-	} else {
-		point_xdouble(p2, p2, ndbl);
+#else
+	point8_affine_lookup(&qa, bt->base, sd[12]);
+	q.E = qa.E;
+	gf8_set1(&q.Z, ONE_52);
+	q.U = qa.U;
+	q.T = qa.T;
+	MULGEN8_ADD(bt->base65, 25);
+	MULGEN8_ADD(bt->base130, 38);
+	for (int i = 11; i >= 0; i --) {
+		point8_xdouble(&q, &q, 5);
+		MULGEN8_ADD(bt->base, i);
+		MULGEN8_ADD(bt->base65, i + 13);
+		MULGEN8_ADD(bt->base130, i + 26);
+		MULGEN8_ADD(bt->base195, i + 39);
 	}
+#endif
+
+#undef MULGEN8_ADD
+
+	point8_store(p, &q);
 }
 
-/* ===================================================================== */
 /*
- * SECTION 4: PRECOMPUTED POINT WINDOWS
- *
- * We store here some precomputed tables for multiples of the base point.
+ * Lookup points from a window with a distinct point in each lane, with
+ * the same digit for all lanes (and sign management, as
+ * point_affine_lookup()).
+ * Input:
+ *   win[i] = (i+1)*P1 (in each lane)
+ *   -16 <= k <= 16
+ * Output:
+ *   P2 <- k*P1 (in each lane)
  */
+TARGET_IFMA
+static void
+point8_affine_lookup_lanes(point8_affine *p2, const point8_affine *win,
+	int8_t k)
+{
+	__m512i kv, m;
+	__mmask8 sk;
 
-#if JQ == JQ255E
+	kv = _mm512_set1_epi64(k);
+	sk = _mm512_cmplt_epi64_mask(kv, _mm512_setzero_si512());
+	m = _mm512_abs_epi64(kv);
 
-/* Points i*G for i = 1 to 16, affine extended format */
-static const point_affine point_win_base[] = {
-	/* G * 1 */
-	{ LGF(0x00000003, 0x00000000, 0x00000000, 0x00000000,
-	      0x00000000, 0x00000000, 0x00000000, 0x00000000),
-	  LGF(0x00000001, 0x00000000, 0x00000000, 0x00000000,
+	for (int i = 0; i < 5; i ++) {
+		p2->E.v[i] = _mm512_set1_epi64(i == 0);
+		p2->U.v[i] = _mm512_setzero_si512();
+		p2->T.v[i] = _mm512_setzero_si512();
+	}
+	for (int j = 0; j < 16; j ++) {
+		__mmask8 c;
+
+		c = _mm512_cmpeq_epi64_mask(m, _mm512_set1_epi64(j + 1));
+		for (int i = 0; i < 5; i ++) {
+			p2->E.v[i] = _mm512_mask_blend_epi64(c,
+				p2->E.v[i], win[j].E.v[i]);
+			p2->U.v[i] = _mm512_mask_blend_epi64(c,
+				p2->U.v[i], win[j].U.v[i]);
+			p2->T.v[i] = _mm512_mask_blend_epi64(c,
+				p2->T.v[i], win[j].T.v[i]);
+		}
+	}
+	gf8_condneg(&p2->U, &p2->U, sk);
+}
+
+/*
+ * Multiplication of eight points by the same scalar: P[j] <- s*P_j for
+ * j = 0 to 7, given the windows of the points (win[16*j+i] = (i+1)*P_j)
+ * and the recoded scalar (see point_mul_prepare_scalar()). This follows
+ * the same steps as point_mul_prepared(). Caller must check
+ * ifma_available() first.
+ */
+TARGET_IFMA
+static void
+point_mul_prepared_x8(point *p, const point_affine *win,
+	const int8_t *sd, uint32_t sk)
+{
+	point8_affine w8[16], qa;
+	point8 q;
+
+	for (int i = 0; i < 16; i ++) {
+		point8_affine_set(&w8[i], win + i, 16);
+	}
+
+#if JQ == JQ255E
+	__mmask8 m0;
+	gf eta;
+	gf8 eta8;
+	uint64_t x[5];
+
+	m0 = (__mmask8)-(sk & 1);
+	gf_condneg(&eta, &ETA, -((sk >> 1) & 1));
+	gf_to_limbs52(x, &eta);
+	gf8_set1(&eta8, x);
+
+	point8_affine_lookup_lanes(&qa, w8, sd[25]);
+	q.E = qa.E;
+	gf8_set1(&q.Z, ONE_52);
+	gf8_condneg(&q.U, &qa.U, m0);
+	q.T = qa.T;
+	point8_affine_lookup_lanes(&qa, w8, sd[51]);
+	gf8_mul(&qa.U, &qa.U, &eta8);
+	gf8_condneg(&qa.T, &qa.T, 0xFF);
+	point8_add_affine(&q, &q, &qa);
+	for (int i = 24; i >= 0; i --) {
+		point8_xdouble(&q, &q, 5);
+		point8_affine_lookup_lanes(&qa, w8, sd[i]);
+		gf8_condneg(&qa.U, &qa.U, m0);
+		point8_add_affine(&q, &q, &qa);
+		point8_affine_lookup_lanes(&qa, w8, sd[i + 26]);
+		gf8_mul(&qa.U, &qa.U, &eta8);
+		gf8_condneg(&qa.T, &qa.T, 0xFF);
+		point8_add_affine(&q, &q, &qa);
+	}
+#else
+	(void)sk;
+	point8_affine_lookup_lanes(&qa, w8, sd[50]);
+	q.E = qa.E;
+	gf8_set1(&q.Z, ONE_52);
+	q.U = qa.U;
+	q.T = qa.T;
+	for (int i = 49; i >= 0; i --) {
+		point8_xdouble(&q, &q, 5);
+		point8_affine_lookup_lanes(&qa, w8, sd[i]);
+		point8_add_affine(&q, &q, &qa);
+	}
+#endif
+
+	point8_store(p, &q);
+}
+
+#endif /* JQ_IFMA */
+
+/*
+ * Multiplication of the fixed base point by n scalars:
+ * P[i] <- s[i]*G for i = 0 to n-1. The 8-way implementation is used
+ * when available; since it costs about as much for a partial group,
+ * a trailing group with enough scalars is padded.
+ */
+static void
+point_mulgen_batch(point *p, const scalar *s, size_t n)
+{
+#if JQ_IFMA
+	if (ifma_available()) {
+		while (n >= MULGEN_X8_MIN) {
+			if (n >= 8) {
+				point_mulgen_x8(p, s);
+				p += 8;
+				s += 8;
+				n -= 8;
+			} else {
+				point pp[8];
+				scalar ss[8];
+
+				memcpy(ss, s, n * sizeof *s);
+				for (size_t i = n; i < 8; i ++) {
+					ss[i] = scalar_zero;
+				}
+				point_mulgen_x8(pp, ss);
+				memcpy(p, pp, n * sizeof *p);
+				n = 0;
+			}
+		}
+	}
+#endif
+	for (size_t i = 0; i < n; i ++) {
+		point_mulgen(&p[i], &s[i]);
+	}
+}
+
+/*
+ * Signature verification helper: given point P1, 128-bit integer `u`
+ * (expressed over 4 limbs), and scalar `v`, compute:
+ * P2 <- u*P1 + v*G
+ * THIS FUNCTION IS NOT CONSTANT-TIME. It is assumed that it will be used
+ * in signature verification, and that signature verification uses only
+ * public data.
+ */
+static void
+point_mul128_add_mulgen_vartime(point *p2,
+	const point *p1, uint32_t *u, const scalar *v)
+{
+	const base_tables *bt = base_tables_get();
+	point win[8];
+	int8_t sdu[130], sdv[256];
+
+	/*
+	 * Make a wNAF window: win[i] = (2*i+1)*P1
+	 */
+	point_double(&win[0], p1);
+	point_add(&win[1], &win[0], p1);
+	for (int i = 2; i < 8; i ++) {
+		point_add(&win[i], &win[i - 1], &win[0]);
+	}
+	win[0] = *p1;
+
+	/*
+	 * Recode u and v into wNAF.
+	 */
+	uint_recode_wNAF(sdu, 130, u, 4);
+	scalar_recode_wNAF(sdv, v);
+
+	/*
+	 * zz = 1 when the accumulator is still the neutral, 0 afterwards.
+	 * ndbl is the number of pending doublings.
+	 */
+	STATS_BEGIN(st);
+	int zz = 1;
+	unsigned ndbl = 0;
+	for (int i = 129; i >= 0; i --) {
+		/* Schedule one more doubling. */
+		ndbl ++;
+
+		/* Get next digits; if all three are zeros, then skip
+		   to the next iteration. */
+		int eu = sdu[i];
+		int ev0 = sdv[i];
+		int ev1 = i < 126 ? sdv[i + 130] : 0;
+		if ((eu | ev0 | ev1) == 0) {
+			continue;
+		}
+
+		/* Apply pending doublings. */
+		if (zz) {
+			zz = 0;
+			*p2 = point_neutral;
+		} else {
+			point_xdouble(p2, p2, ndbl);
+		}
+		ndbl = 0;
+
+		/* Process digits. */
+		if (eu != 0) {
+			if (eu > 0) {
+				point_add(p2, p2, &win[eu >> 1]);
+			} else {
+				point_sub(p2, p2, &win[(-eu) >> 1]);
+			}
+		}
+		if (ev0 != 0) {
+			if (ev0 > 0) {
+				point_add_affine(p2, p2,
+					&bt->base[ev0 - 1]);
+			} else {
+				point_sub_affine(p2, p2,
+					&bt->base[-ev0 - 1]);
+			}
+		}
+		if (ev1 != 0) {
+			if (ev1 > 0) {
+				point_add_affine(p2, p2,
+					&bt->base130[ev1 - 1]);
+			} else {
+				point_sub_affine(p2, p2,
+					&bt->base130[-ev1 - 1]);
+			}
+		}
+	}
+
+	if (zz) {
+		*p2 = point_neutral;
+	} else {
+		point_xdouble(p2, p2, ndbl);
+	}
+	STATS_END(st, JQ255_STAT_VERIFY_LOOP, 1);
+}
+
+/*
+ * Add or subtract a point from a wNAF window.
+ * Input:
+ *   win[i] = (2*i+1)*P
+ *   e is odd, -15 <= e <= +15, or e == 0
+ * Output:
+ *   P2 <- P2 + e*P
+ */
+static inline void
+point_add_wNAF(point *p2, const point *win, int e)
+{
+	if (e > 0) {
+		point_add(p2, p2, &win[e >> 1]);
+	} else if (e < 0) {
+		point_sub(p2, p2, &win[(-e) >> 1]);
+	}
+}
+
+/*
+ * Add or subtract a point from a window of the base point multiples
+ * (point_win_base and similar), in affine coordinates.
+ * Input:
+ *   win[i] = (i+1)*Q
+ *   e is odd, -15 <= e <= +15, or e == 0
+ * Output:
+ *   P2 <- P2 + e*Q
+ */
+static inline void
+point_add_affine_base(point *p2, const point_affine *win, int e)
+{
+	if (e > 0) {
+		point_add_affine(p2, p2, &win[e - 1]);
+	} else if (e < 0) {
+		point_sub_affine(p2, p2, &win[-e - 1]);
+	}
+}
+
+/*
+ * Point multiplication by a scalar: P2 <- s*P1
+ * THIS FUNCTION IS NOT CONSTANT-TIME. It uses wNAF recoding and direct
+ * window accesses, and may be used only when both the point and the
+ * scalar are public.
+ */
+static void
+point_mul_vartime(point *p2, const point *p1, const scalar *s)
+{
+	point win[8];
+
+	/*
+	 * Make a wNAF window: win[i] = (2*i+1)*P1
+	 */
+	point_double(&win[0], p1);
+	point_add(&win[1], &win[0], p1);
+	for (int i = 2; i < 8; i ++) {
+		point_add(&win[i], &win[i - 1], &win[0]);
+	}
+	win[0] = *p1;
+
+#if JQ == JQ255E
+	/*
+	 * Split the scalar (see point_mul()) and use a second window
+	 * over zeta(P1) = (e, eta*u); signs of k0 and k1 are applied on
+	 * the digits.
+	 */
+	point winz[8];
+	uint32_t k0[4], k1[4];
+	int8_t sd0[130], sd1[130];
+	int neg0, neg1;
+
+	for (int i = 0; i < 8; i ++) {
+		winz[i].E = win[i].E;
+		winz[i].Z = win[i].Z;
+		gf_mul(&winz[i].U, &win[i].U, &ETA);
+		gf_neg(&winz[i].T, &win[i].T);
+	}
+	uint32_t sk = scalar_split(k0, k1, s);
+	neg0 = (int)(sk & 1);
+	neg1 = (int)(sk >> 1);
+	uint_recode_wNAF(sd0, 130, k0, 4);
+	uint_recode_wNAF(sd1, 130, k1, 4);
+	const int num = 130;
+#else
+	int8_t sd[256];
+
+	scalar_recode_wNAF(sd, s);
+	const int num = 256;
+#endif
+
+	/*
+	 * zz = 1 when the accumulator is still the neutral, 0 afterwards.
+	 * ndbl is the number of pending doublings.
+	 */
+	int zz = 1;
+	unsigned ndbl = 0;
+	for (int i = num - 1; i >= 0; i --) {
+		ndbl ++;
+#if JQ == JQ255E
+		int e0 = sd0[i];
+		int e1 = sd1[i];
+		if ((e0 | e1) == 0) {
+			continue;
+		}
+#else
+		int e0 = sd[i];
+		if (e0 == 0) {
+			continue;
+		}
+#endif
+		if (zz) {
+			zz = 0;
+			*p2 = point_neutral;
+		} else {
+			point_xdouble(p2, p2, ndbl);
+		}
+		ndbl = 0;
+#if JQ == JQ255E
+		point_add_wNAF(p2, win, neg0 ? -e0 : e0);
+		point_add_wNAF(p2, winz, neg1 ? -e1 : e1);
+#else
+		point_add_wNAF(p2, win, e0);
+#endif
+	}
+
+	if (zz) {
+		*p2 = point_neutral;
+	} else {
+		point_xdouble(p2, p2, ndbl);
+	}
+}
+
+/*
+ * Multiplication of the fixed base point by a scalar: P2 <- s*G
+ * THIS FUNCTION IS NOT CONSTANT-TIME. The wNAF digits of the scalar
+ * are applied with the four built-in windows (multiples of G, 2^65*G,
+ * 2^130*G and 2^195*G), for 65 doublings in total.
+ */
+static void
+point_mulgen_vartime(point *p2, const scalar *s)
+{
+	const base_tables *bt = base_tables_get();
+	int8_t sd[256];
+
+	scalar_recode_wNAF(sd, s);
+
+	int zz = 1;
+	unsigned ndbl = 0;
+	for (int i = 64; i >= 0; i --) {
+		ndbl ++;
+		int e0 = sd[i];
+		int e1 = sd[i + 65];
+		int e2 = sd[i + 130];
+		int e3 = i < 61 ? sd[i + 195] : 0;
+		if ((e0 | e1 | e2 | e3) == 0) {
+			continue;
+		}
+		if (zz) {
+			zz = 0;
+			*p2 = point_neutral;
+		} else {
+			point_xdouble(p2, p2, ndbl);
+		}
+		ndbl = 0;
+		point_add_affine_base(p2, bt->base, e0);
+		point_add_affine_base(p2, bt->base65, e1);
+		point_add_affine_base(p2, bt->base130, e2);
+		point_add_affine_base(p2, bt->base195, e3);
+	}
+
+	if (zz) {
+		*p2 = point_neutral;
+	} else {
+		point_xdouble(p2, p2, ndbl);
+	}
+}
+
+/*
+ * Multi-scalar multiplication: P <- \sum_i s_i*P_i
+ * THIS FUNCTION IS NOT CONSTANT-TIME. It is meant for public data.
+ *
+ * Two algorithms are used:
+ *
+ *  - Straus (interleaved wNAF): the points are processed in chunks
+ *    of MSM_STRAUS_CHUNK, each with its own wNAF window (as in
+ *    point_mul_vartime(), including the endomorphism on jq255e), and
+ *    the doublings are shared within a chunk.
+ *
+ *  - Pippenger (buckets): for each c-bit signed digit position, from
+ *    the top, each point is added to (or subtracted from) the bucket
+ *    for the digit absolute value; the buckets are then summed with
+ *    the usual running sum. Digits are extracted directly from the
+ *    scalars with Booth recoding (no per-point storage). The
+ *    endomorphism does not help here: it halves the number of digit
+ *    positions but doubles the number of terms, so the number of
+ *    additions is unchanged.
+ *
+ * Pippenger is used for n >= MSM_PIPPENGER_MIN.
+ */
+#define MSM_STRAUS_CHUNK     8
+#define MSM_PIPPENGER_MIN    64
+#define MSM_MIN_BITS         5
+#define MSM_MAX_BITS         8
+
+/*
+ * Straus on up to MSM_STRAUS_CHUNK points; the result is added to P2
+ * (if zz is 0) or written into P2 (if zz is 1).
+ */
+static void
+point_msm_straus_vartime(point *p2, int zz,
+	const point *pp, const scalar *ss, size_t n)
+{
+	point win[MSM_STRAUS_CHUNK][8];
+	point acc;
+#if JQ == JQ255E
+	point winz[MSM_STRAUS_CHUNK][8];
+	int8_t sd0[MSM_STRAUS_CHUNK][130], sd1[MSM_STRAUS_CHUNK][130];
+	const int num = 130;
+#else
+	int8_t sd0[MSM_STRAUS_CHUNK][256];
+	const int num = 256;
+#endif
+
+	for (size_t j = 0; j < n; j ++) {
+		point_double(&win[j][0], &pp[j]);
+		point_add(&win[j][1], &win[j][0], &pp[j]);
+		for (int i = 2; i < 8; i ++) {
+			point_add(&win[j][i], &win[j][i - 1], &win[j][0]);
+		}
+		win[j][0] = pp[j];
+#if JQ == JQ255E
+		/*
+		 * The signs of k0 and k1 are applied on the windows,
+		 * so that the digits can be used directly.
+		 */
+		uint32_t k0[4], k1[4];
+		uint32_t sk = scalar_split(k0, k1, &ss[j]);
+		uint32_t m0 = -(sk & 1);
+		uint32_t m1 = -(sk >> 1);
+		for (int i = 0; i < 8; i ++) {
+			winz[j][i].E = win[j][i].E;
+			winz[j][i].Z = win[j][i].Z;
+			gf_mul(&winz[j][i].U, &win[j][i].U, &ETA);
+			gf_condneg(&winz[j][i].U, &winz[j][i].U, m1);
+			gf_neg(&winz[j][i].T, &win[j][i].T);
+			gf_condneg(&win[j][i].U, &win[j][i].U, m0);
+		}
+		uint_recode_wNAF(sd0[j], 130, k0, 4);
+		uint_recode_wNAF(sd1[j], 130, k1, 4);
+#else
+		scalar_recode_wNAF(sd0[j], &ss[j]);
+#endif
+	}
+
+	int az = 1;
+	unsigned ndbl = 0;
+	for (int i = num - 1; i >= 0; i --) {
+		ndbl ++;
+		for (size_t j = 0; j < n; j ++) {
+			int e0 = sd0[j][i];
+#if JQ == JQ255E
+			int e1 = sd1[j][i];
+#else
+			int e1 = 0;
+#endif
+			if ((e0 | e1) == 0) {
+				continue;
+			}
+			if (az) {
+				az = 0;
+				acc = point_neutral;
+			} else if (ndbl > 0) {
+				point_xdouble(&acc, &acc, ndbl);
+			}
+			ndbl = 0;
+			point_add_wNAF(&acc, win[j], e0);
+#if JQ == JQ255E
+			point_add_wNAF(&acc, winz[j], e1);
+#endif
+		}
+	}
+	if (az) {
+		acc = point_neutral;
+	} else {
+		point_xdouble(&acc, &acc, ndbl);
+	}
+
+	if (zz) {
+		*p2 = acc;
+	} else {
+		point_add(p2, p2, &acc);
+	}
+}
+
+/*
+ * Get the signed c-bit digit of index j of scalar s, with Booth
+ * recoding: the digit uses bits c*j-1 to c*j+c-1 (bit -1 being 0),
+ * and is in the -2^(c-1) to +2^(c-1) range. With ceil(256/c) digits,
+ * \sum_j d_j*2^(c*j) = s (since s < 2^255).
+ */
+static int
+scalar_booth_digit(const scalar *s, unsigned c, unsigned j)
+{
+	unsigned pos, k;
+	uint32_t w;
+
+	/* Get the c+1 bits starting at position c*j-1. */
+	if (j == 0) {
+		w = s->v[0] << 1;
+	} else {
+		pos = c * j - 1;
+		k = pos >> 5;
+		w = k < 8 ? s->v[k] >> (pos & 31) : 0;
+		if ((pos & 31) + c + 1 > 32 && k + 1 < 8) {
+			w |= s->v[k + 1] << (32 - (pos & 31));
+		}
+	}
+	w &= ((uint32_t)2 << c) - 1;
+	return (int)((w >> 1) + (w & 1)) - (int)((w >> c) << c);
+}
+
+/*
+ * Pippenger with c-bit signed digits (MSM_MIN_BITS <= c <= MSM_MAX_BITS).
+ */
+static void
+point_msm_pippenger_vartime(point *p2,
+	const point *pp, const scalar *ss, size_t n, unsigned c)
+{
+	point bk[1 << (MSM_MAX_BITS - 1)];
+	uint8_t bk_used[1 << (MSM_MAX_BITS - 1)];
+	unsigned num_bk, num_dig;
+	int zz;
+
+	num_bk = 1u << (c - 1);
+	num_dig = (256 + c - 1) / c;
+	zz = 1;
+	for (unsigned j = num_dig; j -- > 0;) {
+		point sum, acc;
+		int sz, az;
+
+		/* Fill the buckets for this digit position. */
+		memset(bk_used, 0, num_bk);
+		for (size_t i = 0; i < n; i ++) {
+			int d = scalar_booth_digit(&ss[i], c, j);
+			point *b;
+
+			if (d == 0) {
+				continue;
+			}
+			b = &bk[(d < 0 ? -d : d) - 1];
+			if (!bk_used[(d < 0 ? -d : d) - 1]) {
+				bk_used[(d < 0 ? -d : d) - 1] = 1;
+				if (d > 0) {
+					*b = pp[i];
+				} else {
+					point_neg(b, &pp[i]);
+				}
+			} else if (d > 0) {
+				point_add(b, b, &pp[i]);
+			} else {
+				point_sub(b, b, &pp[i]);
+			}
+		}
+
+		/*
+		 * acc = \sum_b (b+1)*bk[b], computed as the sum of the
+		 * running sums from the top bucket.
+		 */
+		sz = 1;
+		az = 1;
+		for (unsigned b = num_bk; b -- > 0;) {
+			if (bk_used[b]) {
+				if (sz) {
+					sz = 0;
+					sum = bk[b];
+				} else {
+					point_add(&sum, &sum, &bk[b]);
+				}
+			}
+			if (!sz) {
+				if (az) {
+					az = 0;
+					acc = sum;
+				} else {
+					point_add(&acc, &acc, &sum);
+				}
+			}
+		}
+
+		if (zz) {
+			if (!az) {
+				zz = 0;
+				*p2 = acc;
+			}
+		} else {
+			point_xdouble(p2, p2, c);
+			if (!az) {
+				point_add(p2, p2, &acc);
+			}
+		}
+	}
+	if (zz) {
+		*p2 = point_neutral;
+	}
+}
+
+static void
+point_msm_vartime(point *p2, const point *pp, const scalar *ss, size_t n)
+{
+	if (n >= MSM_PIPPENGER_MIN) {
+		/*
+		 * Choose the digit size that minimizes the number of
+		 * point additions: ceil(256/c)*(n + 2^c). For
+		 * n >= MSM_PIPPENGER_MIN, this is c = 5 up to n = 120,
+		 * 6 up to 330, 7 up to 691, and 8 beyond; smaller digits
+		 * never win.
+		 */
+		unsigned c = MSM_MIN_BITS;
+		uint64_t best = (uint64_t)-1;
+		for (unsigned t = MSM_MIN_BITS; t <= MSM_MAX_BITS; t ++) {
+			uint64_t cost = (uint64_t)((256 + t - 1) / t)
+				* ((uint64_t)n + ((uint64_t)1 << t));
+			if (cost < best) {
+				best = cost;
+				c = t;
+			}
+		}
+		point_msm_pippenger_vartime(p2, pp, ss, n, c);
+		return;
+	}
+
+	if (n == 0) {
+		*p2 = point_neutral;
+		return;
+	}
+	for (size_t i = 0; i < n; i += MSM_STRAUS_CHUNK) {
+		size_t m = n - i;
+		if (m > MSM_STRAUS_CHUNK) {
+			m = MSM_STRAUS_CHUNK;
+		}
+		point_msm_straus_vartime(p2, i == 0, pp + i, ss + i, m);
+	}
+}
+
+/*
+ * Add or subtract a point from a wNAF window, in affine coordinates.
+ * Input:
+ *   win[i] = (2*i+1)*P
+ *   e is odd, -15 <= e <= +15, or e == 0
+ * Output:
+ *   P2 <- P2 + e*P
+ */
+static inline void
+point_add_affine_wNAF(point *p2, const point_affine *win, int e)
+{
+	if (e > 0) {
+		point_add_affine(p2, p2, &win[e >> 1]);
+	} else if (e < 0) {
+		point_sub_affine(p2, p2, &win[(-e) >> 1]);
+	}
+}
+
+/*
+ * Build the expanded wNAF windows for a point P1, used with
+ * point_mul128_add_mulgen_expanded_vartime():
+ *   win[i]     = (2*i+1)*P1
+ *   win[i + 8] = (2*i+1)*(2^65)*P1
+ * for i = 0 to 7. All points are normalized to affine coordinates.
+ */
+static void
+point_make_expanded_window(point_affine *win, const point *p1)
+{
+	point tt[16], p2;
+
+	for (int j = 0; j < 16; j += 8) {
+		if (j == 0) {
+			tt[0] = *p1;
+		} else {
+			point_xdouble(&tt[8], p1, 65);
+		}
+		point_double(&p2, &tt[j]);
+		for (int i = 1; i < 8; i ++) {
+			point_add(&tt[j + i], &tt[j + i - 1], &p2);
+		}
+	}
+	point_to_affine_batch(win, tt, 16);
+}
+
+/*
+ * Signature verification helper with an expanded window for the point
+ * P (see point_make_expanded_window()): given 128-bit integer `u`
+ * (expressed over 4 limbs), and scalar `v`, compute:
+ * P2 <- v*G - u*P
+ * Both u and v are split into chunks of 65 bits (two chunks for u,
+ * four for v, using the 2^65, 2^130 and 2^195 base point windows), so
+ * that only 64 doublings are needed, instead of 129 with
+ * point_mul128_add_mulgen_vartime(). All additions use affine points.
+ * THIS FUNCTION IS NOT CONSTANT-TIME. It is assumed that it will be used
+ * in signature verification, and that signature verification uses only
+ * public data.
+ */
+static void
+point_mul128_add_mulgen_expanded_vartime(point *p2,
+	const point_affine *win, uint32_t *u, const scalar *v)
+{
+	const base_tables *bt = base_tables_get();
+	int8_t sdu[130], sdv[256];
+
+	/*
+	 * Recode u and v into wNAF.
+	 */
+	uint_recode_wNAF(sdu, 130, u, 4);
+	scalar_recode_wNAF(sdv, v);
+
+	/*
+	 * zz = 1 when the accumulator is still the neutral, 0 afterwards.
+	 * ndbl is the number of pending doublings.
+	 */
+	STATS_BEGIN(st);
+	int zz = 1;
+	unsigned ndbl = 0;
+	for (int i = 64; i >= 0; i --) {
+		/* Schedule one more doubling. */
+		ndbl ++;
+
+		/* Get next digits; if all are zeros, then skip to the
+		   next iteration. Digits of u are negated since we
+		   subtract u*P. */
+		int eu0 = -sdu[i];
+		int eu1 = -sdu[i + 65];
+		int ev0 = sdv[i];
+		int ev1 = sdv[i + 65];
+		int ev2 = sdv[i + 130];
+		int ev3 = i < 61 ? sdv[i + 195] : 0;
+		if ((eu0 | eu1 | ev0 | ev1 | ev2 | ev3) == 0) {
+			continue;
+		}
+
+		/* Apply pending doublings. */
+		if (zz) {
+			zz = 0;
+			*p2 = point_neutral;
+		} else {
+			point_xdouble(p2, p2, ndbl);
+		}
+		ndbl = 0;
+
+		/* Process digits. The base point windows contain all
+		   multiples (not only the odd ones). */
+		point_add_affine_wNAF(p2, win, eu0);
+		point_add_affine_wNAF(p2, win + 8, eu1);
+		if (ev0 != 0) {
+			if (ev0 > 0) {
+				point_add_affine(p2, p2,
+					&bt->base[ev0 - 1]);
+			} else {
+				point_sub_affine(p2, p2,
+					&bt->base[-ev0 - 1]);
+			}
+		}
+		if (ev1 != 0) {
+			if (ev1 > 0) {
+				point_add_affine(p2, p2,
+					&bt->base65[ev1 - 1]);
+			} else {
+				point_sub_affine(p2, p2,
+					&bt->base65[-ev1 - 1]);
+			}
+		}
+		if (ev2 != 0) {
+			if (ev2 > 0) {
+				point_add_affine(p2, p2,
+					&bt->base130[ev2 - 1]);
+			} else {
+				point_sub_affine(p2, p2,
+					&bt->base130[-ev2 - 1]);
+			}
+		}
+		if (ev3 != 0) {
+			if (ev3 > 0) {
+				point_add_affine(p2, p2,
+					&bt->base195[ev3 - 1]);
+			} else {
+				point_sub_affine(p2, p2,
+					&bt->base195[-ev3 - 1]);
+			}
+		}
+	}
+
+	if (zz) {
+		*p2 = point_neutral;
+	} else {
+		point_xdouble(p2, p2, ndbl);
+	}
+	STATS_END(st, JQ255_STAT_VERIFY_LOOP, 1);
+}
+
+/* ===================================================================== */
+/*
+ * SECTION 4: PRECOMPUTED POINT WINDOWS
+ *
+ * We store here some precomputed tables for multiples of the base point.
+ */
+
+#if defined JQ_PARAMS
+
+#if defined JQ_TABLES
+#include JQ_TABLES
+#else
+/*
+ * Without JQ_TABLES, each window contains only the generator (JQ_GEN,
+ * affine extended format), and the other entries are zero. This is
+ * used only to build mkmulgen, which computes the actual windows from
+ * the generator; point multiplications do not work in that mode.
+ */
+static const point_affine point_win_base[16] = { { JQ_GEN } };
+static const point_affine point_win_base65[16] = { { JQ_GEN } };
+static const point_affine point_win_base130[16] = { { JQ_GEN } };
+static const point_affine point_win_base195[16] = { { JQ_GEN } };
+#endif
+
+#elif JQ == JQ255E
+
+/* Points i*G for i = 1 to 16, affine extended format */
+static const point_affine point_win_base[] = {
+	/* G * 1 */
+	{ LGF(0x00000003, 0x00000000, 0x00000000, 0x00000000,
+	      0x00000000, 0x00000000, 0x00000000, 0x00000000),
+	  LGF(0x00000001, 0x00000000, 0x00000000, 0x00000000,
+	      0x00000000, 0x00000000, 0x00000000, 0x00000000),
+	  LGF(0x00000001, 0x00000000, 0x00000000, 0x00000000,
+	      0x00000000, 0x00000000, 0x00000000, 0x00000000) },
+	/* G * 2 */
+	{ LGF(0xD6342FD1, 0xD0FAC687, 0xEB1A1F58, 0x687D6343,
+	      0xF58D0FAC, 0x343EB1A1, 0xFAC687D6, 0x1A1F58D0),
+	  LGF(0xDB6D97A3, 0xB6DB6DB6, 0x6DB6DB6D, 0xDB6DB6DB,
+	      0xB6DB6DB6, 0x6DB6DB6D, 0xDB6DB6DB, 0x36DB6DB6),
+	  LGF(0x97827791, 0x0A72F053, 0xCBC14E5E, 0x05397829,
+	      0xE5E0A72F, 0x829CBC14, 0x72F05397, 0x414E5E0A) },
+	/* G * 3 */
+	{ LGF(0xD61A9E2F, 0x26AFA803, 0x7F0E7D48, 0xAD827302,
+	      0xBA270925, 0x4D5065C0, 0xDB3919FD, 0x6E6BA44D),
+	  LGF(0xC4043E79, 0xC2F21347, 0x066D4156, 0x6B1CEBA6,
+	      0xA3E20224, 0xAB617909, 0xD30336A0, 0x12358E75),
+	  LGF(0x2BDDB3C7, 0xC4FAF544, 0xF0485A50, 0xC58EF652,
+	      0x71E284EF, 0x0509961D, 0xDC59141C, 0x7287BBB2) },
+	/* G * 4 */
+	{ LGF(0xF8390C16, 0xBCE7BEB9, 0xE825BA04, 0xCBFF478E,
+	      0x95BDA924, 0x96E4BB9C, 0x9561D944, 0x0F137176),
+	  LGF(0x130DB4AD, 0x65A29F71, 0xFA47C8BB, 0x9F71130D,
+	      0xC8BB65A2, 0x130DFA47, 0x65A29F71, 0x7A47C8BB),
+	  LGF(0x4402088D, 0x4D0A213B, 0xF44E59F2, 0x853223D7,
+	      0x2101F311, 0x03ADCBE2, 0x9918E929, 0x2375E811) },
+	/* G * 5 */
+	{ LGF(0xE875C86A, 0xD23D2C8B, 0x73C41197, 0x1BD81557,
+	      0xBCDB09C0, 0x74304444, 0x980D6493, 0x3A3E1251),
+	  LGF(0xDA5B43EE, 0x1F2B6B08, 0xC44A0C63, 0xE40F8B8B,
+	      0xB35FB70C, 0x5866F1F8, 0x50F768D7, 0x185034D2),
+	  LGF(0x3D361051, 0xC9192749, 0xC1C66FF4, 0xE00C1E20,
+	      0x724B43CC, 0x8982206A, 0xBB5DF4DA, 0x3E3560E7) },
+	/* G * 6 */
+	{ LGF(0x229AD5F2, 0x643AD390, 0x07471E77, 0xC7120748,
+	      0x6A6D2E2A, 0x1673C5B9, 0x5844C804, 0x124FA9DF),
+	  LGF(0xF91D6B18, 0x0BD0C5F1, 0x263610A7, 0xBB4A410D,
+	      0x98F35F00, 0xA1AB0B9D, 0xAFDDC92B, 0x4FA6D8B6),
+	  LGF(0xAEB11ACD, 0x355D1614, 0xAEE9D26F, 0x76ED99CC,
+	      0xE94A460E, 0xD7991971, 0xDA88753E, 0x34F3562F) },
+	/* G * 7 */
+	{ LGF(0x678229FB, 0xE8D6CBC7, 0x232C88D0, 0xD86308C5,
+	      0x4BFC77E7, 0xC36F6969, 0x82AAF7AC, 0x4C5C3FA3),
+	  LGF(0x159EF4EA, 0x7EB52414, 0xEB4CC9E1, 0xB885C9D1,
+	      0xEE64BF7F, 0x350914B3, 0x520AED5A, 0x6DD8CDFA),
+	  LGF(0x34C75544, 0x59DAD0E6, 0x0C2A0899, 0x818C7393,
+	      0x60AC1520, 0x0957AB7A, 0x0A217C1C, 0x56861F4D) },
+	/* G * 8 */
+	{ LGF(0x53187B28, 0x4E11C113, 0x515E9113, 0xAD881FFB,
+	      0x2FD5BA49, 0x86AD97E4, 0xB2A6146C, 0x2C922B2C),
+	  LGF(0xEB513A8B, 0x99DA8C93, 0x5DEDFC87, 0x0706B8B9,
+	      0x1F778CE9, 0xC54D8F47, 0xFA2E63E5, 0x4766315B),
+	  LGF(0x39729F9A, 0x4D9B8F56, 0x8B0077A8, 0x89B68A9C,
+	      0xFCA311FD, 0xF3C520B8, 0xB811270A, 0x532698BC) },
+	/* G * 9 */
+	{ LGF(0xB52FBCC4, 0x6FB66DF6, 0x38AA1784, 0x675E5BCC,
+	      0x852C1B0B, 0x55B6D3E8, 0xFA293050, 0x2289F3AB),
+	  LGF(0xD0A08E61, 0xA84A27A9, 0x132CCAC1, 0x27E9084D,
+	      0x01F68C40, 0x498C7D8B, 0x940E4159, 0x6957FDFF),
+	  LGF(0x815F2EFF, 0x8D2F2DE6, 0x88C812F9, 0x76CA668F,
+	      0x32B42796, 0x56244B8A, 0x72CB2D3C, 0x431DA1A6) },
+	/* G * 10 */
+	{ LGF(0xACC048BE, 0x8EB44683, 0xAAD5CD46, 0x803FC1C6,
+	      0x0762C505, 0xAF553973, 0x61B06E3A, 0x30290CF9),
+	  LGF(0xB889903E, 0x3AA366BB, 0xCC140A37, 0x55838146,
+	      0xA9B6AD5E, 0x4AA37581, 0x916F803C, 0x7B37113C),
+	  LGF(0xE1C6283E, 0xD912EBC4, 0x8AE5C163, 0xC70EAC51,
+	      0xE828C438, 0x9EDDA370, 0x189ECFD9, 0x252DC97C) },
+	/* G * 11 */
+	{ LGF(0x99D93A3B, 0x38A7E995, 0xA3919A65, 0x09DF0EB0,
+	      0xF643AF23, 0x6F385F29, 0x2424A548, 0x467C84CA),
+	  LGF(0x864E7F82, 0xA9A8911D, 0xAB741725, 0x65CF6B9C,
+	      0xE772B327, 0x8C133221, 0x8CD1F209, 0x15852107),
+	  LGF(0x8F92D685, 0x41583C9A, 0x53E938EB, 0xFAE4DC55,
+	      0x6C5406EA, 0xC3FC1F02, 0xBC1F036B, 0x5D4A07E9) },
+	/* G * 12 */
+	{ LGF(0x83BF7B93, 0xA49A13F8, 0x8DC7807E, 0x06E6D0CF,
+	      0x238DA4B1, 0x4B3B87C8, 0x5A9F7719, 0x66FF84AF),
+	  LGF(0x087640AA, 0xE4C1C725, 0x3EF5D5E0, 0xFB902D6A,
+	      0x2E1297EB, 0x53EF3593, 0xE1787343, 0x67E65CF7),
+	  LGF(0xFF9309B4, 0x4203ACE2, 0x8E506208, 0xAE5BB531,
+	      0x3DEB52CB, 0x4742F3CB, 0x3959DA85, 0x2213A3D9) },
+	/* G * 13 */
+	{ LGF(0x2ED04723, 0xA9962278, 0xB5D2A716, 0x22587604,
+	      0xFFB6AD2D, 0x3E7BB13D, 0x9D4C885B, 0x6E7036BE),
+	  LGF(0x81061965, 0x90F88398, 0xF2BFCB98, 0x67D0394F,
+	      0xCD1396D8, 0x913200FC, 0x306A3580, 0x17F96D76),
+	  LGF(0x4099DC93, 0xF1F0EC98, 0xE43361F5, 0xE02396E9,
+	      0xAB0AE384, 0x028EBB02, 0x2DB22F61, 0x0E236467) },
+	/* G * 14 */
+	{ LGF(0x0F2521F0, 0xC6C60BB3, 0x5CB6D116, 0xA59973DD,
+	      0x706DD30D, 0x069708CC, 0xF8A08989, 0x74C367AB),
+	  LGF(0xD2AC4172, 0x05B49673, 0x0D77E4E6, 0xA016A689,
+	      0x0635E1C0, 0x7C6DAA97, 0x47A6A04A, 0x42C80345),
+	  LGF(0x75DEF4DC, 0x0266FAA8, 0x05C5A659, 0x41B211E5,
+	      0x39E5E234, 0xE13C4A76, 0xE6AF9B7D, 0x0C4AC28D) },
+	/* G * 15 */
+	{ LGF(0xE86224A7, 0x543AA085, 0x9EA21055, 0x626226C0,
+	      0xEE7E01D9, 0x257B5FE5, 0x82C497CD, 0x1110D927),
+	  LGF(0x19120727, 0x7FFA4AF7, 0x1BF74984, 0x705D1257,
+	      0x9FAE1F07, 0x4AD1FA64, 0x265D7456, 0x2F4CA2B6),
+	  LGF(0xF7C6525E, 0xB111F1B5, 0xC1B29AC7, 0x54BD0CFF,
+	      0x7009957D, 0xCC7CCE32, 0x0D563132, 0x0CCF7FF0) },
+	/* G * 16 */
+	{ LGF(0x24F31B2E, 0x97DA44A0, 0xDB5120DD, 0xF8FAE043,
+	      0xD7F5F415, 0x03D9F770, 0xA296F053, 0x676824C9),
+	  LGF(0xE1227049, 0x2D808316, 0x32683177, 0x15064C91,
+	      0x41E90ED8, 0x706D8A1F, 0x1A6DB76E, 0x251A1931),
+	  LGF(0x9E05F91A, 0x95191DCA, 0x0C6EE0A8, 0x0DB49CC1,
+	      0x7BF95128, 0x7C16D8FF, 0xB15D04AE, 0x2C8D5EC4) }
+};
+
+/* Points i*(2^65)*G for i = 1 to 16, affine extended format */
+static const point_affine point_win_base65[] = {
+	/* (2^65)*G * 1 */
+	{ LGF(0x8E08211F, 0x886FF627, 0xF94734AB, 0x4629856E,
+	      0xB41DD08C, 0xAB3BAC1A, 0x634A53B5, 0x6CE0B77B),
+	  LGF(0xC596FA71, 0xAD5F8FBF, 0x9DE223FF, 0x41589354,
+	      0xE50A4384, 0x395D2181, 0xA8A7626E, 0x1B313D36),
+	  LGF(0xEB9D832B, 0x17E71DD1, 0xD599D9CB, 0x222B7C0C,
+	      0xFF13EC0E, 0x48E8393C, 0x21A5AAD2, 0x6E78594A) },
+	/* (2^65)*G * 2 */
+	{ LGF(0x2716A209, 0x111922C7, 0x3417B3E6, 0xE4584C1E,
+	      0xCE6C2582, 0x8AA629F4, 0x8DD93292, 0x7521310F),
+	  LGF(0x889E3F33, 0x2B7C2F71, 0xA5E65CF4, 0x4CA4C049,
+	      0x9976BFE7, 0x5CD27D90, 0x9985D602, 0x0BE56F35),
+	  LGF(0x1BE2027B, 0xC699D8CD, 0x19ECC70E, 0xC9233D82,
+	      0xABAECD17, 0x6C805A5D, 0x6985620E, 0x40534B30) },
+	/* (2^65)*G * 3 */
+	{ LGF(0xD6A45A0E, 0x33F6746E, 0xCDA92791, 0x5A40972F,
+	      0x6C9CC38D, 0x7B11CD4B, 0x8D0885BF, 0x390940AD),
+	  LGF(0xED61CB7F, 0x4A504A5D, 0x42D7801D, 0xAF415083,
+	      0xAB4295EB, 0x0519A68A, 0x0B09C2B4, 0x098D3AB9),
+	  LGF(0x59A456C6, 0xA06F9DAD, 0x3FFE78C9, 0x92D53426,
+	      0x45C181DE, 0x0696A395, 0x7B5F6FD7, 0x41A59092) },
+	/* (2^65)*G * 4 */
+	{ LGF(0x32A76153, 0x6C4E581C, 0xD6E7A570, 0xEADD9BBE,
+	      0xC0DF4A3B, 0xBD9A0206, 0xFA934AC1, 0x10D60536),
+	  LGF(0x81B4D89F, 0xD98BB32E, 0xE1067F08, 0x5A0FCD3A,
+	      0xAFAD3191, 0x3B845EF3, 0xAA6E2C23, 0x3540EB32),
+	  LGF(0xA76336E1, 0x1D5909B1, 0x47CE6A39, 0x4563C7AD,
+	      0xA3CB3C98, 0x893FFC0C, 0x11381CFF, 0x6470D110) },
+	/* (2^65)*G * 5 */
+	{ LGF(0x8591C275, 0x648443E4, 0x18227B9E, 0x74427A88,
+	      0x6E87C51E, 0x9AE9B073, 0xB9985165, 0x742236A2),
+	  LGF(0xD80EB7AB, 0xDB2EB15D, 0x633AC0BB, 0x695C5863,
+	      0x5FB45810, 0x9DD36D92, 0x374E74CB, 0x4B36B3BE),
+	  LGF(0x97F19A1B, 0x3B020304, 0xCBC99BC3, 0xBCF6E190,
+	      0x3280BAD3, 0x52217A6F, 0x685E3293, 0x7563AAD0) },
+	/* (2^65)*G * 6 */
+	{ LGF(0x0C14DC83, 0xD8AD585D, 0xD6669E2A, 0x748A8C77,
+	      0x6BC1A5D5, 0x9318569D, 0x42C4587D, 0x637BA56A),
+	  LGF(0x1425C001, 0x2473D6DB, 0x6E58108F, 0x76306718,
+	      0xF6ED32DE, 0x0C0776C9, 0x90ACB085, 0x143CF8A0),
+	  LGF(0x05579C38, 0x73CDF9E5, 0x9040AF87, 0xDE3B04BA,
+	      0x8418DD26, 0x3A3345F9, 0xCC1F09C1, 0x2C301B6B) },
+	/* (2^65)*G * 7 */
+	{ LGF(0x9D051B56, 0xE14526AA, 0x8273B21D, 0x0E16666D,
+	      0x6F56FA43, 0x1094A46B, 0x96A1BB91, 0x5C780EAA),
+	  LGF(0x27D26209, 0xE95E2181, 0xE8FB612B, 0x33088969,
+	      0xF2BF788C, 0xBAC06821, 0xD61C83DD, 0x7EE7B8C1),
+	  LGF(0x1F3502A9, 0x0474E697, 0x5FA59240, 0x624FFDB3,
+	      0xA1A25303, 0x617E1C89, 0x16C33383, 0x72AB912B) },
+	/* (2^65)*G * 8 */
+	{ LGF(0xD67CC3ED, 0xE800A094, 0xF26076D9, 0xD6C684ED,
+	      0x17DD5343, 0xE95C514D, 0x473732FF, 0x6B3865BE),
+	  LGF(0x01944CB8, 0x4C033B23, 0xA5D337CB, 0x3260DA08,
+	      0xA6C39FFC, 0x34DFEFB2, 0x9B5B142E, 0x23587229),
+	  LGF(0xD04090FB, 0x439324FC, 0x6FC23C15, 0x08AA0426,
+	      0xBBFAA0EE, 0x7B1EF0DE, 0xE34C35A1, 0x2961CB37) },
+	/* (2^65)*G * 9 */
+	{ LGF(0xA19EF549, 0xE7847250, 0x94B8F6C1, 0xDD56EA48,
+	      0x9C0105B4, 0xF8815AEC, 0x916B15C7, 0x32138C48),
+	  LGF(0x6086DF92, 0x6742B67C, 0x8D75331F, 0x53193A71,
+	      0xCA14E352, 0xADD356D1, 0xD7C9E88D, 0x07DF0CC5),
+	  LGF(0xB8594D9B, 0x5C9C41C3, 0xE6FADF0D, 0x643500CD,
+	      0x03003B68, 0x0D31937E, 0x3766078D, 0x713B783B) },
+	/* (2^65)*G * 10 */
+	{ LGF(0xB299A5D0, 0x25F90BCE, 0x24E25FBE, 0x4FD5981D,
+	      0xBEFEC84E, 0x83A3CE92, 0x6A90B198, 0x5C932978),
+	  LGF(0x51C4DF08, 0x7982C540, 0xEBBFE2BB, 0x476A1D01,
+	      0x7E287D25, 0x3F6064CC, 0x0C17C457, 0x79E82E42),
+	  LGF(0xE8B54114, 0x8CE01EA2, 0xE2EF99F8, 0x73165189,
+	      0x7B6F0AD1, 0x27984BF8, 0x70DAFA38, 0x1813C6ED) },
+	/* (2^65)*G * 11 */
+	{ LGF(0x0884167D, 0x7CAD3302, 0xCDDA791E, 0x383BFB84,
+	      0x16879C64, 0x8D0D667D, 0xAEAFD937, 0x4515BBA1),
+	  LGF(0x13403E58, 0x00FF1286, 0x2D02F041, 0x854CBABF,
+	      0x65593890, 0xB97069DD, 0x68B5A376, 0x3CC8BC31),
+	  LGF(0xF65D98BA, 0xC303EBB8, 0x5BEF4381, 0xF8F2F98E,
+	      0x9FE2783E, 0x206DA25D, 0xD462C39D, 0x058DA5FE) },
+	/* (2^65)*G * 12 */
+	{ LGF(0x7FDDE52D, 0x7118E357, 0x6D616E5E, 0x4F20F40E,
+	      0x4D7E5167, 0x68592F91, 0xD95C2805, 0x3E658213),
+	  LGF(0x6588D284, 0x3688782C, 0x163B51DB, 0xA50B5985,
+	      0xF7311FA5, 0x23447D42, 0x5B751D79, 0x51CBB2B6),
+	  LGF(0xEB5BEC17, 0x877FB541, 0xD77A0305, 0xDC1EF290,
+	      0x43025B6A, 0x15EB451E, 0x0CB85A8A, 0x60570F44) },
+	/* (2^65)*G * 13 */
+	{ LGF(0x45295FBE, 0xBF9758CD, 0xBE8D1017, 0x0DAC5E2E,
+	      0x89E728B3, 0x3CA545A9, 0x1F644B88, 0x40255DC8),
+	  LGF(0x7A9FAA68, 0x6AF277E6, 0x9009703F, 0xFDEE555C,
+	      0x8D5B502A, 0xAA36C89F, 0xAFC87131, 0x052051ED),
+	  LGF(0x86AAB04C, 0xDED77C44, 0x9AA3A8E1, 0x9B85D45C,
+	      0xC4F2C4BA, 0x0F6D233D, 0x319D2237, 0x50C64067) },
+	/* (2^65)*G * 14 */
+	{ LGF(0x4910DE30, 0x13D6BB10, 0x76848E4E, 0x52126D43,
+	      0x0130A4FF, 0x8E7CF5FB, 0xF7F8E0F4, 0x631EFE8E),
+	  LGF(0x08EB56DD, 0x86A494FC, 0xD62219A0, 0xF694DF6E,
+	      0x22098B86, 0x214282B0, 0xA95620EB, 0x7182E92F),
+	  LGF(0xF4D51B6A, 0x8A96C7C2, 0xFBF79614, 0x6E06A2EF,
+	      0x36FFDEC3, 0x2F8383D0, 0x275A04FE, 0x136A3753) },
+	/* (2^65)*G * 15 */
+	{ LGF(0x2F78D8DC, 0x71477471, 0x2A4254F0, 0x533027C6,
+	      0x8C3DB802, 0xBF13A51C, 0xA671868A, 0x09C0518D),
+	  LGF(0xE71417FD, 0xD25E4076, 0xD617E037, 0xAE53B9A6,
+	      0xBB08D620, 0xEDF6131A, 0x7206C6C4, 0x406E8857),
+	  LGF(0xE5261DBE, 0xA7B19AB7, 0x93780470, 0x5FD69501,
+	      0xD3DDA8C2, 0x69CB583F, 0x106BD4A6, 0x7A35DA9A) },
+	/* (2^65)*G * 16 */
+	{ LGF(0x3E152D96, 0xB7E60EBD, 0x3CBC9CE8, 0x16B77AD0,
+	      0xA8F300F7, 0xA8D3D5EB, 0x6203938C, 0x0DA857B8),
+	  LGF(0xD0781C73, 0x7D37BBB6, 0x82DAF6AB, 0x1ADF4CFE,
+	      0xDFBA601C, 0x6CB90D1D, 0x3C090D35, 0x7B916A82),
+	  LGF(0x1875E47C, 0xFE1CAB3D, 0xE298321B, 0x75D85076,
+	      0x623721E5, 0xAA62937A, 0xE382EC23, 0x78BE6830) }
+};
+
+/* Points i*(2^130)*G for i = 1 to 16, affine extended format */
+static const point_affine point_win_base130[] = {
+	/* (2^130)*G * 1 */
+	{ LGF(0xDE63606E, 0x869B548F, 0x9BE27159, 0x04DA93AE,
+	      0xBC2E0657, 0x9FBB8D6B, 0x0E47A525, 0x06CB9DE7),
+	  LGF(0xCAF58BCB, 0x6A6F8767, 0xCD520CD9, 0xEF9A2E5A,
+	      0xEE40437C, 0x2B998E19, 0xF3E02AB1, 0x1E3A7692),
+	  LGF(0xC50BD952, 0x12DCF83E, 0x82CB44C6, 0xC1FEC4C7,
+	      0x2158E8D4, 0x2FCDD9E7, 0x46FAC0AE, 0x6383719F) },
+	/* (2^130)*G * 2 */
+	{ LGF(0x3D54F276, 0xB08E5A16, 0xADF1CAD3, 0x137941C5,
+	      0x1B6AA715, 0xE12975DE, 0xE1492E65, 0x69E07759),
+	  LGF(0xC28259E8, 0x97643EA7, 0xA0416456, 0x64C33BBE,
+	      0xAFFFBCEB, 0xAC5EBA85, 0x8936CEEA, 0x1DE0359F),
+	  LGF(0x1879EA59, 0xF32ACE06, 0xAB9427B0, 0xC8A5F632,
+	      0xE081587F, 0xF83CBCAC, 0x87D69006, 0x3A18C765) },
+	/* (2^130)*G * 3 */
+	{ LGF(0x8C9DC498, 0xA6954493, 0x73152188, 0x9225D9C9,
+	      0x85C3FC53, 0x7A630559, 0xA431B60A, 0x7F9D9B87),
+	  LGF(0x185A63C2, 0x4A8F6858, 0x105E6338, 0xC29D0227,
+	      0x57313D72, 0x4FA122A3, 0x3C842009, 0x62BAF3EF),
+	  LGF(0x7B30E0BC, 0x18390845, 0x76EF453F, 0x799295C3,
+	      0xAF33DE83, 0xC5FE42DE, 0x628B654A, 0x54C34BDF) },
+	/* (2^130)*G * 4 */
+	{ LGF(0xEC32F903, 0x607C64DA, 0xA9BA461C, 0x8777F23B,
+	      0x92C3BE8D, 0x6E7804AC, 0x5F951D11, 0x180B366A),
+	  LGF(0xFFC35397, 0x17625F88, 0xDA783099, 0xEF697901,
+	      0xEF458EDC, 0xDCCCD3E1, 0xCFBBEDE2, 0x37EDC360),
+	  LGF(0xA0B94FB0, 0x5F7FC0E7, 0x38D69625, 0x3E9CC116,
+	      0x720B072F, 0x62C64632, 0x5D836913, 0x51589183) },
+	/* (2^130)*G * 5 */
+	{ LGF(0xCEA3BDDC, 0xB5DA3AAF, 0xAE7AD735, 0x75DE8E82,
+	      0x5446291A, 0xA458CD16, 0x5A7FF671, 0x552022F7),
+	  LGF(0xE9EC95DF, 0x055D6CCD, 0xDFCADBF5, 0xEB86F24A,
+	      0x9F7AE17C, 0x6DDAC4AB, 0x09ADD692, 0x282E2094),
+	  LGF(0x6B02F394, 0x60BA3A7F, 0x387EA15D, 0x5AF736BE,
+	      0x3EC38691, 0x541CE0C5, 0x32FB79E4, 0x775F5966) },
+	/* (2^130)*G * 6 */
+	{ LGF(0xD222B565, 0x7C2346E4, 0x258AEB93, 0xA45999A2,
+	      0x64D273CD, 0x66ECF438, 0xB5A5952D, 0x5EF32CC1),
+	  LGF(0xDCAD7528, 0xBA9DA77E, 0x892C93FF, 0xB6FA24A8,
+	      0xFA1ACD6B, 0xF406AD1F, 0x131E195C, 0x7E4F46D5),
+	  LGF(0xEA698452, 0x85A61A2D, 0xB9C3F150, 0xEB5AD1F6,
+	      0x89B1BA23, 0xA68B3F01, 0xCA2FEDC4, 0x3306A93B) },
+	/* (2^130)*G * 7 */
+	{ LGF(0x988BD912, 0x70FD1203, 0x5FC76584, 0xE9BDF6AD,
+	      0xDB704F5D, 0x5E05B4C4, 0x189FDCFE, 0x4830813F),
+	  LGF(0xEBEF1413, 0x9E343B6F, 0xB7F95D67, 0xC1293137,
+	      0x05CA0B5B, 0x6FB5672D, 0x2AEC172D, 0x37223948),
+	  LGF(0x28A8DD36, 0xEDC0FD96, 0x89BAA4F4, 0xF796A60E,
+	      0xCF12747E, 0x21A50BBD, 0xCED8D90B, 0x35266C9A) },
+	/* (2^130)*G * 8 */
+	{ LGF(0xD1F7E9CE, 0x68EE4317, 0xC8731082, 0x27214239,
+	      0x24ED9795, 0x5D86EBC5, 0x4D486C20, 0x303B08CF),
+	  LGF(0xEA446499, 0x21232B19, 0xEDDC580B, 0x0F110F3B,
+	      0x7F928B59, 0x7BFEE516, 0xC48289F4, 0x4E1CF6CC),
+	  LGF(0x04969A8C, 0x1768F10E, 0x60B519A9, 0x0834BAF8,
+	      0xCEC7737D, 0x94AAE19E, 0xB5360B34, 0x1DFD019E) },
+	/* (2^130)*G * 9 */
+	{ LGF(0x454A9789, 0xFA3E5E1F, 0xCE8DDF8F, 0x9259F250,
+	      0x2FBB9A1B, 0x2830FF4E, 0xF57EA2FC, 0x4262554C),
+	  LGF(0xA28FF940, 0xFFFA0532, 0xE791A9D0, 0x06134380,
+	      0x934E696A, 0x24120A75, 0x2C83BC57, 0x6F671B02),
+	  LGF(0x9180368F, 0x0BE5ED63, 0xF6E447C2, 0xBB03E3FD,
+	      0x83E29BB6, 0x4CA31E3B, 0x35166005, 0x03BBDFC6) },
+	/* (2^130)*G * 10 */
+	{ LGF(0xE93AA158, 0xE1B24ECC, 0x3202BCE6, 0xBC5D29A7,
+	      0xA4D753B1, 0x2970E4C0, 0x18E51DF5, 0x776F6C1C),
+	  LGF(0x3B071E37, 0x0EE1B500, 0x8D80BCA7, 0x3EC32044,
+	      0x5EC7534A, 0x108D5A1C, 0xEBA1A511, 0x64ECAAC0),
+	  LGF(0x1535C514, 0x10E50013, 0x6D74A32A, 0xD00F9D21,
+	      0xA13E6050, 0x8C125FB0, 0xA3AC991A, 0x4BC50BF7) },
+	/* (2^130)*G * 11 */
+	{ LGF(0x3EB40DBD, 0x10DC6E26, 0x1F4F95D8, 0x31DC4E88,
+	      0x5D45B50A, 0x2C33E16E, 0x2A3899E8, 0x3622E7BF),
+	  LGF(0xD4AB70A1, 0x6CC3477A, 0x712BA4D4, 0x0BC92225,
+	      0x4564D8F4, 0xD51C733D, 0x599B372A, 0x029CAFA5),
+	  LGF(0x6518ADF3, 0x3D63011A, 0x816D4B31, 0x84FD6E87,
+	      0x67CD8FA6, 0x396102BA, 0xE547B2AD, 0x30F0D235) },
+	/* (2^130)*G * 12 */
+	{ LGF(0x82E719F6, 0x54246632, 0x779DEFF8, 0xB3E38AE4,
+	      0x3EE0C99A, 0x3F2A874D, 0x8561373F, 0x70F7A39B),
+	  LGF(0xB7854025, 0xCB9E1D5C, 0xC064493E, 0x960067A5,
+	      0xA91ED717, 0x41F420B5, 0x7E661D8D, 0x6E81F9FA),
+	  LGF(0xD1B3FF89, 0x96737B3B, 0x8B260B44, 0xFA5B9975,
+	      0xD5EB0507, 0x4E40C5DC, 0xE37DDC45, 0x797141D1) },
+	/* (2^130)*G * 13 */
+	{ LGF(0xDE84F742, 0x3A2AA626, 0xE24C4D0F, 0xC52014D6,
+	      0x665947AC, 0x87620DD6, 0x38239FA8, 0x4489AC65),
+	  LGF(0xE489DDB8, 0x1A722773, 0x3D4AABD6, 0xF9498389,
+	      0xBB3DFDCC, 0x59F3D4C5, 0xD2801E6A, 0x653EE371),
+	  LGF(0x108032A6, 0xA14B344A, 0x99975786, 0x336E96DD,
+	      0x6ED6198C, 0x3AF72BF1, 0x23DFA5BC, 0x6E8DE137) },
+	/* (2^130)*G * 14 */
+	{ LGF(0x21EA7956, 0x5BDDDC01, 0xEE996605, 0x30C254D3,
+	      0xBE2A729B, 0xE23DA12D, 0xD7B177EE, 0x0698AEC8),
+	  LGF(0x09693F50, 0x460E164D, 0x44D22EC2, 0x96FABF77,
+	      0x595E868E, 0x216A1928, 0xAC402680, 0x50E1BEE9),
+	  LGF(0x5FE17CBC, 0x2EA3B442, 0x8227BB81, 0x3076D3BE,
+	      0x99779B03, 0x73999AF9, 0x287FBDD0, 0x52BC8B51) },
+	/* (2^130)*G * 15 */
+	{ LGF(0x33632097, 0x4DE169D2, 0x2711C087, 0x7269B654,
+	      0x544AC635, 0xC7562833, 0x09C7A4DA, 0x67C8ED8C),
+	  LGF(0x64C6EE61, 0x442C914C, 0xAA3D41CD, 0x5486463A,
+	      0x744FB271, 0x2323BA05, 0xB63D2983, 0x5CE94782),
+	  LGF(0x41CFEA05, 0x5E85E0F8, 0xC8449D15, 0xFE575987,
+	      0x40C3632A, 0x4B8F046B, 0xC85A090C, 0x79B75334) },
+	/* (2^130)*G * 16 */
+	{ LGF(0x45B50B50, 0xA1638BEC, 0x669E52E3, 0xB956B5A6,
+	      0x6F53165A, 0xAFF58E0E, 0xEDB8A088, 0x5F00BEB6),
+	  LGF(0x560BD063, 0x20DDE2D9, 0x9386B815, 0x68337F97,
+	      0xB5F9B94C, 0x9CAE33A6, 0x8B17674E, 0x0F2ED841),
+	  LGF(0x8690FF50, 0x42082E61, 0x5901899E, 0x3721E53E,
+	      0x342DE052, 0xBB88653D, 0xCF10FA1C, 0x2EED8F30) }
+};
+
+/* Points i*(2^195)*G for i = 1 to 16, affine extended format */
+static const point_affine point_win_base195[] = {
+	/* (2^195)*G * 1 */
+	{ LGF(0x2FD3D48B, 0x259381D5, 0xCA5B1805, 0x05A13379,
+	      0x83A60AC4, 0x4F9CCA64, 0x2FF7C515, 0x26FE2B2D),
+	  LGF(0x864B8022, 0xC6C4EA52, 0x27F2FE05, 0x3FACF030,
+	      0xAFE0F2B2, 0x5A78F8FD, 0x2117A352, 0x7A205868),
+	  LGF(0xF869915D, 0x827479FB, 0x2A0FAC70, 0xD2369B35,
+	      0xAA299C4A, 0x759EDBD5, 0x3C1C85C0, 0x6CF49CB7) },
+	/* (2^195)*G * 2 */
+	{ LGF(0xF6BA6D06, 0xBEA01D24, 0x8F9811D4, 0x2F4C099F,
+	      0x3EE54433, 0xFEFB9425, 0x3F986A71, 0x26E11FA3),
+	  LGF(0xFDCCE69F, 0xE7A9C455, 0x23C52866, 0xB043C24E,
+	      0x3179B032, 0xCBC1DD8A, 0x4E366C38, 0x597FE7EC),
+	  LGF(0x28BB5A33, 0xF41D8A29, 0xD79CEDB6, 0xB52F9C48,
+	      0x62DF9B38, 0x31EC395A, 0x2AECDB76, 0x5D82A362) },
+	/* (2^195)*G * 3 */
+	{ LGF(0x90F2D551, 0x9902C1E0, 0xA8811C74, 0xE3C20E9F,
+	      0xB83A88A9, 0x5D9FD304, 0x152AC3D0, 0x7A97A73E),
+	  LGF(0x782AD7E7, 0xEBF1C192, 0x0228990B, 0xDAC867CE,
+	      0x39C2A9BB, 0xB0C0AEB8, 0x2E3222F2, 0x5D529C2B),
+	  LGF(0x8F1AE0C2, 0xDF8E6392, 0x0BB45ACF, 0x8692B805,
+	      0xE7017825, 0x4CC66CF8, 0x70747870, 0x25F396E8) },
+	/* (2^195)*G * 4 */
+	{ LGF(0xD9017500, 0x825E9E80, 0xC34493C0, 0x532E7F73,
+	      0x55EB285B, 0x23A615DE, 0x6278C4C5, 0x68BEB6AD),
+	  LGF(0x050CE7CF, 0xE5AD1FDA, 0x398FE9E2, 0xD5179DCB,
+	      0xA2B23DE9, 0x880F0F9C, 0x7C583AB6, 0x73E9DA1D),
+	  LGF(0x161AD03A, 0x1BED8C4A, 0x631A3736, 0x56A385AC,
+	      0xE2FDED3F, 0x55CA5A73, 0x5751514B, 0x2F2A1084) },
+	/* (2^195)*G * 5 */
+	{ LGF(0xA10674B8, 0xEF721415, 0x520B23D9, 0x39A98FB9,
+	      0x3583A50F, 0xDD94B182, 0x359D5D64, 0x1A980F7E),
+	  LGF(0xCED00FE0, 0x81533FD0, 0x457375B0, 0x2B41B323,
+	      0x0B0B6412, 0x3428954D, 0x656FCDE7, 0x3FB05C6B),
+	  LGF(0xCD1FF35F, 0xD6A2CFBE, 0x3E59FA2B, 0x3EB933A6,
+	      0xD6CF146F, 0x0156D1B1, 0x53FBE8B0, 0x1FA8E207) },
+	/* (2^195)*G * 6 */
+	{ LGF(0x0A7FA85F, 0xC3201380, 0xA647E0CA, 0xCE6BBA92,
+	      0xC1969616, 0xD1328954, 0xD146C39F, 0x53505DC8),
+	  LGF(0xAA4DEFF3, 0xABECE8DE, 0x70FF8BED, 0xA6B25F53,
+	      0x8B95875D, 0xC70C1F01, 0x80019FB8, 0x1EEE7F43),
+	  LGF(0xCC1E0562, 0xCC3FC741, 0x42B13EF8, 0x93B664F2,
+	      0x16798EB4, 0x5D617DE8, 0x3CAC8CA8, 0x35C68ADE) },
+	/* (2^195)*G * 7 */
+	{ LGF(0x7745E14A, 0x293F3FD5, 0xEE207D6F, 0x023E52D8,
+	      0xA7918F82, 0xC95A3B2F, 0x3594BCCC, 0x203E41FE),
+	  LGF(0xCE5A6CD2, 0xC2513D53, 0x4C9ADB58, 0x8AF5B5BD,
+	      0x56292D78, 0xDF748C18, 0xC147EB47, 0x1C54D437),
+	  LGF(0xA5ABCB56, 0x02C3EA61, 0xBA7BA956, 0xB56CC897,
+	      0x80AA5525, 0xB8E346F8, 0x7F925E67, 0x791ECB5E) },
+	/* (2^195)*G * 8 */
+	{ LGF(0x67A86CB5, 0x9E436CB7, 0xF1F6D3FE, 0x9EAB45BE,
+	      0xE4A81FA1, 0xA2654498, 0xB7FBF10D, 0x5A50303B),
+	  LGF(0xA4853698, 0x961441BF, 0x425429D3, 0x76396E28,
+	      0x49399AB4, 0x23187D9C, 0x1C754A72, 0x47EC8934),
+	  LGF(0x6AF04917, 0xB5B36F77, 0x8CDEC91B, 0x4E7E5985,
+	      0x56A70427, 0x47DBD9D7, 0xB2E0E163, 0x00D090A5) },
+	/* (2^195)*G * 9 */
+	{ LGF(0x3B6C3E84, 0x1390F65E, 0xE8EDE015, 0xD1492FB1,
+	      0xF4D52DD6, 0x3ADC11E0, 0x1EF8D7C0, 0x4E1EFB69),
+	  LGF(0x56DA5EBB, 0x790DDCB6, 0x8A6C1157, 0x899CA30F,
+	      0xE160FF52, 0xB055E943, 0xE97A3F02, 0x0C4E4B67),
+	  LGF(0x421C783F, 0xE665E42E, 0x6D8BF1FD, 0x90F6162E,
+	      0x5667BD29, 0x0E7DEA66, 0xBCA04267, 0x5C4551BB) },
+	/* (2^195)*G * 10 */
+	{ LGF(0x76E757EA, 0x28CA2A1B, 0xB218D2B4, 0x82E93F7D,
+	      0x5317BE46, 0x433AC8B1, 0xBEFBB5CF, 0x0BBAE0E5),
+	  LGF(0x04D1F6B9, 0x7CBAD6A2, 0x999A4399, 0xEB725D50,
+	      0x104B0670, 0x7C80807D, 0x5DF07889, 0x44B8942C),
+	  LGF(0x6D315D12, 0x617C6A39, 0x86404CA2, 0x4555C3E7,
+	      0x9819C28B, 0x4584662C, 0x144BDDCC, 0x3B052B97) },
+	/* (2^195)*G * 11 */
+	{ LGF(0x7FFDE613, 0x0D101C91, 0x631EC7C4, 0x200EE9E2,
+	      0xA8A29B73, 0xD28F560E, 0xE40BF4D0, 0x2CCB2CF7),
+	  LGF(0x6E7DF796, 0x30FE9671, 0x9A98317F, 0xB6A21496,
+	      0x7543C3F6, 0xEB5423DB, 0xD475BB65, 0x7DD81F0A),
+	  LGF(0x5FC133E0, 0x6E9D90B8, 0x4652F82F, 0x4ED76031,
+	      0x89A2673B, 0x76EEE284, 0x851B3032, 0x69561B43) },
+	/* (2^195)*G * 12 */
+	{ LGF(0xB1499911, 0x50C89E4A, 0x513DFDB2, 0xA66737D8,
+	      0x3EE958E7, 0xB3A61F72, 0x27D42687, 0x2DFA0BA1),
+	  LGF(0x4BB15593, 0x041881DC, 0x90F070A8, 0x06206286,
+	      0xA6239BFD, 0xF6647FFF, 0xE0A8E484, 0x60406418),
+	  LGF(0xCF384958, 0xB186E710, 0x53A27045, 0xCC5BCAEE,
+	      0x0823ABA8, 0x5F7FF4B1, 0x24508710, 0x3C01E53D) },
+	/* (2^195)*G * 13 */
+	{ LGF(0x4921B43D, 0xA5498175, 0x169BCBD8, 0x039A3283,
+	      0xF7E6E8DA, 0x16210166, 0x2C1C58B5, 0x0B005155),
+	  LGF(0xE250DF40, 0x02A5C58C, 0x60313C1E, 0x80A9A629,
+	      0xA9A286D9, 0xEDC81102, 0x0E5DE932, 0x03C8B061),
+	  LGF(0x329A1F5C, 0x9B656127, 0x90853286, 0x7F61E2E1,
+	      0x901D370E, 0x220189A7, 0xE72A0992, 0x5C2FDF1B) },
+	/* (2^195)*G * 14 */
+	{ LGF(0x45249491, 0x1725A4D4, 0xD83A2644, 0x117438E7,
+	      0x06740CDF, 0xB7E063EA, 0x9D2BB8D8, 0x6021348E),
+	  LGF(0x188EE74D, 0x2359C265, 0xDB7611FC, 0x3498D65B,
+	      0x286A6BD1, 0x97D9FFD6, 0x4E36165F, 0x63F77522),
+	  LGF(0x5B583047, 0xD5B3AA1D, 0x7FE06CED, 0xA3107630,
+	      0xA98D71BD, 0x6492A9AF, 0xB782F441, 0x534AFBC1) },
+	/* (2^195)*G * 15 */
+	{ LGF(0x1937FD6E, 0x66C6224B, 0xA12C63DB, 0x07778715,
+	      0xB3E6947A, 0xD35D4667, 0x27D08486, 0x6C435D4A),
+	  LGF(0xD34FC573, 0x14BD04EF, 0x7B42BEA3, 0x58F89E26,
+	      0x083CC9BF, 0xDD4D47FA, 0x8DA29629, 0x5C69FCC3),
+	  LGF(0x623C4605, 0x98A6F2B6, 0xDD9551F4, 0x4F944F4C,
+	      0xD1C9E81B, 0x5A90BF07, 0x6A326820, 0x0B9C0955) },
+	/* (2^195)*G * 16 */
+	{ LGF(0x173AD989, 0xF4448E39, 0xAC6C7FE8, 0xB4BD88C5,
+	      0xC5C899F0, 0x6217606A, 0x2CBA888E, 0x4DA95AF1),
+	  LGF(0x81B3D10D, 0x805E0284, 0x39FCEFCB, 0x3E6A069F,
+	      0x7FED771B, 0xDA636B90, 0xB675A4E1, 0x162581D9),
+	  LGF(0x02F702CE, 0x52668A89, 0x39061B8D, 0x44FDFE7C,
+	      0x252FD554, 0xEEAA462F, 0xB083E563, 0x02FA9D8F) }
+};
+
+#elif JQ == JQ255S
+
+/* Points i*G for i = 1 to 16, affine extended format */
+static const point_affine point_win_base[] = {
+	/* G * 1 */
+	{ LGF(0xA2789410, 0x104220CD, 0x348CC437, 0x6D7386B2,
+	      0x4612D10E, 0x55E452A6, 0xA747ADAC, 0x0F520B1B),
+	  LGF(0x00000003, 0x00000000, 0x00000000, 0x00000000,
 	      0x00000000, 0x00000000, 0x00000000, 0x00000000),
-	  LGF(0x00000001, 0x00000000, 0x00000000, 0x00000000,
+	  LGF(0x00000009, 0x00000000, 0x00000000, 0x00000000,
 	      0x00000000, 0x00000000, 0x00000000, 0x00000000) },
 	/* G * 2 */
-	{ LGF(0xD6342FD1, 0xD0FAC687, 0xEB1A1F58, 0x687D6343,
-	      0xF58D0FAC, 0x343EB1A1, 0xFAC687D6, 0x1A1F58D0),
-	  LGF(0xDB6D97A3, 0xB6DB6DB6, 0x6DB6DB6D, 0xDB6DB6DB,
-	      0xB6DB6DB6, 0x6DB6DB6D, 0xDB6DB6DB, 0x36DB6DB6),
-	  LGF(0x97827791, 0x0A72F053, 0xCBC14E5E, 0x05397829,
-	      0xE5E0A72F, 0x829CBC14, 0x72F05397, 0x414E5E0A) },
+	{ LGF(0x0E9EA08D, 0x155215A0, 0xF46D0A34, 0xC474598B,
+	      0xDE7F0296, 0xA479391B, 0xEFDB7348, 0x7DCAB2C9),
+	  LGF(0x0D1657FC, 0xB3E22F8D, 0x219E490E, 0xE5427944,
+	      0x5887FD30, 0x256C2BE7, 0x9C5869ED, 0x6F44EC74),
+	  LGF(0x69B07916, 0x84CC11AA, 0x16FEEF18, 0xEC33C759,
+	      0x78762D61, 0x2501ACD9, 0xD5F7C6BD, 0x42B401D3) },
 	/* G * 3 */
-	{ LGF(0xD61A9E2F, 0x26AFA803, 0x7F0E7D48, 0xAD827302,
-	      0xBA270925, 0x4D5065C0, 0xDB3919FD, 0x6E6BA44D),
-	  LGF(0xC4043E79, 0xC2F21347, 0x066D4156, 0x6B1CEBA6,
-	      0xA3E20224, 0xAB617909, 0xD30336A0, 0x12358E75),
-	  LGF(0x2BDDB3C7, 0xC4FAF544, 0xF0485A50, 0xC58EF652,
-	      0x71E284EF, 0x0509961D, 0xDC59141C, 0x7287BBB2) },
+	{ LGF(0x369F681F, 0x1C2AE84D, 0xA657BB05, 0xE7931687,
+	      0x8780329D, 0xFAC101D1, 0x346F39AA, 0x407A13E6),
+	  LGF(0x36F06441, 0x7204233F, 0x233F36F0, 0x36F07204,
+	      0x7204233F, 0x233F36F0, 0x36F07204, 0x7204233F),
+	  LGF(0x64ED4BDD, 0xB582FD50, 0xAE3D0228, 0x9F6417AA,
+	      0x79D25F29, 0x10163C9F, 0xD9DADBFA, 0x3E21C102) },
 	/* G * 4 */
-	{ LGF(0xF8390C16, 0xBCE7BEB9, 0xE825BA04, 0xCBFF478E,
-	      0x95BDA924, 0x96E4BB9C, 0x9561D944, 0x0F137176),
-	  LGF(0x130DB4AD, 0x65A29F71, 0xFA47C8BB, 0x9F71130D,
-	      0xC8BB65A2, 0x130DFA47, 0x65A29F71, 0x7A47C8BB),
-	  LGF(0x4402088D, 0x4D0A213B, 0xF44E59F2, 0x853223D7,
-	      0x2101F311, 0x03ADCBE2, 0x9918E929, 0x2375E811) },
+	{ LGF(0x0A0C8EFE, 0xFCB9E72D, 0xCBC752B5, 0x879B715F,
+	      0x585A38A4, 0xADBF0638, 0x83525815, 0x1153E6DF),
+	  LGF(0x69223E39, 0x9204A59E, 0x4B12D8E7, 0x4E645F87,
+	      0x9F5D3475, 0xF2A1145C, 0x662F1657, 0x54E64904),
+	  LGF(0xF87650FD, 0x330B2867, 0x0D1CB6FA, 0x013E9EBA,
+	      0x7FC59C00, 0xAB4BE93A, 0x8B86CA68, 0x11F4E281) },
 	/* G * 5 */
-	{ LGF(0xE875C86A, 0xD23D2C8B, 0x73C41197, 0x1BD81557,
-	      0xBCDB09C0, 0x74304444, 0x980D6493, 0x3A3E1251),
-	  LGF(0xDA5B43EE, 0x1F2B6B08, 0xC44A0C63, 0xE40F8B8B,
-	      0xB35FB70C, 0x5866F1F8, 0x50F768D7, 0x185034D2),
-	  LGF(0x3D361051, 0xC9192749, 0xC1C66FF4, 0xE00C1E20,
-	      0x724B43CC, 0x8982206A, 0xBB5DF4DA, 0x3E3560E7) },
+	{ LGF(0xB7768768, 0xDE7D4909, 0xC57ADC57, 0x89E1BB43,
+	      0x36A0B118, 0x850ECBC9, 0xD764C85E, 0x67D128B9),
+	  LGF(0x0667B64D, 0xDF0337C0, 0x2FBA673A, 0x58856B29,
+	      0x33A6D7CE, 0xC17C3E93, 0x9F0CC65D, 0x52932B9A),
+	  LGF(0x423C38C3, 0x1C824AAF, 0x19778FD9, 0x635DC688,
+	      0xDCBD289A, 0x3B8EBB2D, 0x3D12426F, 0x591738A9) },
 	/* G * 6 */
-	{ LGF(0x229AD5F2, 0x643AD390, 0x07471E77, 0xC7120748,
-	      0x6A6D2E2A, 0x1673C5B9, 0x5844C804, 0x124FA9DF),
-	  LGF(0xF91D6B18, 0x0BD0C5F1, 0x263610A7, 0xBB4A410D,
-	      0x98F35F00, 0xA1AB0B9D, 0xAFDDC92B, 0x4FA6D8B6),
-	  LGF(0xAEB11ACD, 0x355D1614, 0xAEE9D26F, 0x76ED99CC,
-	      0xE94A460E, 0xD7991971, 0xDA88753E, 0x34F3562F) },
+	{ LGF(0xD0DC5ED9, 0xDB908132, 0x563AB60C, 0xBAF1C9AE,
+	      0x47C0974E, 0x3F0A5A36, 0xE4758D2C, 0x1AE40CE8),
+	  LGF(0x659F8304, 0x2378FCE7, 0xE92DA598, 0xF71199A7,
+	      0xEE1D7E76, 0x05D59CEC, 0x18E39726, 0x7B55CE1D),
+	  LGF(0xDBE905C9, 0x5C964B33, 0x22A48DBC, 0xFB8008F3,
+	      0xD3C7EDD4, 0x002552F2, 0x7F5A5422, 0x42B37300) },
 	/* G * 7 */
-	{ LGF(0x678229FB, 0xE8D6CBC7, 0x232C88D0, 0xD86308C5,
-	      0x4BFC77E7, 0xC36F6969, 0x82AAF7AC, 0x4C5C3FA3),
-	  LGF(0x159EF4EA, 0x7EB52414, 0xEB4CC9E1, 0xB885C9D1,
-	      0xEE64BF7F, 0x350914B3, 0x520AED5A, 0x6DD8CDFA),
-	  LGF(0x34C75544, 0x59DAD0E6, 0x0C2A0899, 0x818C7393,
-	      0x60AC1520, 0x0957AB7A, 0x0A217C1C, 0x56861F4D) },
+	{ LGF(0x5A305CD1, 0xBCF61643, 0x7A24E5FE, 0x8FF2EAAA,
+	      0x0FFADF5D, 0x1F836A92, 0x8A25A05C, 0x77869103),
+	  LGF(0x9712F248, 0xBB70A309, 0xB5C7CED6, 0x62AE8CAB,
+	      0xC3D060D0, 0x150E35D2, 0x47D95DA4, 0x6EB76B26),
+	  LGF(0xE42EC752, 0x5429F9F2, 0x72EDC8DB, 0x64F44E4B,
+	      0xBC1B7A38, 0x6A2EACE6, 0x44734AB4, 0x59A07700) },
 	/* G * 8 */
-	{ LGF(0x53187B28, 0x4E11C113, 0x515E9113, 0xAD881FFB,
-	      0x2FD5BA49, 0x86AD97E4, 0xB2A6146C, 0x2C922B2C),
-	  LGF(0xEB513A8B, 0x99DA8C93, 0x5DEDFC87, 0x0706B8B9,
-	      0x1F778CE9, 0xC54D8F47, 0xFA2E63E5, 0x4766315B),
-	  LGF(0x39729F9A, 0x4D9B8F56, 0x8B0077A8, 0x89B68A9C,
-	      0xFCA311FD, 0xF3C520B8, 0xB811270A, 0x532698BC) },
+	{ LGF(0x56AF9D20, 0x1EA227FB, 0xA435E2AC, 0x342B4BA3,
+	      0xE4A5FB16, 0x188E0332, 0xE64F8650, 0x4CB7E380),
+	  LGF(0x93F6EEA0, 0x2DE04D6F, 0x4BD9AB93, 0x13A2A2DE,
+	      0xACF9CC03, 0x4BA8485F, 0xEC331ED1, 0x26DCD74F),
+	  LGF(0xFF3A091D, 0x008F881C, 0xAC529912, 0xD79E9196,
+	      0xB91D9EE2, 0x27641FC9, 0x791D0D36, 0x08F2F46F) },
 	/* G * 9 */
-	{ LGF(0xB52FBCC4, 0x6FB66DF6, 0x38AA1784, 0x675E5BCC,
-	      0x852C1B0B, 0x55B6D3E8, 0xFA293050, 0x2289F3AB),
-	  LGF(0xD0A08E61, 0xA84A27A9, 0x132CCAC1, 0x27E9084D,
-	      0x01F68C40, 0x498C7D8B, 0x940E4159, 0x6957FDFF),
-	  LGF(0x815F2EFF, 0x8D2F2DE6, 0x88C812F9, 0x76CA668F,
-	      0x32B42796, 0x56244B8A, 0x72CB2D3C, 0x431DA1A6) },
+	{ LGF(0x3867E249, 0x7064AA19, 0x1BBD9331, 0x9E0262DD,
+	      0x47465363, 0x28DAB54C, 0xF58996EC, 0x186E71D5),
+	  LGF(0x28B2AEF7, 0xF293B014, 0x9F64AADF, 0x6544BF67,
+	      0x3DC0038B, 0xC25DB7DB, 0xE8B16348, 0x641BC3EA),
+	  LGF(0x553D878E, 0xC9769297, 0xF210B104, 0x5AFEBCBF,
+	      0xEBC5E399, 0xC30E7E91, 0xF78889DE, 0x5344F6CB) },
 	/* G * 10 */
-	{ LGF(0xACC048BE, 0x8EB44683, 0xAAD5CD46, 0x803FC1C6,
-	      0x0762C505, 0xAF553973, 0x61B06E3A, 0x30290CF9),
-	  LGF(0xB889903E, 0x3AA366BB, 0xCC140A37, 0x55838146,
-	      0xA9B6AD5E, 0x4AA37581, 0x916F803C, 0x7B37113C),
-	  LGF(0xE1C6283E, 0xD912EBC4, 0x8AE5C163, 0xC70EAC51,
-	      0xE828C438, 0x9EDDA370, 0x189ECFD9, 0x252DC97C) },
+	{ LGF(0x69A38BAF, 0xEC41FB98, 0xB257A28D, 0x55781708,
+	      0x46435A2C, 0xF1BEAC33, 0xF2E5C1DF, 0x24D9FE2B),
+	  LGF(0x35E0E33E, 0xAC2450CD, 0x4BE098FF, 0xA5FBAFCA,
+	      0xF6CC3634, 0x15C5CFFB, 0x4DD0CC8A, 0x11EB002E),
+	  LGF(0x0B3E9878, 0xB57551F4, 0x087CD2FE, 0xA1D9E1AC,
+	      0xE072548A, 0xFE443CA5, 0x431C24BB, 0x3361CE26) },
 	/* G * 11 */
-	{ LGF(0x99D93A3B, 0x38A7E995, 0xA3919A65, 0x09DF0EB0,
-	      0xF643AF23, 0x6F385F29, 0x2424A548, 0x467C84CA),
-	  LGF(0x864E7F82, 0xA9A8911D, 0xAB741725, 0x65CF6B9C,
-	      0xE772B327, 0x8C133221, 0x8CD1F209, 0x15852107),
-	  LGF(0x8F92D685, 0x41583C9A, 0x53E938EB, 0xFAE4DC55,
-	      0x6C5406EA, 0xC3FC1F02, 0xBC1F036B, 0x5D4A07E9) },
+	{ LGF(0xFDB68B79, 0x640788E8, 0xD4645856, 0xA02A4D6F,
+	      0x6A54EB86, 0xB18CAB0F, 0x814FCFF1, 0x01511890),
+	  LGF(0x9FDD13DE, 0x4845EE2F, 0x84D73CA8, 0x343EAC12,
+	      0x33C3A9ED, 0xD7761D75, 0xD6AF1B44, 0x44204FCF),
+	  LGF(0xEA04605B, 0x88C209C7, 0xB025867C, 0xDEC8E3E4,
+	      0xAB8AE0C4, 0xF25BD01A, 0xBFBE67E2, 0x10E31B1D) },
 	/* G * 12 */
-	{ LGF(0x83BF7B93, 0xA49A13F8, 0x8DC7807E, 0x06E6D0CF,
-	      0x238DA4B1, 0x4B3B87C8, 0x5A9F7719, 0x66FF84AF),
-	  LGF(0x087640AA, 0xE4C1C725, 0x3EF5D5E0, 0xFB902D6A,
-	      0x2E1297EB, 0x53EF3593, 0xE1787343, 0x67E65CF7),
-	  LGF(0xFF9309B4, 0x4203ACE2, 0x8E506208, 0xAE5BB531,
-	      0x3DEB52CB, 0x4742F3CB, 0x3959DA85, 0x2213A3D9) },
+	{ LGF(0xAC5599AB, 0xC31D48EE, 0x69F1BBA3, 0x3E87D668,
+	      0x1165365F, 0x8AB43867, 0x2E25AB56, 0x42B17278),
+	  LGF(0xAD8160D1, 0xEDFD8B4B, 0x5457C4A7, 0x9BBB9D36,
+	      0x3BA7F9DB, 0xC2A3F962, 0x296F8D92, 0x1EA722FF),
+	  LGF(0x4727F1F8, 0xDBD377FD, 0xB05F1736, 0x060E2D9D,
+	      0x9422C162, 0xA86F76D5, 0x92E58063, 0x466ED475) },
 	/* G * 13 */
-	{ LGF(0x2ED04723, 0xA9962278, 0xB5D2A716, 0x22587604,
-	      0xFFB6AD2D, 0x3E7BB13D, 0x9D4C885B, 0x6E7036BE),
-	  LGF(0x81061965, 0x90F88398, 0xF2BFCB98, 0x67D0394F,
-	      0xCD1396D8, 0x913200FC, 0x306A3580, 0x17F96D76),
-	  LGF(0x4099DC93, 0xF1F0EC98, 0xE43361F5, 0xE02396E9,
-	      0xAB0AE384, 0x028EBB02, 0x2DB22F61, 0x0E236467) },
+	{ LGF(0xC42DF019, 0xFFAD311F, 0x6B1677A5, 0xCC5F0E31,
+	      0x724C430C, 0xDB27E2AA, 0x7910438F, 0x72491B47),
+	  LGF(0x76049D71, 0x4DEC2338, 0xA8EA7661, 0x12E5410D,
+	      0x1E78A79B, 0xA8C80C9E, 0x071FC1D5, 0x56187141),
+	  LGF(0x61AB363D, 0x5F87D7B1, 0x6751C8BA, 0xFADED89F,
+	      0xBA3C4BCD, 0x37A78C21, 0x9C950F96, 0x3E2BE3EF) },
 	/* G * 14 */
-	{ LGF(0x0F2521F0, 0xC6C60BB3, 0x5CB6D116, 0xA59973DD,
-	      0x706DD30D, 0x069708CC, 0xF8A08989, 0x74C367AB),
-	  LGF(0xD2AC4172, 0x05B49673, 0x0D77E4E6, 0xA016A689,
-	      0x0635E1C0, 0x7C6DAA97, 0x47A6A04A, 0x42C80345),
-	  LGF(0x75DEF4DC, 0x0266FAA8, 0x05C5A659, 0x41B211E5,
-	      0x39E5E234, 0xE13C4A76, 0xE6AF9B7D, 0x0C4AC28D) },
+	{ LGF(0x4FE98F30, 0xB1620E56, 0x92E72DD0, 0xB119CC91,
+	      0xE6CCAC7F, 0xA0040674, 0xDD41A2D1, 0x5E430A47),
+	  LGF(0x87390957, 0x06930693, 0x567E3C9A, 0xC3E0CD34,
+	      0x8E0CEEAE, 0x2EDB8253, 0x6D3123EB, 0x60EF0D21),
+	  LGF(0xEC603124, 0xCEB292E0, 0x09C8339D, 0x18B961A3,
+	      0x5D3B524A, 0x917BC541, 0x257F38AE, 0x681E3041) },
 	/* G * 15 */
-	{ LGF(0xE86224A7, 0x543AA085, 0x9EA21055, 0x626226C0,
-	      0xEE7E01D9, 0x257B5FE5, 0x82C497CD, 0x1110D927),
-	  LGF(0x19120727, 0x7FFA4AF7, 0x1BF74984, 0x705D1257,
-	      0x9FAE1F07, 0x4AD1FA64, 0x265D7456, 0x2F4CA2B6),
-	  LGF(0xF7C6525E, 0xB111F1B5, 0xC1B29AC7, 0x54BD0CFF,
-	      0x7009957D, 0xCC7CCE32, 0x0D563132, 0x0CCF7FF0) },
+	{ LGF(0xCBB41565, 0x871FFDDB, 0x1DE23B6B, 0x98B52686,
+	      0xC016B5CD, 0x51EBFEAA, 0xB08C48A2, 0x3BE6B06E),
+	  LGF(0x57EA5D5A, 0x30100939, 0xAE95E20B, 0x99E3DE25,
+	      0x449B9EFD, 0x5594A4E0, 0xCFB9A5A5, 0x100615BC),
+	  LGF(0xD534F12E, 0x2CB15E4A, 0x49523FF8, 0x07A2C5FB,
+	      0x8E59F7E5, 0x79BCF046, 0x8A8B99AA, 0x172AAB62) },
 	/* G * 16 */
-	{ LGF(0x24F31B2E, 0x97DA44A0, 0xDB5120DD, 0xF8FAE043,
-	      0xD7F5F415, 0x03D9F770, 0xA296F053, 0x676824C9),
-	  LGF(0xE1227049, 0x2D808316, 0x32683177, 0x15064C91,
-	      0x41E90ED8, 0x706D8A1F, 0x1A6DB76E, 0x251A1931),
-	  LGF(0x9E05F91A, 0x95191DCA, 0x0C6EE0A8, 0x0DB49CC1,
-	      0x7BF95128, 0x7C16D8FF, 0xB15D04AE, 0x2C8D5EC4) }
+	{ LGF(0x94943C22, 0x18BF1FBA, 0xC9AF901F, 0xEE888DF3,
+	      0x083B2FE3, 0xE6355FA5, 0x5B5F3676, 0x2DE21A5F),
+	  LGF(0xBEE08226, 0xFE9991C8, 0xB6132ED0, 0x70631241,
+	      0x930CC3DF, 0xF17032C1, 0x5E61EDCA, 0x1880F6E6),
+	  LGF(0x5053E953, 0x7D5A5028, 0xE2C9B21E, 0xB0627DFE,
+	      0xE54A4C3C, 0xB6548C27, 0xA2BDDB5E, 0x5C75B961) }
+};
+
+/* Points i*(2^65)*G for i = 1 to 16, affine extended format */
+static const point_affine point_win_base65[] = {
+	/* (2^65)*G * 1 */
+	{ LGF(0xFC850F1F, 0xAD671792, 0x10F4FB5A, 0xB7D10E97,
+	      0xF1498B64, 0xE59F700C, 0xA555FEFD, 0x145C3F79),
+	  LGF(0x301870EC, 0xC504DF70, 0x59BEB30B, 0xC3F57575,
+	      0x0E041627, 0x59EF9CAA, 0x1FDF29EA, 0x3AA6C124),
+	  LGF(0xA73A5D82, 0x6D1B6960, 0xB7B83754, 0x7E905634,
+	      0x66E7AD73, 0x5728E3A8, 0x4DD20707, 0x6F9938F0) },
+	/* (2^65)*G * 2 */
+	{ LGF(0xF769D548, 0xAEA44289, 0xD9C85032, 0xF3B3A271,
+	      0x19A10A0D, 0x450F6EC6, 0xD8A60452, 0x2A078A32),
+	  LGF(0xA49AB090, 0xE395C342, 0xD994BBBA, 0xBEEAEA12,
+	      0x316756DE, 0xE555C4B2, 0x2A2835EA, 0x0C4B1FDF),
+	  LGF(0xE71A2679, 0xACC1B6C0, 0x6A20F966, 0x3B828FBF,
+	      0xF305035E, 0x2B40BE24, 0x5F9EE71D, 0x5138EFFC) },
+	/* (2^65)*G * 3 */
+	{ LGF(0x61C3B389, 0xFCB87370, 0x5FB663E6, 0x2EB5074C,
+	      0x727B63A1, 0xC58DE35B, 0x00B2FBF9, 0x6F9AECFE),
+	  LGF(0x64D47F35, 0xDD2736E0, 0x4CCCB7AD, 0x8235DE8C,
+	      0x937FCD8B, 0x84993635, 0xFEACCC60, 0x05DADA9D),
+	  LGF(0xCCDEEA2C, 0x041CF837, 0x8F430D4E, 0x128FA18D,
+	      0xF6EC5EF7, 0x146AA2BA, 0x7A3314D7, 0x367779B5) },
+	/* (2^65)*G * 4 */
+	{ LGF(0x6AB767DD, 0x02E35314, 0xF6DB6D43, 0x07B12ACE,
+	      0x8291AF02, 0xB844A3A3, 0xBFF84166, 0x168FE09E),
+	  LGF(0x2E0DD4AF, 0x20CCC894, 0x40E6146F, 0xB05A1446,
+	      0x747B5584, 0x39FB3501, 0xAA0DCC5D, 0x637DD68B),
+	  LGF(0xC8D19D78, 0xF858BE49, 0xC049D501, 0x1CD2F537,
+	      0x72C504DC, 0x5B82CA8E, 0xD8F74B16, 0x081DAA0C) },
+	/* (2^65)*G * 5 */
+	{ LGF(0xE492D81E, 0xEAAC278E, 0xDF4B5715, 0x9B679600,
+	      0xF7D251E0, 0x0930AFE6, 0x4B0A57E8, 0x12B18E68),
+	  LGF(0xE0B61BA4, 0x8E3257DD, 0x87333A80, 0x034912BE,
+	      0x6FE3860D, 0x35538974, 0xB72FDAE3, 0x0430DD4D),
+	  LGF(0x10703FE2, 0x8F69AB4C, 0xB9CA5DEA, 0x9DB06D02,
+	      0xE9A31DF3, 0x80E1FCAC, 0x833EE541, 0x6CE5827F) },
+	/* (2^65)*G * 6 */
+	{ LGF(0xD0BE8BD1, 0x296B5AC7, 0x17A925CB, 0xF9ABC6FE,
+	      0xFE2755E0, 0x9A382C9B, 0xA45DEDDC, 0x18BD1D68),
+	  LGF(0x17995DE4, 0x41C60373, 0xFD0E5177, 0xEB9F7DAE,
+	      0xEBEFEA23, 0x3C89F25A, 0xE2A6FEA1, 0x6BC51220),
+	  LGF(0xDC0850D8, 0xA8BE5154, 0x9117FF61, 0x46B4997F,
+	      0xFD05C7A5, 0xF3632B4C, 0x3A06C5F9, 0x5198473D) },
+	/* (2^65)*G * 7 */
+	{ LGF(0xE54EC194, 0x0C025505, 0x5E54A341, 0x16DFAAD1,
+	      0x9BAC268D, 0x4E0E0938, 0x3AE0F758, 0x2C841A6C),
+	  LGF(0x0B45CB36, 0x6E0C6EC0, 0xA09D7B7D, 0xDE22614D,
+	      0x86C5311B, 0x68532DB3, 0x90BF3721, 0x6C76A366),
+	  LGF(0x61021E16, 0xEF4DC9C5, 0xEE045148, 0xBF20C5FE,
+	      0xF7E93EA0, 0xCC0911EB, 0xB042AE8F, 0x2C44B584) },
+	/* (2^65)*G * 8 */
+	{ LGF(0xC7DFAAFF, 0x0D409883, 0x44A2B7AC, 0xA9BB3C13,
+	      0x23AA330B, 0xADEE45CF, 0x38DF8DF9, 0x32F82151),
+	  LGF(0x98027EEE, 0xCF5B38B8, 0x6C358DFB, 0x2E0E5F28,
+	      0xB54C83A0, 0x77F9F481, 0xD4AD38D8, 0x320289A4),
+	  LGF(0x2D050368, 0x850595A4, 0x1A87EED4, 0x69338F65,
+	      0xC63C7E31, 0xB56B41AA, 0xF28D875D, 0x0A7DECD4) },
+	/* (2^65)*G * 9 */
+	{ LGF(0x0CD6C445, 0x3EA9CA53, 0xB11E2F78, 0xF4121ED9,
+	      0xDF4CBE2B, 0x32D2ACB4, 0x5C93F764, 0x6BFAD453),
+	  LGF(0x30D70239, 0xE9F73ACE, 0x73FFD2AB, 0x2D6EB283,
+	      0x14264D84, 0xE362CB1B, 0x47F58EDA, 0x6A58C4C4),
+	  LGF(0xEB81C4F0, 0xD421A3CD, 0x973B8F0F, 0x8C5750AC,
+	      0xB3184DFA, 0x43D7F20C, 0xA00332B5, 0x05EA57EA) },
+	/* (2^65)*G * 10 */
+	{ LGF(0x8C55EFC5, 0x6E80B93F, 0xAC82CA7F, 0xCFA05077,
+	      0x997B623A, 0xFC3A41A8, 0xF388397E, 0x594955BF),
+	  LGF(0x1D23F58F, 0xBD4ABD3A, 0x13D824B7, 0xFDF2BE7E,
+	      0x6DA9D7C5, 0xFDF4EBAD, 0x0A760CE6, 0x6F6BF0FD),
+	  LGF(0x55EADF3C, 0xB81C2566, 0xD18BC1A6, 0xBDD6F1B6,
+	      0x471E8803, 0x3160D36F, 0x809C36C6, 0x5B172E38) },
+	/* (2^65)*G * 11 */
+	{ LGF(0xF53D8310, 0x80DDD82D, 0xFB0E0E43, 0x9FE3E489,
+	      0x92FEAA7B, 0xE1EC96F4, 0x8CA0A54C, 0x0D9EFEC2),
+	  LGF(0x5BEF5D82, 0xAC82BC83, 0x26768EEA, 0x1ED56E4F,
+	      0xAE0F6520, 0x7CB1DF78, 0x1A793D69, 0x3F27081B),
+	  LGF(0xF93EB90E, 0x057471C1, 0xFB299F2D, 0xDA034A47,
+	      0xB0691BD2, 0xC51142A5, 0xFCF6A3EE, 0x5FD614C1) },
+	/* (2^65)*G * 12 */
+	{ LGF(0x52CB2A5C, 0xDBEFD63B, 0xC7FCE11E, 0xCA182B05,
+	      0xB7E0B2B0, 0x8173D517, 0x6EBCC5BD, 0x1A664CA5),
+	  LGF(0x00488C1B, 0x3C2CD45E, 0xD5AA1E98, 0x744209C1,
+	      0x3F628FFF, 0xB0A6FCE8, 0x1138F9B1, 0x770D858C),
+	  LGF(0x88D37A03, 0x6A96C565, 0x14153EC3, 0x733C7CA7,
+	      0x78D61F3C, 0xA04AF9D1, 0xFFE4F21E, 0x10420882) },
+	/* (2^65)*G * 13 */
+	{ LGF(0x1CCCC730, 0x85581131, 0x61E9960D, 0x7B6D5AAC,
+	      0xE26F9B9C, 0xC3729090, 0x61BABE1E, 0x035DE04A),
+	  LGF(0x159B7C7E, 0x2B0FECC1, 0x3AD75522, 0x5176B224,
+	      0x6C3BD8ED, 0xF578275E, 0x4A4335B5, 0x3EA45CDA),
+	  LGF(0xFB8296AD, 0x399CEF5F, 0x0203F23D, 0x7BB775A1,
+	      0x009BFFEE, 0xEA10679B, 0xFA69E967, 0x70977639) },
+	/* (2^65)*G * 14 */
+	{ LGF(0x2E20E4A3, 0x969B92FA, 0xDBFB267E, 0xC10608CE,
+	      0x1B964F50, 0x03B07217, 0x4D4EAAF8, 0x513E12D6),
+	  LGF(0x2B792081, 0xDCABCD1C, 0x97317B12, 0xC0B470A2,
+	      0x5D26A03D, 0xB2C96A08, 0x7D7202E9, 0x52A2BF2E),
+	  LGF(0x4111A128, 0x92EA95A7, 0x195F29D9, 0x8164FFF4,
+	      0x39E5051E, 0x8A3F1593, 0x7E870D74, 0x43FC2262) },
+	/* (2^65)*G * 15 */
+	{ LGF(0xC3DF479B, 0x5B4B80D1, 0x1817958B, 0x26E5E74F,
+	      0x3AED803B, 0x899B72B3, 0xFAB7DFA1, 0x07D749F9),
+	  LGF(0x82ED1F56, 0xCB4E8E86, 0xE6F438C6, 0x95E7B3DA,
+	      0x11E4EAE5, 0x436574C3, 0x6B6557D1, 0x5B29A9D4),
+	  LGF(0x8E2A8D1F, 0xA0FF9F12, 0x527B4E88, 0xD3C936A9,
+	      0xF2B0454A, 0xB279CEBE, 0x6130D747, 0x04B77CA1) },
+	/* (2^65)*G * 16 */
+	{ LGF(0xDB9A5B83, 0xD82E7D79, 0xDB1386D1, 0xE55F1507,
+	      0x0B19751E, 0x4E2ED8BC, 0x6AD8C891, 0x191D614E),
+	  LGF(0x07947CAE, 0xA0A662EF, 0x407ADF90, 0xCFD4B9B4,
+	      0x4CDA26D4, 0x9698A42E, 0xFA1C5F43, 0x00D98818),
+	  LGF(0x20D474E3, 0xF048C3E4, 0xCDA1B6AB, 0xA09CE0B0,
+	      0x9727A4CA, 0x31ED70E8, 0xB2D89DF0, 0x214C5B3C) }
+};
+
+/* Points i*(2^130)*G for i = 1 to 16, affine extended format */
+static const point_affine point_win_base130[] = {
+	/* (2^130)*G * 1 */
+	{ LGF(0x287B7A8C, 0xC547E3D2, 0x2E9A0A54, 0x907B6425,
+	      0x55F5D398, 0x7A7BA223, 0x492D6D08, 0x5FEB95EE),
+	  LGF(0x247C18A0, 0xC17AB82D, 0x6973F13C, 0x95542A3E,
+	      0x9E957BD2, 0xB14CDFC7, 0xBADE4F32, 0x661229C7),
+	  LGF(0x28E441B7, 0x5541C599, 0x442F368E, 0x5B912D60,
+	      0x5BC7D073, 0x2EC47581, 0x03E1A1E7, 0x02802A6A) },
+	/* (2^130)*G * 2 */
+	{ LGF(0x0F28E7B4, 0x15A644D9, 0x4550787C, 0x2AEBD607,
+	      0x83354F29, 0x319418ED, 0x2688A0B0, 0x2B3CECA0),
+	  LGF(0x87129578, 0x72C27DF1, 0x94A3CAEB, 0xF443CA1C,
+	      0x35C3A22D, 0xEA24368F, 0x7283DADF, 0x17A619CA),
+	  LGF(0x3459B171, 0x0EC06DB4, 0x8FD7DD2D, 0x1A6558F9,
+	      0xA82A6DEE, 0x4B3F9D68, 0x340F9542, 0x649637A5) },
+	/* (2^130)*G * 3 */
+	{ LGF(0x8F86DA38, 0xA065A103, 0x66338796, 0xBF1723E4,
+	      0x18633561, 0xD922BF8C, 0x97CE7EDA, 0x168AAAD7),
+	  LGF(0x2CB400ED, 0x31D729A1, 0xCEEAA6A9, 0x7A195520,
+	      0x192BE4B6, 0x86F51D53, 0x1CDCF306, 0x22A23BF6),
+	  LGF(0xE212FCC2, 0xCACA700A, 0x3381880A, 0x8E87630B,
+	      0xBC73A980, 0xC73BF67B, 0x1AA1CCE1, 0x66C538B7) },
+	/* (2^130)*G * 4 */
+	{ LGF(0x7B396AC1, 0xA7C98580, 0x050B1CC0, 0xF5B27B3B,
+	      0xF3BB8550, 0x199AF9DF, 0xCCECE2DE, 0x0DD0B15B),
+	  LGF(0x08A28FA3, 0x767FEA82, 0x37DCA7EE, 0xA2DC84A0,
+	      0x33E1DE6F, 0xEBD2AC82, 0x21AD21CA, 0x188F7085),
+	  LGF(0xBA423FFD, 0x3AC52264, 0x3B333AA4, 0xEF5048FF,
+	      0xEC2F8A1A, 0x2FBD912D, 0x670533CF, 0x2BEF1130) },
+	/* (2^130)*G * 5 */
+	{ LGF(0x9FC7024F, 0xCD8A44DA, 0xBC29AA93, 0xF737A550,
+	      0x1E9106B9, 0x0D895281, 0x2DA132F4, 0x2392F5F4),
+	  LGF(0x64875239, 0xB8201817, 0x342A7459, 0x5B4DD1BB,
+	      0x0BE03B56, 0xC66B48D8, 0x636EA208, 0x7F08F18F),
+	  LGF(0x72019CF2, 0x2CC60206, 0x05B43C11, 0x14E86A76,
+	      0x5DE4C795, 0xB9CE10F5, 0xBA073D7D, 0x67B29276) },
+	/* (2^130)*G * 6 */
+	{ LGF(0xF864F06F, 0x43D22D5E, 0x3BE07C7C, 0x69548FFF,
+	      0x3EDD77B8, 0xEBB4F5A3, 0x2CA0CD5B, 0x5C5A9324),
+	  LGF(0x2E2ECC30, 0x9FFA28B9, 0x78DA5C00, 0xFB480B56,
+	      0xB14804D7, 0xE1C94F9A, 0x48C9FA1D, 0x7D453CC9),
+	  LGF(0x84BD090A, 0x99B10D26, 0x702948B9, 0xAA8361C9,
+	      0x15F7685C, 0x8FE833DB, 0x46BA5349, 0x5A40858A) },
+	/* (2^130)*G * 7 */
+	{ LGF(0xC806064F, 0xFE714DB9, 0x96052BB3, 0xEC532CBC,
+	      0x62B03E4E, 0xFEB56676, 0x52734277, 0x7D201AFC),
+	  LGF(0x55F5DEF5, 0x87848119, 0x33271AC2, 0x48D26621,
+	      0xA6C81237, 0xAF3F2A3F, 0xE01B2E7D, 0x1A086A6F),
+	  LGF(0xAA0289C2, 0xE60717C5, 0x465F8A77, 0x06226B3A,
+	      0xC053632B, 0xAAE6A9C9, 0x16332425, 0x74441004) },
+	/* (2^130)*G * 8 */
+	{ LGF(0xC3D8E685, 0x9C901178, 0x5E9E8C93, 0x3FD38D2D,
+	      0x3AECC482, 0xA0478BE3, 0x263956AC, 0x507DF5A8),
+	  LGF(0x59DBD92B, 0x1DC9A2A8, 0x6245BBB3, 0xBF15C84C,
+	      0xB2CAB143, 0x2A8D65D0, 0x17A5525E, 0x3DE43A80),
+	  LGF(0x13E8DD16, 0x20400890, 0x9E66D5ED, 0x98B67294,
+	      0x76BC1D61, 0x2468A4B8, 0x4A76A7C6, 0x1D2C24FA) },
+	/* (2^130)*G * 9 */
+	{ LGF(0xA15BFEC5, 0x4E0B3042, 0xB78EFCC3, 0x25107B05,
+	      0x0AB84B6A, 0x895F5129, 0x6CD0570A, 0x2875F452),
+	  LGF(0x891C8CF1, 0xDB52105D, 0xF01D372F, 0xA1E811D5,
+	      0x0ADED951, 0x5CF867DE, 0xE0B4DA8B, 0x17052800),
+	  LGF(0xD990BDFE, 0x465AF151, 0xED9253B0, 0x61C1C858,
+	      0xA3FBDE66, 0x565E0443, 0x53E17835, 0x12DB650B) },
+	/* (2^130)*G * 10 */
+	{ LGF(0x29D2E833, 0x01496672, 0xED0CA017, 0x01916903,
+	      0x293857A0, 0xB4E997E9, 0x85A3DB38, 0x52B3D9F4),
+	  LGF(0x46496B31, 0x126C8477, 0x626487D7, 0x23D37316,
+	      0x982B39EB, 0x46505E02, 0x2143582E, 0x23434575),
+	  LGF(0xA0420BAA, 0x6BBD04A3, 0x425C1B2E, 0x9684CAEB,
+	      0x89C6CAF4, 0x2D86F805, 0xA6568CBE, 0x625467C6) },
+	/* (2^130)*G * 11 */
+	{ LGF(0x228C2235, 0x8444EE09, 0xBBF1E2D0, 0xC67ADEED,
+	      0x16B2CFD7, 0x78F69BE7, 0xB95FF650, 0x7B0AF5F2),
+	  LGF(0xBECE2651, 0xD51EDD52, 0xD6FA4957, 0x792F3E2E,
+	      0x8E6F750E, 0x8349ED26, 0xEF6F6D88, 0x6BB94CDF),
+	  LGF(0x5088C5A8, 0xE4774F54, 0xFFA8E04D, 0x43CAA7EC,
+	      0x0644B58D, 0x2CBAD6B9, 0xA1180C6F, 0x66EC80D6) },
+	/* (2^130)*G * 12 */
+	{ LGF(0x8591C1AD, 0xAF4B65BA, 0x17CEAF23, 0x34946626,
+	      0xD86050C8, 0x67D0F7B0, 0x2F7E3A00, 0x7DD5EFEF),
+	  LGF(0xDE2129A6, 0x89340045, 0xE46000DB, 0x10CF7923,
+	      0x2C69ABE2, 0xA17D1BEB, 0x203C2DA4, 0x1F3592DE),
+	  LGF(0xC9A50DDD, 0x946A6220, 0x90529CD9, 0xB19B06C5,
+	      0xC2D4D2BA, 0x932CF781, 0x2633F97D, 0x643EC048) },
+	/* (2^130)*G * 13 */
+	{ LGF(0x02E72852, 0x681F8DB2, 0x6FBEA675, 0x1321374B,
+	      0x23DB7E8C, 0xD874B177, 0x0693A8A2, 0x19430AF8),
+	  LGF(0x57355C90, 0x0F4767AD, 0x19124EA8, 0xCAD900D8,
+	      0xE702318A, 0xB4B045E5, 0x3A7E1058, 0x7AB6CB35),
+	  LGF(0x0505358F, 0xF5572A21, 0x20133EC8, 0x0C528F0B,
+	      0xB3606AA3, 0xC425B464, 0x6CAB14B8, 0x33E0CFF1) },
+	/* (2^130)*G * 14 */
+	{ LGF(0x862E3AF0, 0x1739D8DE, 0xB3D5ED7B, 0xEAEA8FAE,
+	      0x4B06CE7A, 0x394668C3, 0x5FC95D4F, 0x26B43F06),
+	  LGF(0x01A95CF8, 0xE62B26D3, 0x48398A95, 0x84BC9EEC,
+	      0x267875A4, 0x08F76F6E, 0x9A0A50A1, 0x32D3B1A4),
+	  LGF(0xEAB69B8C, 0x1E1D0050, 0x31875B73, 0x5FAE0C5B,
+	      0x29295DB8, 0x5FD8D77B, 0x8F5136E0, 0x720DA33C) },
+	/* (2^130)*G * 15 */
+	{ LGF(0xC609C455, 0x53614A3B, 0xD229E43B, 0x1FDF44E6,
+	      0xEC35FF3A, 0xC69D5CC6, 0xD4386D2C, 0x40D8B2ED),
+	  LGF(0x58819185, 0x9A0B63FF, 0x1086D125, 0xF789BF22,
+	      0xB1E1776A, 0xAD341ED8, 0x46EBF733, 0x082617E1),
+	  LGF(0xB0AF72AF, 0x94BAFDC6, 0x67032F80, 0xCE7FD958,
+	      0x42E3E324, 0x60A041C7, 0xE0C48A92, 0x52BAFECD) },
+	/* (2^130)*G * 16 */
+	{ LGF(0x6686F776, 0xB5972247, 0x42C88D93, 0xFCAABBE4,
+	      0xFA237DD5, 0x0A7A9E0D, 0x43FCED53, 0x2DBB938F),
+	  LGF(0xC1409964, 0xF50D8973, 0xECBBDB1D, 0x7E7D988F,
+	      0x0DE07B83, 0x64BAB168, 0xE277A32E, 0x588C179E),
+	  LGF(0xF1FFD3B3, 0x62A6B63B, 0xA4AEC308, 0xAA7B23F4,
+	      0xBC75755C, 0x52196FBD, 0xD4635289, 0x60C42361) }
+};
+
+/* Points i*(2^195)*G for i = 1 to 16, affine extended format */
+static const point_affine point_win_base195[] = {
+	/* (2^195)*G * 1 */
+	{ LGF(0x52EF088D, 0xEB4B028B, 0x511D0BF8, 0x7BFFA172,
+	      0x4AA70C44, 0x20A72891, 0x23A0A46D, 0x1982687F),
+	  LGF(0x4F6950E1, 0xD5386C02, 0xF2C711D7, 0xB46F6A19,
+	      0x7F90F84F, 0xD13612F7, 0xC35B1108, 0x02B1FE40),
+	  LGF(0x3C8937C9, 0x24BC6E86, 0xD4AE4DC9, 0xA15165FB,
+	      0x4BAA772F, 0xF54207D1, 0x734C65E6, 0x4ECAC7AF) },
+	/* (2^195)*G * 2 */
+	{ LGF(0xF5DF3C6B, 0x6736CB36, 0x9E622FFF, 0xAAC155C4,
+	      0x6C9AF425, 0x08BF6AEC, 0x3E754687, 0x32453BFF),
+	  LGF(0x01D9BE69, 0x4D205228, 0x30005684, 0x491F6D95,
+	      0x61348B5B, 0x03948795, 0xC7DA4C9E, 0x207807A3),
+	  LGF(0x5081D09A, 0x39C46014, 0xEEDD6F53, 0xE3BB41D1,
+	      0x2AECE484, 0x8BAB5AC4, 0x073E261D, 0x7BE8AD2F) },
+	/* (2^195)*G * 3 */
+	{ LGF(0x0240D5AB, 0xE2163ED4, 0xD2EDE213, 0x0D36DDAF,
+	      0x84DA7A94, 0xB5DA9A3A, 0x81AD5800, 0x616BB179),
+	  LGF(0x42399CCB, 0x62329BF6, 0x54BDD8E5, 0xD15830A7,
+	      0x45F76715, 0x052C83B7, 0x77A075E5, 0x2C2FEC42),
+	  LGF(0x050E4AFB, 0xCA181F67, 0x3CABC581, 0x8FA110DC,
+	      0x46B0A4C3, 0xEC7B337F, 0x8F72400F, 0x61465925) },
+	/* (2^195)*G * 4 */
+	{ LGF(0xC01F036B, 0x11A5ECC6, 0x3DCFAB11, 0x00905EC7,
+	      0xBE833EB9, 0xBD182106, 0x520D6147, 0x21345004),
+	  LGF(0x823F9793, 0x33F1C936, 0x8646E9E2, 0x45EB4CD7,
+	      0x49110514, 0xB28C3C8D, 0x39F3AA65, 0x20B293F7),
+	  LGF(0xF465E491, 0xECE0E7C9, 0x3E295315, 0x6E3D99DD,
+	      0x0D23AB0D, 0x11CAE9FC, 0x3D65F08E, 0x395BB5CD) },
+	/* (2^195)*G * 5 */
+	{ LGF(0xB04EFBCB, 0xC3465879, 0x7DF1D9F8, 0xDDD7400D,
+	      0xBB68E927, 0x3FC45AA3, 0x7CC560D9, 0x0D654BC9),
+	  LGF(0x4D4F0DAA, 0x3F09E8FE, 0xB553CA96, 0xE47EE2E2,
+	      0xAC578533, 0x9FFA3C3A, 0xA08113C1, 0x356B0675),
+	  LGF(0x6CF3E78E, 0x2F2E5ED1, 0xDD5F3D89, 0x3739979B,
+	      0x9FB489BE, 0x6DA80DAB, 0xBDA14A65, 0x431D2978) },
+	/* (2^195)*G * 6 */
+	{ LGF(0xE71501A7, 0x93683AAA, 0x01C67235, 0x7A150F18,
+	      0x300E35B7, 0x5F345C36, 0x605D8B43, 0x7A900684),
+	  LGF(0xC8E7B387, 0xA143C257, 0x6CC108D4, 0x62D88913,
+	      0xBB72837C, 0xE32F52E0, 0x12F67001, 0x076CCDEE),
+	  LGF(0x262D9E46, 0x02F43BF7, 0x5B679BDB, 0xC600EF04,
+	      0x5A115558, 0x75B858E1, 0x25934593, 0x580DEEF0) },
+	/* (2^195)*G * 7 */
+	{ LGF(0x09001CAE, 0xCAF3D56D, 0x7F61B1E3, 0x56CCAFC5,
+	      0x3BA1A346, 0x6BE0EB31, 0xB592478D, 0x4AB3F0BE),
+	  LGF(0x8AEDB101, 0x971F761E, 0x3B802862, 0xD10EB0D7,
+	      0xDE5AD3F6, 0x100B543B, 0x27445B8E, 0x2D2D355F),
+	  LGF(0x90669B3D, 0xBB6B5140, 0x9368BB18, 0x6AF73229,
+	      0xC4662114, 0xD33B393F, 0x2E5F9548, 0x44B393C4) },
+	/* (2^195)*G * 8 */
+	{ LGF(0xC96EBE06, 0x073F794D, 0x6642E5AB, 0xF9AAA789,
+	      0x18DC4F59, 0x47F09728, 0x70B031C5, 0x30E51AB0),
+	  LGF(0x79CB6EA2, 0x6AC99539, 0x43904E3A, 0xB754075F,
+	      0x6C51FC54, 0x0F5C5D70, 0x6A945237, 0x72F0811D),
+	  LGF(0x7656E362, 0xBB17DDD3, 0x405FA3BF, 0x9F321433,
+	      0x72A57EE6, 0x326CCE63, 0x0F2A9875, 0x2CEB4E80) },
+	/* (2^195)*G * 9 */
+	{ LGF(0xE1675B2C, 0x39611A8F, 0x7A122549, 0xFF7E1AF2,
+	      0x7B6325F6, 0xBF6F1A75, 0x55883EDC, 0x074A5FED),
+	  LGF(0xCAFEB583, 0xF2B5C06F, 0xA1A2C97B, 0x2D0EFBE6,
+	      0x1442F46D, 0x466067CE, 0xC999DD67, 0x13349ABF),
+	  LGF(0x2D09A54C, 0xA4D40FF4, 0x16DF1800, 0xC003C77D,
+	      0xE6393676, 0xA0761711, 0x64969117, 0x2C1C0AAC) },
+	/* (2^195)*G * 10 */
+	{ LGF(0xA4EEFBF4, 0xA3062A05, 0x726FAB1E, 0xE5D5C2E0,
+	      0x531F05A1, 0x60DC0E92, 0x89936E48, 0x4643A40C),
+	  LGF(0x453A8A8A, 0x1F87C746, 0x5DA27586, 0xDDCF1D00,
+	      0xC7664BF3, 0xC77308C7, 0x6436D94B, 0x5774724E),
+	  LGF(0x6CB73C25, 0xAA14EFB7, 0x3DC2B252, 0xAFD7FD33,
+	      0xCCBF5685, 0x58B8811A, 0x0471A372, 0x1C9D11E4) },
+	/* (2^195)*G * 11 */
+	{ LGF(0x3B886BC0, 0xD13062D6, 0xB8D4C07B, 0x59FB0704,
+	      0x6A5FE90E, 0x012B93CE, 0xA4404810, 0x5884A598),
+	  LGF(0x9987EBED, 0x08A8CB0C, 0xC4D7168A, 0x05428BBD,
+	      0x0207E6AA, 0x5FDD560F, 0x2497FC6D, 0x4CD603F7),
+	  LGF(0xBAB59BD5, 0x3F08842C, 0x0024CECC, 0x1502C744,
+	      0x6BE0B6EA, 0x7241E80F, 0xFB557160, 0x6942504C) },
+	/* (2^195)*G * 12 */
+	{ LGF(0x7B7A2079, 0x94CCC8EE, 0x9368F9D1, 0x98E6462E,
+	      0x3D44A6C4, 0xF97BFF02, 0x4D545564, 0x5396F045),
+	  LGF(0x7F72D537, 0xB4754DE2, 0x2AC5B1C3, 0xC0F01E80,
+	      0x4B64FC09, 0x6492E0F0, 0xE1CDCAD1, 0x14C0F255),
+	  LGF(0x516E0A97, 0x392EB3FD, 0x05B71FB1, 0x4EC3DC56,
+	      0x7BDCED64, 0x7F75ADBF, 0xC96482D6, 0x6FC86668) },
+	/* (2^195)*G * 13 */
+	{ LGF(0xBD6BFE31, 0xEAD383AB, 0x9F6E73B8, 0xBCB0813E,
+	      0xBA25DFF8, 0xC58E3723, 0x6C6C9E5B, 0x4F9DA6DF),
+	  LGF(0xF580DF1C, 0xCF158917, 0xD3E90C45, 0x0E14A880,
+	      0xF882B1C7, 0x60D780AF, 0xED165A4B, 0x420C0614),
+	  LGF(0xB121A745, 0xCBDDA904, 0xC9A6880F, 0x31611DAE,
+	      0x31FEC743, 0xB43A2ACF, 0xE4E1F3CE, 0x5F142474) },
+	/* (2^195)*G * 14 */
+	{ LGF(0xD884B154, 0x37DADA6D, 0x051FC1FE, 0x9BD20465,
+	      0xD36E5167, 0xF618BF0E, 0x85F6BE8F, 0x6713DDBB),
+	  LGF(0xA182F658, 0xE3DF626A, 0xD410C765, 0x0AEB0A55,
+	      0x9DD03BA1, 0x645809F3, 0x5AE057DB, 0x40C86021),
+	  LGF(0xCF581D58, 0xB2C0705F, 0xFC64B6A1, 0xB136DC9F,
+	      0x919623A2, 0xB0115208, 0x83722184, 0x15D34F32) },
+	/* (2^195)*G * 15 */
+	{ LGF(0x2ECAC269, 0xA304489B, 0x3145A960, 0x8482C85F,
+	      0x2CDBD9D0, 0x4A240F13, 0x29DB3D90, 0x2AE80644),
+	  LGF(0x8436B829, 0xBA4D3B43, 0xB0906610, 0xFD932027,
+	      0x56D1C683, 0x43EFF537, 0xFF8301C5, 0x0C078789),
+	  LGF(0x0F98A082, 0x206A563B, 0xC630CCDC, 0xBFEFB28B,
+	      0x5BE2309A, 0xE3FA9751, 0x904FD7A5, 0x71698D07) },
+	/* (2^195)*G * 16 */
+	{ LGF(0x494F6306, 0x320F03CA, 0x8E79B929, 0x5AA58711,
+	      0x3C3A18CF, 0x4BAD3FD4, 0x0DF3849B, 0x255DDF7E),
+	  LGF(0x18A991C5, 0x2C949105, 0x18F00C14, 0xAAC1F71E,
+	      0x9768A122, 0x2E1D217E, 0xBB0B3E0B, 0x50A69209),
+	  LGF(0x3C888F1E, 0xF93D8C08, 0x59145CCC, 0x57112855,
+	      0x44969A4C, 0x1F0F91EC, 0x4C260615, 0x7AB91A18) }
+};
+
+#else
+#error Unknown curve
+#endif
+
+/* ===================================================================== */
+/*
+ * SECTION 5: CRYPTOGRAPHIC SCHEMES
+ *
+ * This part implements the high-level schemes (signature, key exchange...)
+ * as documented in the jq255.h API.
+ */
+
+#include "blake2s.h"
+#include "jq255.h"
+
+/*
+ * If JQ_SUFFIX is defined, then its value is appended to the names of
+ * all public functions. This allows linking together several builds of
+ * this file for the same curve, e.g. compiled with different target
+ * options; see jq255_dispatch.c.
+ */
+#ifdef JQ_SUFFIX
+#define JQ_FN_(name, sfx)    name ## sfx
+#define JQ_FN__(name, sfx)   JQ_FN_(name, sfx)
+#define JQ_FN(name)          JQ_FN__(name, JQ_SUFFIX)
+#else
+#define JQ_FN(name)          name
+#endif
+
+#if JQ == JQ255E
+#define jq_private_key            jq255e_private_key
+#define jq_public_key             jq255e_public_key
+#define jq_public_key_expanded    jq255e_public_key_expanded
+#define jq_public_key_compact     jq255e_public_key_compact
+#define jq_keypair                jq255e_keypair
+#define jq_generate_private_key   JQ_FN(jq255e_generate_private_key)
+#define jq_make_public            JQ_FN(jq255e_make_public)
+#define jq_generate_keypair       JQ_FN(jq255e_generate_keypair)
+#define jq_generate_keypairs      JQ_FN(jq255e_generate_keypairs)
+#define jq_keypool                jq255e_keypool
+#define jq_keypool_slot           jq255e_keypool_slot
+#define jq_keypool_init           JQ_FN(jq255e_keypool_init)
+#define jq_keypool_refill         JQ_FN(jq255e_keypool_refill)
+#define jq_keypool_pop            JQ_FN(jq255e_keypool_pop)
+#define jq_keypool_count          JQ_FN(jq255e_keypool_count)
+#define jq_decode_private_key     JQ_FN(jq255e_decode_private_key)
+#define jq_decode_public_key      JQ_FN(jq255e_decode_public_key)
+#define jq_decode_public_keys     JQ_FN(jq255e_decode_public_keys)
+#define jq_decode_keypair         JQ_FN(jq255e_decode_keypair)
+#define jq_keydir_size            JQ_FN(jq255e_keydir_size)
+#define jq_keydir_build           JQ_FN(jq255e_keydir_build)
+#define jq_keydir_open            JQ_FN(jq255e_keydir_open)
+#define jq_keydir_check           JQ_FN(jq255e_keydir_check)
+#define jq_encode_private_key     JQ_FN(jq255e_encode_private_key)
+#define jq_encode_public_key      JQ_FN(jq255e_encode_public_key)
+#define jq_decode_public_key_compact JQ_FN(jq255e_decode_public_key_compact)
+#define jq_compact_public_key     JQ_FN(jq255e_compact_public_key)
+#define jq_encode_public_key_compact JQ_FN(jq255e_encode_public_key_compact)
+#define jq_encode_keypair         JQ_FN(jq255e_encode_keypair)
+#define jq_sign                   JQ_FN(jq255e_sign)
+#define jq_sign_seeded            JQ_FN(jq255e_sign_seeded)
+#define jq_sign_many              JQ_FN(jq255e_sign_many)
+#define jq_signer                 jq255e_signer
+#define jq_signer_init            JQ_FN(jq255e_signer_init)
+#define jq_signer_sign            JQ_FN(jq255e_signer_sign)
+#define jq_sign_ctx               jq255e_sign_ctx
+#define jq_sign_init              JQ_FN(jq255e_sign_init)
+#define jq_sign_update            JQ_FN(jq255e_sign_update)
+#define jq_sign_final             JQ_FN(jq255e_sign_final)
+#define jq_verify                 JQ_FN(jq255e_verify)
+#define jq_verify_ctx             jq255e_verify_ctx
+#define jq_verify_init            JQ_FN(jq255e_verify_init)
+#define jq_verify_update          JQ_FN(jq255e_verify_update)
+#define jq_verify_final           JQ_FN(jq255e_verify_final)
+#define jq_verify_item            jq255e_verify_item
+#define jq_verify_batch           JQ_FN(jq255e_verify_batch)
+#define jq_verify_job             jq255e_verify_job
+#define jq_verify_queue_slot      jq255e_verify_queue_slot
+#define jq_verify_queue           jq255e_verify_queue
+#define jq_verify_queue_init      JQ_FN(jq255e_verify_queue_init)
+#define jq_verify_submit          JQ_FN(jq255e_verify_submit)
+#define jq_verify_poll            JQ_FN(jq255e_verify_poll)
+#define jq_verify_flush           JQ_FN(jq255e_verify_flush)
+#define jq_expand_public_key      JQ_FN(jq255e_expand_public_key)
+#define jq_verify_expanded        JQ_FN(jq255e_verify_expanded)
+#define jq_verify_compact         JQ_FN(jq255e_verify_compact)
+#define jq_ECDH                   JQ_FN(jq255e_ECDH)
+#define jq_ECDH_compact           JQ_FN(jq255e_ECDH_compact)
+#define jq_ECDH_many              JQ_FN(jq255e_ECDH_many)
+#define jq_ECDH_self              jq255e_ECDH_self
+#define jq_ECDH_peer              jq255e_ECDH_peer
+#define jq_ECDH_prepare_self      JQ_FN(jq255e_ECDH_prepare_self)
+#define jq_ECDH_prepare_peer      JQ_FN(jq255e_ECDH_prepare_peer)
+#define jq_ECDH_prepared          JQ_FN(jq255e_ECDH_prepared)
+#define jq_point                  jq255e_point
+#define jq_scalar                 jq255e_scalar
+#define jq_scalar_decode          JQ_FN(jq255e_scalar_decode)
+#define jq_scalar_decode_reduce   JQ_FN(jq255e_scalar_decode_reduce)
+#define jq_scalar_encode          JQ_FN(jq255e_scalar_encode)
+#define jq_point_decode           JQ_FN(jq255e_point_decode)
+#define jq_point_encode           JQ_FN(jq255e_point_encode)
+#define jq_point_from_public_key  JQ_FN(jq255e_point_from_public_key)
+#define jq_point_add              JQ_FN(jq255e_point_add)
+#define jq_point_mul_vartime      JQ_FN(jq255e_point_mul_vartime)
+#define jq_point_mulgen_vartime   JQ_FN(jq255e_point_mulgen_vartime)
+#define jq_point_msm_vartime      JQ_FN(jq255e_point_msm_vartime)
+#define jq_scalar_from_private_key JQ_FN(jq255e_scalar_from_private_key)
+#define jq_private_key_from_scalar JQ_FN(jq255e_private_key_from_scalar)
+#define jq_scalar_add             JQ_FN(jq255e_scalar_add)
+#define jq_scalar_sub             JQ_FN(jq255e_scalar_sub)
+#define jq_scalar_neg             JQ_FN(jq255e_scalar_neg)
+#define jq_scalar_mul             JQ_FN(jq255e_scalar_mul)
+#define jq_point_to_public_key    JQ_FN(jq255e_point_to_public_key)
+#define jq_point_neg              JQ_FN(jq255e_point_neg)
+#define jq_point_sub              JQ_FN(jq255e_point_sub)
+#define jq_point_double           JQ_FN(jq255e_point_double)
+#define jq_point_mul              JQ_FN(jq255e_point_mul)
+#define jq_point_mulgen           JQ_FN(jq255e_point_mulgen)
+#define jq_point_equals           JQ_FN(jq255e_point_equals)
+#define jq_point_is_neutral       JQ_FN(jq255e_point_is_neutral)
+#define jq_tables                 jq255e_tables
+#define jq_tables_size            JQ_FN(jq255e_tables_size)
+#define jq_tables_clone           JQ_FN(jq255e_tables_clone)
+#define jq_tables_use             JQ_FN(jq255e_tables_use)
+#define jq_stats_snapshot         JQ_FN(jq255e_stats_snapshot)
+#define jq_stats_reset            JQ_FN(jq255e_stats_reset)
+#elif JQ == JQ255S
+#define jq_private_key            jq255s_private_key
+#define jq_public_key             jq255s_public_key
+#define jq_public_key_expanded    jq255s_public_key_expanded
+#define jq_public_key_compact     jq255s_public_key_compact
+#define jq_keypair                jq255s_keypair
+#define jq_generate_private_key   JQ_FN(jq255s_generate_private_key)
+#define jq_make_public            JQ_FN(jq255s_make_public)
+#define jq_generate_keypair       JQ_FN(jq255s_generate_keypair)
+#define jq_generate_keypairs      JQ_FN(jq255s_generate_keypairs)
+#define jq_keypool                jq255s_keypool
+#define jq_keypool_slot           jq255s_keypool_slot
+#define jq_keypool_init           JQ_FN(jq255s_keypool_init)
+#define jq_keypool_refill         JQ_FN(jq255s_keypool_refill)
+#define jq_keypool_pop            JQ_FN(jq255s_keypool_pop)
+#define jq_keypool_count          JQ_FN(jq255s_keypool_count)
+#define jq_decode_private_key     JQ_FN(jq255s_decode_private_key)
+#define jq_decode_public_key      JQ_FN(jq255s_decode_public_key)
+#define jq_decode_public_keys     JQ_FN(jq255s_decode_public_keys)
+#define jq_decode_keypair         JQ_FN(jq255s_decode_keypair)
+#define jq_keydir_size            JQ_FN(jq255s_keydir_size)
+#define jq_keydir_build           JQ_FN(jq255s_keydir_build)
+#define jq_keydir_open            JQ_FN(jq255s_keydir_open)
+#define jq_keydir_check           JQ_FN(jq255s_keydir_check)
+#define jq_encode_private_key     JQ_FN(jq255s_encode_private_key)
+#define jq_encode_public_key      JQ_FN(jq255s_encode_public_key)
+#define jq_decode_public_key_compact JQ_FN(jq255s_decode_public_key_compact)
+#define jq_compact_public_key     JQ_FN(jq255s_compact_public_key)
+#define jq_encode_public_key_compact JQ_FN(jq255s_encode_public_key_compact)
+#define jq_encode_keypair         JQ_FN(jq255s_encode_keypair)
+#define jq_sign                   JQ_FN(jq255s_sign)
+#define jq_sign_seeded            JQ_FN(jq255s_sign_seeded)
+#define jq_sign_many              JQ_FN(jq255s_sign_many)
+#define jq_signer                 jq255s_signer
+#define jq_signer_init            JQ_FN(jq255s_signer_init)
+#define jq_signer_sign            JQ_FN(jq255s_signer_sign)
+#define jq_sign_ctx               jq255s_sign_ctx
+#define jq_sign_init              JQ_FN(jq255s_sign_init)
+#define jq_sign_update            JQ_FN(jq255s_sign_update)
+#define jq_sign_final             JQ_FN(jq255s_sign_final)
+#define jq_verify                 JQ_FN(jq255s_verify)
+#define jq_verify_ctx             jq255s_verify_ctx
+#define jq_verify_init            JQ_FN(jq255s_verify_init)
+#define jq_verify_update          JQ_FN(jq255s_verify_update)
+#define jq_verify_final           JQ_FN(jq255s_verify_final)
+#define jq_verify_item            jq255s_verify_item
+#define jq_verify_batch           JQ_FN(jq255s_verify_batch)
+#define jq_verify_job             jq255s_verify_job
+#define jq_verify_queue_slot      jq255s_verify_queue_slot
+#define jq_verify_queue           jq255s_verify_queue
+#define jq_verify_queue_init      JQ_FN(jq255s_verify_queue_init)
+#define jq_verify_submit          JQ_FN(jq255s_verify_submit)
+#define jq_verify_poll            JQ_FN(jq255s_verify_poll)
+#define jq_verify_flush           JQ_FN(jq255s_verify_flush)
+#define jq_expand_public_key      JQ_FN(jq255s_expand_public_key)
+#define jq_verify_expanded        JQ_FN(jq255s_verify_expanded)
+#define jq_verify_compact         JQ_FN(jq255s_verify_compact)
+#define jq_ECDH                   JQ_FN(jq255s_ECDH)
+#define jq_ECDH_compact           JQ_FN(jq255s_ECDH_compact)
+#define jq_ECDH_many              JQ_FN(jq255s_ECDH_many)
+#define jq_ECDH_self              jq255s_ECDH_self
+#define jq_ECDH_peer              jq255s_ECDH_peer
+#define jq_ECDH_prepare_self      JQ_FN(jq255s_ECDH_prepare_self)
+#define jq_ECDH_prepare_peer      JQ_FN(jq255s_ECDH_prepare_peer)
+#define jq_ECDH_prepared          JQ_FN(jq255s_ECDH_prepared)
+#define jq_point                  jq255s_point
+#define jq_scalar                 jq255s_scalar
+#define jq_scalar_decode          JQ_FN(jq255s_scalar_decode)
+#define jq_scalar_decode_reduce   JQ_FN(jq255s_scalar_decode_reduce)
+#define jq_scalar_encode          JQ_FN(jq255s_scalar_encode)
+#define jq_point_decode           JQ_FN(jq255s_point_decode)
+#define jq_point_encode           JQ_FN(jq255s_point_encode)
+#define jq_point_from_public_key  JQ_FN(jq255s_point_from_public_key)
+#define jq_point_add              JQ_FN(jq255s_point_add)
+#define jq_point_mul_vartime      JQ_FN(jq255s_point_mul_vartime)
+#define jq_point_mulgen_vartime   JQ_FN(jq255s_point_mulgen_vartime)
+#define jq_point_msm_vartime      JQ_FN(jq255s_point_msm_vartime)
+#define jq_scalar_from_private_key JQ_FN(jq255s_scalar_from_private_key)
+#define jq_private_key_from_scalar JQ_FN(jq255s_private_key_from_scalar)
+#define jq_scalar_add             JQ_FN(jq255s_scalar_add)
+#define jq_scalar_sub             JQ_FN(jq255s_scalar_sub)
+#define jq_scalar_neg             JQ_FN(jq255s_scalar_neg)
+#define jq_scalar_mul             JQ_FN(jq255s_scalar_mul)
+#define jq_point_to_public_key    JQ_FN(jq255s_point_to_public_key)
+#define jq_point_neg              JQ_FN(jq255s_point_neg)
+#define jq_point_sub              JQ_FN(jq255s_point_sub)
+#define jq_point_double           JQ_FN(jq255s_point_double)
+#define jq_point_mul              JQ_FN(jq255s_point_mul)
+#define jq_point_mulgen           JQ_FN(jq255s_point_mulgen)
+#define jq_point_equals           JQ_FN(jq255s_point_equals)
+#define jq_point_is_neutral       JQ_FN(jq255s_point_is_neutral)
+#define jq_tables                 jq255s_tables
+#define jq_tables_size            JQ_FN(jq255s_tables_size)
+#define jq_tables_clone           JQ_FN(jq255s_tables_clone)
+#define jq_tables_use             JQ_FN(jq255s_tables_use)
+#define jq_stats_snapshot         JQ_FN(jq255s_stats_snapshot)
+#define jq_stats_reset            JQ_FN(jq255s_stats_reset)
+#else
+#error Unknown curve
+#endif
+
+#ifdef JQ_SUFFIX
+/*
+ * Public functions that are called before their definition need a
+ * prototype under their suffixed name.
+ */
+void jq_compact_public_key(jq_public_key_compact *cpk,
+	const jq_public_key *pk);
+size_t jq_sign_seeded(void *sig, const jq_keypair *jk,
+	const char *hash_name, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len);
+#endif
+
+/*
+ * A private key is a scalar; a public key is a point, and its encoded
+ * version (32 bytes). The API structure contains blobs into which we
+ * copy our internal structures when approprivate.
+ * In some cases, we get "invalid key" values. They use the following
+ * representations:
+ *  - Invalid private key: the scalar value is zero.
+ *  - Invalid public key: the point is
+ *    original invalid encoding is kept in the slot for the Z coordinate.
+ *  - Invalid compact public key: the top bit of the last byte is set
+ *    (this is never the case for a valid encoding, since q < 2^255).
+ */
+
+/* see jq255.h */
+void
+jq_generate_private_key(jq_private_key *sk, const void *seed, size_t seed_len)
+{
+	blake2s_context bc;
+	uint8_t tmp[32];
+	scalar s;
+
+	/* Hash the seed to produce 32 bytes, which are then decoded as a
+	   scalar. */
+	blake2s_init(&bc, 32);
+	blake2s_update(&bc, seed, seed_len);
+	blake2s_final(&bc, tmp);
+	scalar_decode_reduce(&s, tmp, 32);
+
+	/* It is very improbable that a zero is obtained, but just for
+	   completeness, in that case, we add 1. */
+	scalar_select(&s, &s, &scalar_one, scalar_is_zero(&s));
+	memcpy(sk, &s, sizeof s);
+}
+
+/* see jq255.h */
+void
+jq_make_public(jq_public_key *pk, const jq_private_key *sk)
+{
+	scalar s;
+	point p;
+
+	memcpy(&s, sk, sizeof s);
+	point_mulgen(&p, &s);
+	memcpy(pk, &p, sizeof p);
+	point_encode((unsigned char *)pk + sizeof p, &p);
+}
+
+/* see jq255.h */
+void
+jq_generate_keypair(jq_keypair *jk, const void *seed, size_t seed_len)
+{
+	jq_generate_private_key(&jk->private_key, seed, seed_len);
+	jq_make_public(&jk->public_key, &jk->private_key);
+}
+
+/* see jq255.h */
+void
+jq_generate_keypairs(jq_keypair *jk, const void *const *seeds,
+	const size_t *seed_len, size_t n)
+{
+	/*
+	 * Key pairs are processed in chunks of POINT_BATCH: the base point
+	 * multiplications use the batch (possibly 8-way) implementation,
+	 * and the encoding of the public keys shares a single inversion.
+	 */
+	for (size_t i = 0; i < n; i += POINT_BATCH) {
+		scalar s[POINT_BATCH];
+		point p[POINT_BATCH];
+		uint8_t enc[POINT_BATCH * 32];
+		size_t m;
+
+		m = n - i;
+		if (m > POINT_BATCH) {
+			m = POINT_BATCH;
+		}
+		for (size_t j = 0; j < m; j ++) {
+			jq_generate_private_key(&jk[i + j].private_key,
+				seeds[i + j], seed_len[i + j]);
+			memcpy(&s[j], &jk[i + j].private_key, sizeof s[j]);
+		}
+		point_mulgen_batch(p, s, m);
+		point_encode_batch(enc, p, m);
+		for (size_t j = 0; j < m; j ++) {
+			uint8_t *pk = (uint8_t *)&jk[i + j].public_key;
+
+			memcpy(pk, &p[j], sizeof p[j]);
+			memcpy(pk + sizeof p[j], enc + 32 * j, 32);
+		}
+	}
+}
+
+/*
+ * Ephemeral key pool.
+ *
+ * The pool is a bounded multi-producer multi-consumer ring: each slot
+ * has a sequence number, which tells whether the slot is ready to be
+ * filled (sequence equal to the push position) or to be taken
+ * (sequence equal to the pop position plus one). A thread claims a
+ * position with a compare-and-swap on the head or tail counter, then
+ * accesses the slot contents and publishes the new sequence number
+ * with a release store. No lock is ever taken; a thread that fails to
+ * claim a position retries with the updated counter.
+ *
+ * Counters are 64-bit and never wrap in practice.
+ */
+
+#if defined __GNUC__ || defined __clang__
+
+static inline uint64_t
+keypool_load(uint64_t *p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void
+keypool_store(uint64_t *p, uint64_t x)
+{
+	__atomic_store_n(p, x, __ATOMIC_RELEASE);
+}
+
+static inline int
+keypool_cas(uint64_t *p, uint64_t *old, uint64_t x)
+{
+	return __atomic_compare_exchange_n(p, old, x, 1,
+		__ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t
+keypool_fetch_add(uint64_t *p, uint64_t x)
+{
+	return __atomic_fetch_add(p, x, __ATOMIC_RELAXED);
+}
+
+#elif defined _MSC_VER
+
+#include <intrin.h>
+
+/* The interlocked functions are full barriers. */
+static inline uint64_t
+keypool_load(uint64_t *p)
+{
+	return (uint64_t)_InterlockedCompareExchange64(
+		(volatile __int64 *)p, 0, 0);
+}
+
+static inline void
+keypool_store(uint64_t *p, uint64_t x)
+{
+	_InterlockedExchange64((volatile __int64 *)p, (__int64)x);
+}
+
+static inline int
+keypool_cas(uint64_t *p, uint64_t *old, uint64_t x)
+{
+	uint64_t r;
+
+	r = (uint64_t)_InterlockedCompareExchange64(
+		(volatile __int64 *)p, (__int64)x, (__int64)*old);
+	if (r == *old) {
+		return 1;
+	}
+	*old = r;
+	return 0;
+}
+
+static inline uint64_t
+keypool_fetch_add(uint64_t *p, uint64_t x)
+{
+	return (uint64_t)_InterlockedExchangeAdd64(
+		(volatile __int64 *)p, (__int64)x);
+}
+
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 201112L \
+	&& !defined __STDC_NO_ATOMICS__
+
+#include <stdatomic.h>
+
+static inline uint64_t
+keypool_load(uint64_t *p)
+{
+	return atomic_load_explicit((_Atomic uint64_t *)p,
+		memory_order_acquire);
+}
+
+static inline void
+keypool_store(uint64_t *p, uint64_t x)
+{
+	atomic_store_explicit((_Atomic uint64_t *)p, x,
+		memory_order_release);
+}
+
+static inline int
+keypool_cas(uint64_t *p, uint64_t *old, uint64_t x)
+{
+	return atomic_compare_exchange_weak_explicit((_Atomic uint64_t *)p,
+		old, x, memory_order_relaxed, memory_order_relaxed);
+}
+
+static inline uint64_t
+keypool_fetch_add(uint64_t *p, uint64_t x)
+{
+	return atomic_fetch_add_explicit((_Atomic uint64_t *)p, x,
+		memory_order_relaxed);
+}
+
+#else
+#error No atomic operations available for the key pool
+#endif
+
+/*
+ * Clear some memory that held secret values. The volatile accesses
+ * prevent the compiler from removing the stores as dead.
+ */
+static void
+wipe_memory(void *dst, size_t len)
+{
+	volatile uint8_t *d = dst;
+
+	while (len -- > 0) {
+		*d ++ = 0;
+	}
+}
+
+/*
+ * Internal layout of the pool and of its slots. The head (pop side)
+ * and tail (push side) counters are kept in distinct cache lines so
+ * that consumers and producers do not contend on the same line.
+ */
+typedef struct {
+	jq_keypair jk;
+	uint64_t seq;
+} keypool_slot;
+
+typedef struct {
+	uint64_t head;
+	uint8_t pad1[56];
+	uint64_t tail;
+	uint8_t pad2[56];
+	uint64_t ctr;
+	uint64_t mask;
+	keypool_slot *slots;
+} keypool;
+
+typedef char keypool_slot_size_check[
+	sizeof(keypool_slot) <= sizeof(jq_keypool_slot) ? 1 : -1];
+typedef char keypool_size_check[
+	sizeof(keypool) <= sizeof(jq_keypool) ? 1 : -1];
+
+/*
+ * Get the number of keys currently in the pool. With concurrent
+ * accesses, this is only an approximation.
+ */
+static uint64_t
+keypool_num(keypool *kp)
+{
+	uint64_t head, tail;
+
+	head = keypool_load(&kp->head);
+	tail = keypool_load(&kp->tail);
+	if (tail < head) {
+		return 0;
+	}
+	if (tail - head > kp->mask + 1) {
+		return kp->mask + 1;
+	}
+	return tail - head;
+}
+
+/*
+ * Push a key pair into the pool. Returned value is 1 on success, 0 if
+ * the pool is full.
+ */
+static int
+keypool_push(keypool *kp, const jq_keypair *jk)
+{
+	keypool_slot *sl;
+	uint64_t pos;
+
+	pos = keypool_load(&kp->tail);
+	for (;;) {
+		uint64_t seq;
+
+		sl = &kp->slots[pos & kp->mask];
+		seq = keypool_load(&sl->seq);
+		if (seq == pos) {
+			if (keypool_cas(&kp->tail, &pos, pos + 1)) {
+				break;
+			}
+		} else if ((int64_t)(seq - pos) < 0) {
+			return 0;
+		} else {
+			pos = keypool_load(&kp->tail);
+		}
+	}
+	sl->jk = *jk;
+	keypool_store(&sl->seq, pos + 1);
+	return 1;
+}
+
+/* see jq255.h */
+int
+jq_keypool_init(jq_keypool *pool, jq_keypool_slot *slots, size_t capacity)
+{
+	keypool *kp;
+	keypool_slot *sl;
+
+	if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+		return 0;
+	}
+	kp = (keypool *)pool;
+	sl = (keypool_slot *)slots;
+	memset(kp, 0, sizeof *kp);
+	kp->mask = (uint64_t)capacity - 1;
+	kp->slots = sl;
+	for (size_t i = 0; i < capacity; i ++) {
+		memset(&sl[i].jk, 0, sizeof sl[i].jk);
+		sl[i].seq = (uint64_t)i;
+	}
+	return 1;
+}
+
+/* see jq255.h */
+size_t
+jq_keypool_refill(jq_keypool *pool,
+	const void *seed, size_t seed_len, size_t max)
+{
+	keypool *kp;
+	blake2s_context bc;
+	uint8_t ks[POINT_BATCH][40];
+	const void *ksp[POINT_BATCH];
+	size_t ksl[POINT_BATCH];
+	jq_keypair jk[POINT_BATCH];
+	size_t added;
+
+	/*
+	 * The caller seed is hashed into 32 bytes; the seed of each key
+	 * is that hash followed by a pool-wide 64-bit counter, so that
+	 * all keys are distinct even if a refill seed is reused.
+	 */
+	kp = (keypool *)pool;
+	blake2s_init(&bc, 32);
+	blake2s_update(&bc, seed, seed_len);
+	blake2s_final(&bc, ks[0]);
+	for (size_t j = 0; j < POINT_BATCH; j ++) {
+		memcpy(ks[j], ks[0], 32);
+		ksp[j] = ks[j];
+		ksl[j] = sizeof ks[j];
+	}
+
+	added = 0;
+	while (added < max) {
+		uint64_t ctr, room;
+		size_t m, j;
+
+		/* Do not generate keys that would not fit. */
+		room = kp->mask + 1 - keypool_num(kp);
+		m = max - added;
+		if (m > POINT_BATCH) {
+			m = POINT_BATCH;
+		}
+		if ((uint64_t)m > room) {
+			m = (size_t)room;
+		}
+		if (m == 0) {
+			break;
+		}
+		ctr = keypool_fetch_add(&kp->ctr, (uint64_t)m);
+		for (j = 0; j < m; j ++) {
+			uint64_t x = ctr + (uint64_t)j;
+
+			enc32le(ks[j] + 32, (uint32_t)x);
+			enc32le(ks[j] + 36, (uint32_t)(x >> 32));
+		}
+		jq_generate_keypairs(jk, ksp, ksl, m);
+		for (j = 0; j < m; j ++) {
+			if (!keypool_push(kp, &jk[j])) {
+				break;
+			}
+		}
+		added += j;
+		wipe_memory(jk, m * sizeof jk[0]);
+		if (j < m) {
+			/* Other producers filled the pool first. */
+			break;
+		}
+	}
+	wipe_memory(ks, sizeof ks);
+	wipe_memory(&bc, sizeof bc);
+	return added;
+}
+
+/* see jq255.h */
+int
+jq_keypool_pop(jq_keypool *pool, jq_keypair *jk)
+{
+	keypool *kp;
+	keypool_slot *sl;
+	uint64_t pos;
+
+	kp = (keypool *)pool;
+	pos = keypool_load(&kp->head);
+	for (;;) {
+		uint64_t seq;
+
+		sl = &kp->slots[pos & kp->mask];
+		seq = keypool_load(&sl->seq);
+		if (seq == pos + 1) {
+			if (keypool_cas(&kp->head, &pos, pos + 1)) {
+				break;
+			}
+		} else if ((int64_t)(seq - (pos + 1)) < 0) {
+			return 0;
+		} else {
+			pos = keypool_load(&kp->head);
+		}
+	}
+	*jk = sl->jk;
+	wipe_memory(&sl->jk, sizeof sl->jk);
+	keypool_store(&sl->seq, pos + kp->mask + 1);
+	return 1;
+}
+
+/* see jq255.h */
+size_t
+jq_keypool_count(jq_keypool *pool)
+{
+	return (size_t)keypool_num((keypool *)pool);
+}
+
+/* see jq255.h */
+int
+jq_decode_private_key(jq_private_key *sk, const void *src, size_t len)
+{
+	scalar s;
+	uint32_t r;
+
+	if (len != 32) {
+		s = scalar_zero;
+		r = 0;
+	} else {
+		r = scalar_decode(&s, src);
+		r &= ~scalar_is_zero(&s);
+	}
+	memcpy(sk, &s, sizeof s);
+	return (int)(r & 1);
+}
+
+/* see jq255.h */
+int
+jq_decode_public_key(jq_public_key *pk, const void *src, size_t len)
+{
+	point p;
+	uint32_t r;
+
+	if (len != 32) {
+		p = point_neutral;
+		memset((unsigned char *)pk + sizeof p, 0, 32);
+		r = 0;
+	} else {
+		r = point_decode(&p, src);
+		r &= ~point_is_neutral(&p);
+		memcpy((unsigned char *)pk + sizeof p, src, 32);
+	}
+	memcpy(pk, &p, sizeof p);
+	return (int)(r & 1);
+}
+
+/* see jq255.h */
+int
+jq_decode_public_keys(jq_public_key *pk, const void *src, size_t n,
+	uint8_t *ok)
+{
+	const uint8_t *buf = src;
+	uint32_t rr = 0xFFFFFFFF;
+
+	memset(ok, 0, (n + 7) >> 3);
+	for (size_t i = 0; i < n; i += 2) {
+		point p[2];
+		uint32_t r[2];
+		size_t m = n - i;
+
+		if (m >= 2) {
+			m = 2;
+			point_decode_x2(p, r, buf + 32 * i);
+		} else {
+			r[0] = point_decode(&p[0], buf + 32 * i);
+		}
+		for (size_t j = 0; j < m; j ++) {
+			size_t k = i + j;
+
+			r[j] &= ~point_is_neutral(&p[j]);
+			memcpy(&pk[k], &p[j], sizeof p[j]);
+			memcpy((unsigned char *)&pk[k] + sizeof p[j],
+				buf + 32 * k, 32);
+			ok[k >> 3] |= (uint8_t)((r[j] & 1) << (k & 7));
+			rr &= r[j];
+		}
+	}
+	return (int)(rr & 1);
+}
+
+/*
+ * Key directory layout (see jq255.h). Records are built by chunks of
+ * KEYDIR_CHUNK keys, decoded with jq_decode_public_keys().
+ */
+#define KEYDIR_VERSION   1
+#define KEYDIR_CHUNK     64
+
+typedef char keydir_record_size_check[
+	sizeof(jq_public_key) == JQ255_KEYDIR_RECORD_LEN ? 1 : -1];
+
+static void
+keydir_enc64le(uint8_t *dst, uint64_t x)
+{
+	enc32le(dst, (uint32_t)x);
+	enc32le(dst + 4, (uint32_t)(x >> 32));
+}
+
+static uint64_t
+keydir_dec64le(const uint8_t *src)
+{
+	return (uint64_t)dec32le(src) | ((uint64_t)dec32le(src + 4) << 32);
+}
+
+/*
+ * Compute the records digest of a key directory with n records.
+ */
+static void
+keydir_digest(uint8_t *out, const uint8_t *rec, size_t n)
+{
+	blake2s_context bc;
+
+	blake2s_init(&bc, 16);
+	blake2s_update(&bc, rec, n * JQ255_KEYDIR_RECORD_LEN);
+	blake2s_final(&bc, out);
+}
+
+/*
+ * Compute the header checksum (over the first 56 bytes of the header).
+ */
+static void
+keydir_checksum(uint8_t *out, const uint8_t *hdr)
+{
+	blake2s_context bc;
+
+	blake2s_init(&bc, 8);
+	blake2s_update(&bc, hdr, 56);
+	blake2s_final(&bc, out);
+}
+
+/* see jq255.h */
+size_t
+jq_keydir_size(size_t n)
+{
+	return JQ255_KEYDIR_HEADER_LEN + n * JQ255_KEYDIR_RECORD_LEN;
+}
+
+/* see jq255.h */
+size_t
+jq_keydir_build(void *dst, const void *src, size_t n)
+{
+	uint8_t *hdr = dst;
+	uint8_t *rec = hdr + JQ255_KEYDIR_HEADER_LEN;
+	const uint8_t *buf = src;
+	size_t num_valid;
+
+	num_valid = 0;
+	for (size_t i = 0; i < n; i += KEYDIR_CHUNK) {
+		jq_public_key pk[KEYDIR_CHUNK];
+		uint8_t ok[KEYDIR_CHUNK >> 3];
+		size_t m = n - i;
+
+		if (m > KEYDIR_CHUNK) {
+			m = KEYDIR_CHUNK;
+		}
+		jq_decode_public_keys(pk, buf + 32 * i, m, ok);
+		for (size_t j = 0; j < m; j ++) {
+			uint8_t *r = rec + (i + j) * JQ255_KEYDIR_RECORD_LEN;
+			point p;
+
+			/* Coordinates are stored fully reduced, so that
+			   records are valid for both the 32-bit and the
+			   64-bit implementations. */
+			memcpy(&p, &pk[j], sizeof p);
+			gf_encode(r, &p.E);
+			gf_encode(r + 32, &p.Z);
+			gf_encode(r + 64, &p.U);
+			gf_encode(r + 96, &p.T);
+			memcpy(r + 128, (const uint8_t *)&pk[j] + sizeof p, 32);
+			num_valid += (ok[j >> 3] >> (j & 7)) & 1;
+		}
+	}
+
+	memcpy(hdr, "JQKEYDIR", 8);
+	enc32le(hdr + 8, KEYDIR_VERSION);
+	enc32le(hdr + 12, JQ);
+	enc32le(hdr + 16, JQ255_KEYDIR_RECORD_LEN);
+	enc32le(hdr + 20, 0);
+	keydir_enc64le(hdr + 24, (uint64_t)n);
+	keydir_enc64le(hdr + 32, (uint64_t)num_valid);
+	keydir_digest(hdr + 40, rec, n);
+	keydir_checksum(hdr + 56, hdr);
+	return num_valid;
+}
+
+/*
+ * Check a key directory header against the buffer length; on success,
+ * the number of records is written in *n and 1 is returned.
+ */
+static int
+keydir_check_header(const uint8_t *hdr, size_t len, size_t *n)
+{
+	uint8_t tmp[8];
+	uint64_t num;
+
+	if (len < JQ255_KEYDIR_HEADER_LEN) {
+		return 0;
+	}
+	keydir_checksum(tmp, hdr);
+	if (memcmp(hdr, "JQKEYDIR", 8) != 0
+		|| memcmp(tmp, hdr + 56, 8) != 0
+		|| dec32le(hdr + 8) != KEYDIR_VERSION
+		|| dec32le(hdr + 12) != JQ
+		|| dec32le(hdr + 16) != JQ255_KEYDIR_RECORD_LEN)
+	{
+		return 0;
+	}
+	num = keydir_dec64le(hdr + 24);
+	if (num > (uint64_t)(len - JQ255_KEYDIR_HEADER_LEN)
+		/ JQ255_KEYDIR_RECORD_LEN)
+	{
+		return 0;
+	}
+	*n = (size_t)num;
+	return 1;
+}
+
+/* see jq255.h */
+const jq_public_key *
+jq_keydir_open(const void *buf, size_t len, size_t *n)
+{
+	static const uint32_t one = 1;
+	size_t num;
+
+	/* Records are used in place, which requires the in-memory
+	   layout of a public key to match the file format. */
+	if (*(const uint8_t *)&one != 1 || ((uintptr_t)buf & 7) != 0) {
+		return NULL;
+	}
+	if (!keydir_check_header(buf, len, &num)) {
+		return NULL;
+	}
+	*n = num;
+	return (const jq_public_key *)(const void *)
+		((const uint8_t *)buf + JQ255_KEYDIR_HEADER_LEN);
+}
+
+/* see jq255.h */
+int
+jq_keydir_check(const void *buf, size_t len)
+{
+	const uint8_t *hdr = buf;
+	uint8_t tmp[16];
+	size_t num;
+
+	if (!keydir_check_header(hdr, len, &num)) {
+		return 0;
+	}
+	keydir_digest(tmp, hdr + JQ255_KEYDIR_HEADER_LEN, num);
+	return memcmp(tmp, hdr + 40, 16) == 0;
+}
+
+/* see jq255.h */
+int
+jq_decode_keypair(jq_keypair *jk, const void *src, size_t len)
+{
+	uint32_t r;
+	scalar s;
+	point p;
+
+	if (len != 64) {
+		memcpy(&jk->private_key, &scalar_zero, sizeof scalar_zero);
+		memcpy(&jk->public_key, &point_neutral, sizeof point_neutral);
+		memset((unsigned char *)&jk->public_key + sizeof(point), 0, 32);
+		return 0;
+	}
+	r = scalar_decode(&s, src);
+	r &= ~scalar_is_zero(&s);
+	r &= point_decode(&p, (const uint8_t *)src + 32);
+	r &= ~point_is_neutral(&p);
+	scalar_select(&s, &scalar_zero, &s, r);
+	point_select(&p, &point_neutral, &p, r);
+	memcpy(&jk->private_key, &s, sizeof s);
+	memcpy(&jk->public_key, &p, sizeof p);
+	memcpy((unsigned char *)&jk->public_key + sizeof(point),
+		(const uint8_t *)src + 32, 32);
+	return (int)(r & 1);
+}
+
+/* see jq255.h */
+size_t
+jq_encode_private_key(void *dst, const jq_private_key *sk)
+{
+	scalar s;
+
+	memcpy(&s, sk, sizeof s);
+	scalar_encode(dst, &s);
+	return 32;
+}
+
+/* see jq255.h */
+size_t
+jq_encode_public_key(void *dst, const jq_public_key *pk)
+{
+	uint8_t tmp[32];
+	point p;
+	uint32_t r;
+
+	/* If the key is valid, then we already have a copy of its encoding,
+	   so we can just copy that value. If the key is invalid, then
+	   the encoding is invalid and we must produce from zeros. */
+	memcpy(&p, pk, sizeof p);
+	memcpy(tmp, (const uint8_t *)pk + sizeof(point), 32);
+	r = ~point_is_neutral(&p);
+	for (int i = 0; i < 32; i ++) {
+		tmp[i] &= r;
+	}
+	memcpy(dst, tmp, 32);
+	return 32;
+}
+
+/* see jq255.h */
+int
+jq_decode_public_key_compact(jq_public_key_compact *cpk,
+	const void *src, size_t len)
+{
+	jq_public_key pk;
+	int r;
+
+	r = jq_decode_public_key(&pk, src, len);
+	jq_compact_public_key(cpk, &pk);
+	return r;
+}
+
+/* see jq255.h */
+void
+jq_compact_public_key(jq_public_key_compact *cpk, const jq_public_key *pk)
+{
+	point p;
+	uint32_t bad;
+
+	/* Keep the encoding; for an invalid key, the top bit is forced,
+	   so that the compact key never decodes. */
+	memcpy(&p, pk, sizeof p);
+	memcpy(cpk->b, (const uint8_t *)pk + sizeof(point), 32);
+	bad = point_is_neutral(&p);
+	cpk->b[31] |= (uint8_t)(bad & 0x80);
+}
+
+/* see jq255.h */
+size_t
+jq_encode_public_key_compact(void *dst, const jq_public_key_compact *cpk)
+{
+	uint8_t tmp[32];
+	uint32_t r;
+
+	r = (uint32_t)(cpk->b[31] >> 7) - 1;
+	for (int i = 0; i < 32; i ++) {
+		tmp[i] = cpk->b[i] & r;
+	}
+	memcpy(dst, tmp, 32);
+	return 32;
+}
+
+/* see jq255.h */
+size_t
+jq_encode_keypair(void *dst, const jq_keypair *jk)
+{
+	jq_encode_private_key(dst, &jk->private_key);
+	jq_encode_public_key((uint8_t *)dst + 32, &jk->public_key);
+	return 64;
+}
+
+/*
+ * Hash function identifier, as hashed by make_sign_k() and
+ * make_challenge(): a single byte 0x52 in raw mode, or a byte 0x48
+ * followed by the name and its terminating zero. The name length is
+ * obtained once per API call with hash_tag_init(), and the tag is then
+ * shared by all the hashes of that call.
+ */
+typedef struct {
+	const char *name;
+	size_t len;       /* including the terminating zero; 0 in raw mode */
+} hash_tag;
+
+static void
+hash_tag_init(hash_tag *ht, const char *hash_name)
+{
+	ht->name = hash_name;
+	if (hash_name == NULL || hash_name[0] == 0) {
+		ht->len = 0;
+	} else {
+		ht->len = strlen(hash_name) + 1;
+	}
+}
+
+/* Tag for BLAKE2s, used by the streaming API. */
+static const hash_tag hash_tag_blake2s = {
+	JQ255_HASHNAME_BLAKE2S, sizeof JQ255_HASHNAME_BLAKE2S
 };
 
-/* Points i*(2^65)*G for i = 1 to 16, affine extended format */
-static const point_affine point_win_base65[] = {
-	/* (2^65)*G * 1 */
-	{ LGF(0x8E08211F, 0x886FF627, 0xF94734AB, 0x4629856E,
-	      0xB41DD08C, 0xAB3BAC1A, 0x634A53B5, 0x6CE0B77B),
-	  LGF(0xC596FA71, 0xAD5F8FBF, 0x9DE223FF, 0x41589354,
-	      0xE50A4384, 0x395D2181, 0xA8A7626E, 0x1B313D36),
-	  LGF(0xEB9D832B, 0x17E71DD1, 0xD599D9CB, 0x222B7C0C,
-	      0xFF13EC0E, 0x48E8393C, 0x21A5AAD2, 0x6E78594A) },
-	/* (2^65)*G * 2 */
-	{ LGF(0x2716A209, 0x111922C7, 0x3417B3E6, 0xE4584C1E,
-	      0xCE6C2582, 0x8AA629F4, 0x8DD93292, 0x7521310F),
-	  LGF(0x889E3F33, 0x2B7C2F71, 0xA5E65CF4, 0x4CA4C049,
-	      0x9976BFE7, 0x5CD27D90, 0x9985D602, 0x0BE56F35),
-	  LGF(0x1BE2027B, 0xC699D8CD, 0x19ECC70E, 0xC9233D82,
-	      0xABAECD17, 0x6C805A5D, 0x6985620E, 0x40534B30) },
-	/* (2^65)*G * 3 */
-	{ LGF(0xD6A45A0E, 0x33F6746E, 0xCDA92791, 0x5A40972F,
-	      0x6C9CC38D, 0x7B11CD4B, 0x8D0885BF, 0x390940AD),
-	  LGF(0xED61CB7F, 0x4A504A5D, 0x42D7801D, 0xAF415083,
-	      0xAB4295EB, 0x0519A68A, 0x0B09C2B4, 0x098D3AB9),
-	  LGF(0x59A456C6, 0xA06F9DAD, 0x3FFE78C9, 0x92D53426,
-	      0x45C181DE, 0x0696A395, 0x7B5F6FD7, 0x41A59092) },
-	/* (2^65)*G * 4 */
-	{ LGF(0x32A76153, 0x6C4E581C, 0xD6E7A570, 0xEADD9BBE,
-	      0xC0DF4A3B, 0xBD9A0206, 0xFA934AC1, 0x10D60536),
-	  LGF(0x81B4D89F, 0xD98BB32E, 0xE1067F08, 0x5A0FCD3A,
-	      0xAFAD3191, 0x3B845EF3, 0xAA6E2C23, 0x3540EB32),
-	  LGF(0xA76336E1, 0x1D5909B1, 0x47CE6A39, 0x4563C7AD,
-	      0xA3CB3C98, 0x893FFC0C, 0x11381CFF, 0x6470D110) },
-	/* (2^65)*G * 5 */
-	{ LGF(0x8591C275, 0x648443E4, 0x18227B9E, 0x74427A88,
-	      0x6E87C51E, 0x9AE9B073, 0xB9985165, 0x742236A2),
-	  LGF(0xD80EB7AB, 0xDB2EB15D, 0x633AC0BB, 0x695C5863,
-	      0x5FB45810, 0x9DD36D92, 0x374E74CB, 0x4B36B3BE),
-	  LGF(0x97F19A1B, 0x3B020304, 0xCBC99BC3, 0xBCF6E190,
-	      0x3280BAD3, 0x52217A6F, 0x685E3293, 0x7563AAD0) },
-	/* (2^65)*G * 6 */
-	{ LGF(0x0C14DC83, 0xD8AD585D, 0xD6669E2A, 0x748A8C77,
-	      0x6BC1A5D5, 0x9318569D, 0x42C4587D, 0x637BA56A),
-	  LGF(0x1425C001, 0x2473D6DB, 0x6E58108F, 0x76306718,
-	      0xF6ED32DE, 0x0C0776C9, 0x90ACB085, 0x143CF8A0),
-	  LGF(0x05579C38, 0x73CDF9E5, 0x9040AF87, 0xDE3B04BA,
-	      0x8418DD26, 0x3A3345F9, 0xCC1F09C1, 0x2C301B6B) },
-	/* (2^65)*G * 7 */
-	{ LGF(0x9D051B56, 0xE14526AA, 0x8273B21D, 0x0E16666D,
-	      0x6F56FA43, 0x1094A46B, 0x96A1BB91, 0x5C780EAA),
-	  LGF(0x27D26209, 0xE95E2181, 0xE8FB612B, 0x33088969,
-	      0xF2BF788C, 0xBAC06821, 0xD61C83DD, 0x7EE7B8C1),
-	  LGF(0x1F3502A9, 0x0474E697, 0x5FA59240, 0x624FFDB3,
-	      0xA1A25303, 0x617E1C89, 0x16C33383, 0x72AB912B) },
-	/* (2^65)*G * 8 */
-	{ LGF(0xD67CC3ED, 0xE800A094, 0xF26076D9, 0xD6C684ED,
-	      0x17DD5343, 0xE95C514D, 0x473732FF, 0x6B3865BE),
-	  LGF(0x01944CB8, 0x4C033B23, 0xA5D337CB, 0x3260DA08,
-	      0xA6C39FFC, 0x34DFEFB2, 0x9B5B142E, 0x23587229),
-	  LGF(0xD04090FB, 0x439324FC, 0x6FC23C15, 0x08AA0426,
-	      0xBBFAA0EE, 0x7B1EF0DE, 0xE34C35A1, 0x2961CB37) },
-	/* (2^65)*G * 9 */
-	{ LGF(0xA19EF549, 0xE7847250, 0x94B8F6C1, 0xDD56EA48,
-	      0x9C0105B4, 0xF8815AEC, 0x916B15C7, 0x32138C48),
-	  LGF(0x6086DF92, 0x6742B67C, 0x8D75331F, 0x53193A71,
-	      0xCA14E352, 0xADD356D1, 0xD7C9E88D, 0x07DF0CC5),
-	  LGF(0xB8594D9B, 0x5C9C41C3, 0xE6FADF0D, 0x643500CD,
-	      0x03003B68, 0x0D31937E, 0x3766078D, 0x713B783B) },
-	/* (2^65)*G * 10 */
-	{ LGF(0xB299A5D0, 0x25F90BCE, 0x24E25FBE, 0x4FD5981D,
-	      0xBEFEC84E, 0x83A3CE92, 0x6A90B198, 0x5C932978),
-	  LGF(0x51C4DF08, 0x7982C540, 0xEBBFE2BB, 0x476A1D01,
-	      0x7E287D25, 0x3F6064CC, 0x0C17C457, 0x79E82E42),
-	  LGF(0xE8B54114, 0x8CE01EA2, 0xE2EF99F8, 0x73165189,
-	      0x7B6F0AD1, 0x27984BF8, 0x70DAFA38, 0x1813C6ED) },
-	/* (2^65)*G * 11 */
-	{ LGF(0x0884167D, 0x7CAD3302, 0xCDDA791E, 0x383BFB84,
-	      0x16879C64, 0x8D0D667D, 0xAEAFD937, 0x4515BBA1),
-	  LGF(0x13403E58, 0x00FF1286, 0x2D02F041, 0x854CBABF,
-	      0x65593890, 0xB97069DD, 0x68B5A376, 0x3CC8BC31),
-	  LGF(0xF65D98BA, 0xC303EBB8, 0x5BEF4381, 0xF8F2F98E,
-	      0x9FE2783E, 0x206DA25D, 0xD462C39D, 0x058DA5FE) },
-	/* (2^65)*G * 12 */
-	{ LGF(0x7FDDE52D, 0x7118E357, 0x6D616E5E, 0x4F20F40E,
-	      0x4D7E5167, 0x68592F91, 0xD95C2805, 0x3E658213),
-	  LGF(0x6588D284, 0x3688782C, 0x163B51DB, 0xA50B5985,
-	      0xF7311FA5, 0x23447D42, 0x5B751D79, 0x51CBB2B6),
-	  LGF(0xEB5BEC17, 0x877FB541, 0xD77A0305, 0xDC1EF290,
-	      0x43025B6A, 0x15EB451E, 0x0CB85A8A, 0x60570F44) },
-	/* (2^65)*G * 13 */
-	{ LGF(0x45295FBE, 0xBF9758CD, 0xBE8D1017, 0x0DAC5E2E,
-	      0x89E728B3, 0x3CA545A9, 0x1F644B88, 0x40255DC8),
-	  LGF(0x7A9FAA68, 0x6AF277E6, 0x9009703F, 0xFDEE555C,
-	      0x8D5B502A, 0xAA36C89F, 0xAFC87131, 0x052051ED),
-	  LGF(0x86AAB04C, 0xDED77C44, 0x9AA3A8E1, 0x9B85D45C,
-	      0xC4F2C4BA, 0x0F6D233D, 0x319D2237, 0x50C64067) },
-	/* (2^65)*G * 14 */
-	{ LGF(0x4910DE30, 0x13D6BB10, 0x76848E4E, 0x52126D43,
-	      0x0130A4FF, 0x8E7CF5FB, 0xF7F8E0F4, 0x631EFE8E),
-	  LGF(0x08EB56DD, 0x86A494FC, 0xD62219A0, 0xF694DF6E,
-	      0x22098B86, 0x214282B0, 0xA95620EB, 0x7182E92F),
-	  LGF(0xF4D51B6A, 0x8A96C7C2, 0xFBF79614, 0x6E06A2EF,
-	      0x36FFDEC3, 0x2F8383D0, 0x275A04FE, 0x136A3753) },
-	/* (2^65)*G * 15 */
-	{ LGF(0x2F78D8DC, 0x71477471, 0x2A4254F0, 0x533027C6,
-	      0x8C3DB802, 0xBF13A51C, 0xA671868A, 0x09C0518D),
-	  LGF(0xE71417FD, 0xD25E4076, 0xD617E037, 0xAE53B9A6,
-	      0xBB08D620, 0xEDF6131A, 0x7206C6C4, 0x406E8857),
-	  LGF(0xE5261DBE, 0xA7B19AB7, 0x93780470, 0x5FD69501,
-	      0xD3DDA8C2, 0x69CB583F, 0x106BD4A6, 0x7A35DA9A) },
-	/* (2^65)*G * 16 */
-	{ LGF(0x3E152D96, 0xB7E60EBD, 0x3CBC9CE8, 0x16B77AD0,
-	      0xA8F300F7, 0xA8D3D5EB, 0x6203938C, 0x0DA857B8),
-	  LGF(0xD0781C73, 0x7D37BBB6, 0x82DAF6AB, 0x1ADF4CFE,
-	      0xDFBA601C, 0x6CB90D1D, 0x3C090D35, 0x7B916A82),
-	  LGF(0x1875E47C, 0xFE1CAB3D, 0xE298321B, 0x75D85076,
-	      0x623721E5, 0xAA62937A, 0xE382EC23, 0x78BE6830) }
-};
+static void
+hash_tag_update(blake2s_context *bc, const hash_tag *ht)
+{
+	uint8_t t;
+
+	t = ht->len == 0 ? 0x52 : 0x48;
+	blake2s_update(bc, &t, 1);
+	blake2s_update(bc, ht->name, ht->len);
+}
+
+/*
+ * Start the computation of the per-signature secret scalar k: the
+ * BLAKE2s context is initialized and fed with the key-dependent prefix
+ * (encoded private key `sec`, encoded public key `epub`). This part
+ * is the same for all signatures with a given key pair. The prefix is
+ * exactly one block, and is always followed by more data (the seed
+ * length), so it is processed right away: copies of the context then
+ * start from the midstate.
+ */
+static void
+make_sign_k_prefix(blake2s_context *bc, const scalar *sec, const void *epub)
+{
+	unsigned char tmp[32];
+
+	blake2s_init(bc, 32);
+	scalar_encode(tmp, sec);
+	blake2s_update(bc, tmp, 32);
+	blake2s_update(bc, epub, 32);
+	blake2s_flush(bc);
+}
+
+/*
+ * Finish the computation of the per-signature secret scalar k, from a
+ * context obtained with make_sign_k_prefix(). The context is consumed.
+ */
+static void
+make_sign_k_finish(scalar *k, blake2s_context *bc,
+	const hash_tag *ht, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len)
+{
+	unsigned char tmp[32];
+
+	for (int i = 0; i < 8; i ++) {
+		tmp[i] = (uint8_t)((uint64_t)seed_len >> (8 * i));
+	}
+	blake2s_update(bc, tmp, 8);
+	blake2s_update(bc, seed, seed_len);
+	hash_tag_update(bc, ht);
+	blake2s_update(bc, hv, hv_len);
+	blake2s_final(bc, tmp);
+	scalar_decode_reduce(k, tmp, 32);
+}
+
+/*
+ * Compute the per-signature secret scalar k. The private key is provided
+ * as the scalar `sec`; the public key is provided as `epub` (encoded).
+ */
+static void
+make_sign_k(scalar *k, const scalar *sec, const void *epub,
+	const hash_tag *ht, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len)
+{
+	blake2s_context bc;
+
+	make_sign_k_prefix(&bc, sec, epub);
+	make_sign_k_finish(k, &bc, ht, hv, hv_len, seed, seed_len);
+}
+
+/*
+ * Compute the "challenge" part of the signature, from the encoded
+ * point R (`er`, 32 bytes). The challenge has length exactly 16 bytes.
+ */
+static void
+make_challenge_encoded(void *dst, const void *er, const void *epub,
+	const hash_tag *ht, const void *hv, size_t hv_len)
+{
+	blake2s_context bc;
+	unsigned char tmp[32];
+	STATS_BEGIN(st);
+
+	blake2s_init(&bc, 32);
+	blake2s_update(&bc, er, 32);
+	blake2s_update(&bc, epub, 32);
+	hash_tag_update(&bc, ht);
+	blake2s_update(&bc, hv, hv_len);
+	blake2s_final(&bc, tmp);
+	memcpy(dst, tmp, 16);
+	STATS_END(st, JQ255_STAT_CHALLENGE, 1);
+}
+
+/*
+ * Compute the "challenge" part of the signature. The challenge has
+ * length exactly 16 bytes.
+ */
+static void
+make_challenge(void *dst, const point *r, const void *epub,
+	const hash_tag *ht, const void *hv, size_t hv_len)
+{
+	unsigned char tmp[32];
+
+	point_encode(tmp, r);
+	make_challenge_encoded(dst, tmp, epub, ht, hv, hv_len);
+}
+
+/*
+ * Batch operations hash short inputs with the multi-buffer BLAKE2s
+ * implementation; each input is first assembled into a buffer of at
+ * most HASH_INPUT_MAX bytes. Longer inputs are hashed individually.
+ */
+#define HASH_INPUT_MAX   192
+
+/*
+ * Append the hash function identifier and the hash value (in the
+ * format used by make_sign_k() and make_challenge()) to buf[], which
+ * already contains `off` bytes. The new total length is returned; if it
+ * would exceed HASH_INPUT_MAX, then nothing is written and 0 is
+ * returned.
+ */
+static size_t
+hash_input_message(uint8_t *buf, size_t off,
+	const hash_tag *ht, const void *hv, size_t hv_len)
+{
+	size_t nlen;
+
+	nlen = ht->len;
+	if (nlen > HASH_INPUT_MAX || hv_len > HASH_INPUT_MAX
+		|| off + 1 + nlen + hv_len > HASH_INPUT_MAX)
+	{
+		return 0;
+	}
+	if (nlen == 0) {
+		buf[off ++] = 0x52;
+	} else {
+		buf[off ++] = 0x48;
+		memcpy(buf + off, ht->name, nlen);
+		off += nlen;
+	}
+	memcpy(buf + off, hv, hv_len);
+	return off + hv_len;
+}
+
+/*
+ * Batch version of make_sign_k() (with no seed), for n messages
+ * signed with the same key (n <= POINT_BATCH).
+ */
+static void
+make_sign_k_batch(scalar *k, const scalar *sec, const void *epub,
+	const hash_tag *ht, const void *const *hv, const size_t *hv_len,
+	size_t n)
+{
+	uint8_t buf[POINT_BATCH][HASH_INPUT_MAX], out[POINT_BATCH][32];
+	void *dst[POINT_BATCH];
+	const void *src[POINT_BATCH];
+	size_t len[POINT_BATCH], idx[POINT_BATCH], num;
+
+	num = 0;
+	for (size_t i = 0; i < n; i ++) {
+		size_t blen;
+
+		scalar_encode(buf[i], sec);
+		memcpy(buf[i] + 32, epub, 32);
+		memset(buf[i] + 64, 0, 8);
+		blen = hash_input_message(buf[i], 72, ht, hv[i], hv_len[i]);
+		if (blen == 0) {
+			make_sign_k(&k[i], sec, epub, ht, hv[i], hv_len[i],
+				NULL, 0);
+			continue;
+		}
+		dst[num] = out[i];
+		src[num] = buf[i];
+		len[num] = blen;
+		idx[num] = i;
+		num ++;
+	}
+	if (num > 0) {
+		blake2s_multi(dst, 32, src, len, num);
+	}
+	for (size_t j = 0; j < num; j ++) {
+		scalar_decode_reduce(&k[idx[j]], out[idx[j]], 32);
+	}
+}
+
+/*
+ * Batch version of make_challenge_encoded(), for n signatures
+ * (n <= POINT_BATCH). Challenges are computed only for entries i such
+ * that skip[i] is zero.
+ */
+static void
+make_challenge_batch(uint8_t (*c)[16], const uint8_t (*er)[32],
+	const void *const *epub, const hash_tag *const *ht,
+	const void *const *hv, const size_t *hv_len, const int *skip,
+	size_t n)
+{
+	uint8_t buf[POINT_BATCH][HASH_INPUT_MAX], out[POINT_BATCH][32];
+	void *dst[POINT_BATCH];
+	const void *src[POINT_BATCH];
+	size_t len[POINT_BATCH], idx[POINT_BATCH], num;
+
+	num = 0;
+	for (size_t i = 0; i < n; i ++) {
+		size_t blen;
+
+		if (skip[i]) {
+			continue;
+		}
+		memcpy(buf[i], er[i], 32);
+		memcpy(buf[i] + 32, epub[i], 32);
+		blen = hash_input_message(buf[i], 64,
+			ht[i], hv[i], hv_len[i]);
+		if (blen == 0) {
+			make_challenge_encoded(c[i], er[i], epub[i],
+				ht[i], hv[i], hv_len[i]);
+			continue;
+		}
+		dst[num] = out[i];
+		src[num] = buf[i];
+		len[num] = blen;
+		idx[num] = i;
+		num ++;
+	}
+	if (num > 0) {
+		STATS_BEGIN(st);
+		blake2s_multi(dst, 32, src, len, num);
+		STATS_END(st, JQ255_STAT_CHALLENGE, num);
+	}
+	for (size_t j = 0; j < num; j ++) {
+		memcpy(c[idx[j]], out[idx[j]], 16);
+	}
+}
+
+/* see jq255.h */
+size_t
+jq_sign(void *sig, const jq_keypair *jk,
+	const char *hash_name, const void *hv, size_t hv_len)
+{
+	return jq_sign_seeded(sig, jk, hash_name, hv, hv_len, NULL, 0);
+}
+
+/*
+ * Signature generation with an already computed per-signature secret
+ * scalar k. The signature (48 bytes) is written into sig.
+ */
+static void
+sign_with_k(void *sig, const scalar *sec, const void *epub, const scalar *k,
+	const hash_tag *ht, const void *hv, size_t hv_len)
+{
+	scalar s;
+	point r;
+	unsigned char tmp[32];
+
+	/* R = k*G */
+	point_mulgen(&r, k);
+
+	/* c = H(R, Q, m) */
+	make_challenge(tmp, &r, epub, ht, hv, hv_len);
+
+	/* s = k + sec*c */
+	scalar_decode_reduce(&s, tmp, 16);
+	scalar_mul(&s, &s, sec);
+	scalar_add(&s, &s, k);
+
+	memcpy(sig, tmp, 16);
+	scalar_encode((uint8_t *)sig + 16, &s);
+}
+
+/* see jq255.h */
+size_t
+jq_sign_seeded(void *sig, const jq_keypair *jk,
+	const char *hash_name, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len)
+{
+	scalar sec, k;
+	const void *epub;
+	hash_tag ht;
+
+	memcpy(&sec, &jk->private_key, sizeof sec);
+	epub = (const uint8_t *)&jk->public_key + sizeof(point);
+	hash_tag_init(&ht, hash_name);
+
+	/* Per-signature secret scalar k. */
+	make_sign_k(&k, &sec, epub, &ht, hv, hv_len, seed, seed_len);
+
+	sign_with_k(sig, &sec, epub, &k, &ht, hv, hv_len);
+	return 48;
+}
+
+/*
+ * Internal layout of a signer: the key pair elements, and the
+ * make_sign_k() context after the key-dependent prefix.
+ */
+typedef struct {
+	scalar sec;
+	uint8_t epub[32];
+	blake2s_context kc;
+} signer;
+
+typedef char signer_size_check[
+	sizeof(signer) <= sizeof(jq_signer) ? 1 : -1];
+
+/* see jq255.h */
+void
+jq_signer_init(jq_signer *sg, const jq_keypair *jk)
+{
+	signer *x = (signer *)(void *)sg;
+
+	memcpy(&x->sec, &jk->private_key, sizeof x->sec);
+	memcpy(x->epub, (const uint8_t *)&jk->public_key + sizeof(point), 32);
+	make_sign_k_prefix(&x->kc, &x->sec, x->epub);
+}
+
+/* see jq255.h */
+size_t
+jq_signer_sign(void *sig, const jq_signer *sg,
+	const char *hash_name, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len)
+{
+	const signer *x = (const signer *)(const void *)sg;
+	blake2s_context bc;
+	scalar k;
+	hash_tag ht;
+
+	hash_tag_init(&ht, hash_name);
+	bc = x->kc;
+	make_sign_k_finish(&k, &bc, &ht, hv, hv_len, seed, seed_len);
+	sign_with_k(sig, &x->sec, x->epub, &k, &ht, hv, hv_len);
+	return 48;
+}
+
+/*
+ * Internal layout of a streaming signature context: the key pair
+ * elements, the make_sign_k() context after the key-dependent prefix,
+ * and the running BLAKE2s over the message.
+ */
+typedef struct {
+	scalar sec;
+	uint8_t epub[32];
+	blake2s_context kc;
+	blake2s_context mc;
+} sign_stream;
+
+typedef char sign_stream_size_check[
+	sizeof(sign_stream) <= sizeof(jq_sign_ctx) ? 1 : -1];
+
+/* see jq255.h */
+void
+jq_sign_init(jq_sign_ctx *sc, const jq_keypair *jk)
+{
+	sign_stream *x = (sign_stream *)(void *)sc;
+
+	memcpy(&x->sec, &jk->private_key, sizeof x->sec);
+	memcpy(x->epub, (const uint8_t *)&jk->public_key + sizeof(point), 32);
+	make_sign_k_prefix(&x->kc, &x->sec, x->epub);
+	blake2s_init(&x->mc, 32);
+}
+
+/* see jq255.h */
+void
+jq_sign_update(jq_sign_ctx *sc, const void *data, size_t len)
+{
+	sign_stream *x = (sign_stream *)(void *)sc;
+
+	blake2s_update(&x->mc, data, len);
+}
+
+/* see jq255.h */
+size_t
+jq_sign_final(jq_sign_ctx *sc, void *sig, const void *seed, size_t seed_len)
+{
+	sign_stream *x = (sign_stream *)(void *)sc;
+	blake2s_context bc;
+	scalar k;
+	uint8_t hv[32];
+
+	blake2s_final(&x->mc, hv);
+	bc = x->kc;
+	make_sign_k_finish(&k, &bc, &hash_tag_blake2s, hv, 32,
+		seed, seed_len);
+	sign_with_k(sig, &x->sec, x->epub, &k, &hash_tag_blake2s, hv, 32);
+
+	/* The context is ready for a new message with the same key. */
+	blake2s_init(&x->mc, 32);
+	return 48;
+}
+
+/*
+ * Batch signature helper: compute the n signatures (with no seed) of
+ * messages hv[0..n-1] with the same key. The n R points are encoded
+ * together, with a single shared inversion.
+ * Constraint: 0 < n <= POINT_BATCH
+ */
+static void
+sign_chunk(uint8_t *sigs, const jq_keypair *jk, const hash_tag *ht,
+	const void *const *hv, const size_t *hv_len, size_t n)
+{
+	scalar sec, k[POINT_BATCH];
+	point r[POINT_BATCH];
+	uint8_t er[POINT_BATCH][32], c[POINT_BATCH][16];
+	const void *epub[POINT_BATCH];
+	const hash_tag *hn[POINT_BATCH];
+	int skip[POINT_BATCH];
+
+	if (n == 0) {
+		return;
+	}
+	memcpy(&sec, &jk->private_key, sizeof sec);
+	for (size_t i = 0; i < POINT_BATCH; i ++) {
+		epub[i] = (const uint8_t *)&jk->public_key + sizeof(point);
+		hn[i] = ht;
+		skip[i] = 0;
+	}
+
+	/* Per-signature secret scalars k, and R = k*G */
+	make_sign_k_batch(k, &sec, epub[0], ht, hv, hv_len, n);
+	point_mulgen_batch(r, k, n);
+	point_encode_batch(er, r, n);
+
+	/* c = H(R, Q, m) */
+	make_challenge_batch(c, (const uint8_t (*)[32])er,
+		epub, hn, hv, hv_len, skip, n);
+
+	for (size_t i = 0; i < n; i ++) {
+		uint8_t *sig = sigs + 48 * i;
+		scalar s;
+
+		/* s = k + sec*c */
+		scalar_decode_reduce(&s, c[i], 16);
+		scalar_mul(&s, &s, &sec);
+		scalar_add(&s, &s, &k[i]);
+
+		memcpy(sig, c[i], 16);
+		scalar_encode(sig + 16, &s);
+	}
+}
+
+/*
+ * Parameters of a jq_sign_many() call, shared by all tasks. Task i
+ * computes signatures i*POINT_BATCH to (i+1)*POINT_BATCH-1.
+ */
+typedef struct {
+	uint8_t *sigs;
+	const jq_keypair *jk;
+	hash_tag ht;
+	const void *const *hv;
+	const size_t *hv_len;
+	size_t n;
+} sign_many_job;
+
+static void
+sign_many_task(void *arg, size_t index)
+{
+	const sign_many_job *job = arg;
+	size_t off, m;
+
+	off = index * POINT_BATCH;
+	m = job->n - off;
+	if (m > POINT_BATCH) {
+		m = POINT_BATCH;
+	}
+	sign_chunk(job->sigs + 48 * off, job->jk, &job->ht,
+		job->hv + off, job->hv_len + off, m);
+}
+
+/* see jq255.h */
+size_t
+jq_sign_many(void *sigs, const jq_keypair *jk, const char *hash_name,
+	const void *const *hv, const size_t *hv_len, size_t n,
+	const jq255_executor *ex)
+{
+	sign_many_job job;
+	size_t num_tasks;
+
+	if (n == 0) {
+		return 0;
+	}
+	job.sigs = sigs;
+	job.jk = jk;
+	hash_tag_init(&job.ht, hash_name);
+	job.hv = hv;
+	job.hv_len = hv_len;
+	job.n = n;
+	num_tasks = (n + POINT_BATCH - 1) / POINT_BATCH;
+	if (ex == NULL || ex->run == NULL || num_tasks == 1) {
+		for (size_t i = 0; i < num_tasks; i ++) {
+			sign_many_task(&job, i);
+		}
+	} else {
+		ex->run(ex->pool, num_tasks, &sign_many_task, &job);
+	}
+	return 48 * n;
+}
+
+/*
+ * Signature verification helper: decode the signature and recompute
+ * the point R = s*G - c*Q. Returned value is 1 on success, 0 if the
+ * signature or the public key is invalid (in which case r is not set).
+ */
+static int
+verify_make_R(point *r, const void *sig, size_t sig_len,
+	const jq_public_key *pk)
+{
+	point p;
+	scalar s;
+	uint32_t c[4];
+
+	/* Valid signatures have length 48 bytes exactly. */
+	if (sig_len != 48) {
+		return 0;
+	}
+
+	/* If the public key is invalid, report a failure. */
+	memcpy(&p, pk, sizeof p);
+	if (point_is_neutral(&p)) {
+		return 0;
+	}
+
+	/* Decode scalar s and challenge c. */
+	if (!scalar_decode(&s, (const uint8_t *)sig + 16)) {
+		return 0;
+	}
+	for (int i = 0; i < 4; i ++) {
+		c[i] = dec32le((const uint8_t *)sig + 4 * i);
+	}
+
+	/* Recompute R = s*G - c*Q */
+	point_neg(&p, &p);
+	point_mul128_add_mulgen_vartime(r, &p, c, &s);
+	return 1;
+}
+
+/* see jq255.h */
+int
+jq_verify(const void *sig, size_t sig_len, const jq_public_key *pk,
+	const char *hash_name, const void *hv, size_t hv_len)
+{
+	point p;
+	const void *epub;
+	unsigned char tmp[16];
+	hash_tag ht;
+
+	if (!verify_make_R(&p, sig, sig_len, pk)) {
+		return 0;
+	}
+	epub = (const uint8_t *)pk + sizeof(point);
+
+	/* Recompute the challenge c. Signature is valid if that value
+	   matches what was received as part of the signature. */
+	hash_tag_init(&ht, hash_name);
+	make_challenge(tmp, &p, epub, &ht, hv, hv_len);
+	return memcmp(tmp, sig, 16) == 0;
+}
+
+/*
+ * Internal layout of a streaming verification context: the public key
+ * and the running BLAKE2s over the message.
+ */
+typedef struct {
+	jq_public_key pk;
+	blake2s_context mc;
+} verify_stream;
+
+typedef char verify_stream_size_check[
+	sizeof(verify_stream) <= sizeof(jq_verify_ctx) ? 1 : -1];
+
+/* see jq255.h */
+void
+jq_verify_init(jq_verify_ctx *vc, const jq_public_key *pk)
+{
+	verify_stream *x = (verify_stream *)(void *)vc;
+
+	x->pk = *pk;
+	blake2s_init(&x->mc, 32);
+}
+
+/* see jq255.h */
+void
+jq_verify_update(jq_verify_ctx *vc, const void *data, size_t len)
+{
+	verify_stream *x = (verify_stream *)(void *)vc;
+
+	blake2s_update(&x->mc, data, len);
+}
+
+/* see jq255.h */
+int
+jq_verify_final(jq_verify_ctx *vc, const void *sig, size_t sig_len)
+{
+	verify_stream *x = (verify_stream *)(void *)vc;
+	uint8_t hv[32];
+
+	blake2s_final(&x->mc, hv);
+	blake2s_init(&x->mc, 32);
+	return jq_verify(sig, sig_len, &x->pk, JQ255_HASHNAME_BLAKE2S, hv, 32);
+}
+
+/*
+ * Internal layout of an expanded public key. The first two fields
+ * match the layout of a public key.
+ */
+typedef struct {
+	point p;
+	uint8_t epub[32];
+	point_affine win[16];
+} pubkey_expanded;
+
+typedef char pubkey_expanded_size_check[
+	sizeof(pubkey_expanded) <= sizeof(jq_public_key_expanded) ? 1 : -1];
+
+/* see jq255.h */
+void
+jq_expand_public_key(jq_public_key_expanded *epk, const jq_public_key *pk)
+{
+	pubkey_expanded *x = (pubkey_expanded *)(void *)epk;
+
+	memcpy(&x->p, pk, sizeof x->p);
+	memcpy(x->epub, (const uint8_t *)pk + sizeof(point), 32);
+	point_make_expanded_window(x->win, &x->p);
+}
+
+/* see jq255.h */
+int
+jq_verify_expanded(const void *sig, size_t sig_len,
+	const jq_public_key_expanded *epk,
+	const char *hash_name, const void *hv, size_t hv_len)
+{
+	const pubkey_expanded *x = (const pubkey_expanded *)(const void *)epk;
+	point p;
+	scalar s;
+	uint32_t c[4];
+	unsigned char tmp[16];
+	hash_tag ht;
+
+	/* Valid signatures have length 48 bytes exactly. */
+	if (sig_len != 48) {
+		return 0;
+	}
+
+	/* If the public key is invalid, report a failure. */
+	if (point_is_neutral(&x->p)) {
+		return 0;
+	}
+
+	/* Decode scalar s and challenge c. */
+	if (!scalar_decode(&s, (const uint8_t *)sig + 16)) {
+		return 0;
+	}
+	for (int i = 0; i < 4; i ++) {
+		c[i] = dec32le((const uint8_t *)sig + 4 * i);
+	}
+
+	/* Recompute R = s*G - c*Q */
+	point_mul128_add_mulgen_expanded_vartime(&p, x->win, c, &s);
+
+	/* Recompute the challenge c. Signature is valid if that value
+	   matches what was received as part of the signature. */
+	hash_tag_init(&ht, hash_name);
+	make_challenge(tmp, &p, x->epub, &ht, hv, hv_len);
+	return memcmp(tmp, sig, 16) == 0;
+}
+
+/* see jq255.h */
+int
+jq_verify_compact(const void *sig, size_t sig_len,
+	const jq_public_key_compact *cpk,
+	const char *hash_name, const void *hv, size_t hv_len)
+{
+	jq_public_key pk;
+
+	/* Decoding fails on an invalid compact key, since its encoding
+	   is then non-canonical; jq_verify() reports the failure. */
+	jq_decode_public_key(&pk, cpk->b, 32);
+	return jq_verify(sig, sig_len, &pk, hash_name, hv, hv_len);
+}
+
+/* see jq255.h */
+int
+jq_verify_batch(uint8_t *results, const jq_verify_item *items, size_t n)
+{
+	/*
+	 * Our signatures contain the challenge c, not the point R, so
+	 * each R must be recomputed individually before it can be hashed;
+	 * there is no combined equation to check. What the batch shares
+	 * is the normalization of the R points: the per-signature field
+	 * inversion in point_encode() is replaced with a single
+	 * inversion over each chunk of up to POINT_BATCH signatures, and
+	 * the challenges of a chunk are hashed with the multi-buffer
+	 * BLAKE2s. Since each signature is still checked exactly, there
+	 * is no need for a per-item fallback.
+	 */
+	point r[POINT_BATCH];
+	uint8_t er[POINT_BATCH][32], c[POINT_BATCH][16];
+	const void *epub[POINT_BATCH], *hv[POINT_BATCH];
+	hash_tag htv[POINT_BATCH];
+	const hash_tag *ht[POINT_BATCH];
+	size_t hv_len[POINT_BATCH];
+	int ok[POINT_BATCH], skip[POINT_BATCH];
+	int all;
+
+	if (results != NULL) {
+		memset(results, 0, (n + 7) >> 3);
+	}
+	all = 1;
+	for (size_t i = 0; i < n; i += POINT_BATCH) {
+		size_t m = n - i;
+		if (m > POINT_BATCH) {
+			m = POINT_BATCH;
+		}
 
-/* Points i*(2^130)*G for i = 1 to 16, affine extended format */
-static const point_affine point_win_base130[] = {
-	/* (2^130)*G * 1 */
-	{ LGF(0xDE63606E, 0x869B548F, 0x9BE27159, 0x04DA93AE,
-	      0xBC2E0657, 0x9FBB8D6B, 0x0E47A525, 0x06CB9DE7),
-	  LGF(0xCAF58BCB, 0x6A6F8767, 0xCD520CD9, 0xEF9A2E5A,
-	      0xEE40437C, 0x2B998E19, 0xF3E02AB1, 0x1E3A7692),
-	  LGF(0xC50BD952, 0x12DCF83E, 0x82CB44C6, 0xC1FEC4C7,
-	      0x2158E8D4, 0x2FCDD9E7, 0x46FAC0AE, 0x6383719F) },
-	/* (2^130)*G * 2 */
-	{ LGF(0x3D54F276, 0xB08E5A16, 0xADF1CAD3, 0x137941C5,
-	      0x1B6AA715, 0xE12975DE, 0xE1492E65, 0x69E07759),
-	  LGF(0xC28259E8, 0x97643EA7, 0xA0416456, 0x64C33BBE,
-	      0xAFFFBCEB, 0xAC5EBA85, 0x8936CEEA, 0x1DE0359F),
-	  LGF(0x1879EA59, 0xF32ACE06, 0xAB9427B0, 0xC8A5F632,
-	      0xE081587F, 0xF83CBCAC, 0x87D69006, 0x3A18C765) },
-	/* (2^130)*G * 3 */
-	{ LGF(0x8C9DC498, 0xA6954493, 0x73152188, 0x9225D9C9,
-	      0x85C3FC53, 0x7A630559, 0xA431B60A, 0x7F9D9B87),
-	  LGF(0x185A63C2, 0x4A8F6858, 0x105E6338, 0xC29D0227,
-	      0x57313D72, 0x4FA122A3, 0x3C842009, 0x62BAF3EF),
-	  LGF(0x7B30E0BC, 0x18390845, 0x76EF453F, 0x799295C3,
-	      0xAF33DE83, 0xC5FE42DE, 0x628B654A, 0x54C34BDF) },
-	/* (2^130)*G * 4 */
-	{ LGF(0xEC32F903, 0x607C64DA, 0xA9BA461C, 0x8777F23B,
-	      0x92C3BE8D, 0x6E7804AC, 0x5F951D11, 0x180B366A),
-	  LGF(0xFFC35397, 0x17625F88, 0xDA783099, 0xEF697901,
-	      0xEF458EDC, 0xDCCCD3E1, 0xCFBBEDE2, 0x37EDC360),
-	  LGF(0xA0B94FB0, 0x5F7FC0E7, 0x38D69625, 0x3E9CC116,
-	      0x720B072F, 0x62C64632, 0x5D836913, 0x51589183) },
-	/* (2^130)*G * 5 */
-	{ LGF(0xCEA3BDDC, 0xB5DA3AAF, 0xAE7AD735, 0x75DE8E82,
-	      0x5446291A, 0xA458CD16, 0x5A7FF671, 0x552022F7),
-	  LGF(0xE9EC95DF, 0x055D6CCD, 0xDFCADBF5, 0xEB86F24A,
-	      0x9F7AE17C, 0x6DDAC4AB, 0x09ADD692, 0x282E2094),
-	  LGF(0x6B02F394, 0x60BA3A7F, 0x387EA15D, 0x5AF736BE,
-	      0x3EC38691, 0x541CE0C5, 0x32FB79E4, 0x775F5966) },
-	/* (2^130)*G * 6 */
-	{ LGF(0xD222B565, 0x7C2346E4, 0x258AEB93, 0xA45999A2,
-	      0x64D273CD, 0x66ECF438, 0xB5A5952D, 0x5EF32CC1),
-	  LGF(0xDCAD7528, 0xBA9DA77E, 0x892C93FF, 0xB6FA24A8,
-	      0xFA1ACD6B, 0xF406AD1F, 0x131E195C, 0x7E4F46D5),
-	  LGF(0xEA698452, 0x85A61A2D, 0xB9C3F150, 0xEB5AD1F6,
-	      0x89B1BA23, 0xA68B3F01, 0xCA2FEDC4, 0x3306A93B) },
-	/* (2^130)*G * 7 */
-	{ LGF(0x988BD912, 0x70FD1203, 0x5FC76584, 0xE9BDF6AD,
-	      0xDB704F5D, 0x5E05B4C4, 0x189FDCFE, 0x4830813F),
-	  LGF(0xEBEF1413, 0x9E343B6F, 0xB7F95D67, 0xC1293137,
-	      0x05CA0B5B, 0x6FB5672D, 0x2AEC172D, 0x37223948),
-	  LGF(0x28A8DD36, 0xEDC0FD96, 0x89BAA4F4, 0xF796A60E,
-	      0xCF12747E, 0x21A50BBD, 0xCED8D90B, 0x35266C9A) },
-	/* (2^130)*G * 8 */
-	{ LGF(0xD1F7E9CE, 0x68EE4317, 0xC8731082, 0x27214239,
-	      0x24ED9795, 0x5D86EBC5, 0x4D486C20, 0x303B08CF),
-	  LGF(0xEA446499, 0x21232B19, 0xEDDC580B, 0x0F110F3B,
-	      0x7F928B59, 0x7BFEE516, 0xC48289F4, 0x4E1CF6CC),
-	  LGF(0x04969A8C, 0x1768F10E, 0x60B519A9, 0x0834BAF8,
-	      0xCEC7737D, 0x94AAE19E, 0xB5360B34, 0x1DFD019E) },
-	/* (2^130)*G * 9 */
-	{ LGF(0x454A9789, 0xFA3E5E1F, 0xCE8DDF8F, 0x9259F250,
-	      0x2FBB9A1B, 0x2830FF4E, 0xF57EA2FC, 0x4262554C),
-	  LGF(0xA28FF940, 0xFFFA0532, 0xE791A9D0, 0x06134380,
-	      0x934E696A, 0x24120A75, 0x2C83BC57, 0x6F671B02),
-	  LGF(0x9180368F, 0x0BE5ED63, 0xF6E447C2, 0xBB03E3FD,
-	      0x83E29BB6, 0x4CA31E3B, 0x35166005, 0x03BBDFC6) },
-	/* (2^130)*G * 10 */
-	{ LGF(0xE93AA158, 0xE1B24ECC, 0x3202BCE6, 0xBC5D29A7,
-	      0xA4D753B1, 0x2970E4C0, 0x18E51DF5, 0x776F6C1C),
-	  LGF(0x3B071E37, 0x0EE1B500, 0x8D80BCA7, 0x3EC32044,
-	      0x5EC7534A, 0x108D5A1C, 0xEBA1A511, 0x64ECAAC0),
-	  LGF(0x1535C514, 0x10E50013, 0x6D74A32A, 0xD00F9D21,
-	      0xA13E6050, 0x8C125FB0, 0xA3AC991A, 0x4BC50BF7) },
-	/* (2^130)*G * 11 */
-	{ LGF(0x3EB40DBD, 0x10DC6E26, 0x1F4F95D8, 0x31DC4E88,
-	      0x5D45B50A, 0x2C33E16E, 0x2A3899E8, 0x3622E7BF),
-	  LGF(0xD4AB70A1, 0x6CC3477A, 0x712BA4D4, 0x0BC92225,
-	      0x4564D8F4, 0xD51C733D, 0x599B372A, 0x029CAFA5),
-	  LGF(0x6518ADF3, 0x3D63011A, 0x816D4B31, 0x84FD6E87,
-	      0x67CD8FA6, 0x396102BA, 0xE547B2AD, 0x30F0D235) },
-	/* (2^130)*G * 12 */
-	{ LGF(0x82E719F6, 0x54246632, 0x779DEFF8, 0xB3E38AE4,
-	      0x3EE0C99A, 0x3F2A874D, 0x8561373F, 0x70F7A39B),
-	  LGF(0xB7854025, 0xCB9E1D5C, 0xC064493E, 0x960067A5,
-	      0xA91ED717, 0x41F420B5, 0x7E661D8D, 0x6E81F9FA),
-	  LGF(0xD1B3FF89, 0x96737B3B, 0x8B260B44, 0xFA5B9975,
-	      0xD5EB0507, 0x4E40C5DC, 0xE37DDC45, 0x797141D1) },
-	/* (2^130)*G * 13 */
-	{ LGF(0xDE84F742, 0x3A2AA626, 0xE24C4D0F, 0xC52014D6,
-	      0x665947AC, 0x87620DD6, 0x38239FA8, 0x4489AC65),
-	  LGF(0xE489DDB8, 0x1A722773, 0x3D4AABD6, 0xF9498389,
-	      0xBB3DFDCC, 0x59F3D4C5, 0xD2801E6A, 0x653EE371),
-	  LGF(0x108032A6, 0xA14B344A, 0x99975786, 0x336E96DD,
-	      0x6ED6198C, 0x3AF72BF1, 0x23DFA5BC, 0x6E8DE137) },
-	/* (2^130)*G * 14 */
-	{ LGF(0x21EA7956, 0x5BDDDC01, 0xEE996605, 0x30C254D3,
-	      0xBE2A729B, 0xE23DA12D, 0xD7B177EE, 0x0698AEC8),
-	  LGF(0x09693F50, 0x460E164D, 0x44D22EC2, 0x96FABF77,
-	      0x595E868E, 0x216A1928, 0xAC402680, 0x50E1BEE9),
-	  LGF(0x5FE17CBC, 0x2EA3B442, 0x8227BB81, 0x3076D3BE,
-	      0x99779B03, 0x73999AF9, 0x287FBDD0, 0x52BC8B51) },
-	/* (2^130)*G * 15 */
-	{ LGF(0x33632097, 0x4DE169D2, 0x2711C087, 0x7269B654,
-	      0x544AC635, 0xC7562833, 0x09C7A4DA, 0x67C8ED8C),
-	  LGF(0x64C6EE61, 0x442C914C, 0xAA3D41CD, 0x5486463A,
-	      0x744FB271, 0x2323BA05, 0xB63D2983, 0x5CE94782),
-	  LGF(0x41CFEA05, 0x5E85E0F8, 0xC8449D15, 0xFE575987,
-	      0x40C3632A, 0x4B8F046B, 0xC85A090C, 0x79B75334) },
-	/* (2^130)*G * 16 */
-	{ LGF(0x45B50B50, 0xA1638BEC, 0x669E52E3, 0xB956B5A6,
-	      0x6F53165A, 0xAFF58E0E, 0xEDB8A088, 0x5F00BEB6),
-	  LGF(0x560BD063, 0x20DDE2D9, 0x9386B815, 0x68337F97,
-	      0xB5F9B94C, 0x9CAE33A6, 0x8B17674E, 0x0F2ED841),
-	  LGF(0x8690FF50, 0x42082E61, 0x5901899E, 0x3721E53E,
-	      0x342DE052, 0xBB88653D, 0xCF10FA1C, 0x2EED8F30) }
-};
+		for (size_t j = 0; j < m; j ++) {
+			const jq_verify_item *it = &items[i + j];
 
-/* Points i*(2^195)*G for i = 1 to 16, affine extended format */
-static const point_affine point_win_base195[] = {
-	/* (2^195)*G * 1 */
-	{ LGF(0x2FD3D48B, 0x259381D5, 0xCA5B1805, 0x05A13379,
-	      0x83A60AC4, 0x4F9CCA64, 0x2FF7C515, 0x26FE2B2D),
-	  LGF(0x864B8022, 0xC6C4EA52, 0x27F2FE05, 0x3FACF030,
-	      0xAFE0F2B2, 0x5A78F8FD, 0x2117A352, 0x7A205868),
-	  LGF(0xF869915D, 0x827479FB, 0x2A0FAC70, 0xD2369B35,
-	      0xAA299C4A, 0x759EDBD5, 0x3C1C85C0, 0x6CF49CB7) },
-	/* (2^195)*G * 2 */
-	{ LGF(0xF6BA6D06, 0xBEA01D24, 0x8F9811D4, 0x2F4C099F,
-	      0x3EE54433, 0xFEFB9425, 0x3F986A71, 0x26E11FA3),
-	  LGF(0xFDCCE69F, 0xE7A9C455, 0x23C52866, 0xB043C24E,
-	      0x3179B032, 0xCBC1DD8A, 0x4E366C38, 0x597FE7EC),
-	  LGF(0x28BB5A33, 0xF41D8A29, 0xD79CEDB6, 0xB52F9C48,
-	      0x62DF9B38, 0x31EC395A, 0x2AECDB76, 0x5D82A362) },
-	/* (2^195)*G * 3 */
-	{ LGF(0x90F2D551, 0x9902C1E0, 0xA8811C74, 0xE3C20E9F,
-	      0xB83A88A9, 0x5D9FD304, 0x152AC3D0, 0x7A97A73E),
-	  LGF(0x782AD7E7, 0xEBF1C192, 0x0228990B, 0xDAC867CE,
-	      0x39C2A9BB, 0xB0C0AEB8, 0x2E3222F2, 0x5D529C2B),
-	  LGF(0x8F1AE0C2, 0xDF8E6392, 0x0BB45ACF, 0x8692B805,
-	      0xE7017825, 0x4CC66CF8, 0x70747870, 0x25F396E8) },
-	/* (2^195)*G * 4 */
-	{ LGF(0xD9017500, 0x825E9E80, 0xC34493C0, 0x532E7F73,
-	      0x55EB285B, 0x23A615DE, 0x6278C4C5, 0x68BEB6AD),
-	  LGF(0x050CE7CF, 0xE5AD1FDA, 0x398FE9E2, 0xD5179DCB,
-	      0xA2B23DE9, 0x880F0F9C, 0x7C583AB6, 0x73E9DA1D),
-	  LGF(0x161AD03A, 0x1BED8C4A, 0x631A3736, 0x56A385AC,
-	      0xE2FDED3F, 0x55CA5A73, 0x5751514B, 0x2F2A1084) },
-	/* (2^195)*G * 5 */
-	{ LGF(0xA10674B8, 0xEF721415, 0x520B23D9, 0x39A98FB9,
-	      0x3583A50F, 0xDD94B182, 0x359D5D64, 0x1A980F7E),
-	  LGF(0xCED00FE0, 0x81533FD0, 0x457375B0, 0x2B41B323,
-	      0x0B0B6412, 0x3428954D, 0x656FCDE7, 0x3FB05C6B),
-	  LGF(0xCD1FF35F, 0xD6A2CFBE, 0x3E59FA2B, 0x3EB933A6,
-	      0xD6CF146F, 0x0156D1B1, 0x53FBE8B0, 0x1FA8E207) },
-	/* (2^195)*G * 6 */
-	{ LGF(0x0A7FA85F, 0xC3201380, 0xA647E0CA, 0xCE6BBA92,
-	      0xC1969616, 0xD1328954, 0xD146C39F, 0x53505DC8),
-	  LGF(0xAA4DEFF3, 0xABECE8DE, 0x70FF8BED, 0xA6B25F53,
-	      0x8B95875D, 0xC70C1F01, 0x80019FB8, 0x1EEE7F43),
-	  LGF(0xCC1E0562, 0xCC3FC741, 0x42B13EF8, 0x93B664F2,
-	      0x16798EB4, 0x5D617DE8, 0x3CAC8CA8, 0x35C68ADE) },
-	/* (2^195)*G * 7 */
-	{ LGF(0x7745E14A, 0x293F3FD5, 0xEE207D6F, 0x023E52D8,
-	      0xA7918F82, 0xC95A3B2F, 0x3594BCCC, 0x203E41FE),
-	  LGF(0xCE5A6CD2, 0xC2513D53, 0x4C9ADB58, 0x8AF5B5BD,
-	      0x56292D78, 0xDF748C18, 0xC147EB47, 0x1C54D437),
-	  LGF(0xA5ABCB56, 0x02C3EA61, 0xBA7BA956, 0xB56CC897,
-	      0x80AA5525, 0xB8E346F8, 0x7F925E67, 0x791ECB5E) },
-	/* (2^195)*G * 8 */
-	{ LGF(0x67A86CB5, 0x9E436CB7, 0xF1F6D3FE, 0x9EAB45BE,
-	      0xE4A81FA1, 0xA2654498, 0xB7FBF10D, 0x5A50303B),
-	  LGF(0xA4853698, 0x961441BF, 0x425429D3, 0x76396E28,
-	      0x49399AB4, 0x23187D9C, 0x1C754A72, 0x47EC8934),
-	  LGF(0x6AF04917, 0xB5B36F77, 0x8CDEC91B, 0x4E7E5985,
-	      0x56A70427, 0x47DBD9D7, 0xB2E0E163, 0x00D090A5) },
-	/* (2^195)*G * 9 */
-	{ LGF(0x3B6C3E84, 0x1390F65E, 0xE8EDE015, 0xD1492FB1,
-	      0xF4D52DD6, 0x3ADC11E0, 0x1EF8D7C0, 0x4E1EFB69),
-	  LGF(0x56DA5EBB, 0x790DDCB6, 0x8A6C1157, 0x899CA30F,
-	      0xE160FF52, 0xB055E943, 0xE97A3F02, 0x0C4E4B67),
-	  LGF(0x421C783F, 0xE665E42E, 0x6D8BF1FD, 0x90F6162E,
-	      0x5667BD29, 0x0E7DEA66, 0xBCA04267, 0x5C4551BB) },
-	/* (2^195)*G * 10 */
-	{ LGF(0x76E757EA, 0x28CA2A1B, 0xB218D2B4, 0x82E93F7D,
-	      0x5317BE46, 0x433AC8B1, 0xBEFBB5CF, 0x0BBAE0E5),
-	  LGF(0x04D1F6B9, 0x7CBAD6A2, 0x999A4399, 0xEB725D50,
-	      0x104B0670, 0x7C80807D, 0x5DF07889, 0x44B8942C),
-	  LGF(0x6D315D12, 0x617C6A39, 0x86404CA2, 0x4555C3E7,
-	      0x9819C28B, 0x4584662C, 0x144BDDCC, 0x3B052B97) },
-	/* (2^195)*G * 11 */
-	{ LGF(0x7FFDE613, 0x0D101C91, 0x631EC7C4, 0x200EE9E2,
-	      0xA8A29B73, 0xD28F560E, 0xE40BF4D0, 0x2CCB2CF7),
-	  LGF(0x6E7DF796, 0x30FE9671, 0x9A98317F, 0xB6A21496,
-	      0x7543C3F6, 0xEB5423DB, 0xD475BB65, 0x7DD81F0A),
-	  LGF(0x5FC133E0, 0x6E9D90B8, 0x4652F82F, 0x4ED76031,
-	      0x89A2673B, 0x76EEE284, 0x851B3032, 0x69561B43) },
-	/* (2^195)*G * 12 */
-	{ LGF(0xB1499911, 0x50C89E4A, 0x513DFDB2, 0xA66737D8,
-	      0x3EE958E7, 0xB3A61F72, 0x27D42687, 0x2DFA0BA1),
-	  LGF(0x4BB15593, 0x041881DC, 0x90F070A8, 0x06206286,
-	      0xA6239BFD, 0xF6647FFF, 0xE0A8E484, 0x60406418),
-	  LGF(0xCF384958, 0xB186E710, 0x53A27045, 0xCC5BCAEE,
-	      0x0823ABA8, 0x5F7FF4B1, 0x24508710, 0x3C01E53D) },
-	/* (2^195)*G * 13 */
-	{ LGF(0x4921B43D, 0xA5498175, 0x169BCBD8, 0x039A3283,
-	      0xF7E6E8DA, 0x16210166, 0x2C1C58B5, 0x0B005155),
-	  LGF(0xE250DF40, 0x02A5C58C, 0x60313C1E, 0x80A9A629,
-	      0xA9A286D9, 0xEDC81102, 0x0E5DE932, 0x03C8B061),
-	  LGF(0x329A1F5C, 0x9B656127, 0x90853286, 0x7F61E2E1,
-	      0x901D370E, 0x220189A7, 0xE72A0992, 0x5C2FDF1B) },
-	/* (2^195)*G * 14 */
-	{ LGF(0x45249491, 0x1725A4D4, 0xD83A2644, 0x117438E7,
-	      0x06740CDF, 0xB7E063EA, 0x9D2BB8D8, 0x6021348E),
-	  LGF(0x188EE74D, 0x2359C265, 0xDB7611FC, 0x3498D65B,
-	      0x286A6BD1, 0x97D9FFD6, 0x4E36165F, 0x63F77522),
-	  LGF(0x5B583047, 0xD5B3AA1D, 0x7FE06CED, 0xA3107630,
-	      0xA98D71BD, 0x6492A9AF, 0xB782F441, 0x534AFBC1) },
-	/* (2^195)*G * 15 */
-	{ LGF(0x1937FD6E, 0x66C6224B, 0xA12C63DB, 0x07778715,
-	      0xB3E6947A, 0xD35D4667, 0x27D08486, 0x6C435D4A),
-	  LGF(0xD34FC573, 0x14BD04EF, 0x7B42BEA3, 0x58F89E26,
-	      0x083CC9BF, 0xDD4D47FA, 0x8DA29629, 0x5C69FCC3),
-	  LGF(0x623C4605, 0x98A6F2B6, 0xDD9551F4, 0x4F944F4C,
-	      0xD1C9E81B, 0x5A90BF07, 0x6A326820, 0x0B9C0955) },
-	/* (2^195)*G * 16 */
-	{ LGF(0x173AD989, 0xF4448E39, 0xAC6C7FE8, 0xB4BD88C5,
-	      0xC5C899F0, 0x6217606A, 0x2CBA888E, 0x4DA95AF1),
-	  LGF(0x81B3D10D, 0x805E0284, 0x39FCEFCB, 0x3E6A069F,
-	      0x7FED771B, 0xDA636B90, 0xB675A4E1, 0x162581D9),
-	  LGF(0x02F702CE, 0x52668A89, 0x39061B8D, 0x44FDFE7C,
-	      0x252FD554, 0xEEAA462F, 0xB083E563, 0x02FA9D8F) }
-};
+			ok[j] = verify_make_R(&r[j], it->sig, it->sig_len,
+				it->pk);
+			if (!ok[j]) {
+				r[j] = point_neutral;
+			}
+		}
+		point_encode_batch(er, r, m);
+		for (size_t j = 0; j < m; j ++) {
+			const jq_verify_item *it = &items[i + j];
+
+			epub[j] = (const uint8_t *)it->pk + sizeof(point);
+			hash_tag_init(&htv[j], it->hash_name);
+			ht[j] = &htv[j];
+			hv[j] = it->hv;
+			hv_len[j] = it->hv_len;
+			skip[j] = !ok[j];
+		}
+		make_challenge_batch(c, (const uint8_t (*)[32])er,
+			epub, ht, hv, hv_len, skip, m);
+		for (size_t j = 0; j < m; j ++) {
+			if (ok[j]) {
+				ok[j] = memcmp(c[j], items[i + j].sig, 16) == 0;
+			}
+			if (ok[j]) {
+				if (results != NULL) {
+					results[(i + j) >> 3] |=
+						(uint8_t)(1 << ((i + j) & 7));
+				}
+			} else {
+				all = 0;
+			}
+		}
+	}
+	return all;
+}
+
+/*
+ * Verification queue: a bounded ring with the same slot sequence
+ * protocol as the key pool. A consumer claims a run of consecutive
+ * published slots at the head with a single CAS, copies the jobs out
+ * and releases the slots, then verifies the run with jq_verify_batch()
+ * (which hashes the challenges with the multi-buffer BLAKE2s).
+ */
+typedef struct {
+	jq_verify_job job;
+	uint64_t time;
+	uint64_t seq;
+} vqueue_slot;
+
+typedef struct {
+	uint64_t head;
+	uint8_t pad1[56];
+	uint64_t tail;
+	uint8_t pad2[56];
+	uint64_t batch;
+	uint64_t max_wait;
+	uint64_t mask;
+	vqueue_slot *slots;
+} vqueue;
+
+typedef char vqueue_slot_size_check[
+	sizeof(vqueue_slot) <= sizeof(jq_verify_queue_slot) ? 1 : -1];
+typedef char vqueue_size_check[
+	sizeof(vqueue) <= sizeof(jq_verify_queue) ? 1 : -1];
+
+/*
+ * Claim up to q->batch consecutive submitted requests at the head of
+ * the queue. Unless `force` is non-zero, a partial batch is claimed
+ * only if its oldest request has waited at least q->max_wait. The jobs
+ * are copied into jobs[] and their slots are released; the number of
+ * claimed jobs is returned.
+ */
+static size_t
+vqueue_claim(vqueue *q, jq_verify_job *jobs, uint64_t now, int force)
+{
+	uint64_t pos;
+	size_t n;
+
+	pos = keypool_load(&q->head);
+	for (;;) {
+		n = 0;
+		while (n < q->batch) {
+			vqueue_slot *sl = &q->slots[(pos + n) & q->mask];
+
+			if (keypool_load(&sl->seq) != pos + n + 1) {
+				break;
+			}
+			n ++;
+		}
+		if (n == 0) {
+			return 0;
+		}
+		if (!force && n < q->batch) {
+			uint64_t d;
+
+			/* A negative delay means that the submitting
+			   thread's clock is ahead; the request is young. */
+			d = now - keypool_load(&q->slots[pos & q->mask].time);
+			if ((int64_t)d < 0 || d < q->max_wait) {
+				return 0;
+			}
+		}
+		if (keypool_cas(&q->head, &pos, pos + n)) {
+			break;
+		}
+	}
+	for (size_t i = 0; i < n; i ++) {
+		vqueue_slot *sl = &q->slots[(pos + i) & q->mask];
 
-#elif JQ == JQ255S
+		jobs[i] = sl->job;
+		keypool_store(&sl->seq, pos + i + q->mask + 1);
+	}
+	return n;
+}
 
-/* Points i*G for i = 1 to 16, affine extended format */
-static const point_affine point_win_base[] = {
-	/* G * 1 */
-	{ LGF(0xA2789410, 0x104220CD, 0x348CC437, 0x6D7386B2,
-	      0x4612D10E, 0x55E452A6, 0xA747ADAC, 0x0F520B1B),
-	  LGF(0x00000003, 0x00000000, 0x00000000, 0x00000000,
-	      0x00000000, 0x00000000, 0x00000000, 0x00000000),
-	  LGF(0x00000009, 0x00000000, 0x00000000, 0x00000000,
-	      0x00000000, 0x00000000, 0x00000000, 0x00000000) },
-	/* G * 2 */
-	{ LGF(0x0E9EA08D, 0x155215A0, 0xF46D0A34, 0xC474598B,
-	      0xDE7F0296, 0xA479391B, 0xEFDB7348, 0x7DCAB2C9),
-	  LGF(0x0D1657FC, 0xB3E22F8D, 0x219E490E, 0xE5427944,
-	      0x5887FD30, 0x256C2BE7, 0x9C5869ED, 0x6F44EC74),
-	  LGF(0x69B07916, 0x84CC11AA, 0x16FEEF18, 0xEC33C759,
-	      0x78762D61, 0x2501ACD9, 0xD5F7C6BD, 0x42B401D3) },
-	/* G * 3 */
-	{ LGF(0x369F681F, 0x1C2AE84D, 0xA657BB05, 0xE7931687,
-	      0x8780329D, 0xFAC101D1, 0x346F39AA, 0x407A13E6),
-	  LGF(0x36F06441, 0x7204233F, 0x233F36F0, 0x36F07204,
-	      0x7204233F, 0x233F36F0, 0x36F07204, 0x7204233F),
-	  LGF(0x64ED4BDD, 0xB582FD50, 0xAE3D0228, 0x9F6417AA,
-	      0x79D25F29, 0x10163C9F, 0xD9DADBFA, 0x3E21C102) },
-	/* G * 4 */
-	{ LGF(0x0A0C8EFE, 0xFCB9E72D, 0xCBC752B5, 0x879B715F,
-	      0x585A38A4, 0xADBF0638, 0x83525815, 0x1153E6DF),
-	  LGF(0x69223E39, 0x9204A59E, 0x4B12D8E7, 0x4E645F87,
-	      0x9F5D3475, 0xF2A1145C, 0x662F1657, 0x54E64904),
-	  LGF(0xF87650FD, 0x330B2867, 0x0D1CB6FA, 0x013E9EBA,
-	      0x7FC59C00, 0xAB4BE93A, 0x8B86CA68, 0x11F4E281) },
-	/* G * 5 */
-	{ LGF(0xB7768768, 0xDE7D4909, 0xC57ADC57, 0x89E1BB43,
-	      0x36A0B118, 0x850ECBC9, 0xD764C85E, 0x67D128B9),
-	  LGF(0x0667B64D, 0xDF0337C0, 0x2FBA673A, 0x58856B29,
-	      0x33A6D7CE, 0xC17C3E93, 0x9F0CC65D, 0x52932B9A),
-	  LGF(0x423C38C3, 0x1C824AAF, 0x19778FD9, 0x635DC688,
-	      0xDCBD289A, 0x3B8EBB2D, 0x3D12426F, 0x591738A9) },
-	/* G * 6 */
-	{ LGF(0xD0DC5ED9, 0xDB908132, 0x563AB60C, 0xBAF1C9AE,
-	      0x47C0974E, 0x3F0A5A36, 0xE4758D2C, 0x1AE40CE8),
-	  LGF(0x659F8304, 0x2378FCE7, 0xE92DA598, 0xF71199A7,
-	      0xEE1D7E76, 0x05D59CEC, 0x18E39726, 0x7B55CE1D),
-	  LGF(0xDBE905C9, 0x5C964B33, 0x22A48DBC, 0xFB8008F3,
-	      0xD3C7EDD4, 0x002552F2, 0x7F5A5422, 0x42B37300) },
-	/* G * 7 */
-	{ LGF(0x5A305CD1, 0xBCF61643, 0x7A24E5FE, 0x8FF2EAAA,
-	      0x0FFADF5D, 0x1F836A92, 0x8A25A05C, 0x77869103),
-	  LGF(0x9712F248, 0xBB70A309, 0xB5C7CED6, 0x62AE8CAB,
-	      0xC3D060D0, 0x150E35D2, 0x47D95DA4, 0x6EB76B26),
-	  LGF(0xE42EC752, 0x5429F9F2, 0x72EDC8DB, 0x64F44E4B,
-	      0xBC1B7A38, 0x6A2EACE6, 0x44734AB4, 0x59A07700) },
-	/* G * 8 */
-	{ LGF(0x56AF9D20, 0x1EA227FB, 0xA435E2AC, 0x342B4BA3,
-	      0xE4A5FB16, 0x188E0332, 0xE64F8650, 0x4CB7E380),
-	  LGF(0x93F6EEA0, 0x2DE04D6F, 0x4BD9AB93, 0x13A2A2DE,
-	      0xACF9CC03, 0x4BA8485F, 0xEC331ED1, 0x26DCD74F),
-	  LGF(0xFF3A091D, 0x008F881C, 0xAC529912, 0xD79E9196,
-	      0xB91D9EE2, 0x27641FC9, 0x791D0D36, 0x08F2F46F) },
-	/* G * 9 */
-	{ LGF(0x3867E249, 0x7064AA19, 0x1BBD9331, 0x9E0262DD,
-	      0x47465363, 0x28DAB54C, 0xF58996EC, 0x186E71D5),
-	  LGF(0x28B2AEF7, 0xF293B014, 0x9F64AADF, 0x6544BF67,
-	      0x3DC0038B, 0xC25DB7DB, 0xE8B16348, 0x641BC3EA),
-	  LGF(0x553D878E, 0xC9769297, 0xF210B104, 0x5AFEBCBF,
-	      0xEBC5E399, 0xC30E7E91, 0xF78889DE, 0x5344F6CB) },
-	/* G * 10 */
-	{ LGF(0x69A38BAF, 0xEC41FB98, 0xB257A28D, 0x55781708,
-	      0x46435A2C, 0xF1BEAC33, 0xF2E5C1DF, 0x24D9FE2B),
-	  LGF(0x35E0E33E, 0xAC2450CD, 0x4BE098FF, 0xA5FBAFCA,
-	      0xF6CC3634, 0x15C5CFFB, 0x4DD0CC8A, 0x11EB002E),
-	  LGF(0x0B3E9878, 0xB57551F4, 0x087CD2FE, 0xA1D9E1AC,
-	      0xE072548A, 0xFE443CA5, 0x431C24BB, 0x3361CE26) },
-	/* G * 11 */
-	{ LGF(0xFDB68B79, 0x640788E8, 0xD4645856, 0xA02A4D6F,
-	      0x6A54EB86, 0xB18CAB0F, 0x814FCFF1, 0x01511890),
-	  LGF(0x9FDD13DE, 0x4845EE2F, 0x84D73CA8, 0x343EAC12,
-	      0x33C3A9ED, 0xD7761D75, 0xD6AF1B44, 0x44204FCF),
-	  LGF(0xEA04605B, 0x88C209C7, 0xB025867C, 0xDEC8E3E4,
-	      0xAB8AE0C4, 0xF25BD01A, 0xBFBE67E2, 0x10E31B1D) },
-	/* G * 12 */
-	{ LGF(0xAC5599AB, 0xC31D48EE, 0x69F1BBA3, 0x3E87D668,
-	      0x1165365F, 0x8AB43867, 0x2E25AB56, 0x42B17278),
-	  LGF(0xAD8160D1, 0xEDFD8B4B, 0x5457C4A7, 0x9BBB9D36,
-	      0x3BA7F9DB, 0xC2A3F962, 0x296F8D92, 0x1EA722FF),
-	  LGF(0x4727F1F8, 0xDBD377FD, 0xB05F1736, 0x060E2D9D,
-	      0x9422C162, 0xA86F76D5, 0x92E58063, 0x466ED475) },
-	/* G * 13 */
-	{ LGF(0xC42DF019, 0xFFAD311F, 0x6B1677A5, 0xCC5F0E31,
-	      0x724C430C, 0xDB27E2AA, 0x7910438F, 0x72491B47),
-	  LGF(0x76049D71, 0x4DEC2338, 0xA8EA7661, 0x12E5410D,
-	      0x1E78A79B, 0xA8C80C9E, 0x071FC1D5, 0x56187141),
-	  LGF(0x61AB363D, 0x5F87D7B1, 0x6751C8BA, 0xFADED89F,
-	      0xBA3C4BCD, 0x37A78C21, 0x9C950F96, 0x3E2BE3EF) },
-	/* G * 14 */
-	{ LGF(0x4FE98F30, 0xB1620E56, 0x92E72DD0, 0xB119CC91,
-	      0xE6CCAC7F, 0xA0040674, 0xDD41A2D1, 0x5E430A47),
-	  LGF(0x87390957, 0x06930693, 0x567E3C9A, 0xC3E0CD34,
-	      0x8E0CEEAE, 0x2EDB8253, 0x6D3123EB, 0x60EF0D21),
-	  LGF(0xEC603124, 0xCEB292E0, 0x09C8339D, 0x18B961A3,
-	      0x5D3B524A, 0x917BC541, 0x257F38AE, 0x681E3041) },
-	/* G * 15 */
-	{ LGF(0xCBB41565, 0x871FFDDB, 0x1DE23B6B, 0x98B52686,
-	      0xC016B5CD, 0x51EBFEAA, 0xB08C48A2, 0x3BE6B06E),
-	  LGF(0x57EA5D5A, 0x30100939, 0xAE95E20B, 0x99E3DE25,
-	      0x449B9EFD, 0x5594A4E0, 0xCFB9A5A5, 0x100615BC),
-	  LGF(0xD534F12E, 0x2CB15E4A, 0x49523FF8, 0x07A2C5FB,
-	      0x8E59F7E5, 0x79BCF046, 0x8A8B99AA, 0x172AAB62) },
-	/* G * 16 */
-	{ LGF(0x94943C22, 0x18BF1FBA, 0xC9AF901F, 0xEE888DF3,
-	      0x083B2FE3, 0xE6355FA5, 0x5B5F3676, 0x2DE21A5F),
-	  LGF(0xBEE08226, 0xFE9991C8, 0xB6132ED0, 0x70631241,
-	      0x930CC3DF, 0xF17032C1, 0x5E61EDCA, 0x1880F6E6),
-	  LGF(0x5053E953, 0x7D5A5028, 0xE2C9B21E, 0xB0627DFE,
-	      0xE54A4C3C, 0xB6548C27, 0xA2BDDB5E, 0x5C75B961) }
-};
+/*
+ * Process claimed batches until none is available; the total number of
+ * processed requests is returned.
+ */
+static size_t
+vqueue_run(vqueue *q, uint64_t now, int force)
+{
+	jq_verify_job jobs[JQ255_VERIFY_QUEUE_MAX_BATCH];
+	jq_verify_item items[JQ255_VERIFY_QUEUE_MAX_BATCH];
+	uint8_t results[(JQ255_VERIFY_QUEUE_MAX_BATCH + 7) >> 3];
+	size_t total;
+
+	total = 0;
+	for (;;) {
+		size_t n;
+
+		n = vqueue_claim(q, jobs, now, force);
+		if (n == 0) {
+			return total;
+		}
+		for (size_t i = 0; i < n; i ++) {
+			items[i].sig = jobs[i].sig;
+			items[i].sig_len = jobs[i].sig_len;
+			items[i].pk = jobs[i].pk;
+			items[i].hash_name = jobs[i].hash_name;
+			items[i].hv = jobs[i].hv;
+			items[i].hv_len = jobs[i].hv_len;
+		}
+		jq_verify_batch(results, items, n);
+		for (size_t i = 0; i < n; i ++) {
+			if (jobs[i].done != NULL) {
+				jobs[i].done(jobs[i].ctx,
+					(results[i >> 3] >> (i & 7)) & 1);
+			}
+		}
+		total += n;
+	}
+}
 
-/* Points i*(2^65)*G for i = 1 to 16, affine extended format */
-static const point_affine point_win_base65[] = {
-	/* (2^65)*G * 1 */
-	{ LGF(0xFC850F1F, 0xAD671792, 0x10F4FB5A, 0xB7D10E97,
-	      0xF1498B64, 0xE59F700C, 0xA555FEFD, 0x145C3F79),
-	  LGF(0x301870EC, 0xC504DF70, 0x59BEB30B, 0xC3F57575,
-	      0x0E041627, 0x59EF9CAA, 0x1FDF29EA, 0x3AA6C124),
-	  LGF(0xA73A5D82, 0x6D1B6960, 0xB7B83754, 0x7E905634,
-	      0x66E7AD73, 0x5728E3A8, 0x4DD20707, 0x6F9938F0) },
-	/* (2^65)*G * 2 */
-	{ LGF(0xF769D548, 0xAEA44289, 0xD9C85032, 0xF3B3A271,
-	      0x19A10A0D, 0x450F6EC6, 0xD8A60452, 0x2A078A32),
-	  LGF(0xA49AB090, 0xE395C342, 0xD994BBBA, 0xBEEAEA12,
-	      0x316756DE, 0xE555C4B2, 0x2A2835EA, 0x0C4B1FDF),
-	  LGF(0xE71A2679, 0xACC1B6C0, 0x6A20F966, 0x3B828FBF,
-	      0xF305035E, 0x2B40BE24, 0x5F9EE71D, 0x5138EFFC) },
-	/* (2^65)*G * 3 */
-	{ LGF(0x61C3B389, 0xFCB87370, 0x5FB663E6, 0x2EB5074C,
-	      0x727B63A1, 0xC58DE35B, 0x00B2FBF9, 0x6F9AECFE),
-	  LGF(0x64D47F35, 0xDD2736E0, 0x4CCCB7AD, 0x8235DE8C,
-	      0x937FCD8B, 0x84993635, 0xFEACCC60, 0x05DADA9D),
-	  LGF(0xCCDEEA2C, 0x041CF837, 0x8F430D4E, 0x128FA18D,
-	      0xF6EC5EF7, 0x146AA2BA, 0x7A3314D7, 0x367779B5) },
-	/* (2^65)*G * 4 */
-	{ LGF(0x6AB767DD, 0x02E35314, 0xF6DB6D43, 0x07B12ACE,
-	      0x8291AF02, 0xB844A3A3, 0xBFF84166, 0x168FE09E),
-	  LGF(0x2E0DD4AF, 0x20CCC894, 0x40E6146F, 0xB05A1446,
-	      0x747B5584, 0x39FB3501, 0xAA0DCC5D, 0x637DD68B),
-	  LGF(0xC8D19D78, 0xF858BE49, 0xC049D501, 0x1CD2F537,
-	      0x72C504DC, 0x5B82CA8E, 0xD8F74B16, 0x081DAA0C) },
-	/* (2^65)*G * 5 */
-	{ LGF(0xE492D81E, 0xEAAC278E, 0xDF4B5715, 0x9B679600,
-	      0xF7D251E0, 0x0930AFE6, 0x4B0A57E8, 0x12B18E68),
-	  LGF(0xE0B61BA4, 0x8E3257DD, 0x87333A80, 0x034912BE,
-	      0x6FE3860D, 0x35538974, 0xB72FDAE3, 0x0430DD4D),
-	  LGF(0x10703FE2, 0x8F69AB4C, 0xB9CA5DEA, 0x9DB06D02,
-	      0xE9A31DF3, 0x80E1FCAC, 0x833EE541, 0x6CE5827F) },
-	/* (2^65)*G * 6 */
-	{ LGF(0xD0BE8BD1, 0x296B5AC7, 0x17A925CB, 0xF9ABC6FE,
-	      0xFE2755E0, 0x9A382C9B, 0xA45DEDDC, 0x18BD1D68),
-	  LGF(0x17995DE4, 0x41C60373, 0xFD0E5177, 0xEB9F7DAE,
-	      0xEBEFEA23, 0x3C89F25A, 0xE2A6FEA1, 0x6BC51220),
-	  LGF(0xDC0850D8, 0xA8BE5154, 0x9117FF61, 0x46B4997F,
-	      0xFD05C7A5, 0xF3632B4C, 0x3A06C5F9, 0x5198473D) },
-	/* (2^65)*G * 7 */
-	{ LGF(0xE54EC194, 0x0C025505, 0x5E54A341, 0x16DFAAD1,
-	      0x9BAC268D, 0x4E0E0938, 0x3AE0F758, 0x2C841A6C),
-	  LGF(0x0B45CB36, 0x6E0C6EC0, 0xA09D7B7D, 0xDE22614D,
-	      0x86C5311B, 0x68532DB3, 0x90BF3721, 0x6C76A366),
-	  LGF(0x61021E16, 0xEF4DC9C5, 0xEE045148, 0xBF20C5FE,
-	      0xF7E93EA0, 0xCC0911EB, 0xB042AE8F, 0x2C44B584) },
-	/* (2^65)*G * 8 */
-	{ LGF(0xC7DFAAFF, 0x0D409883, 0x44A2B7AC, 0xA9BB3C13,
-	      0x23AA330B, 0xADEE45CF, 0x38DF8DF9, 0x32F82151),
-	  LGF(0x98027EEE, 0xCF5B38B8, 0x6C358DFB, 0x2E0E5F28,
-	      0xB54C83A0, 0x77F9F481, 0xD4AD38D8, 0x320289A4),
-	  LGF(0x2D050368, 0x850595A4, 0x1A87EED4, 0x69338F65,
-	      0xC63C7E31, 0xB56B41AA, 0xF28D875D, 0x0A7DECD4) },
-	/* (2^65)*G * 9 */
-	{ LGF(0x0CD6C445, 0x3EA9CA53, 0xB11E2F78, 0xF4121ED9,
-	      0xDF4CBE2B, 0x32D2ACB4, 0x5C93F764, 0x6BFAD453),
-	  LGF(0x30D70239, 0xE9F73ACE, 0x73FFD2AB, 0x2D6EB283,
-	      0x14264D84, 0xE362CB1B, 0x47F58EDA, 0x6A58C4C4),
-	  LGF(0xEB81C4F0, 0xD421A3CD, 0x973B8F0F, 0x8C5750AC,
-	      0xB3184DFA, 0x43D7F20C, 0xA00332B5, 0x05EA57EA) },
-	/* (2^65)*G * 10 */
-	{ LGF(0x8C55EFC5, 0x6E80B93F, 0xAC82CA7F, 0xCFA05077,
-	      0x997B623A, 0xFC3A41A8, 0xF388397E, 0x594955BF),
-	  LGF(0x1D23F58F, 0xBD4ABD3A, 0x13D824B7, 0xFDF2BE7E,
-	      0x6DA9D7C5, 0xFDF4EBAD, 0x0A760CE6, 0x6F6BF0FD),
-	  LGF(0x55EADF3C, 0xB81C2566, 0xD18BC1A6, 0xBDD6F1B6,
-	      0x471E8803, 0x3160D36F, 0x809C36C6, 0x5B172E38) },
-	/* (2^65)*G * 11 */
-	{ LGF(0xF53D8310, 0x80DDD82D, 0xFB0E0E43, 0x9FE3E489,
-	      0x92FEAA7B, 0xE1EC96F4, 0x8CA0A54C, 0x0D9EFEC2),
-	  LGF(0x5BEF5D82, 0xAC82BC83, 0x26768EEA, 0x1ED56E4F,
-	      0xAE0F6520, 0x7CB1DF78, 0x1A793D69, 0x3F27081B),
-	  LGF(0xF93EB90E, 0x057471C1, 0xFB299F2D, 0xDA034A47,
-	      0xB0691BD2, 0xC51142A5, 0xFCF6A3EE, 0x5FD614C1) },
-	/* (2^65)*G * 12 */
-	{ LGF(0x52CB2A5C, 0xDBEFD63B, 0xC7FCE11E, 0xCA182B05,
-	      0xB7E0B2B0, 0x8173D517, 0x6EBCC5BD, 0x1A664CA5),
-	  LGF(0x00488C1B, 0x3C2CD45E, 0xD5AA1E98, 0x744209C1,
-	      0x3F628FFF, 0xB0A6FCE8, 0x1138F9B1, 0x770D858C),
-	  LGF(0x88D37A03, 0x6A96C565, 0x14153EC3, 0x733C7CA7,
-	      0x78D61F3C, 0xA04AF9D1, 0xFFE4F21E, 0x10420882) },
-	/* (2^65)*G * 13 */
-	{ LGF(0x1CCCC730, 0x85581131, 0x61E9960D, 0x7B6D5AAC,
-	      0xE26F9B9C, 0xC3729090, 0x61BABE1E, 0x035DE04A),
-	  LGF(0x159B7C7E, 0x2B0FECC1, 0x3AD75522, 0x5176B224,
-	      0x6C3BD8ED, 0xF578275E, 0x4A4335B5, 0x3EA45CDA),
-	  LGF(0xFB8296AD, 0x399CEF5F, 0x0203F23D, 0x7BB775A1,
-	      0x009BFFEE, 0xEA10679B, 0xFA69E967, 0x70977639) },
-	/* (2^65)*G * 14 */
-	{ LGF(0x2E20E4A3, 0x969B92FA, 0xDBFB267E, 0xC10608CE,
-	      0x1B964F50, 0x03B07217, 0x4D4EAAF8, 0x513E12D6),
-	  LGF(0x2B792081, 0xDCABCD1C, 0x97317B12, 0xC0B470A2,
-	      0x5D26A03D, 0xB2C96A08, 0x7D7202E9, 0x52A2BF2E),
-	  LGF(0x4111A128, 0x92EA95A7, 0x195F29D9, 0x8164FFF4,
-	      0x39E5051E, 0x8A3F1593, 0x7E870D74, 0x43FC2262) },
-	/* (2^65)*G * 15 */
-	{ LGF(0xC3DF479B, 0x5B4B80D1, 0x1817958B, 0x26E5E74F,
-	      0x3AED803B, 0x899B72B3, 0xFAB7DFA1, 0x07D749F9),
-	  LGF(0x82ED1F56, 0xCB4E8E86, 0xE6F438C6, 0x95E7B3DA,
-	      0x11E4EAE5, 0x436574C3, 0x6B6557D1, 0x5B29A9D4),
-	  LGF(0x8E2A8D1F, 0xA0FF9F12, 0x527B4E88, 0xD3C936A9,
-	      0xF2B0454A, 0xB279CEBE, 0x6130D747, 0x04B77CA1) },
-	/* (2^65)*G * 16 */
-	{ LGF(0xDB9A5B83, 0xD82E7D79, 0xDB1386D1, 0xE55F1507,
-	      0x0B19751E, 0x4E2ED8BC, 0x6AD8C891, 0x191D614E),
-	  LGF(0x07947CAE, 0xA0A662EF, 0x407ADF90, 0xCFD4B9B4,
-	      0x4CDA26D4, 0x9698A42E, 0xFA1C5F43, 0x00D98818),
-	  LGF(0x20D474E3, 0xF048C3E4, 0xCDA1B6AB, 0xA09CE0B0,
-	      0x9727A4CA, 0x31ED70E8, 0xB2D89DF0, 0x214C5B3C) }
-};
+/* see jq255.h */
+int
+jq_verify_queue_init(jq_verify_queue *vq,
+	jq_verify_queue_slot *slots, size_t capacity,
+	size_t batch, uint64_t max_wait)
+{
+	vqueue *q;
+	vqueue_slot *sl;
+
+	if (capacity < 2 || (capacity & (capacity - 1)) != 0
+		|| batch < 1 || batch > JQ255_VERIFY_QUEUE_MAX_BATCH
+		|| batch > capacity)
+	{
+		return 0;
+	}
+	q = (vqueue *)vq;
+	sl = (vqueue_slot *)slots;
+	memset(q, 0, sizeof *q);
+	q->batch = (uint64_t)batch;
+	q->max_wait = max_wait;
+	q->mask = (uint64_t)capacity - 1;
+	q->slots = sl;
+	for (size_t i = 0; i < capacity; i ++) {
+		memset(&sl[i].job, 0, sizeof sl[i].job);
+		sl[i].time = 0;
+		sl[i].seq = (uint64_t)i;
+	}
+	return 1;
+}
+
+/* see jq255.h */
+int
+jq_verify_submit(jq_verify_queue *vq, const jq_verify_job *job,
+	uint64_t now)
+{
+	vqueue *q;
+	vqueue_slot *sl;
+	uint64_t pos;
+
+	q = (vqueue *)vq;
+	pos = keypool_load(&q->tail);
+	for (;;) {
+		uint64_t seq;
+
+		sl = &q->slots[pos & q->mask];
+		seq = keypool_load(&sl->seq);
+		if (seq == pos) {
+			if (keypool_cas(&q->tail, &pos, pos + 1)) {
+				break;
+			}
+		} else if ((int64_t)(seq - pos) < 0) {
+			return 0;
+		} else {
+			pos = keypool_load(&q->tail);
+		}
+	}
+	sl->job = *job;
+	keypool_store(&sl->time, now);
+	keypool_store(&sl->seq, pos + 1);
+	return 1;
+}
 
-/* Points i*(2^130)*G for i = 1 to 16, affine extended format */
-static const point_affine point_win_base130[] = {
-	/* (2^130)*G * 1 */
-	{ LGF(0x287B7A8C, 0xC547E3D2, 0x2E9A0A54, 0x907B6425,
-	      0x55F5D398, 0x7A7BA223, 0x492D6D08, 0x5FEB95EE),
-	  LGF(0x247C18A0, 0xC17AB82D, 0x6973F13C, 0x95542A3E,
-	      0x9E957BD2, 0xB14CDFC7, 0xBADE4F32, 0x661229C7),
-	  LGF(0x28E441B7, 0x5541C599, 0x442F368E, 0x5B912D60,
-	      0x5BC7D073, 0x2EC47581, 0x03E1A1E7, 0x02802A6A) },
-	/* (2^130)*G * 2 */
-	{ LGF(0x0F28E7B4, 0x15A644D9, 0x4550787C, 0x2AEBD607,
-	      0x83354F29, 0x319418ED, 0x2688A0B0, 0x2B3CECA0),
-	  LGF(0x87129578, 0x72C27DF1, 0x94A3CAEB, 0xF443CA1C,
-	      0x35C3A22D, 0xEA24368F, 0x7283DADF, 0x17A619CA),
-	  LGF(0x3459B171, 0x0EC06DB4, 0x8FD7DD2D, 0x1A6558F9,
-	      0xA82A6DEE, 0x4B3F9D68, 0x340F9542, 0x649637A5) },
-	/* (2^130)*G * 3 */
-	{ LGF(0x8F86DA38, 0xA065A103, 0x66338796, 0xBF1723E4,
-	      0x18633561, 0xD922BF8C, 0x97CE7EDA, 0x168AAAD7),
-	  LGF(0x2CB400ED, 0x31D729A1, 0xCEEAA6A9, 0x7A195520,
-	      0x192BE4B6, 0x86F51D53, 0x1CDCF306, 0x22A23BF6),
-	  LGF(0xE212FCC2, 0xCACA700A, 0x3381880A, 0x8E87630B,
-	      0xBC73A980, 0xC73BF67B, 0x1AA1CCE1, 0x66C538B7) },
-	/* (2^130)*G * 4 */
-	{ LGF(0x7B396AC1, 0xA7C98580, 0x050B1CC0, 0xF5B27B3B,
-	      0xF3BB8550, 0x199AF9DF, 0xCCECE2DE, 0x0DD0B15B),
-	  LGF(0x08A28FA3, 0x767FEA82, 0x37DCA7EE, 0xA2DC84A0,
-	      0x33E1DE6F, 0xEBD2AC82, 0x21AD21CA, 0x188F7085),
-	  LGF(0xBA423FFD, 0x3AC52264, 0x3B333AA4, 0xEF5048FF,
-	      0xEC2F8A1A, 0x2FBD912D, 0x670533CF, 0x2BEF1130) },
-	/* (2^130)*G * 5 */
-	{ LGF(0x9FC7024F, 0xCD8A44DA, 0xBC29AA93, 0xF737A550,
-	      0x1E9106B9, 0x0D895281, 0x2DA132F4, 0x2392F5F4),
-	  LGF(0x64875239, 0xB8201817, 0x342A7459, 0x5B4DD1BB,
-	      0x0BE03B56, 0xC66B48D8, 0x636EA208, 0x7F08F18F),
-	  LGF(0x72019CF2, 0x2CC60206, 0x05B43C11, 0x14E86A76,
-	      0x5DE4C795, 0xB9CE10F5, 0xBA073D7D, 0x67B29276) },
-	/* (2^130)*G * 6 */
-	{ LGF(0xF864F06F, 0x43D22D5E, 0x3BE07C7C, 0x69548FFF,
-	      0x3EDD77B8, 0xEBB4F5A3, 0x2CA0CD5B, 0x5C5A9324),
-	  LGF(0x2E2ECC30, 0x9FFA28B9, 0x78DA5C00, 0xFB480B56,
-	      0xB14804D7, 0xE1C94F9A, 0x48C9FA1D, 0x7D453CC9),
-	  LGF(0x84BD090A, 0x99B10D26, 0x702948B9, 0xAA8361C9,
-	      0x15F7685C, 0x8FE833DB, 0x46BA5349, 0x5A40858A) },
-	/* (2^130)*G * 7 */
-	{ LGF(0xC806064F, 0xFE714DB9, 0x96052BB3, 0xEC532CBC,
-	      0x62B03E4E, 0xFEB56676, 0x52734277, 0x7D201AFC),
-	  LGF(0x55F5DEF5, 0x87848119, 0x33271AC2, 0x48D26621,
-	      0xA6C81237, 0xAF3F2A3F, 0xE01B2E7D, 0x1A086A6F),
-	  LGF(0xAA0289C2, 0xE60717C5, 0x465F8A77, 0x06226B3A,
-	      0xC053632B, 0xAAE6A9C9, 0x16332425, 0x74441004) },
-	/* (2^130)*G * 8 */
-	{ LGF(0xC3D8E685, 0x9C901178, 0x5E9E8C93, 0x3FD38D2D,
-	      0x3AECC482, 0xA0478BE3, 0x263956AC, 0x507DF5A8),
-	  LGF(0x59DBD92B, 0x1DC9A2A8, 0x6245BBB3, 0xBF15C84C,
-	      0xB2CAB143, 0x2A8D65D0, 0x17A5525E, 0x3DE43A80),
-	  LGF(0x13E8DD16, 0x20400890, 0x9E66D5ED, 0x98B67294,
-	      0x76BC1D61, 0x2468A4B8, 0x4A76A7C6, 0x1D2C24FA) },
-	/* (2^130)*G * 9 */
-	{ LGF(0xA15BFEC5, 0x4E0B3042, 0xB78EFCC3, 0x25107B05,
-	      0x0AB84B6A, 0x895F5129, 0x6CD0570A, 0x2875F452),
-	  LGF(0x891C8CF1, 0xDB52105D, 0xF01D372F, 0xA1E811D5,
-	      0x0ADED951, 0x5CF867DE, 0xE0B4DA8B, 0x17052800),
-	  LGF(0xD990BDFE, 0x465AF151, 0xED9253B0, 0x61C1C858,
-	      0xA3FBDE66, 0x565E0443, 0x53E17835, 0x12DB650B) },
-	/* (2^130)*G * 10 */
-	{ LGF(0x29D2E833, 0x01496672, 0xED0CA017, 0x01916903,
-	      0x293857A0, 0xB4E997E9, 0x85A3DB38, 0x52B3D9F4),
-	  LGF(0x46496B31, 0x126C8477, 0x626487D7, 0x23D37316,
-	      0x982B39EB, 0x46505E02, 0x2143582E, 0x23434575),
-	  LGF(0xA0420BAA, 0x6BBD04A3, 0x425C1B2E, 0x9684CAEB,
-	      0x89C6CAF4, 0x2D86F805, 0xA6568CBE, 0x625467C6) },
-	/* (2^130)*G * 11 */
-	{ LGF(0x228C2235, 0x8444EE09, 0xBBF1E2D0, 0xC67ADEED,
-	      0x16B2CFD7, 0x78F69BE7, 0xB95FF650, 0x7B0AF5F2),
-	  LGF(0xBECE2651, 0xD51EDD52, 0xD6FA4957, 0x792F3E2E,
-	      0x8E6F750E, 0x8349ED26, 0xEF6F6D88, 0x6BB94CDF),
-	  LGF(0x5088C5A8, 0xE4774F54, 0xFFA8E04D, 0x43CAA7EC,
-	      0x0644B58D, 0x2CBAD6B9, 0xA1180C6F, 0x66EC80D6) },
-	/* (2^130)*G * 12 */
-	{ LGF(0x8591C1AD, 0xAF4B65BA, 0x17CEAF23, 0x34946626,
-	      0xD86050C8, 0x67D0F7B0, 0x2F7E3A00, 0x7DD5EFEF),
-	  LGF(0xDE2129A6, 0x89340045, 0xE46000DB, 0x10CF7923,
-	      0x2C69ABE2, 0xA17D1BEB, 0x203C2DA4, 0x1F3592DE),
-	  LGF(0xC9A50DDD, 0x946A6220, 0x90529CD9, 0xB19B06C5,
-	      0xC2D4D2BA, 0x932CF781, 0x2633F97D, 0x643EC048) },
-	/* (2^130)*G * 13 */
-	{ LGF(0x02E72852, 0x681F8DB2, 0x6FBEA675, 0x1321374B,
-	      0x23DB7E8C, 0xD874B177, 0x0693A8A2, 0x19430AF8),
-	  LGF(0x57355C90, 0x0F4767AD, 0x19124EA8, 0xCAD900D8,
-	      0xE702318A, 0xB4B045E5, 0x3A7E1058, 0x7AB6CB35),
-	  LGF(0x0505358F, 0xF5572A21, 0x20133EC8, 0x0C528F0B,
-	      0xB3606AA3, 0xC425B464, 0x6CAB14B8, 0x33E0CFF1) },
-	/* (2^130)*G * 14 */
-	{ LGF(0x862E3AF0, 0x1739D8DE, 0xB3D5ED7B, 0xEAEA8FAE,
-	      0x4B06CE7A, 0x394668C3, 0x5FC95D4F, 0x26B43F06),
-	  LGF(0x01A95CF8, 0xE62B26D3, 0x48398A95, 0x84BC9EEC,
-	      0x267875A4, 0x08F76F6E, 0x9A0A50A1, 0x32D3B1A4),
-	  LGF(0xEAB69B8C, 0x1E1D0050, 0x31875B73, 0x5FAE0C5B,
-	      0x29295DB8, 0x5FD8D77B, 0x8F5136E0, 0x720DA33C) },
-	/* (2^130)*G * 15 */
-	{ LGF(0xC609C455, 0x53614A3B, 0xD229E43B, 0x1FDF44E6,
-	      0xEC35FF3A, 0xC69D5CC6, 0xD4386D2C, 0x40D8B2ED),
-	  LGF(0x58819185, 0x9A0B63FF, 0x1086D125, 0xF789BF22,
-	      0xB1E1776A, 0xAD341ED8, 0x46EBF733, 0x082617E1),
-	  LGF(0xB0AF72AF, 0x94BAFDC6, 0x67032F80, 0xCE7FD958,
-	      0x42E3E324, 0x60A041C7, 0xE0C48A92, 0x52BAFECD) },
-	/* (2^130)*G * 16 */
-	{ LGF(0x6686F776, 0xB5972247, 0x42C88D93, 0xFCAABBE4,
-	      0xFA237DD5, 0x0A7A9E0D, 0x43FCED53, 0x2DBB938F),
-	  LGF(0xC1409964, 0xF50D8973, 0xECBBDB1D, 0x7E7D988F,
-	      0x0DE07B83, 0x64BAB168, 0xE277A32E, 0x588C179E),
-	  LGF(0xF1FFD3B3, 0x62A6B63B, 0xA4AEC308, 0xAA7B23F4,
-	      0xBC75755C, 0x52196FBD, 0xD4635289, 0x60C42361) }
-};
+/* see jq255.h */
+size_t
+jq_verify_poll(jq_verify_queue *vq, uint64_t now)
+{
+	return vqueue_run((vqueue *)vq, now, 0);
+}
 
-/* Points i*(2^195)*G for i = 1 to 16, affine extended format */
-static const point_affine point_win_base195[] = {
-	/* (2^195)*G * 1 */
-	{ LGF(0x52EF088D, 0xEB4B028B, 0x511D0BF8, 0x7BFFA172,
-	      0x4AA70C44, 0x20A72891, 0x23A0A46D, 0x1982687F),
-	  LGF(0x4F6950E1, 0xD5386C02, 0xF2C711D7, 0xB46F6A19,
-	      0x7F90F84F, 0xD13612F7, 0xC35B1108, 0x02B1FE40),
-	  LGF(0x3C8937C9, 0x24BC6E86, 0xD4AE4DC9, 0xA15165FB,
-	      0x4BAA772F, 0xF54207D1, 0x734C65E6, 0x4ECAC7AF) },
-	/* (2^195)*G * 2 */
-	{ LGF(0xF5DF3C6B, 0x6736CB36, 0x9E622FFF, 0xAAC155C4,
-	      0x6C9AF425, 0x08BF6AEC, 0x3E754687, 0x32453BFF),
-	  LGF(0x01D9BE69, 0x4D205228, 0x30005684, 0x491F6D95,
-	      0x61348B5B, 0x03948795, 0xC7DA4C9E, 0x207807A3),
-	  LGF(0x5081D09A, 0x39C46014, 0xEEDD6F53, 0xE3BB41D1,
-	      0x2AECE484, 0x8BAB5AC4, 0x073E261D, 0x7BE8AD2F) },
-	/* (2^195)*G * 3 */
-	{ LGF(0x0240D5AB, 0xE2163ED4, 0xD2EDE213, 0x0D36DDAF,
-	      0x84DA7A94, 0xB5DA9A3A, 0x81AD5800, 0x616BB179),
-	  LGF(0x42399CCB, 0x62329BF6, 0x54BDD8E5, 0xD15830A7,
-	      0x45F76715, 0x052C83B7, 0x77A075E5, 0x2C2FEC42),
-	  LGF(0x050E4AFB, 0xCA181F67, 0x3CABC581, 0x8FA110DC,
-	      0x46B0A4C3, 0xEC7B337F, 0x8F72400F, 0x61465925) },
-	/* (2^195)*G * 4 */
-	{ LGF(0xC01F036B, 0x11A5ECC6, 0x3DCFAB11, 0x00905EC7,
-	      0xBE833EB9, 0xBD182106, 0x520D6147, 0x21345004),
-	  LGF(0x823F9793, 0x33F1C936, 0x8646E9E2, 0x45EB4CD7,
-	      0x49110514, 0xB28C3C8D, 0x39F3AA65, 0x20B293F7),
-	  LGF(0xF465E491, 0xECE0E7C9, 0x3E295315, 0x6E3D99DD,
-	      0x0D23AB0D, 0x11CAE9FC, 0x3D65F08E, 0x395BB5CD) },
-	/* (2^195)*G * 5 */
-	{ LGF(0xB04EFBCB, 0xC3465879, 0x7DF1D9F8, 0xDDD7400D,
-	      0xBB68E927, 0x3FC45AA3, 0x7CC560D9, 0x0D654BC9),
-	  LGF(0x4D4F0DAA, 0x3F09E8FE, 0xB553CA96, 0xE47EE2E2,
-	      0xAC578533, 0x9FFA3C3A, 0xA08113C1, 0x356B0675),
-	  LGF(0x6CF3E78E, 0x2F2E5ED1, 0xDD5F3D89, 0x3739979B,
-	      0x9FB489BE, 0x6DA80DAB, 0xBDA14A65, 0x431D2978) },
-	/* (2^195)*G * 6 */
-	{ LGF(0xE71501A7, 0x93683AAA, 0x01C67235, 0x7A150F18,
-	      0x300E35B7, 0x5F345C36, 0x605D8B43, 0x7A900684),
-	  LGF(0xC8E7B387, 0xA143C257, 0x6CC108D4, 0x62D88913,
-	      0xBB72837C, 0xE32F52E0, 0x12F67001, 0x076CCDEE),
-	  LGF(0x262D9E46, 0x02F43BF7, 0x5B679BDB, 0xC600EF04,
-	      0x5A115558, 0x75B858E1, 0x25934593, 0x580DEEF0) },
-	/* (2^195)*G * 7 */
-	{ LGF(0x09001CAE, 0xCAF3D56D, 0x7F61B1E3, 0x56CCAFC5,
-	      0x3BA1A346, 0x6BE0EB31, 0xB592478D, 0x4AB3F0BE),
-	  LGF(0x8AEDB101, 0x971F761E, 0x3B802862, 0xD10EB0D7,
-	      0xDE5AD3F6, 0x100B543B, 0x27445B8E, 0x2D2D355F),
-	  LGF(0x90669B3D, 0xBB6B5140, 0x9368BB18, 0x6AF73229,
-	      0xC4662114, 0xD33B393F, 0x2E5F9548, 0x44B393C4) },
-	/* (2^195)*G * 8 */
-	{ LGF(0xC96EBE06, 0x073F794D, 0x6642E5AB, 0xF9AAA789,
-	      0x18DC4F59, 0x47F09728, 0x70B031C5, 0x30E51AB0),
-	  LGF(0x79CB6EA2, 0x6AC99539, 0x43904E3A, 0xB754075F,
-	      0x6C51FC54, 0x0F5C5D70, 0x6A945237, 0x72F0811D),
-	  LGF(0x7656E362, 0xBB17DDD3, 0x405FA3BF, 0x9F321433,
-	      0x72A57EE6, 0x326CCE63, 0x0F2A9875, 0x2CEB4E80) },
-	/* (2^195)*G * 9 */
-	{ LGF(0xE1675B2C, 0x39611A8F, 0x7A122549, 0xFF7E1AF2,
-	      0x7B6325F6, 0xBF6F1A75, 0x55883EDC, 0x074A5FED),
-	  LGF(0xCAFEB583, 0xF2B5C06F, 0xA1A2C97B, 0x2D0EFBE6,
-	      0x1442F46D, 0x466067CE, 0xC999DD67, 0x13349ABF),
-	  LGF(0x2D09A54C, 0xA4D40FF4, 0x16DF1800, 0xC003C77D,
-	      0xE6393676, 0xA0761711, 0x64969117, 0x2C1C0AAC) },
-	/* (2^195)*G * 10 */
-	{ LGF(0xA4EEFBF4, 0xA3062A05, 0x726FAB1E, 0xE5D5C2E0,
-	      0x531F05A1, 0x60DC0E92, 0x89936E48, 0x4643A40C),
-	  LGF(0x453A8A8A, 0x1F87C746, 0x5DA27586, 0xDDCF1D00,
-	      0xC7664BF3, 0xC77308C7, 0x6436D94B, 0x5774724E),
-	  LGF(0x6CB73C25, 0xAA14EFB7, 0x3DC2B252, 0xAFD7FD33,
-	      0xCCBF5685, 0x58B8811A, 0x0471A372, 0x1C9D11E4) },
-	/* (2^195)*G * 11 */
-	{ LGF(0x3B886BC0, 0xD13062D6, 0xB8D4C07B, 0x59FB0704,
-	      0x6A5FE90E, 0x012B93CE, 0xA4404810, 0x5884A598),
-	  LGF(0x9987EBED, 0x08A8CB0C, 0xC4D7168A, 0x05428BBD,
-	      0x0207E6AA, 0x5FDD560F, 0x2497FC6D, 0x4CD603F7),
-	  LGF(0xBAB59BD5, 0x3F08842C, 0x0024CECC, 0x1502C744,
-	      0x6BE0B6EA, 0x7241E80F, 0xFB557160, 0x6942504C) },
-	/* (2^195)*G * 12 */
-	{ LGF(0x7B7A2079, 0x94CCC8EE, 0x9368F9D1, 0x98E6462E,
-	      0x3D44A6C4, 0xF97BFF02, 0x4D545564, 0x5396F045),
-	  LGF(0x7F72D537, 0xB4754DE2, 0x2AC5B1C3, 0xC0F01E80,
-	      0x4B64FC09, 0x6492E0F0, 0xE1CDCAD1, 0x14C0F255),
-	  LGF(0x516E0A97, 0x392EB3FD, 0x05B71FB1, 0x4EC3DC56,
-	      0x7BDCED64, 0x7F75ADBF, 0xC96482D6, 0x6FC86668) },
-	/* (2^195)*G * 13 */
-	{ LGF(0xBD6BFE31, 0xEAD383AB, 0x9F6E73B8, 0xBCB0813E,
-	      0xBA25DFF8, 0xC58E3723, 0x6C6C9E5B, 0x4F9DA6DF),
-	  LGF(0xF580DF1C, 0xCF158917, 0xD3E90C45, 0x0E14A880,
-	      0xF882B1C7, 0x60D780AF, 0xED165A4B, 0x420C0614),
-	  LGF(0xB121A745, 0xCBDDA904, 0xC9A6880F, 0x31611DAE,
-	      0x31FEC743, 0xB43A2ACF, 0xE4E1F3CE, 0x5F142474) },
-	/* (2^195)*G * 14 */
-	{ LGF(0xD884B154, 0x37DADA6D, 0x051FC1FE, 0x9BD20465,
-	      0xD36E5167, 0xF618BF0E, 0x85F6BE8F, 0x6713DDBB),
-	  LGF(0xA182F658, 0xE3DF626A, 0xD410C765, 0x0AEB0A55,
-	      0x9DD03BA1, 0x645809F3, 0x5AE057DB, 0x40C86021),
-	  LGF(0xCF581D58, 0xB2C0705F, 0xFC64B6A1, 0xB136DC9F,
-	      0x919623A2, 0xB0115208, 0x83722184, 0x15D34F32) },
-	/* (2^195)*G * 15 */
-	{ LGF(0x2ECAC269, 0xA304489B, 0x3145A960, 0x8482C85F,
-	      0x2CDBD9D0, 0x4A240F13, 0x29DB3D90, 0x2AE80644),
-	  LGF(0x8436B829, 0xBA4D3B43, 0xB0906610, 0xFD932027,
-	      0x56D1C683, 0x43EFF537, 0xFF8301C5, 0x0C078789),
-	  LGF(0x0F98A082, 0x206A563B, 0xC630CCDC, 0xBFEFB28B,
-	      0x5BE2309A, 0xE3FA9751, 0x904FD7A5, 0x71698D07) },
-	/* (2^195)*G * 16 */
-	{ LGF(0x494F6306, 0x320F03CA, 0x8E79B929, 0x5AA58711,
-	      0x3C3A18CF, 0x4BAD3FD4, 0x0DF3849B, 0x255DDF7E),
-	  LGF(0x18A991C5, 0x2C949105, 0x18F00C14, 0xAAC1F71E,
-	      0x9768A122, 0x2E1D217E, 0xBB0B3E0B, 0x50A69209),
-	  LGF(0x3C888F1E, 0xF93D8C08, 0x59145CCC, 0x57112855,
-	      0x44969A4C, 0x1F0F91EC, 0x4C260615, 0x7AB91A18) }
-};
+/* see jq255.h */
+size_t
+jq_verify_flush(jq_verify_queue *vq)
+{
+	return vqueue_run((vqueue *)vq, 0, 1);
+}
+
+/*
+ * Length of the input of the ECDH key derivation: the two encoded
+ * public keys, a status byte, and the shared secret.
+ */
+#define ECDH_KDF_LEN   97
+
+/*
+ * Build the input of the ECDH key derivation, given the encoded product
+ * point (private key times peer point). `bad` is -1 if the peer public
+ * key was invalid, 0 otherwise.
+ */
+static void
+ecdh_kdf_input(uint8_t *buf, const uint8_t *shared, const scalar *s,
+	const uint8_t *epub_self, const uint8_t *epub_peer, uint32_t bad)
+{
+	uint8_t tmp[32];
+
+	/*
+	 * If the peer key was not valid, replace the shared secret with
+	 * our own private key. This will lead to an output key unguessable
+	 * by outsiders, but will otherwise not leak whether the process
+	 * worked or not.
+	 */
+	scalar_encode(tmp, s);
+	for (int i = 0; i < 32; i ++) {
+		buf[65 + i] = shared[i] ^ (bad & (shared[i] ^ tmp[i]));
+	}
 
-#else
-#error Unknown curve
-#endif
+	/*
+	 * We need to order the two public keys lexicographically.
+	 */
+	uint32_t cc = 0;
+	for (int i = 31; i >= 0; i --) {
+		cc = ((uint32_t)epub_self[i]
+			- (uint32_t)epub_peer[i] - cc) >> 31;
+	}
+	uint32_t z1 = -cc;
+	uint32_t z2 = ~z1;
+	for (int i = 0; i < 32; i ++) {
+		buf[i]      = (epub_self[i] & z1) | (epub_peer[i] & z2);
+		buf[i + 32] = (epub_self[i] & z2) | (epub_peer[i] & z1);
+	}
+	buf[64] = 0x53 - (bad & (0x53 - 0x46));
+}
 
-/* ===================================================================== */
 /*
- * SECTION 5: CRYPTOGRAPHIC SCHEMES
- *
- * This part implements the high-level schemes (signature, key exchange...)
- * as documented in the jq255.h API.
+ * Final ECDH step: given the product point p (private key times peer
+ * point), derive the shared key with BLAKE2s. `bad` is -1 if the peer
+ * public key was invalid, 0 otherwise. Returned value is 1 on success,
+ * 0 on failure.
  */
+static int
+ecdh_finish(void *shared_key, const point *p, const scalar *s,
+	const uint8_t *epub_self, const uint8_t *epub_peer, uint32_t bad)
+{
+	uint8_t shared[32], buf[ECDH_KDF_LEN];
 
-#include "blake2s.h"
-#include "jq255.h"
+	/*
+	 * The encoded product point is the candidate shared secret.
+	 */
+	point_encode(shared, p);
+	ecdh_kdf_input(buf, shared, s, epub_self, epub_peer, bad);
+	blake2s(shared_key, 32, NULL, 0, buf, sizeof buf);
+	return (int)(bad + 1);
+}
 
-#if JQ == JQ255E
-#define jq_private_key            jq255e_private_key
-#define jq_public_key             jq255e_public_key
-#define jq_keypair                jq255e_keypair
-#define jq_generate_private_key   jq255e_generate_private_key
-#define jq_make_public            jq255e_make_public
-#define jq_generate_keypair       jq255e_generate_keypair
-#define jq_decode_private_key     jq255e_decode_private_key
-#define jq_decode_public_key      jq255e_decode_public_key
-#define jq_decode_keypair         jq255e_decode_keypair
-#define jq_encode_private_key     jq255e_encode_private_key
-#define jq_encode_public_key      jq255e_encode_public_key
-#define jq_encode_keypair         jq255e_encode_keypair
-#define jq_sign                   jq255e_sign
-#define jq_sign_seeded            jq255e_sign_seeded
-#define jq_verify                 jq255e_verify
-#define jq_ECDH                   jq255e_ECDH
-#elif JQ == JQ255S
-#define jq_private_key            jq255s_private_key
-#define jq_public_key             jq255s_public_key
-#define jq_keypair                jq255s_keypair
-#define jq_generate_private_key   jq255s_generate_private_key
-#define jq_make_public            jq255s_make_public
-#define jq_generate_keypair       jq255s_generate_keypair
-#define jq_decode_private_key     jq255s_decode_private_key
-#define jq_decode_public_key      jq255s_decode_public_key
-#define jq_decode_keypair         jq255s_decode_keypair
-#define jq_encode_private_key     jq255s_encode_private_key
-#define jq_encode_public_key      jq255s_encode_public_key
-#define jq_encode_keypair         jq255s_encode_keypair
-#define jq_sign                   jq255s_sign
-#define jq_sign_seeded            jq255s_sign_seeded
-#define jq_verify                 jq255s_verify
-#define jq_ECDH                   jq255s_ECDH
-#else
-#error Unknown curve
-#endif
+/* see jq255.h */
+int
+jq_ECDH(void *shared_key,
+	const jq_keypair *jk_self, const jq_public_key *pk_peer)
+{
+	point p;
+	scalar s;
+	const uint8_t *epub_self;
+	const uint8_t *epub_peer;
+	uint32_t bad;
+
+	/*
+	 * Get peer public key; set the 'bad' flag to true if the peer
+	 * public key was invalid.
+	 */
+	memcpy(&p, pk_peer, sizeof p);
+	epub_peer = (const uint8_t *)pk_peer + sizeof(point);
+	bad = point_is_neutral(&p);
+
+	/*
+	 * Get our private key, and multiply the peer public key with it.
+	 */
+	memcpy(&s, &jk_self->private_key, sizeof s);
+	STATS_BEGIN(st);
+	point_mul(&p, &p, &s);
+	STATS_END(st, JQ255_STAT_ECDH_MUL, 1);
+
+	epub_self = (const uint8_t *)&jk_self->public_key + sizeof(point);
+	return ecdh_finish(shared_key, &p, &s, epub_self, epub_peer, bad);
+}
+
+/* see jq255.h */
+int
+jq_ECDH_compact(void *shared_key,
+	const jq_keypair *jk_self, const jq_public_key_compact *cpk_peer)
+{
+	jq_public_key pk;
+
+	jq_decode_public_key(&pk, cpk_peer->b, 32);
+	return jq_ECDH(shared_key, jk_self, &pk);
+}
 
 /*
- * A private key is a scalar; a public key is a point, and its encoded
- * version (32 bytes). The API structure contains blobs into which we
- * copy our internal structures when approprivate.
- * In some cases, we get "invalid key" values. They use the following
- * representations:
- *  - Invalid private key: the scalar value is zero.
- *  - Invalid public key: the point is
- *    original invalid encoding is kept in the slot for the Z coordinate.
+ * Internal layout of a prepared local key pair: the private key, the
+ * encoded public key, and the recoded private key (digits and signs,
+ * see point_mul_prepare_scalar()).
+ */
+typedef struct {
+	scalar s;
+	uint8_t epub[32];
+	int8_t sd[52];
+	uint32_t sk;
+} ecdh_self;
+
+typedef char ecdh_self_size_check[
+	sizeof(ecdh_self) <= sizeof(jq_ECDH_self) ? 1 : -1];
+
+/*
+ * Internal layout of a prepared peer public key: the window of
+ * multiples of the peer point (see point_mul_prepare_window()), the
+ * encoded public key, and the 'bad' flag (-1 for an invalid key).
  */
+typedef struct {
+	point_affine win[16];
+	uint8_t epub[32];
+	uint32_t bad;
+} ecdh_peer;
+
+typedef char ecdh_peer_size_check[
+	sizeof(ecdh_peer) <= sizeof(jq_ECDH_peer) ? 1 : -1];
 
 /* see jq255.h */
 void
-jq_generate_private_key(jq_private_key *sk, const void *seed, size_t seed_len)
+jq_ECDH_prepare_self(jq_ECDH_self *es, const jq_keypair *jk_self)
 {
-	blake2s_context bc;
-	uint8_t tmp[32];
+	ecdh_self *x = (ecdh_self *)(void *)es;
+
+	memcpy(&x->s, &jk_self->private_key, sizeof x->s);
+	memcpy(x->epub,
+		(const uint8_t *)&jk_self->public_key + sizeof(point), 32);
+	x->sk = point_mul_prepare_scalar(x->sd, &x->s);
+}
+
+/* see jq255.h */
+void
+jq_ECDH_prepare_peer(jq_ECDH_peer *ep, const jq_public_key *pk_peer)
+{
+	ecdh_peer *x = (ecdh_peer *)(void *)ep;
+	point p;
+
+	/*
+	 * An invalid peer key is the neutral point, for which the window
+	 * is well-defined (all entries are the neutral); the 'bad' flag
+	 * then makes jq_ECDH_prepared() report the failure.
+	 */
+	memcpy(&p, pk_peer, sizeof p);
+	memcpy(x->epub, (const uint8_t *)pk_peer + sizeof(point), 32);
+	x->bad = point_is_neutral(&p);
+	point_mul_prepare_window(x->win, &p);
+}
+
+/* see jq255.h */
+int
+jq_ECDH_prepared(void *shared_key,
+	const jq_ECDH_self *es, const jq_ECDH_peer *ep)
+{
+	const ecdh_self *xs = (const ecdh_self *)(const void *)es;
+	const ecdh_peer *xp = (const ecdh_peer *)(const void *)ep;
+	point p;
+
+	STATS_BEGIN(st);
+	point_mul_prepared(&p, xp->win, xs->sd, xs->sk);
+	STATS_END(st, JQ255_STAT_ECDH_MUL, 1);
+	return ecdh_finish(shared_key, &p, &xs->s,
+		xs->epub, xp->epub, xp->bad);
+}
+
+/*
+ * Number of peers processed together by jq_ECDH_many(); this is also
+ * the width of the 8-way implementation.
+ */
+#define ECDH_MANY_GROUP   8
+
+/* see jq255.h */
+int
+jq_ECDH_many(void *shared_keys, const jq_keypair *jk_self,
+	const jq_public_key *pk_peers, size_t n, uint8_t *ok)
+{
+	point p[ECDH_MANY_GROUP];
+	point_affine win[ECDH_MANY_GROUP * 16];
+	uint8_t shared[ECDH_MANY_GROUP][32];
+	uint8_t kin[ECDH_MANY_GROUP][ECDH_KDF_LEN];
+	void *kout[ECDH_MANY_GROUP];
+	const void *kinp[ECDH_MANY_GROUP];
+	size_t kin_len[ECDH_MANY_GROUP];
+	uint32_t bad[ECDH_MANY_GROUP];
+	int8_t sd[52];
+	uint32_t sk, all;
 	scalar s;
+	const uint8_t *epub_self;
 
-	/* Hash the seed to produce 32 bytes, which are then decoded as a
-	   scalar. */
-	blake2s_init(&bc, 32);
-	blake2s_update(&bc, seed, seed_len);
-	blake2s_final(&bc, tmp);
-	scalar_decode_reduce(&s, tmp, 32);
+	if (ok != NULL) {
+		memset(ok, 0, (n + 7) >> 3);
+	}
 
-	/* It is very improbable that a zero is obtained, but just for
-	   completeness, in that case, we add 1. */
-	scalar_select(&s, &s, &scalar_one, scalar_is_zero(&s));
-	memcpy(sk, &s, sizeof s);
+	/*
+	 * The private key is recoded once for all peers.
+	 */
+	memcpy(&s, &jk_self->private_key, sizeof s);
+	epub_self = (const uint8_t *)&jk_self->public_key + sizeof(point);
+	sk = point_mul_prepare_scalar(sd, &s);
+
+	all = 1;
+	for (size_t i = 0; i < n; i += ECDH_MANY_GROUP) {
+		size_t m = n - i;
+		if (m > ECDH_MANY_GROUP) {
+			m = ECDH_MANY_GROUP;
+		}
+
+		/*
+		 * Windows of multiples of the peer points, as in
+		 * point_mul_prepare_window(); all windows of the group
+		 * are normalized with a single inversion. An invalid
+		 * peer key is the neutral point, with a well-defined
+		 * window. Each projective window is built in t[], then
+		 * stored in win[] (E, U, T) and zz[] (Z) until the
+		 * shared inversion. The temporaries are scoped so that
+		 * their stack space is reused by the ladder.
+		 */
+		{
+			gf zz[ECDH_MANY_GROUP * 16], iZ[ECDH_MANY_GROUP * 16];
+
+			for (size_t j = 0; j < m; j ++) {
+				point t[16];
+
+				memcpy(&t[0], &pk_peers[i + j], sizeof(point));
+				bad[j] = point_is_neutral(&t[0]);
+				for (int k = 1; k < 15; k += 2) {
+					point_double(&t[k], &t[k >> 1]);
+					point_add(&t[k + 1], &t[k], &t[0]);
+				}
+				point_double(&t[15], &t[7]);
+				for (int k = 0; k < 16; k ++) {
+					win[16 * j + k].E = t[k].E;
+					win[16 * j + k].U = t[k].U;
+					win[16 * j + k].T = t[k].T;
+					zz[16 * j + k] = t[k].Z;
+				}
+			}
+			gf_inv_batch(iZ, zz, 16 * m);
+			for (size_t k = 0; k < 16 * m; k ++) {
+				gf_mul(&win[k].E, &win[k].E, &iZ[k]);
+				gf_mul(&win[k].U, &win[k].U, &iZ[k]);
+				gf_mul(&win[k].T, &win[k].T, &iZ[k]);
+			}
+		}
+
+		STATS_BEGIN(st);
+#if JQ_IFMA
+		if (m >= MULGEN_X8_MIN && ifma_available()) {
+			/* Pad a partial group with copies of the first
+			   window. */
+			for (size_t j = m; j < ECDH_MANY_GROUP; j ++) {
+				memcpy(&win[16 * j], &win[0],
+					16 * sizeof win[0]);
+			}
+			point_mul_prepared_x8(p, win, sd, sk);
+		} else
+#endif
+		{
+			for (size_t j = 0; j < m; j ++) {
+				point_mul_prepared(&p[j], &win[16 * j],
+					sd, sk);
+			}
+		}
+		STATS_END(st, JQ255_STAT_ECDH_MUL, m);
+
+		/*
+		 * Encode the products with a shared inversion, then
+		 * derive the keys with the multi-buffer BLAKE2s.
+		 */
+		point_encode_batch(shared, p, m);
+		for (size_t j = 0; j < m; j ++) {
+			const jq_public_key *pk = &pk_peers[i + j];
+
+			ecdh_kdf_input(kin[j], shared[j], &s, epub_self,
+				(const uint8_t *)pk + sizeof(point), bad[j]);
+			kout[j] = (uint8_t *)shared_keys + 32 * (i + j);
+			kinp[j] = kin[j];
+			kin_len[j] = sizeof kin[j];
+		}
+		blake2s_multi(kout, 32, kinp, kin_len, m);
+		for (size_t j = 0; j < m; j ++) {
+			if (ok != NULL) {
+				ok[(i + j) >> 3] |=
+					(uint8_t)((bad[j] + 1) << ((i + j) & 7));
+			}
+			all &= bad[j] + 1;
+		}
+	}
+	return (int)all;
+}
+
+
+/*
+ * Group element and scalar API. The public types hold the internal
+ * point and scalar structures directly (with the same size, so that
+ * arrays of them can be used in place).
+ */
+typedef char point_size_check[
+	sizeof(point) == sizeof(jq_point) ? 1 : -1];
+typedef char scalar_size_check[
+	sizeof(scalar) == sizeof(jq_scalar) ? 1 : -1];
+
+/* see jq255.h */
+int
+jq_scalar_decode(jq_scalar *s, const void *src, size_t len)
+{
+	scalar x;
+	uint32_t r;
+
+	if (len != 32) {
+		x = scalar_zero;
+		r = 0;
+	} else {
+		r = scalar_decode(&x, src);
+	}
+	memcpy(s, &x, sizeof x);
+	return (int)(r & 1);
+}
+
+/* see jq255.h */
+void
+jq_scalar_decode_reduce(jq_scalar *s, const void *src, size_t len)
+{
+	scalar x;
+
+	scalar_decode_reduce(&x, src, len);
+	memcpy(s, &x, sizeof x);
+}
+
+/* see jq255.h */
+void
+jq_scalar_encode(void *dst, const jq_scalar *s)
+{
+	scalar x;
+
+	memcpy(&x, s, sizeof x);
+	scalar_encode(dst, &x);
+}
+
+/* see jq255.h */
+int
+jq_point_decode(jq_point *p, const void *src, size_t len)
+{
+	point x;
+	uint32_t r;
+
+	if (len != 32) {
+		x = point_neutral;
+		r = 0;
+	} else {
+		r = point_decode(&x, src);
+	}
+	memcpy(p, &x, sizeof x);
+	return (int)(r & 1);
+}
+
+/* see jq255.h */
+void
+jq_point_encode(void *dst, const jq_point *p)
+{
+	point x;
+
+	memcpy(&x, p, sizeof x);
+	point_encode(dst, &x);
+}
+
+/* see jq255.h */
+void
+jq_point_from_public_key(jq_point *p, const jq_public_key *pk)
+{
+	/* An invalid public key already holds the neutral point. */
+	memcpy(p, pk, sizeof(point));
+}
+
+/* see jq255.h */
+void
+jq_point_add(jq_point *p3, const jq_point *p1, const jq_point *p2)
+{
+	point x1, x2;
+
+	memcpy(&x1, p1, sizeof x1);
+	memcpy(&x2, p2, sizeof x2);
+	point_add(&x1, &x1, &x2);
+	memcpy(p3, &x1, sizeof x1);
+}
+
+/* see jq255.h */
+void
+jq_point_mul_vartime(jq_point *p2, const jq_point *p1, const jq_scalar *s)
+{
+	point x;
+	scalar y;
+
+	memcpy(&x, p1, sizeof x);
+	memcpy(&y, s, sizeof y);
+	point_mul_vartime(&x, &x, &y);
+	memcpy(p2, &x, sizeof x);
+}
+
+/* see jq255.h */
+void
+jq_point_mulgen_vartime(jq_point *p, const jq_scalar *s)
+{
+	point x;
+	scalar y;
+
+	memcpy(&y, s, sizeof y);
+	point_mulgen_vartime(&x, &y);
+	memcpy(p, &x, sizeof x);
+}
+/* see jq255.h */
+void
+jq_point_msm_vartime(jq_point *p, const jq_point *pp, const jq_scalar *ss,
+	size_t n)
+{
+	point x;
+
+	point_msm_vartime(&x, (const point *)(const void *)pp,
+		(const scalar *)(const void *)ss, n);
+	memcpy(p, &x, sizeof x);
+}
+
+/* see jq255.h */
+void
+jq_scalar_from_private_key(jq_scalar *s, const jq_private_key *sk)
+{
+	memcpy(s, sk, sizeof(scalar));
+}
+
+/* see jq255.h */
+int
+jq_private_key_from_scalar(jq_private_key *sk, const jq_scalar *s)
+{
+	scalar x;
+
+	/* A zero scalar is the "invalid key" value. */
+	memcpy(&x, s, sizeof x);
+	memcpy(sk, &x, sizeof x);
+	return (int)(~scalar_is_zero(&x) & 1);
+}
+
+/* see jq255.h */
+void
+jq_scalar_add(jq_scalar *d, const jq_scalar *a, const jq_scalar *b)
+{
+	scalar x, y;
+
+	memcpy(&x, a, sizeof x);
+	memcpy(&y, b, sizeof y);
+	scalar_add(&x, &x, &y);
+	memcpy(d, &x, sizeof x);
+}
+
+/* see jq255.h */
+void
+jq_scalar_sub(jq_scalar *d, const jq_scalar *a, const jq_scalar *b)
+{
+	scalar x, y;
+
+	memcpy(&x, a, sizeof x);
+	memcpy(&y, b, sizeof y);
+	scalar_sub(&x, &x, &y);
+	memcpy(d, &x, sizeof x);
 }
 
 /* see jq255.h */
 void
-jq_make_public(jq_public_key *pk, const jq_private_key *sk)
+jq_scalar_neg(jq_scalar *d, const jq_scalar *a)
 {
-	scalar s;
-	point p;
+	scalar x;
 
-	memcpy(&s, sk, sizeof s);
-	point_mulgen(&p, &s);
-	memcpy(pk, &p, sizeof p);
-	point_encode((unsigned char *)pk + sizeof p, &p);
+	memcpy(&x, a, sizeof x);
+	scalar_neg(&x, &x);
+	memcpy(d, &x, sizeof x);
 }
 
 /* see jq255.h */
 void
-jq_generate_keypair(jq_keypair *jk, const void *seed, size_t seed_len)
+jq_scalar_mul(jq_scalar *d, const jq_scalar *a, const jq_scalar *b)
 {
-	jq_generate_private_key(&jk->private_key, seed, seed_len);
-	jq_make_public(&jk->public_key, &jk->private_key);
+	scalar x, y;
+
+	memcpy(&x, a, sizeof x);
+	memcpy(&y, b, sizeof y);
+	scalar_mul(&x, &x, &y);
+	memcpy(d, &x, sizeof x);
 }
 
 /* see jq255.h */
 int
-jq_decode_private_key(jq_private_key *sk, const void *src, size_t len)
+jq_point_to_public_key(jq_public_key *pk, const jq_point *p)
 {
-	scalar s;
+	point x;
 	uint32_t r;
 
-	if (len != 32) {
-		s = scalar_zero;
-		r = 0;
-	} else {
-		r = scalar_decode(&s, src);
-		r &= ~scalar_is_zero(&s);
-	}
-	memcpy(sk, &s, sizeof s);
+	memcpy(&x, p, sizeof x);
+	memcpy(pk, &x, sizeof x);
+	point_encode((unsigned char *)pk + sizeof x, &x);
+	r = ~point_is_neutral(&x);
 	return (int)(r & 1);
 }
 
 /* see jq255.h */
-int
-jq_decode_public_key(jq_public_key *pk, const void *src, size_t len)
+void
+jq_point_neg(jq_point *p2, const jq_point *p1)
 {
-	point p;
-	uint32_t r;
+	point x;
 
-	if (len != 32) {
-		p = point_neutral;
-		memset((unsigned char *)pk + sizeof p, 0, 32);
-		r = 0;
-	} else {
-		r = point_decode(&p, src);
-		r &= ~point_is_neutral(&p);
-		memcpy((unsigned char *)pk + sizeof p, src, 32);
-	}
-	memcpy(pk, &p, sizeof p);
-	return (int)(r & 1);
+	memcpy(&x, p1, sizeof x);
+	point_neg(&x, &x);
+	memcpy(p2, &x, sizeof x);
 }
 
 /* see jq255.h */
-int
-jq_decode_keypair(jq_keypair *jk, const void *src, size_t len)
+void
+jq_point_sub(jq_point *p3, const jq_point *p1, const jq_point *p2)
 {
-	uint32_t r;
-	scalar s;
-	point p;
+	point x1, x2;
 
-	if (len != 64) {
-		memcpy(&jk->private_key, &scalar_zero, sizeof scalar_zero);
-		memcpy(&jk->public_key, &point_neutral, sizeof point_neutral);
-		memset((unsigned char *)&jk->public_key + sizeof(point), 0, 32);
-		return 0;
-	}
-	r = scalar_decode(&s, src);
-	r &= ~scalar_is_zero(&s);
-	r &= point_decode(&p, (const uint8_t *)src + 32);
-	r &= ~point_is_neutral(&p);
-	scalar_select(&s, &scalar_zero, &s, r);
-	point_select(&p, &point_neutral, &p, r);
-	memcpy(&jk->private_key, &s, sizeof s);
-	memcpy(&jk->public_key, &p, sizeof p);
-	memcpy((unsigned char *)&jk->public_key + sizeof(point),
-		(const uint8_t *)src + 32, 32);
-	return (int)(r & 1);
+	memcpy(&x1, p1, sizeof x1);
+	memcpy(&x2, p2, sizeof x2);
+	point_sub(&x1, &x1, &x2);
+	memcpy(p3, &x1, sizeof x1);
 }
 
 /* see jq255.h */
-size_t
-jq_encode_private_key(void *dst, const jq_private_key *sk)
+void
+jq_point_double(jq_point *p2, const jq_point *p1)
 {
-	scalar s;
+	point x;
 
-	memcpy(&s, sk, sizeof s);
-	scalar_encode(dst, &s);
-	return 32;
+	memcpy(&x, p1, sizeof x);
+	point_double(&x, &x);
+	memcpy(p2, &x, sizeof x);
 }
 
 /* see jq255.h */
-size_t
-jq_encode_public_key(void *dst, const jq_public_key *pk)
+void
+jq_point_mul(jq_point *p2, const jq_point *p1, const jq_scalar *s)
 {
-	uint8_t tmp[32];
-	point p;
-	uint32_t r;
+	point x;
+	scalar y;
 
-	/* If the key is valid, then we already have a copy of its encoding,
-	   so we can just copy that value. If the key is invalid, then
-	   the encoding is invalid and we must produce from zeros. */
-	memcpy(&p, pk, sizeof p);
-	memcpy(tmp, (const uint8_t *)pk + sizeof(point), 32);
-	r = ~point_is_neutral(&p);
-	for (int i = 0; i < 32; i ++) {
-		tmp[i] &= r;
-	}
-	memcpy(dst, tmp, 32);
-	return 32;
+	memcpy(&x, p1, sizeof x);
+	memcpy(&y, s, sizeof y);
+	point_mul(&x, &x, &y);
+	memcpy(p2, &x, sizeof x);
 }
 
 /* see jq255.h */
-size_t
-jq_encode_keypair(void *dst, const jq_keypair *jk)
+void
+jq_point_mulgen(jq_point *p, const jq_scalar *s)
 {
-	jq_encode_private_key(dst, &jk->private_key);
-	jq_encode_public_key((uint8_t *)dst + 32, &jk->public_key);
-	return 64;
+	point x;
+	scalar y;
+
+	memcpy(&y, s, sizeof y);
+	point_mulgen(&x, &y);
+	memcpy(p, &x, sizeof x);
 }
 
-/*
- * Compute the per-signature secret scalar k. The private key is provided
- * as the scalar `sec`; the public key is provided as `epub` (encoded).
- */
-static void
-make_sign_k(scalar *k, const scalar *sec, const void *epub,
-	const char *hash_name, const void *hv, size_t hv_len,
-	const void *seed, size_t seed_len)
+/* see jq255.h */
+int
+jq_point_equals(const jq_point *p1, const jq_point *p2)
 {
-	blake2s_context bc;
-	unsigned char tmp[32];
+	point x1, x2;
 
-	blake2s_init(&bc, 32);
-	scalar_encode(tmp, sec);
-	blake2s_update(&bc, tmp, 32);
-	blake2s_update(&bc, epub, 32);
-	for (int i = 0; i < 8; i ++) {
-		tmp[i] = (uint8_t)((uint64_t)seed_len >> (8 * i));
-	}
-	blake2s_update(&bc, tmp, 8);
-	blake2s_update(&bc, seed, seed_len);
-	if (hash_name == NULL || hash_name[0] == 0) {
-		tmp[0] = 0x52;
-		blake2s_update(&bc, tmp, 1);
-	} else {
-		tmp[0] = 0x48;
-		blake2s_update(&bc, tmp, 1);
-		blake2s_update(&bc, hash_name, strlen(hash_name) + 1);
-	}
-	blake2s_update(&bc, hv, hv_len);
-	blake2s_final(&bc, tmp);
-	scalar_decode_reduce(k, tmp, 32);
+	memcpy(&x1, p1, sizeof x1);
+	memcpy(&x2, p2, sizeof x2);
+	return (int)(point_equals(&x1, &x2) & 1);
 }
 
-/*
- * Compute the "challenge" part of the signature. The challenge has
- * length exactly 16 bytes.
- */
-static void
-make_challenge(void *dst, const point *r, const void *epub,
-	const char *hash_name, const void *hv, size_t hv_len)
+/* see jq255.h */
+int
+jq_point_is_neutral(const jq_point *p)
 {
-	blake2s_context bc;
-	unsigned char tmp[32];
+	point x;
 
-	blake2s_init(&bc, 32);
-	point_encode(tmp, r);
-	blake2s_update(&bc, tmp, 32);
-	blake2s_update(&bc, epub, 32);
-	if (hash_name == NULL || hash_name[0] == 0) {
-		tmp[0] = 0x52;
-		blake2s_update(&bc, tmp, 1);
-	} else {
-		tmp[0] = 0x48;
-		blake2s_update(&bc, tmp, 1);
-		blake2s_update(&bc, hash_name, strlen(hash_name) + 1);
-	}
-	blake2s_update(&bc, hv, hv_len);
-	blake2s_final(&bc, tmp);
-	memcpy(dst, tmp, 16);
+	memcpy(&x, p, sizeof x);
+	return (int)(point_is_neutral(&x) & 1);
 }
 
+/*
+ * Layout of a copy of the base point tables: the table pointers, then
+ * the points (at offset 64 from the aligned start).
+ */
+#define TABLES_ALIGN   64
+
 /* see jq255.h */
 size_t
-jq_sign(void *sig, const jq_keypair *jk,
-	const char *hash_name, const void *hv, size_t hv_len)
+jq_tables_size(void)
 {
-	return jq_sign_seeded(sig, jk, hash_name, hv, hv_len, NULL, 0);
+	return (TABLES_ALIGN - 1) + TABLES_ALIGN
+		+ BASE_TABLES_NUM * sizeof(point_affine);
 }
 
 /* see jq255.h */
-size_t
-jq_sign_seeded(void *sig, const jq_keypair *jk,
-	const char *hash_name, const void *hv, size_t hv_len,
-	const void *seed, size_t seed_len)
+const jq_tables *
+jq_tables_clone(void *mem, size_t len)
 {
-	scalar sec, k, s;
-	point r;
-	const void *epub;
-	unsigned char tmp[32];
-
-	memcpy(&sec, &jk->private_key, sizeof sec);
-	epub = (const uint8_t *)&jk->public_key + sizeof(point);
-
-	/* Per-signature secret scalar k. */
-	make_sign_k(&k, &sec, epub, hash_name, hv, hv_len, seed, seed_len);
-
-	/* R = k*G */
-	point_mulgen(&r, &k);
-
-	/* c = H(R, Q, m) */
-	make_challenge(tmp, &r, epub, hash_name, hv, hv_len);
-
-	/* s = k + sec*c */
-	scalar_decode_reduce(&s, tmp, 16);
-	scalar_mul(&s, &s, &sec);
-	scalar_add(&s, &s, &k);
+	base_tables *bt;
+	point_affine *win;
+	uintptr_t a;
 
-	memcpy(sig, tmp, 16);
-	scalar_encode((uint8_t *)sig + 16, &s);
-	return 48;
+	if (len < jq_tables_size()) {
+		return NULL;
+	}
+	a = ((uintptr_t)mem + (TABLES_ALIGN - 1))
+		& ~(uintptr_t)(TABLES_ALIGN - 1);
+	bt = (base_tables *)a;
+	win = (point_affine *)(a + TABLES_ALIGN);
+	memcpy(win, point_win_base, 16 * sizeof *win);
+	memcpy(win + 16, point_win_base65, 16 * sizeof *win);
+	memcpy(win + 32, point_win_base130, 16 * sizeof *win);
+	memcpy(win + 48, point_win_base195, 16 * sizeof *win);
+	bt->base = win;
+	bt->base65 = win + 16;
+	bt->base130 = win + 32;
+	bt->base195 = win + 48;
+#if MULGEN_LARGE
+	memcpy(win + 64, point_win_mulgen,
+		16 * MULGEN_NUM_WIN * sizeof *win);
+	bt->mulgen = win + 64;
+#endif
+	return (const jq_tables *)(const void *)bt;
 }
 
 /* see jq255.h */
-int
-jq_verify(const void *sig, size_t sig_len, const jq_public_key *pk,
-	const char *hash_name, const void *hv, size_t hv_len)
+void
+jq_tables_use(const jq_tables *t)
 {
-	point p;
-	const void *epub;
-	scalar s;
-	unsigned char tmp[16];
-	uint32_t c[4];
-
-	/* Valid signatures have length 48 bytes exactly. */
-	if (sig_len != 48) {
-		return 0;
-	}
-
-	/* If the public key is invalid, report a failure. */
-	memcpy(&p, pk, sizeof p);
-	epub = (const uint8_t *)pk + sizeof(point);
-	if (point_is_neutral(&p)) {
-		return 0;
-	}
-
-	/* Decode scalar s and challenge c. */
-	if (!scalar_decode(&s, (const uint8_t *)sig + 16)) {
-		return 0;
-	}
-	for (int i = 0; i < 4; i ++) {
-		c[i] = dec32le((const uint8_t *)sig + 4 * i);
-	}
-
-	/* Recompute R = s*G - c*Q */
-	point_neg(&p, &p);
-	point_mul128_add_mulgen_vartime(&p, &p, c, &s);
-
-	/* Recompute the challenge c. Signature is valid if that value
-	   matches what was received as part of the signature. */
-	make_challenge(tmp, &p, epub, hash_name, hv, hv_len);
-	return memcmp(tmp, sig, 16) == 0;
+	base_tables_tls = (const base_tables *)(const void *)t;
 }
 
 /* see jq255.h */
 int
-jq_ECDH(void *shared_key,
-	const jq_keypair *jk_self, const jq_public_key *pk_peer)
+jq_stats_snapshot(jq255_stats *st)
 {
-	point p;
-	scalar s;
-	const uint8_t *epub_self;
-	const uint8_t *epub_peer;
-	uint32_t bad;
-	uint8_t shared[32], tmp[64];
-	blake2s_context bc;
-
-	/*
-	 * Get peer public key; set the 'bad' flag to true if the peer
-	 * public key was invalid.
-	 */
-	memcpy(&p, pk_peer, sizeof p);
-	epub_peer = (const uint8_t *)pk_peer + sizeof(point);
-	bad = point_is_neutral(&p);
-
-	/*
-	 * Get our private key, and multiply the peer public key with it.
-	 * The encoded output point is the candidate shared secret.
-	 */
-	memcpy(&s, &jk_self->private_key, sizeof s);
-	point_mul(&p, &p, &s);
-	point_encode(shared, &p);
-
-	/*
-	 * If the peer key was not valid, replace the shared secret with
-	 * our own private key. This will lead to an output key unguessable
-	 * by outsiders, but will otherwise not leak whether the process
-	 * worked or not.
-	 */
-	scalar_encode(tmp, &s);
-	for (int i = 0; i < 32; i ++) {
-		shared[i] ^= bad & (shared[i] ^ tmp[i]);
-	}
+#if JQ255_STATS
+	*st = jq_stats_tls;
+	return 1;
+#else
+	memset(st, 0, sizeof *st);
+	return 0;
+#endif
+}
 
-	/*
-	 * Derive the key with BLAKE2s.
-	 * We need to order the two public keys lexicographically.
-	 */
-	epub_self = (const uint8_t *)&jk_self->public_key + sizeof(point);
-	uint32_t cc = 0;
-	for (int i = 31; i >= 0; i --) {
-		cc = ((uint32_t)epub_self[i]
-			- (uint32_t)epub_peer[i] - cc) >> 31;
-	}
-	uint32_t z1 = -cc;
-	uint32_t z2 = ~z1;
-	for (int i = 0; i < 32; i ++) {
-		tmp[i]      = (epub_self[i] & z1) | (epub_peer[i] & z2);
-		tmp[i + 32] = (epub_self[i] & z2) | (epub_peer[i] & z1);
-	}
-	blake2s_init(&bc, 32);
-	blake2s_update(&bc, tmp, 64);
-	tmp[0] = 0x53 - (bad & (0x53 - 0x46));
-	blake2s_update(&bc, tmp, 1);
-	blake2s_update(&bc, shared, 32);
-	blake2s_final(&bc, shared_key);
-	return (int)(bad + 1);
+/* see jq255.h */
+void
+jq_stats_reset(void)
+{
+#if JQ255_STATS
+	memset(&jq_stats_tls, 0, sizeof jq_stats_tls);
+#endif
 }
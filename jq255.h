@@ -18,6 +18,41 @@ typedef union { uint32_t w32[8]; uint32_t w64[4]; } jq255s_private_key;
 typedef union { uint32_t w32[40]; uint32_t w64[20]; } jq255e_public_key;
 typedef union { uint32_t w32[40]; uint32_t w64[20]; } jq255s_public_key;
 
+/*
+ * Types for an expanded public key, which contains a public key along
+ * with precomputed tables that speed up signature verification.
+ * Expanded keys are large (1696 bytes) and meant for long-lived public
+ * keys that verify many signatures.
+ * Type contents are opaque and MUST NOT be accessed directly.
+ */
+typedef union { uint32_t w32[424]; uint64_t w64[212]; }
+	jq255e_public_key_expanded;
+typedef union { uint32_t w32[424]; uint64_t w64[212]; }
+	jq255s_public_key_expanded;
+
+/*
+ * Types for a compact public key. A compact key holds only the 32-byte
+ * public key encoding (validated when the compact key was created); the
+ * point is decoded again on each use. This trades a point decoding per
+ * operation (about a sixth of the cost of a signature verification) for a
+ * five times smaller footprint than a public key.
+ * Type contents are opaque and MUST NOT be accessed directly.
+ */
+typedef union { uint8_t b[32]; uint32_t w32[8]; } jq255e_public_key_compact;
+typedef union { uint8_t b[32]; uint32_t w32[8]; } jq255s_public_key_compact;
+
+/*
+ * Types for prepared ECDH operands: a local key pair with its private
+ * key already recoded (128 bytes), and a peer public key with its
+ * precomputed window of multiples (1576 bytes). Preparing both sides
+ * once makes each subsequent key exchange between them faster.
+ * Type contents are opaque and MUST NOT be accessed directly.
+ */
+typedef union { uint32_t w32[32]; uint64_t w64[16]; } jq255e_ECDH_self;
+typedef union { uint32_t w32[32]; uint64_t w64[16]; } jq255s_ECDH_self;
+typedef union { uint32_t w32[394]; uint64_t w64[197]; } jq255e_ECDH_peer;
+typedef union { uint32_t w32[394]; uint64_t w64[197]; } jq255s_ECDH_peer;
+
 /*
  * Types for a private/public key pair, which contains a private and
  * a public key. Key pairs are supposed to correspond to each other.
@@ -59,6 +94,72 @@ void jq255e_generate_keypair(jq255e_keypair *jk,
 void jq255s_generate_keypair(jq255s_keypair *jk,
 	const void *seed, size_t seed_len);
 
+/*
+ * Generate `n` key pairs. Key pair i is generated from seed seeds[i]
+ * (of length seed_len[i] bytes), and is identical to the output of
+ * jq255e_generate_keypair() (resp. jq255s_generate_keypair()) for that
+ * seed; the same rules about seed entropy apply. Key pairs are computed
+ * in groups which share the normalization of the public keys (one
+ * inversion per group instead of one per key), and use the batch base
+ * point multiplication, so that this function is substantially faster
+ * than individual generation. All steps are constant-time.
+ */
+void jq255e_generate_keypairs(jq255e_keypair *jk,
+	const void *const *seeds, const size_t *seed_len, size_t n);
+void jq255s_generate_keypairs(jq255s_keypair *jk,
+	const void *const *seeds, const size_t *seed_len, size_t n);
+
+/*
+ * Ephemeral key pool: a fixed-capacity ring of ready key pairs, meant
+ * for key exchanges with single-use (ephemeral) keys. Refilling the
+ * pool (e.g. from an idle or background thread) uses the batch key
+ * generation of jq255e_generate_keypairs(); taking a key out of the
+ * pool is then a cheap, constant-time operation that does not involve
+ * any point multiplication. The pool is lock-free: any number of
+ * threads may refill it and pop keys from it concurrently.
+ *
+ * The library does not allocate memory; the caller provides the pool
+ * structure and an array of `capacity` slots, which must remain valid
+ * (and not move) as long as the pool is used. The capacity must be a
+ * power of two, at least 2. jq255e_keypool_init() returns 1 on success,
+ * 0 if the capacity is not acceptable.
+ *
+ * jq255e_keypool_refill() generates up to `max` new key pairs, stopping
+ * early when the pool is full, and returns the number of key pairs that
+ * were added. The seed must have at least 128 bits of fresh entropy
+ * for each call (the keys of a refill are derived from the seed and a
+ * pool-wide counter).
+ *
+ * jq255e_keypool_pop() removes one key pair from the pool and writes it
+ * into `jk`. Each key pair is returned only once, and its copy in the
+ * pool is cleared. Returned value is 1 on success, 0 if the pool is
+ * empty (`jk` is then unmodified; the caller may generate a key pair
+ * directly, or refill the pool).
+ *
+ * jq255e_keypool_count() returns the number of key pairs currently in
+ * the pool (approximate if other threads are using the pool), e.g. to
+ * decide when to trigger a refill.
+ *
+ * Type contents are opaque and MUST NOT be accessed directly.
+ */
+typedef union { uint32_t w32[50]; uint64_t w64[25]; } jq255e_keypool_slot;
+typedef union { uint32_t w32[50]; uint64_t w64[25]; } jq255s_keypool_slot;
+typedef union { uint32_t w32[38]; uint64_t w64[19]; } jq255e_keypool;
+typedef union { uint32_t w32[38]; uint64_t w64[19]; } jq255s_keypool;
+
+int jq255e_keypool_init(jq255e_keypool *pool,
+	jq255e_keypool_slot *slots, size_t capacity);
+int jq255s_keypool_init(jq255s_keypool *pool,
+	jq255s_keypool_slot *slots, size_t capacity);
+size_t jq255e_keypool_refill(jq255e_keypool *pool,
+	const void *seed, size_t seed_len, size_t max);
+size_t jq255s_keypool_refill(jq255s_keypool *pool,
+	const void *seed, size_t seed_len, size_t max);
+int jq255e_keypool_pop(jq255e_keypool *pool, jq255e_keypair *jk);
+int jq255s_keypool_pop(jq255s_keypool *pool, jq255s_keypair *jk);
+size_t jq255e_keypool_count(jq255e_keypool *pool);
+size_t jq255s_keypool_count(jq255s_keypool *pool);
+
 /*
  * Decode a private key from bytes. Returned value is 1 on success, 0
  * on failure (invalid private key). On failure, the destination structure
@@ -83,6 +184,100 @@ int jq255e_decode_public_key(jq255e_public_key *pk,
 int jq255s_decode_public_key(jq255s_public_key *pk,
 	const void *src, size_t len);
 
+/*
+ * Decode n public keys at once. The source (src) consists of the n
+ * concatenated encoded public keys, i.e. 32*n bytes; each decoded key
+ * is written into pk[i]. The ok bitmap must have room for (n+7)/8 bytes;
+ * bit i (bit i%8 of byte i/8) is set to 1 if key i was successfully
+ * decoded, to 0 otherwise (and pk[i] is then set to the "invalid key"
+ * value, as with jq255e_decode_public_key()). Returned value is 1 if all
+ * keys were decoded successfully, 0 otherwise.
+ *
+ * This is equivalent to calling jq255e_decode_public_key() on each key
+ * in turn, but faster, since square root computations are interleaved.
+ * Processing is constant-time for each key; only the number of keys
+ * may leak.
+ */
+int jq255e_decode_public_keys(jq255e_public_key *pk,
+	const void *src, size_t n, uint8_t *ok);
+int jq255s_decode_public_keys(jq255s_public_key *pk,
+	const void *src, size_t n, uint8_t *ok);
+
+/*
+ * Key directory: a flat file format for large sets of decoded public
+ * keys, meant to be mapped into memory (e.g. with mmap()) and used in
+ * place, without any per-key decoding or copy.
+ *
+ * Layout (version 1): a 64-byte header, followed by n records of
+ * JQ255_KEYDIR_RECORD_LEN bytes, with record i at offset
+ * 64 + i*JQ255_KEYDIR_RECORD_LEN. All header fields are little-endian.
+ *
+ *    offset  length  contents
+ *       0       8    magic: the ASCII string "JQKEYDIR"
+ *       8       4    format version (1)
+ *      12       4    curve: 1 for jq255e, 2 for jq255s
+ *      16       4    record length (JQ255_KEYDIR_RECORD_LEN)
+ *      20       4    reserved (zero)
+ *      24       8    number of records n
+ *      32       8    number of valid keys
+ *      40      16    BLAKE2s (16-byte output) of all records
+ *      56       8    BLAKE2s (8-byte output) of header bytes 0 to 55
+ *
+ * A record holds the decoded point, as four fully reduced field
+ * elements (32 bytes each, little-endian), followed by the 32-byte
+ * encoded key. Invalid encodings in the builder input yield records
+ * in the "invalid key" state, so that record indices match the input.
+ * On little-endian systems, a record is a jq255e_public_key (resp.
+ * jq255s_public_key) value, which the open function exploits.
+ */
+#define JQ255_KEYDIR_HEADER_LEN   64
+#define JQ255_KEYDIR_RECORD_LEN   160
+
+/*
+ * Get the size (in bytes) of a key directory with n records.
+ */
+size_t jq255e_keydir_size(size_t n);
+size_t jq255s_keydir_size(size_t n);
+
+/*
+ * Build a key directory from n encoded public keys (src, 32*n bytes)
+ * into dst, which must have room for jq255e_keydir_size(n) bytes (it
+ * has no alignment requirement). Keys are decoded with
+ * jq255e_decode_public_keys(). Returned value is the number of valid
+ * keys.
+ */
+size_t jq255e_keydir_build(void *dst, const void *src, size_t n);
+size_t jq255s_keydir_build(void *dst, const void *src, size_t n);
+
+/*
+ * Open a key directory of len bytes at address buf (normally, a file
+ * mapping). The header (magic, version, curve, record length and
+ * checksum) and the total length are checked; on success, a pointer to
+ * the first record is returned, and the number of records is written
+ * into *n. The records can then be used directly as public keys, e.g.
+ * with jq255e_verify(). NULL is returned if the header is invalid or
+ * does not match the curve, if the buffer is too short, if buf is not
+ * a multiple of 8, or if the system is not little-endian.
+ *
+ * The record contents are not validated (only jq255e_keydir_check()
+ * does that, by recomputing the records digest). The file is a cache
+ * of already validated keys, and must be as trusted as the code that
+ * uses it.
+ */
+const jq255e_public_key *jq255e_keydir_open(const void *buf, size_t len,
+	size_t *n);
+const jq255s_public_key *jq255s_keydir_open(const void *buf, size_t len,
+	size_t *n);
+
+/*
+ * Check the records of a key directory (already accepted by
+ * jq255e_keydir_open()) against the records digest in the header.
+ * This reads the whole file. Returned value is 1 if the digest
+ * matches, 0 otherwise.
+ */
+int jq255e_keydir_check(const void *buf, size_t len);
+int jq255s_keydir_check(const void *buf, size_t len);
+
 /*
  * Decode a key pair, i.e. the concatenation of a private key
  * and a public key. Returned value is 1 on success, 0 on error.
@@ -111,6 +306,39 @@ size_t jq255s_encode_private_key(void *dst, const jq255s_private_key *sk);
 size_t jq255e_encode_public_key(void *dst, const jq255e_public_key *pk);
 size_t jq255s_encode_public_key(void *dst, const jq255s_public_key *pk);
 
+/*
+ * Decode a public key from bytes into a compact public key. The
+ * encoding is fully validated, with the same rules as in
+ * jq255e_decode_public_key(); returned value is 1 on success, 0 on
+ * failure. On failure, the compact key is set to an "invalid key" value.
+ */
+int jq255e_decode_public_key_compact(jq255e_public_key_compact *cpk,
+	const void *src, size_t len);
+int jq255s_decode_public_key_compact(jq255s_public_key_compact *cpk,
+	const void *src, size_t len);
+
+/*
+ * Convert a public key into a compact public key. This is inexpensive
+ * (no point decoding is involved); in particular, keys decoded with
+ * jq255e_decode_public_keys() can be converted to compact keys with
+ * this function. If the source key is invalid, then so is the compact
+ * key.
+ */
+void jq255e_compact_public_key(jq255e_public_key_compact *cpk,
+	const jq255e_public_key *pk);
+void jq255s_compact_public_key(jq255s_public_key_compact *cpk,
+	const jq255s_public_key *pk);
+
+/*
+ * Encode a compact public key. Output length is exactly 32 bytes.
+ * Output length is returned. If the source key is invalid, then this
+ * function produces 32 bytes of value 0x00.
+ */
+size_t jq255e_encode_public_key_compact(void *dst,
+	const jq255e_public_key_compact *cpk);
+size_t jq255s_encode_public_key_compact(void *dst,
+	const jq255s_public_key_compact *cpk);
+
 /*
  * Encode a key pair, i.e. the concatenation of a private key and a public
  * key. Output length is exactly 64 bytes. Output length is returned. If
@@ -148,6 +376,68 @@ size_t jq255s_sign_seeded(void *sig, const jq255s_keypair *jk,
 	const char *hash_name, const void *hv, size_t hv_len,
 	const void *seed, size_t seed_len);
 
+/*
+ * A signer is a key pair prepared for generating many signatures: it
+ * keeps the hashing state for the key-dependent part of the
+ * per-signature scalar derivation (one BLAKE2s block, over the encoded
+ * private and public keys), so that each signature starts from there.
+ * signer_sign() produces exactly the same signature as
+ * jq255e_sign_seeded() (resp. jq255s_sign_seeded()) with the source
+ * key pair; this is worthwhile mostly for short message hashes, for
+ * which the saved block is a measurable share of the hashing cost.
+ *
+ * The signer contains a copy of the private key. It is not modified by
+ * signer_sign(), so a single signer can be used concurrently from
+ * several threads.
+ * Type contents are opaque and MUST NOT be accessed directly.
+ */
+typedef union { uint32_t w32[46]; uint64_t w64[23]; } jq255e_signer;
+typedef union { uint32_t w32[46]; uint64_t w64[23]; } jq255s_signer;
+void jq255e_signer_init(jq255e_signer *sg, const jq255e_keypair *jk);
+size_t jq255e_signer_sign(void *sig, const jq255e_signer *sg,
+	const char *hash_name, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len);
+void jq255s_signer_init(jq255s_signer *sg, const jq255s_keypair *jk);
+size_t jq255s_signer_sign(void *sig, const jq255s_signer *sg,
+	const char *hash_name, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len);
+
+/*
+ * Executor interface for batch operations. The library does not create
+ * threads; instead, batch functions split their work into independent
+ * tasks, and hand them to the caller-provided run() callback, which
+ * MUST invoke task(arg, i) exactly once for each i from 0 to
+ * num_tasks-1, in any order and possibly concurrently from several
+ * threads, and return only when all invocations have completed. The
+ * `pool` value is passed unchanged as first parameter of run().
+ */
+typedef struct {
+	void (*run)(void *pool, size_t num_tasks,
+		void (*task)(void *arg, size_t index), void *arg);
+	void *pool;
+} jq255_executor;
+
+/*
+ * Sign `n` message hashes with the same key pair. Message i is provided
+ * as hv[i] (of length hv_len[i] bytes); all messages use the same hash
+ * function `hash_name`. The n signatures (48 bytes each) are written
+ * consecutively into `sigs`; signature i is byte-for-byte identical to
+ * the output of jq255e_sign() (resp. jq255s_sign()) for message i.
+ * The total output length (48*n) is returned.
+ *
+ * If `ex` is not NULL, then the work is spread over the executor `ex`;
+ * otherwise, all signatures are computed in the calling thread.
+ * Signatures are processed in chunks which share some of the
+ * computations, so that this function is faster than individual
+ * signature generation even without an executor.
+ */
+size_t jq255e_sign_many(void *sigs, const jq255e_keypair *jk,
+	const char *hash_name, const void *const *hv, const size_t *hv_len,
+	size_t n, const jq255_executor *ex);
+size_t jq255s_sign_many(void *sigs, const jq255s_keypair *jk,
+	const char *hash_name, const void *const *hv, const size_t *hv_len,
+	size_t n, const jq255_executor *ex);
+
 /*
  * Standard hash function names.
  */
@@ -165,6 +455,39 @@ size_t jq255s_sign_seeded(void *sig, const jq255s_keypair *jk,
 #define JQ255_HASHNAME_BLAKE2S      "blake2s"
 #define JQ255_HASHNAME_BLAKE3       "blake3"
 
+/*
+ * Streaming signature generation, for messages that are too large to
+ * be hashed by the caller in one go, or that arrive in chunks. The
+ * message is hashed with BLAKE2s (32-byte output) as it is injected;
+ * the final step then signs that hash value. The resulting signature
+ * is exactly the one obtained with jq255e_sign_seeded() (resp.
+ * jq255s_sign_seeded()) with hash_name JQ255_HASHNAME_BLAKE2S and the
+ * BLAKE2s hash of the complete message; it can thus be verified with
+ * jq255e_verify() or the streaming verification functions below.
+ *
+ * sign_init() binds the context to a key pair, and precomputes the
+ * key-dependent part of the per-signature scalar derivation. The
+ * message is then injected with an arbitrary number of calls to
+ * sign_update(). sign_final() writes the 48-byte signature into
+ * `sig` (with an optional seed, as in jq255e_sign_seeded()) and
+ * returns its length; the context is then reset for a new message with
+ * the same key pair.
+ *
+ * The context contains a copy of the private key. It does not contain
+ * any pointer, and can be copied or moved in RAM.
+ * Type contents are opaque and MUST NOT be accessed directly.
+ */
+typedef union { uint32_t w32[76]; uint64_t w64[38]; } jq255e_sign_ctx;
+typedef union { uint32_t w32[76]; uint64_t w64[38]; } jq255s_sign_ctx;
+void jq255e_sign_init(jq255e_sign_ctx *sc, const jq255e_keypair *jk);
+void jq255e_sign_update(jq255e_sign_ctx *sc, const void *data, size_t len);
+size_t jq255e_sign_final(jq255e_sign_ctx *sc, void *sig,
+	const void *seed, size_t seed_len);
+void jq255s_sign_init(jq255s_sign_ctx *sc, const jq255s_keypair *jk);
+void jq255s_sign_update(jq255s_sign_ctx *sc, const void *data, size_t len);
+size_t jq255s_sign_final(jq255s_sign_ctx *sc, void *sig,
+	const void *seed, size_t seed_len);
+
 /*
  * Verify a signature. The message hash (or raw message) is provided
  * with the same rules as in the signature generation function.
@@ -184,6 +507,212 @@ int jq255s_verify(const void *sig, size_t sig_len,
 	const jq255s_public_key *pk,
 	const char *hash_name, const void *hv, size_t hv_len);
 
+/*
+ * Streaming signature verification, counterpart of the streaming
+ * signature generation: the message is hashed with BLAKE2s as it is
+ * injected with verify_update(), and verify_final() checks the
+ * signature against that hash, with exactly the same outcome as
+ * jq255e_verify() (resp. jq255s_verify()) with hash_name
+ * JQ255_HASHNAME_BLAKE2S. The context is then reset for a new message
+ * with the same public key.
+ *
+ * WARNING: verification is a variable-time process. It is assumed
+ * that the signature, public key, and message are all public data.
+ * Type contents are opaque and MUST NOT be accessed directly.
+ */
+typedef union { uint32_t w32[70]; uint64_t w64[35]; } jq255e_verify_ctx;
+typedef union { uint32_t w32[70]; uint64_t w64[35]; } jq255s_verify_ctx;
+void jq255e_verify_init(jq255e_verify_ctx *vc, const jq255e_public_key *pk);
+void jq255e_verify_update(jq255e_verify_ctx *vc,
+	const void *data, size_t len);
+int jq255e_verify_final(jq255e_verify_ctx *vc,
+	const void *sig, size_t sig_len);
+void jq255s_verify_init(jq255s_verify_ctx *vc, const jq255s_public_key *pk);
+void jq255s_verify_update(jq255s_verify_ctx *vc,
+	const void *data, size_t len);
+int jq255s_verify_final(jq255s_verify_ctx *vc,
+	const void *sig, size_t sig_len);
+
+/*
+ * A signature verification request, for batch verification: signature
+ * `sig` (of length `sig_len` bytes), public key `pk`, and the message
+ * hash (or raw message) given with the same rules as in the signature
+ * generation function.
+ */
+typedef struct {
+	const void *sig;
+	size_t sig_len;
+	const jq255e_public_key *pk;
+	const char *hash_name;
+	const void *hv;
+	size_t hv_len;
+} jq255e_verify_item;
+typedef struct {
+	const void *sig;
+	size_t sig_len;
+	const jq255s_public_key *pk;
+	const char *hash_name;
+	const void *hv;
+	size_t hv_len;
+} jq255s_verify_item;
+
+/*
+ * Verify `n` signatures. Returned value is 1 if all signatures are
+ * valid, 0 otherwise. If `results` is not NULL, then it receives a
+ * bitmap of ceil(n/8) bytes: bit i (bit i%8 of results[i/8]) is set if
+ * and only if signature i is valid. Each signature is checked
+ * individually, with exactly the same outcome as jq255e_verify()
+ * (resp. jq255s_verify()); batching only lowers the per-signature cost.
+ *
+ * WARNING: verification is a variable-time process. It is assumed
+ * that the signatures, public keys, and hashed messages are all public
+ * data.
+ */
+int jq255e_verify_batch(uint8_t *results,
+	const jq255e_verify_item *items, size_t n);
+int jq255s_verify_batch(uint8_t *results,
+	const jq255s_verify_item *items, size_t n);
+
+/*
+ * Verification queue: signature verification requests are submitted
+ * as they arrive, and verified later in batches (with
+ * jq255e_verify_batch()), with a completion callback for each request.
+ * This lets a server gather the requests of many connections into
+ * batches without blocking a thread per request; a bound on the
+ * queueing delay keeps the latency under control when the request rate
+ * is low.
+ *
+ * The library does not allocate memory, create threads or read any
+ * clock. The caller provides the queue structure and an array of
+ * `capacity` slots (a power of two, at least 2) that must remain valid
+ * (and not move) as long as the queue is used. Times are provided by
+ * the caller as `now` parameters, in arbitrary units (e.g. microseconds
+ * from a monotonic clock), which must be consistent across calls;
+ * `max_wait` uses the same unit.
+ *
+ * jq255e_verify_queue_init() sets up an empty queue. Requests are
+ * processed in batches of `batch` requests (1 to
+ * JQ255_VERIFY_QUEUE_MAX_BATCH), or fewer when the oldest pending
+ * request has waited `max_wait` or more. Returned value is 1 on
+ * success, 0 if a parameter is not acceptable.
+ *
+ * jq255e_verify_submit() queues a request. The job contents are copied,
+ * but not the data they point to (signature, public key, hashed
+ * message), which must remain valid and unmodified until the callback
+ * has been called. Returned value is 1 on success, 0 if the queue is
+ * full (the caller may then call jq255e_verify_poll() or
+ * jq255e_verify_flush(), or verify the signature directly).
+ *
+ * jq255e_verify_poll() processes the pending requests for which a
+ * batch is complete or the delay has expired, and returns the number
+ * of processed requests. It should be called whenever the delay of the
+ * oldest request may have expired (e.g. from a timer, or from the
+ * event loop); 0 is returned if there is nothing to do yet.
+ * jq255e_verify_flush() processes all pending requests regardless of
+ * their age, and returns their number.
+ *
+ * For each processed request, the done() callback (if not NULL) is
+ * called with the `ctx` value of the job and the verification result
+ * (1 for a valid signature, 0 otherwise; the same as with
+ * jq255e_verify()), from the thread that calls jq255e_verify_poll()
+ * or jq255e_verify_flush(). Callbacks MUST NOT call these functions on
+ * the same queue, but may submit new requests.
+ *
+ * The queue is lock-free: any number of threads may submit requests,
+ * poll and flush concurrently. The requests are processed in
+ * submission order, but when several threads process requests, their
+ * callbacks may run concurrently.
+ *
+ * WARNING: verification is a variable-time process. It is assumed
+ * that the signatures, public keys, and hashed messages are all public
+ * data.
+ * Type contents are opaque and MUST NOT be accessed directly.
+ */
+#define JQ255_VERIFY_QUEUE_MAX_BATCH   64
+
+typedef struct {
+	const void *sig;
+	size_t sig_len;
+	const jq255e_public_key *pk;
+	const char *hash_name;
+	const void *hv;
+	size_t hv_len;
+	void (*done)(void *ctx, int ok);
+	void *ctx;
+} jq255e_verify_job;
+typedef struct {
+	const void *sig;
+	size_t sig_len;
+	const jq255s_public_key *pk;
+	const char *hash_name;
+	const void *hv;
+	size_t hv_len;
+	void (*done)(void *ctx, int ok);
+	void *ctx;
+} jq255s_verify_job;
+
+typedef union { uint32_t w32[20]; uint64_t w64[10]; } jq255e_verify_queue_slot;
+typedef union { uint32_t w32[20]; uint64_t w64[10]; } jq255s_verify_queue_slot;
+typedef union { uint32_t w32[40]; uint64_t w64[20]; } jq255e_verify_queue;
+typedef union { uint32_t w32[40]; uint64_t w64[20]; } jq255s_verify_queue;
+
+int jq255e_verify_queue_init(jq255e_verify_queue *vq,
+	jq255e_verify_queue_slot *slots, size_t capacity,
+	size_t batch, uint64_t max_wait);
+int jq255s_verify_queue_init(jq255s_verify_queue *vq,
+	jq255s_verify_queue_slot *slots, size_t capacity,
+	size_t batch, uint64_t max_wait);
+int jq255e_verify_submit(jq255e_verify_queue *vq,
+	const jq255e_verify_job *job, uint64_t now);
+int jq255s_verify_submit(jq255s_verify_queue *vq,
+	const jq255s_verify_job *job, uint64_t now);
+size_t jq255e_verify_poll(jq255e_verify_queue *vq, uint64_t now);
+size_t jq255s_verify_poll(jq255s_verify_queue *vq, uint64_t now);
+size_t jq255e_verify_flush(jq255e_verify_queue *vq);
+size_t jq255s_verify_flush(jq255s_verify_queue *vq);
+
+/*
+ * Compute an expanded public key from a public key. This costs about as
+ * much as one signature verification. If the source public key is in
+ * the special "invalid" state, then so is the expanded key.
+ */
+void jq255e_expand_public_key(jq255e_public_key_expanded *epk,
+	const jq255e_public_key *pk);
+void jq255s_expand_public_key(jq255s_public_key_expanded *epk,
+	const jq255s_public_key *pk);
+
+/*
+ * Verify a signature relatively to an expanded public key. This
+ * function behaves exactly as jq255e_verify() (resp. jq255s_verify()),
+ * but is faster.
+ *
+ * WARNING: verification is a variable-time process. It is assumed
+ * that the signature, public key, and hashed message are all public
+ * data.
+ */
+int jq255e_verify_expanded(const void *sig, size_t sig_len,
+	const jq255e_public_key_expanded *epk,
+	const char *hash_name, const void *hv, size_t hv_len);
+int jq255s_verify_expanded(const void *sig, size_t sig_len,
+	const jq255s_public_key_expanded *epk,
+	const char *hash_name, const void *hv, size_t hv_len);
+
+/*
+ * Verify a signature relatively to a compact public key. This function
+ * behaves exactly as jq255e_verify() (resp. jq255s_verify()), but first
+ * decodes the public key.
+ *
+ * WARNING: verification is a variable-time process. It is assumed
+ * that the signature, public key, and hashed message are all public
+ * data.
+ */
+int jq255e_verify_compact(const void *sig, size_t sig_len,
+	const jq255e_public_key_compact *cpk,
+	const char *hash_name, const void *hv, size_t hv_len);
+int jq255s_verify_compact(const void *sig, size_t sig_len,
+	const jq255s_public_key_compact *cpk,
+	const char *hash_name, const void *hv, size_t hv_len);
+
 /*
  * Perform a key exchange between a local key pair, and a peer public
  * key. The resulting key has length 32 bytes and is written into the
@@ -201,4 +730,341 @@ int jq255e_ECDH(void *shared_key, const jq255e_keypair *jk_self,
 int jq255s_ECDH(void *shared_key, const jq255s_keypair *jk_self,
 	const jq255s_public_key *pk_peer);
 
+/*
+ * Perform a key exchange between a local key pair, and a peer compact
+ * public key. This function behaves as jq255e_ECDH() (resp.
+ * jq255s_ECDH()), but first decodes the peer public key (in constant
+ * time). For a valid peer key, the output is the same as with
+ * jq255e_ECDH(); for an invalid key, a failure is reported and an
+ * unguessable key is still generated.
+ */
+int jq255e_ECDH_compact(void *shared_key, const jq255e_keypair *jk_self,
+	const jq255e_public_key_compact *cpk_peer);
+int jq255s_ECDH_compact(void *shared_key, const jq255s_keypair *jk_self,
+	const jq255s_public_key_compact *cpk_peer);
+
+/*
+ * Perform key exchanges between a local key pair and n peer public keys
+ * (pk_peers[0] to pk_peers[n-1]). The n shared keys (32 bytes each) are
+ * written consecutively into `shared_keys`; key i is the same as the
+ * output of jq255e_ECDH() (resp. jq255s_ECDH()) on pk_peers[i]. If `ok`
+ * is not NULL, then it receives a bitmap of ceil(n/8) bytes: bit i is
+ * set if peer key i was valid. Returned value is 1 if all peer keys
+ * were valid, 0 otherwise (failed exchanges still produce unguessable
+ * keys, as with jq255e_ECDH()).
+ *
+ * The private key is processed only once, and the peers are handled in
+ * groups, with shared normalizations and the multi-buffer BLAKE2s
+ * (and an 8-way implementation of the point multiplications with
+ * AVX-512 IFMA, if available); this is faster than individual key
+ * exchanges. Processing is constant-time; only the number of peer keys
+ * may leak. No memory is allocated; stack usage is bounded and does not
+ * depend on n (about 36 kB with AVX-512 IFMA, 24 kB otherwise).
+ */
+int jq255e_ECDH_many(void *shared_keys, const jq255e_keypair *jk_self,
+	const jq255e_public_key *pk_peers, size_t n, uint8_t *ok);
+int jq255s_ECDH_many(void *shared_keys, const jq255s_keypair *jk_self,
+	const jq255s_public_key *pk_peers, size_t n, uint8_t *ok);
+
+/*
+ * Prepare a local key pair for repeated key exchanges. The prepared
+ * value contains a copy of the private key and must be protected (and
+ * erased after use) as such.
+ */
+void jq255e_ECDH_prepare_self(jq255e_ECDH_self *es,
+	const jq255e_keypair *jk_self);
+void jq255s_ECDH_prepare_self(jq255s_ECDH_self *es,
+	const jq255s_keypair *jk_self);
+
+/*
+ * Prepare a peer public key for repeated key exchanges. This costs a
+ * fraction of a key exchange (it builds the point window that
+ * jq255e_ECDH() otherwise recomputes on each call), and is done in
+ * constant time; if the public key is in the "invalid key" state, then
+ * the prepared peer key is invalid as well.
+ */
+void jq255e_ECDH_prepare_peer(jq255e_ECDH_peer *ep,
+	const jq255e_public_key *pk_peer);
+void jq255s_ECDH_prepare_peer(jq255s_ECDH_peer *ep,
+	const jq255s_public_key *pk_peer);
+
+/*
+ * Perform a key exchange between a prepared local key pair and a
+ * prepared peer public key. The output and the returned value are
+ * exactly the same as with jq255e_ECDH() (resp. jq255s_ECDH()) on the
+ * source key pair and peer public key.
+ */
+int jq255e_ECDH_prepared(void *shared_key,
+	const jq255e_ECDH_self *es, const jq255e_ECDH_peer *ep);
+int jq255s_ECDH_prepared(void *shared_key,
+	const jq255s_ECDH_self *es, const jq255s_ECDH_peer *ep);
+
+/*
+ * Group elements and scalars, for composing group operations without
+ * going through encodings. A jq255e_point (resp. jq255s_point) is
+ * an element of the prime order group, and a jq255e_scalar (resp.
+ * jq255s_scalar) is an integer modulo the group order r. Points are
+ * kept in projective coordinates: encoding a point costs an
+ * inversion, and decoding costs a square root, so that intermediate
+ * values should preferably be kept in that form.
+ * Type contents are opaque and MUST NOT be accessed directly.
+ */
+typedef union { uint32_t w32[32]; uint64_t w64[16]; } jq255e_point;
+typedef union { uint32_t w32[32]; uint64_t w64[16]; } jq255s_point;
+typedef union { uint8_t b[32]; uint32_t w32[8]; } jq255e_scalar;
+typedef union { uint8_t b[32]; uint32_t w32[8]; } jq255s_scalar;
+
+/*
+ * Decode a scalar from exactly 32 bytes (unsigned little-endian
+ * convention). Returned value is 1 on success, 0 on failure (the
+ * source length is not 32, or the value is not lower than r); on
+ * failure, the scalar is set to zero. Unlike private keys, a zero
+ * scalar is accepted.
+ */
+int jq255e_scalar_decode(jq255e_scalar *s, const void *src, size_t len);
+int jq255s_scalar_decode(jq255s_scalar *s, const void *src, size_t len);
+
+/*
+ * Decode a scalar from an arbitrary number of bytes (unsigned
+ * little-endian convention); the value is reduced modulo r. This
+ * function always succeeds.
+ */
+void jq255e_scalar_decode_reduce(jq255e_scalar *s,
+	const void *src, size_t len);
+void jq255s_scalar_decode_reduce(jq255s_scalar *s,
+	const void *src, size_t len);
+
+/*
+ * Encode a scalar into exactly 32 bytes.
+ */
+void jq255e_scalar_encode(void *dst, const jq255e_scalar *s);
+void jq255s_scalar_encode(void *dst, const jq255s_scalar *s);
+
+/*
+ * Decode a group element from exactly 32 bytes. Returned value is
+ * 1 on success, 0 on failure (in which case the point is set to the
+ * neutral). Unlike public keys, the neutral element (encoded as 32
+ * bytes of value zero) is accepted.
+ */
+int jq255e_point_decode(jq255e_point *p, const void *src, size_t len);
+int jq255s_point_decode(jq255s_point *p, const void *src, size_t len);
+
+/*
+ * Encode a group element into exactly 32 bytes.
+ */
+void jq255e_point_encode(void *dst, const jq255e_point *p);
+void jq255s_point_encode(void *dst, const jq255s_point *p);
+
+/*
+ * Get the group element from a public key (without any decoding). If
+ * the public key is in the "invalid key" state, then the neutral is
+ * obtained.
+ */
+void jq255e_point_from_public_key(jq255e_point *p,
+	const jq255e_public_key *pk);
+void jq255s_point_from_public_key(jq255s_point *p,
+	const jq255s_public_key *pk);
+
+/*
+ * Add two group elements: p3 <- p1 + p2. The output may be the same
+ * structure as one of the operands.
+ */
+void jq255e_point_add(jq255e_point *p3,
+	const jq255e_point *p1, const jq255e_point *p2);
+void jq255s_point_add(jq255s_point *p3,
+	const jq255s_point *p1, const jq255s_point *p2);
+
+/*
+ * Multiply a group element by a scalar: p2 <- s*p1. The output may be
+ * the same structure as the input point.
+ * THIS FUNCTION IS NOT CONSTANT-TIME: its execution time and memory
+ * access pattern depend on the point and the scalar. It is meant for
+ * public values only (e.g. recomputing a published commitment) and
+ * MUST NOT be used with a private key or any other secret scalar.
+ * It is about 15 to 20% faster than the constant-time point
+ * multiplication used in key exchange.
+ */
+void jq255e_point_mul_vartime(jq255e_point *p2,
+	const jq255e_point *p1, const jq255e_scalar *s);
+void jq255s_point_mul_vartime(jq255s_point *p2,
+	const jq255s_point *p1, const jq255s_scalar *s);
+
+/*
+ * Multiply the conventional generator by a scalar: p <- s*G.
+ * THIS FUNCTION IS NOT CONSTANT-TIME (see jq255e_point_mul_vartime()).
+ */
+void jq255e_point_mulgen_vartime(jq255e_point *p, const jq255e_scalar *s);
+void jq255s_point_mulgen_vartime(jq255s_point *p, const jq255s_scalar *s);
+
+/*
+ * Multi-scalar multiplication: p <- \sum_{i=0}^{n-1} ss[i]*pp[i].
+ * For n = 0, the neutral is obtained. The algorithm is chosen from n:
+ * for a few points, interleaved wNAF multiplications with shared
+ * doublings (Straus, with the endomorphism on jq255e); for many points
+ * (64 or more), bucket accumulation (Pippenger). The cost per point
+ * decreases as n grows: for n = 1024, it is about a quarter of the
+ * cost of an individual point_mul_vartime(). No memory is allocated;
+ * stack usage is bounded (less than 20 kB).
+ * THIS FUNCTION IS NOT CONSTANT-TIME (see jq255e_point_mul_vartime()).
+ */
+void jq255e_point_msm_vartime(jq255e_point *p,
+	const jq255e_point *pp, const jq255e_scalar *ss, size_t n);
+void jq255s_point_msm_vartime(jq255s_point *p,
+	const jq255s_point *pp, const jq255s_scalar *ss, size_t n);
+
+/*
+ * Conversions between private keys and scalars. The conversion to a
+ * private key returns 1 on success, 0 if the scalar is zero (the private
+ * key is then in the "invalid key" state).
+ */
+void jq255e_scalar_from_private_key(jq255e_scalar *s,
+	const jq255e_private_key *sk);
+void jq255s_scalar_from_private_key(jq255s_scalar *s,
+	const jq255s_private_key *sk);
+int jq255e_private_key_from_scalar(jq255e_private_key *sk,
+	const jq255e_scalar *s);
+int jq255s_private_key_from_scalar(jq255s_private_key *sk,
+	const jq255s_scalar *s);
+
+/*
+ * Scalar arithmetic modulo r: d <- a + b, d <- a - b, d <- -a,
+ * d <- a*b. The output may be the same structure as any of the
+ * operands. All these functions are constant-time.
+ */
+void jq255e_scalar_add(jq255e_scalar *d,
+	const jq255e_scalar *a, const jq255e_scalar *b);
+void jq255s_scalar_add(jq255s_scalar *d,
+	const jq255s_scalar *a, const jq255s_scalar *b);
+void jq255e_scalar_sub(jq255e_scalar *d,
+	const jq255e_scalar *a, const jq255e_scalar *b);
+void jq255s_scalar_sub(jq255s_scalar *d,
+	const jq255s_scalar *a, const jq255s_scalar *b);
+void jq255e_scalar_neg(jq255e_scalar *d, const jq255e_scalar *a);
+void jq255s_scalar_neg(jq255s_scalar *d, const jq255s_scalar *a);
+void jq255e_scalar_mul(jq255e_scalar *d,
+	const jq255e_scalar *a, const jq255e_scalar *b);
+void jq255s_scalar_mul(jq255s_scalar *d,
+	const jq255s_scalar *a, const jq255s_scalar *b);
+
+/*
+ * Make a public key from a group element; this computes the encoding
+ * (one inversion). Returned value is 1 on success, 0 if the point is
+ * the neutral (the public key is then in the "invalid key" state).
+ */
+int jq255e_point_to_public_key(jq255e_public_key *pk, const jq255e_point *p);
+int jq255s_point_to_public_key(jq255s_public_key *pk, const jq255s_point *p);
+
+/*
+ * Group operations: p2 <- -p1, p3 <- p1 - p2, p2 <- 2*p1, p2 <- s*p1,
+ * p <- s*G (G being the conventional generator). The output may be the
+ * same structure as any of the operands. All these functions are
+ * constant-time; point_mul() and point_mulgen() are the operations
+ * used for key exchange and key pair generation, respectively, and
+ * can be used with secret scalars.
+ */
+void jq255e_point_neg(jq255e_point *p2, const jq255e_point *p1);
+void jq255s_point_neg(jq255s_point *p2, const jq255s_point *p1);
+void jq255e_point_sub(jq255e_point *p3,
+	const jq255e_point *p1, const jq255e_point *p2);
+void jq255s_point_sub(jq255s_point *p3,
+	const jq255s_point *p1, const jq255s_point *p2);
+void jq255e_point_double(jq255e_point *p2, const jq255e_point *p1);
+void jq255s_point_double(jq255s_point *p2, const jq255s_point *p1);
+void jq255e_point_mul(jq255e_point *p2,
+	const jq255e_point *p1, const jq255e_scalar *s);
+void jq255s_point_mul(jq255s_point *p2,
+	const jq255s_point *p1, const jq255s_scalar *s);
+void jq255e_point_mulgen(jq255e_point *p, const jq255e_scalar *s);
+void jq255s_point_mulgen(jq255s_point *p, const jq255s_scalar *s);
+
+/*
+ * Compare two group elements: 1 is returned if they are equal, 0
+ * otherwise. This is cheaper than comparing encodings (two
+ * multiplications instead of two inversions), and constant-time.
+ */
+int jq255e_point_equals(const jq255e_point *p1, const jq255e_point *p2);
+int jq255s_point_equals(const jq255s_point *p1, const jq255s_point *p2);
+
+/*
+ * Test whether a group element is the neutral: 1 is returned for the
+ * neutral, 0 for any other element. This is constant-time.
+ */
+int jq255e_point_is_neutral(const jq255e_point *p);
+int jq255s_point_is_neutral(const jq255s_point *p);
+
+/*
+ * Copies of the base point tables. Multiplications of the base point
+ * (key pair generation, signing) and signature verification read
+ * precomputed tables of multiples of the generator: about 6 kB, or up
+ * to 78 kB when the library is compiled with MULGEN_LARGE=1. These
+ * tables are static data; on systems with several NUMA nodes, threads
+ * running on a node other than the one holding that data pay for
+ * remote memory accesses and TLB misses.
+ *
+ * tables_size() returns the size (in bytes) of the memory needed for a
+ * copy of the tables. tables_clone() copies the tables into the
+ * provided memory (mem, of len bytes; the copy is aligned on 64 bytes
+ * within that area), and returns a handle on the copy, or NULL if len
+ * is too small. The library does not allocate anything: the caller
+ * obtains the memory as it sees fit, e.g. with huge pages (mmap() with
+ * MAP_HUGETLB, or madvise(MADV_HUGEPAGE)) and on a given NUMA node
+ * (e.g. numa_alloc_onnode(), or first touch by a thread running on
+ * that node, which tables_clone() performs when called from such a
+ * thread). The memory must remain valid and unmodified as long as the
+ * copy is used.
+ *
+ * tables_use() makes the calling thread use the provided copy for all
+ * subsequent operations on that curve; with NULL, the thread goes back
+ * to the built-in tables (which is also the initial state of every
+ * thread). The selection is per thread (or process-wide if the
+ * compiler has no thread-local storage support).
+ */
+typedef struct jq255e_tables_ jq255e_tables;
+typedef struct jq255s_tables_ jq255s_tables;
+
+size_t jq255e_tables_size(void);
+size_t jq255s_tables_size(void);
+const jq255e_tables *jq255e_tables_clone(void *mem, size_t len);
+const jq255s_tables *jq255s_tables_clone(void *mem, size_t len);
+void jq255e_tables_use(const jq255e_tables *t);
+void jq255s_tables_use(const jq255s_tables *t);
+
+/*
+ * Instrumentation counters. When the library is compiled with
+ * JQ255_STATS=1, the following internal stages are counted and timed
+ * (in clock cycles, as read with rdtsc on x86; elsewhere, only counts
+ * are maintained):
+ *
+ *   JQ255_STAT_POINT_DECODE   decoding of a point (public key)
+ *   JQ255_STAT_RECODE_WNAF    wNAF recoding of a scalar or half-scalar
+ *   JQ255_STAT_VERIFY_LOOP    main loop of the verification double-scalar
+ *                             multiplication (plain or expanded key)
+ *   JQ255_STAT_CHALLENGE      challenge hashing (signing and verifying;
+ *                             batch operations count one per signature)
+ *   JQ255_STAT_ECDH_MUL       point multiplication in key exchange
+ *
+ * The counters are thread-local: stats_snapshot() copies the counters of
+ * the calling thread into `st`, and stats_reset() clears them. Each
+ * curve has its own set of counters. The snapshot function returns 1
+ * if the instrumentation is compiled in; otherwise, it returns 0 and
+ * sets all counters to zero (and the instrumented code has no
+ * overhead).
+ */
+#define JQ255_STAT_POINT_DECODE   0
+#define JQ255_STAT_RECODE_WNAF    1
+#define JQ255_STAT_VERIFY_LOOP    2
+#define JQ255_STAT_CHALLENGE      3
+#define JQ255_STAT_ECDH_MUL       4
+#define JQ255_STAT_NUM            5
+
+typedef struct {
+	uint64_t count[JQ255_STAT_NUM];
+	uint64_t cycles[JQ255_STAT_NUM];
+} jq255_stats;
+
+int jq255e_stats_snapshot(jq255_stats *st);
+void jq255e_stats_reset(void);
+int jq255s_stats_snapshot(jq255_stats *st);
+void jq255s_stats_reset(void);
+
 #endif
@@ -0,0 +1,156 @@
+/*
+ * Runtime selection of the implementation, for x86 builds that must run
+ * on any 64-bit x86 CPU.
+ *
+ * jq255.c is compiled several times for the same curve, each time with
+ * a different function name suffix (JQ_SUFFIX) and different target
+ * options:
+ *
+ *    _ref   portable 64-bit x86 code (no -march option)
+ *    _adx   with -mbmi2 -madx (MULX and ADCX/ADOX instructions, which
+ *           speed up the 64-bit field multiplications)
+ *
+ * The AVX2 window lookups (JQ_LOOKUP in jq255.c) and the AVX-512 IFMA
+ * batch code are present in both builds; they check the CPU features
+ * themselves at runtime.
+ *
+ * This file (compiled with the same JQ value) then defines the public
+ * API functions as GNU indirect functions: the dynamic loader (or the
+ * startup code, for static executables) calls a resolver once per
+ * function, which checks the CPU features and binds the function to the
+ * best available build. There is no per-call overhead beyond that of a
+ * call through the PLT.
+ *
+ * This requires GCC or Clang on an ELF target with ifunc support
+ * (e.g. Linux with glibc).
+ */
+
+#if !defined __x86_64__ || !(defined __GNUC__ || defined __clang__) \
+	|| !defined __ELF__
+#error jq255_dispatch.c requires GCC or Clang on x86_64 ELF
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "jq255.h"
+
+#ifndef JQ
+#define JQ   JQ255E
+#endif
+
+#define JQ255E   1
+#define JQ255S   2
+
+/*
+ * List of the public functions (names without the curve prefix).
+ */
+#define JQ_API(X) \
+	X(generate_private_key) \
+	X(make_public) \
+	X(generate_keypair) \
+	X(generate_keypairs) \
+	X(keypool_init) \
+	X(keypool_refill) \
+	X(keypool_pop) \
+	X(keypool_count) \
+	X(decode_private_key) \
+	X(decode_public_key) \
+	X(decode_public_keys) \
+	X(keydir_size) \
+	X(keydir_build) \
+	X(keydir_open) \
+	X(keydir_check) \
+	X(decode_keypair) \
+	X(encode_private_key) \
+	X(encode_public_key) \
+	X(decode_public_key_compact) \
+	X(compact_public_key) \
+	X(encode_public_key_compact) \
+	X(encode_keypair) \
+	X(sign) \
+	X(sign_seeded) \
+	X(sign_many) \
+	X(signer_init) \
+	X(signer_sign) \
+	X(sign_init) \
+	X(sign_update) \
+	X(sign_final) \
+	X(verify) \
+	X(verify_init) \
+	X(verify_update) \
+	X(verify_final) \
+	X(verify_batch) \
+	X(verify_queue_init) \
+	X(verify_submit) \
+	X(verify_poll) \
+	X(verify_flush) \
+	X(expand_public_key) \
+	X(verify_expanded) \
+	X(verify_compact) \
+	X(ECDH) \
+	X(ECDH_compact) \
+	X(ECDH_many) \
+	X(ECDH_prepare_self) \
+	X(ECDH_prepare_peer) \
+	X(ECDH_prepared) \
+	X(scalar_decode) \
+	X(scalar_decode_reduce) \
+	X(scalar_encode) \
+	X(point_decode) \
+	X(point_encode) \
+	X(point_from_public_key) \
+	X(point_add) \
+	X(point_mul_vartime) \
+	X(point_mulgen_vartime) \
+	X(point_msm_vartime) \
+	X(scalar_from_private_key) \
+	X(private_key_from_scalar) \
+	X(scalar_add) \
+	X(scalar_sub) \
+	X(scalar_neg) \
+	X(scalar_mul) \
+	X(point_to_public_key) \
+	X(point_neg) \
+	X(point_sub) \
+	X(point_double) \
+	X(point_mul) \
+	X(point_mulgen) \
+	X(point_equals) \
+	X(point_is_neutral) \
+	X(tables_size) \
+	X(tables_clone) \
+	X(tables_use) \
+	X(stats_snapshot) \
+	X(stats_reset)
+
+/*
+ * The resolvers run before the program constructors, hence the explicit
+ * call to __builtin_cpu_init().
+ */
+static int
+cpu_has_adx(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+}
+
+#define DISPATCH_(name) \
+	__typeof__(name) name ## _ref, name ## _adx; \
+	static __typeof__(name) * \
+	name ## _resolve(void) \
+	{ \
+		return cpu_has_adx() ? name ## _adx : name ## _ref; \
+	} \
+	__typeof__(name) name __attribute__((ifunc(#name "_resolve")));
+#define DISPATCH(name)   DISPATCH_(name)
+
+#if JQ == JQ255E
+#define DISPATCH_JQ(name)   DISPATCH(jq255e_ ## name)
+#elif JQ == JQ255S
+#define DISPATCH_JQ(name)   DISPATCH(jq255s_ ## name)
+#else
+#error Unknown curve
+#endif
+
+JQ_API(DISPATCH_JQ)
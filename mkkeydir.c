@@ -0,0 +1,111 @@
+/*
+ * Builder for key directories (see jq255e_keydir_build() in jq255.h).
+ *
+ * Usage:
+ *
+ *    mkkeydir [ -s ] input output
+ *
+ * The input file contains the encoded public keys, 32 bytes each,
+ * concatenated. The key directory is written into the output file,
+ * which is created (or truncated) and then mapped into memory, so that
+ * the records are written in place. Keys are for jq255e, or for jq255s
+ * with the -s option. The number of invalid encodings (for which the
+ * records are in the "invalid key" state) is reported on standard
+ * error.
+ *
+ * This program uses the POSIX file mapping functions, and links with
+ * libjq255.a (see 'make mkkeydir').
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "jq255.h"
+
+static void
+usage(void)
+{
+	fprintf(stderr, "usage: mkkeydir [ -s ] input output\n");
+	exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char *argv[])
+{
+	int curve_s, fd_in, fd_out;
+	const char *fin, *fout;
+	struct stat st;
+	size_t n, len, num_valid;
+	void *src, *dst;
+
+	curve_s = 0;
+	if (argc == 4 && strcmp(argv[1], "-s") == 0) {
+		curve_s = 1;
+		fin = argv[2];
+		fout = argv[3];
+	} else if (argc == 3) {
+		fin = argv[1];
+		fout = argv[2];
+	} else {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	fd_in = open(fin, O_RDONLY);
+	if (fd_in < 0 || fstat(fd_in, &st) < 0) {
+		perror(fin);
+		exit(EXIT_FAILURE);
+	}
+	if ((st.st_size & 31) != 0) {
+		fprintf(stderr, "%s: length is not a multiple of 32\n", fin);
+		exit(EXIT_FAILURE);
+	}
+	n = (size_t)st.st_size >> 5;
+	src = NULL;
+	if (n > 0) {
+		src = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED,
+			fd_in, 0);
+		if (src == MAP_FAILED) {
+			perror(fin);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	len = curve_s ? jq255s_keydir_size(n) : jq255e_keydir_size(n);
+	fd_out = open(fout, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd_out < 0 || ftruncate(fd_out, (off_t)len) < 0) {
+		perror(fout);
+		exit(EXIT_FAILURE);
+	}
+	dst = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd_out, 0);
+	if (dst == MAP_FAILED) {
+		perror(fout);
+		exit(EXIT_FAILURE);
+	}
+
+	if (curve_s) {
+		num_valid = jq255s_keydir_build(dst, src, n);
+	} else {
+		num_valid = jq255e_keydir_build(dst, src, n);
+	}
+
+	if (msync(dst, len, MS_SYNC) < 0 || munmap(dst, len) < 0
+		|| close(fd_out) < 0)
+	{
+		perror(fout);
+		exit(EXIT_FAILURE);
+	}
+	if (n > 0) {
+		munmap(src, (size_t)st.st_size);
+	}
+	close(fd_in);
+
+	fprintf(stderr, "%lu keys, %lu invalid\n",
+		(unsigned long)n, (unsigned long)(n - num_valid));
+	return 0;
+}
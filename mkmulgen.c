@@ -0,0 +1,175 @@
+/*
+ * Generator for the large fixed-base tables used by point_mulgen() when
+ * jq255.c is compiled with MULGEN_LARGE=1.
+ *
+ * This program includes jq255.c (compiled for the curve selected by the
+ * JQ macro, with the built-in windows) and writes the tables on its
+ * standard output, as C source code meant to be saved as jq255e_mulgen.h
+ * (or jq255s_mulgen.h). Usage:
+ *
+ *    mkmulgen [ spacing ]
+ *
+ * The scalar is recoded into 51 signed 5-bit digits; digit i+D*k is
+ * looked up in window k, which contains the points j*(2^(5*D*k))*G for
+ * j = 1 to 16 (D is the spacing, from 1 to 13, default 1). There are
+ * ceil(51/D) windows of 1536 bytes each, and point_mulgen() then needs
+ * 5*(D-1) doublings. The built-in four windows correspond to D = 13.
+ *
+ *    mkmulgen base
+ *
+ * writes instead the four base windows (point_win_base, point_win_base65,
+ * point_win_base130 and point_win_base195), in the same format as the
+ * built-in ones. This is used for custom curves: mkmulgen is compiled
+ * with JQ_PARAMS but without JQ_TABLES (the windows then contain only
+ * the generator, which is all that this program needs), and the output
+ * is the JQ_TABLES file for the actual build.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#undef MULGEN_LARGE
+#define MULGEN_LARGE   0
+#include "jq255.c"
+
+static void
+print_gf(const gf *a)
+{
+	uint8_t tmp[32];
+
+	gf_encode(tmp, a);
+	printf("LGF(");
+	for (int i = 0; i < 8; i ++) {
+		printf("0x%08lX%s", (unsigned long)dec32le(tmp + 4 * i),
+			i == 7 ? ")" : i == 3 ? ",\n\t      " : ", ");
+	}
+}
+
+static void
+print_point(const point_affine *p)
+{
+	printf("\t{ ");
+	print_gf(&p->E);
+	printf(",\n\t  ");
+	print_gf(&p->U);
+	printf(",\n\t  ");
+	print_gf(&p->T);
+	printf(" }");
+}
+
+/*
+ * Compute the window of points j*B, for j = 1 to 16.
+ */
+static void
+make_window(point_affine *wa, const point *b)
+{
+	point w[16];
+
+	w[0] = *b;
+	point_double(&w[1], b);
+	for (int j = 2; j < 16; j ++) {
+		point_add(&w[j], &w[j - 1], b);
+	}
+	point_to_affine_batch(wa, w, 16);
+}
+
+#if defined JQ_PARAMS
+#define CURVE_NAME   "the custom curve (" JQ_PARAMS ")"
+#elif JQ == JQ255E
+#define CURVE_NAME   "jq255e"
+#else
+#define CURVE_NAME   "jq255s"
+#endif
+
+int
+main(int argc, char *argv[])
+{
+	int spacing, num_win, base;
+	point b;
+	point_affine wa[16];
+
+	spacing = 1;
+	base = 0;
+	if (argc >= 2) {
+		if (strcmp(argv[1], "base") == 0) {
+			spacing = 13;
+			base = 1;
+		} else {
+			spacing = atoi(argv[1]);
+		}
+	}
+	if (argc > 2 || spacing < 1 || spacing > 13) {
+		fprintf(stderr,
+			"usage: mkmulgen [ spacing (1 to 13) | base ]\n");
+		exit(EXIT_FAILURE);
+	}
+	num_win = (51 + spacing - 1) / spacing;
+
+	b.E = point_win_base[0].E;
+	b.Z = gf_one;
+	b.U = point_win_base[0].U;
+	b.T = point_win_base[0].T;
+
+	printf("/*\n");
+	if (base) {
+		printf(" * Base point windows for %s.\n", CURVE_NAME);
+	} else {
+		printf(" * Large fixed-base tables for %s (spacing %d).\n",
+			CURVE_NAME, spacing);
+	}
+	printf(" * Generated by mkmulgen; do not edit.\n");
+	printf(" */\n\n");
+
+	if (base) {
+		static const char *const names[] = {
+			"", "65", "130", "195"
+		};
+
+		for (int k = 0; k < 4; k ++) {
+			if (k == 0) {
+				printf("/* Points i*G for i = 1 to 16,"
+					" affine extended format */\n");
+			} else {
+				printf("/* Points i*(2^%s)*G for i = 1 to 16,"
+					" affine extended format */\n",
+					names[k]);
+			}
+			printf("static const point_affine"
+				" point_win_base%s[] = {\n", names[k]);
+			make_window(wa, &b);
+			for (int j = 0; j < 16; j ++) {
+				if (k == 0) {
+					printf("\t/* G * %d */\n", j + 1);
+				} else {
+					printf("\t/* (2^%s)*G * %d */\n",
+						names[k], j + 1);
+				}
+				print_point(&wa[j]);
+				printf("%s\n", j == 15 ? "" : ",");
+			}
+			printf("};\n%s", k == 3 ? "" : "\n");
+			point_xdouble(&b, &b, 65);
+		}
+		return 0;
+	}
+
+	printf("#define MULGEN_SPACING   %d\n", spacing);
+	printf("#define MULGEN_NUM_WIN   %d\n\n", num_win);
+	printf("/* Points j*(2^(5*MULGEN_SPACING*k))*G for j = 1 to 16,"
+		" window k at\n   index 16*k; affine extended format */\n");
+	printf("static const point_affine point_win_mulgen[] = {\n");
+	for (int k = 0; k < num_win; k ++) {
+		make_window(wa, &b);
+		for (int j = 0; j < 16; j ++) {
+			printf("\t/* G * %d * 2^%d */\n",
+				j + 1, 5 * spacing * k);
+			print_point(&wa[j]);
+			printf("%s\n",
+				(k == num_win - 1 && j == 15) ? "" : ",");
+		}
+		point_xdouble(&b, &b, 5 * spacing);
+	}
+	printf("};\n");
+	return 0;
+}
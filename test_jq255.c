@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "blake2s.h"
 #include "jq255.h"
 
 #ifndef JQ
@@ -65,37 +66,197 @@ hextobin(void *dst, size_t dst_len, const char *src)
 #if JQ == JQ255E
 #define jq_private_key            jq255e_private_key
 #define jq_public_key             jq255e_public_key
+#define jq_public_key_expanded    jq255e_public_key_expanded
+#define jq_public_key_compact     jq255e_public_key_compact
 #define jq_keypair                jq255e_keypair
 #define jq_generate_private_key   jq255e_generate_private_key
 #define jq_make_public            jq255e_make_public
 #define jq_generate_keypair       jq255e_generate_keypair
+#define jq_generate_keypairs      jq255e_generate_keypairs
+#define jq_keypool                jq255e_keypool
+#define jq_keypool_slot           jq255e_keypool_slot
+#define jq_keypool_init           jq255e_keypool_init
+#define jq_keypool_refill         jq255e_keypool_refill
+#define jq_keypool_pop            jq255e_keypool_pop
+#define jq_keypool_count          jq255e_keypool_count
 #define jq_decode_private_key     jq255e_decode_private_key
 #define jq_decode_public_key      jq255e_decode_public_key
+#define jq_decode_public_keys     jq255e_decode_public_keys
 #define jq_decode_keypair         jq255e_decode_keypair
+#define jq_keydir_size            jq255e_keydir_size
+#define jq_keydir_build           jq255e_keydir_build
+#define jq_keydir_open            jq255e_keydir_open
+#define jq_keydir_check           jq255e_keydir_check
 #define jq_encode_private_key     jq255e_encode_private_key
 #define jq_encode_public_key      jq255e_encode_public_key
+#define jq_decode_public_key_compact  jq255e_decode_public_key_compact
+#define jq_compact_public_key     jq255e_compact_public_key
+#define jq_encode_public_key_compact  jq255e_encode_public_key_compact
 #define jq_encode_keypair         jq255e_encode_keypair
 #define jq_sign                   jq255e_sign
 #define jq_sign_seeded            jq255e_sign_seeded
+#define jq_sign_many              jq255e_sign_many
+#define jq_signer                 jq255e_signer
+#define jq_signer_init            jq255e_signer_init
+#define jq_signer_sign            jq255e_signer_sign
+#define jq_sign_ctx               jq255e_sign_ctx
+#define jq_sign_init              jq255e_sign_init
+#define jq_sign_update            jq255e_sign_update
+#define jq_sign_final             jq255e_sign_final
 #define jq_verify                 jq255e_verify
+#define jq_verify_ctx             jq255e_verify_ctx
+#define jq_verify_init            jq255e_verify_init
+#define jq_verify_update          jq255e_verify_update
+#define jq_verify_final           jq255e_verify_final
+#define jq_verify_item            jq255e_verify_item
+#define jq_verify_batch           jq255e_verify_batch
+#define jq_verify_job             jq255e_verify_job
+#define jq_verify_queue_slot      jq255e_verify_queue_slot
+#define jq_verify_queue           jq255e_verify_queue
+#define jq_verify_queue_init      jq255e_verify_queue_init
+#define jq_verify_submit          jq255e_verify_submit
+#define jq_verify_poll            jq255e_verify_poll
+#define jq_verify_flush           jq255e_verify_flush
+#define jq_expand_public_key      jq255e_expand_public_key
+#define jq_verify_expanded        jq255e_verify_expanded
+#define jq_verify_compact         jq255e_verify_compact
 #define jq_ECDH                   jq255e_ECDH
+#define jq_ECDH_compact           jq255e_ECDH_compact
+#define jq_ECDH_many              jq255e_ECDH_many
+#define jq_ECDH_self              jq255e_ECDH_self
+#define jq_ECDH_peer              jq255e_ECDH_peer
+#define jq_ECDH_prepare_self      jq255e_ECDH_prepare_self
+#define jq_ECDH_prepare_peer      jq255e_ECDH_prepare_peer
+#define jq_ECDH_prepared          jq255e_ECDH_prepared
+#define jq_point                  jq255e_point
+#define jq_scalar                 jq255e_scalar
+#define jq_scalar_decode          jq255e_scalar_decode
+#define jq_scalar_decode_reduce   jq255e_scalar_decode_reduce
+#define jq_scalar_encode          jq255e_scalar_encode
+#define jq_point_decode           jq255e_point_decode
+#define jq_point_encode           jq255e_point_encode
+#define jq_point_from_public_key  jq255e_point_from_public_key
+#define jq_point_add              jq255e_point_add
+#define jq_point_mul_vartime      jq255e_point_mul_vartime
+#define jq_point_mulgen_vartime   jq255e_point_mulgen_vartime
+#define jq_point_msm_vartime      jq255e_point_msm_vartime
+#define jq_scalar_from_private_key jq255e_scalar_from_private_key
+#define jq_private_key_from_scalar jq255e_private_key_from_scalar
+#define jq_scalar_add             jq255e_scalar_add
+#define jq_scalar_sub             jq255e_scalar_sub
+#define jq_scalar_neg             jq255e_scalar_neg
+#define jq_scalar_mul             jq255e_scalar_mul
+#define jq_point_to_public_key    jq255e_point_to_public_key
+#define jq_point_neg              jq255e_point_neg
+#define jq_point_sub              jq255e_point_sub
+#define jq_point_double           jq255e_point_double
+#define jq_point_mul              jq255e_point_mul
+#define jq_point_mulgen           jq255e_point_mulgen
+#define jq_point_equals           jq255e_point_equals
+#define jq_point_is_neutral       jq255e_point_is_neutral
+#define jq_tables                 jq255e_tables
+#define jq_tables_size            jq255e_tables_size
+#define jq_tables_clone           jq255e_tables_clone
+#define jq_tables_use             jq255e_tables_use
+#define jq_stats_snapshot         jq255e_stats_snapshot
+#define jq_stats_reset            jq255e_stats_reset
 #elif JQ == JQ255S
 #define jq_private_key            jq255s_private_key
 #define jq_public_key             jq255s_public_key
+#define jq_public_key_expanded    jq255s_public_key_expanded
+#define jq_public_key_compact     jq255s_public_key_compact
 #define jq_keypair                jq255s_keypair
 #define jq_generate_private_key   jq255s_generate_private_key
 #define jq_make_public            jq255s_make_public
 #define jq_generate_keypair       jq255s_generate_keypair
+#define jq_generate_keypairs      jq255s_generate_keypairs
+#define jq_keypool                jq255s_keypool
+#define jq_keypool_slot           jq255s_keypool_slot
+#define jq_keypool_init           jq255s_keypool_init
+#define jq_keypool_refill         jq255s_keypool_refill
+#define jq_keypool_pop            jq255s_keypool_pop
+#define jq_keypool_count          jq255s_keypool_count
 #define jq_decode_private_key     jq255s_decode_private_key
 #define jq_decode_public_key      jq255s_decode_public_key
+#define jq_decode_public_keys     jq255s_decode_public_keys
 #define jq_decode_keypair         jq255s_decode_keypair
+#define jq_keydir_size            jq255s_keydir_size
+#define jq_keydir_build           jq255s_keydir_build
+#define jq_keydir_open            jq255s_keydir_open
+#define jq_keydir_check           jq255s_keydir_check
 #define jq_encode_private_key     jq255s_encode_private_key
 #define jq_encode_public_key      jq255s_encode_public_key
+#define jq_decode_public_key_compact  jq255s_decode_public_key_compact
+#define jq_compact_public_key     jq255s_compact_public_key
+#define jq_encode_public_key_compact  jq255s_encode_public_key_compact
 #define jq_encode_keypair         jq255s_encode_keypair
 #define jq_sign                   jq255s_sign
 #define jq_sign_seeded            jq255s_sign_seeded
+#define jq_sign_many              jq255s_sign_many
+#define jq_signer                 jq255s_signer
+#define jq_signer_init            jq255s_signer_init
+#define jq_signer_sign            jq255s_signer_sign
+#define jq_sign_ctx               jq255s_sign_ctx
+#define jq_sign_init              jq255s_sign_init
+#define jq_sign_update            jq255s_sign_update
+#define jq_sign_final             jq255s_sign_final
 #define jq_verify                 jq255s_verify
+#define jq_verify_ctx             jq255s_verify_ctx
+#define jq_verify_init            jq255s_verify_init
+#define jq_verify_update          jq255s_verify_update
+#define jq_verify_final           jq255s_verify_final
+#define jq_verify_item            jq255s_verify_item
+#define jq_verify_batch           jq255s_verify_batch
+#define jq_verify_job             jq255s_verify_job
+#define jq_verify_queue_slot      jq255s_verify_queue_slot
+#define jq_verify_queue           jq255s_verify_queue
+#define jq_verify_queue_init      jq255s_verify_queue_init
+#define jq_verify_submit          jq255s_verify_submit
+#define jq_verify_poll            jq255s_verify_poll
+#define jq_verify_flush           jq255s_verify_flush
+#define jq_expand_public_key      jq255s_expand_public_key
+#define jq_verify_expanded        jq255s_verify_expanded
+#define jq_verify_compact         jq255s_verify_compact
 #define jq_ECDH                   jq255s_ECDH
+#define jq_ECDH_compact           jq255s_ECDH_compact
+#define jq_ECDH_many              jq255s_ECDH_many
+#define jq_ECDH_self              jq255s_ECDH_self
+#define jq_ECDH_peer              jq255s_ECDH_peer
+#define jq_ECDH_prepare_self      jq255s_ECDH_prepare_self
+#define jq_ECDH_prepare_peer      jq255s_ECDH_prepare_peer
+#define jq_ECDH_prepared          jq255s_ECDH_prepared
+#define jq_point                  jq255s_point
+#define jq_scalar                 jq255s_scalar
+#define jq_scalar_decode          jq255s_scalar_decode
+#define jq_scalar_decode_reduce   jq255s_scalar_decode_reduce
+#define jq_scalar_encode          jq255s_scalar_encode
+#define jq_point_decode           jq255s_point_decode
+#define jq_point_encode           jq255s_point_encode
+#define jq_point_from_public_key  jq255s_point_from_public_key
+#define jq_point_add              jq255s_point_add
+#define jq_point_mul_vartime      jq255s_point_mul_vartime
+#define jq_point_mulgen_vartime   jq255s_point_mulgen_vartime
+#define jq_point_msm_vartime      jq255s_point_msm_vartime
+#define jq_scalar_from_private_key jq255s_scalar_from_private_key
+#define jq_private_key_from_scalar jq255s_private_key_from_scalar
+#define jq_scalar_add             jq255s_scalar_add
+#define jq_scalar_sub             jq255s_scalar_sub
+#define jq_scalar_neg             jq255s_scalar_neg
+#define jq_scalar_mul             jq255s_scalar_mul
+#define jq_point_to_public_key    jq255s_point_to_public_key
+#define jq_point_neg              jq255s_point_neg
+#define jq_point_sub              jq255s_point_sub
+#define jq_point_double           jq255s_point_double
+#define jq_point_mul              jq255s_point_mul
+#define jq_point_mulgen           jq255s_point_mulgen
+#define jq_point_equals           jq255s_point_equals
+#define jq_point_is_neutral       jq255s_point_is_neutral
+#define jq_tables                 jq255s_tables
+#define jq_tables_size            jq255s_tables_size
+#define jq_tables_clone           jq255s_tables_clone
+#define jq_tables_use             jq255s_tables_use
+#define jq_stats_snapshot         jq255s_stats_snapshot
+#define jq_stats_reset            jq255s_stats_reset
 #else
 #error Unknown curve
 #endif
@@ -944,6 +1105,409 @@ test_pubkey_decode(void)
 	fflush(stdout);
 }
 
+#define NUM_DECODE_BATCH   41
+
+static void
+test_pubkey_decode_batch(void)
+{
+	uint8_t src[NUM_DECODE_BATCH * 32], ok[(NUM_DECODE_BATCH + 7) >> 3];
+	jq_public_key pk[NUM_DECODE_BATCH];
+	size_t n, num_ok, num_bad;
+
+	printf("Test pubkey decode batch: ");
+	fflush(stdout);
+
+	/* Mix known valid and invalid encodings with random public keys;
+	   the all-zero encoding (the neutral) must also be rejected. */
+	num_ok = 0;
+	num_bad = 0;
+	for (n = 0; n < NUM_DECODE_BATCH; n ++) {
+		uint8_t *buf = src + 32 * n;
+
+		if (n % 3 == 0 && KAT_DECODE_OK[num_ok] != NULL) {
+			hextobin(buf, 32, KAT_DECODE_OK[num_ok ++]);
+		} else if (n % 3 == 1 && KAT_DECODE_BAD[num_bad] != NULL) {
+			hextobin(buf, 32, KAT_DECODE_BAD[num_bad ++]);
+		} else if (n == NUM_DECODE_BATCH - 2) {
+			memset(buf, 0, 32);
+		} else {
+			jq_keypair jk;
+			uint8_t seed = (uint8_t)n;
+
+			jq_generate_keypair(&jk, &seed, 1);
+			jq_encode_public_key(buf, &jk.public_key);
+		}
+	}
+
+	for (n = 0; n <= NUM_DECODE_BATCH; n ++) {
+		int all_ok, exp_ok;
+
+		memset(ok, 0xA5, sizeof ok);
+		all_ok = jq_decode_public_keys(pk, src, n, ok);
+		exp_ok = 1;
+		for (size_t i = 0; i < ((n + 7) >> 3); i ++) {
+			if (8 * i + 8 > n && (ok[i] >> (n & 7)) != 0) {
+				fprintf(stderr, "ERR: decode batch: bitmap padding\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		for (size_t i = 0; i < n; i ++) {
+			jq_public_key pk2;
+			int r;
+
+			r = jq_decode_public_key(&pk2, src + 32 * i, 32);
+			if (r != ((ok[i >> 3] >> (i & 7)) & 1)) {
+				fprintf(stderr, "ERR: decode batch: status %u/%u\n",
+					(unsigned)i, (unsigned)n);
+				exit(EXIT_FAILURE);
+			}
+			exp_ok &= r;
+			if (memcmp(&pk[i], &pk2, sizeof pk2) != 0) {
+				fprintf(stderr, "ERR: decode batch: key %u/%u\n",
+					(unsigned)i, (unsigned)n);
+				exit(EXIT_FAILURE);
+			}
+		}
+		if (all_ok != exp_ok) {
+			fprintf(stderr, "ERR: decode batch: wrong return value\n");
+			exit(EXIT_FAILURE);
+		}
+		if (n % 10 == 0) {
+			printf(".");
+			fflush(stdout);
+		}
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#define NUM_KEYDIR   70
+
+static void
+test_keydir(void)
+{
+	static uint64_t kd[(JQ255_KEYDIR_HEADER_LEN
+		+ NUM_KEYDIR * JQ255_KEYDIR_RECORD_LEN) / 8];
+	uint8_t src[NUM_KEYDIR * 32];
+	jq_keypair jk[NUM_KEYDIR];
+	int valid[NUM_KEYDIR];
+	const jq_public_key *keys;
+	uint8_t *buf = (uint8_t *)kd;
+	size_t len, n, num_valid, num_bad;
+
+	printf("Test keydir: ");
+	fflush(stdout);
+
+	if (jq_keydir_size(NUM_KEYDIR) != sizeof kd) {
+		fprintf(stderr, "ERR: keydir: wrong size\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* Some invalid encodings are interleaved with valid keys; the
+	   directory spans several decoding chunks. */
+	num_valid = 0;
+	num_bad = 0;
+	for (size_t i = 0; i < NUM_KEYDIR; i ++) {
+		uint8_t seed[2];
+
+		if (i % 7 == 3 && KAT_DECODE_BAD[num_bad] != NULL) {
+			hextobin(src + 32 * i, 32, KAT_DECODE_BAD[num_bad ++]);
+			valid[i] = 0;
+			continue;
+		}
+		seed[0] = (uint8_t)i;
+		seed[1] = 0x4B;
+		jq_generate_keypair(&jk[i], seed, sizeof seed);
+		jq_encode_public_key(src + 32 * i, &jk[i].public_key);
+		valid[i] = 1;
+		num_valid ++;
+	}
+
+	/* Empty directory. */
+	len = jq_keydir_size(0);
+	if (jq_keydir_build(buf, src, 0) != 0
+		|| jq_keydir_open(buf, len, &n) == NULL || n != 0
+		|| !jq_keydir_check(buf, len))
+	{
+		fprintf(stderr, "ERR: keydir: empty\n");
+		exit(EXIT_FAILURE);
+	}
+
+	len = sizeof kd;
+	if (jq_keydir_build(buf, src, NUM_KEYDIR) != num_valid) {
+		fprintf(stderr, "ERR: keydir: number of valid keys\n");
+		exit(EXIT_FAILURE);
+	}
+	keys = jq_keydir_open(buf, len, &n);
+	if (keys == NULL || n != NUM_KEYDIR || !jq_keydir_check(buf, len)) {
+		fprintf(stderr, "ERR: keydir: open\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* Each valid record verifies signatures in place; invalid
+	   records are in the "invalid key" state. */
+	for (size_t i = 0; i < n; i ++) {
+		uint8_t tmp[32], sig[48], hv[32];
+		int r;
+
+		memset(hv, (int)i, sizeof hv);
+		if (valid[i]) {
+			jq_sign(sig, &jk[i], JQ255_HASHNAME_SHA256, hv, 32);
+			jq_encode_public_key(tmp, &keys[i]);
+			if (memcmp(tmp, src + 32 * i, 32) != 0) {
+				fprintf(stderr, "ERR: keydir: key %u\n",
+					(unsigned)i);
+				exit(EXIT_FAILURE);
+			}
+		} else {
+			jq_sign(sig, &jk[0], JQ255_HASHNAME_SHA256, hv, 32);
+		}
+		r = jq_verify(sig, 48, &keys[i], JQ255_HASHNAME_SHA256, hv, 32);
+		if (r != valid[i]) {
+			fprintf(stderr, "ERR: keydir: verify %u\n", (unsigned)i);
+			exit(EXIT_FAILURE);
+		}
+		if (i % 10 == 0) {
+			printf(".");
+			fflush(stdout);
+		}
+	}
+
+	/* Truncated buffer, misaligned buffer, altered header. */
+	if (jq_keydir_open(buf, len - 1, &n) != NULL
+		|| jq_keydir_open(buf + 4, len - 4, &n) != NULL)
+	{
+		fprintf(stderr, "ERR: keydir: length/alignment not checked\n");
+		exit(EXIT_FAILURE);
+	}
+	for (size_t i = 0; i < JQ255_KEYDIR_HEADER_LEN; i ++) {
+		buf[i] ^= 0x01;
+		if (jq_keydir_open(buf, len, &n) != NULL) {
+			fprintf(stderr, "ERR: keydir: header byte %u\n",
+				(unsigned)i);
+			exit(EXIT_FAILURE);
+		}
+		buf[i] ^= 0x01;
+	}
+
+	/* Altered record: detected only by the check function. */
+	buf[JQ255_KEYDIR_HEADER_LEN + 5 * JQ255_KEYDIR_RECORD_LEN + 17] ^= 0x80;
+	if (jq_keydir_open(buf, len, &n) == NULL || jq_keydir_check(buf, len)) {
+		fprintf(stderr, "ERR: keydir: record alteration\n");
+		exit(EXIT_FAILURE);
+	}
+	buf[JQ255_KEYDIR_HEADER_LEN + 5 * JQ255_KEYDIR_RECORD_LEN + 17] ^= 0x80;
+	if (!jq_keydir_check(buf, len)) {
+		fprintf(stderr, "ERR: keydir: check\n");
+		exit(EXIT_FAILURE);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#define NUM_KEYGEN_BATCH   37
+
+static void
+test_keygen_batch(void)
+{
+	static uint8_t seeds[NUM_KEYGEN_BATCH][40];
+	const void *sp[NUM_KEYGEN_BATCH];
+	size_t slen[NUM_KEYGEN_BATCH];
+	jq_keypair jk[NUM_KEYGEN_BATCH], jk_peer;
+	uint8_t k1[32], k2[32], sig[48];
+	size_t sig_len;
+
+	printf("Test keygen batch: ");
+	fflush(stdout);
+
+	jq_generate_keypair(&jk_peer, "peer", 4);
+
+	for (int i = 0; i < NUM_KEYGEN_BATCH; i ++) {
+		for (int j = 0; j < 40; j ++) {
+			seeds[i][j] = (uint8_t)(i * 41 + j);
+		}
+		sp[i] = seeds[i];
+		slen[i] = (size_t)(i % 40);
+	}
+	for (size_t n = 0; n <= NUM_KEYGEN_BATCH; n += 3) {
+		memset(jk, 0, sizeof jk);
+		jq_generate_keypairs(jk, sp, slen, n);
+		for (size_t i = 0; i < NUM_KEYGEN_BATCH; i ++) {
+			jq_keypair jk2;
+			uint8_t buf1[64], buf2[64];
+
+			if (i >= n) {
+				const uint8_t *z = (const uint8_t *)&jk[i];
+				for (size_t u = 0; u < sizeof jk[i]; u ++) {
+					if (z[u] != 0) {
+						fprintf(stderr, "ERR: KEYGEN BATCH:"
+							" overflow\n");
+						exit(EXIT_FAILURE);
+					}
+				}
+				continue;
+			}
+			jq_generate_keypair(&jk2, sp[i], slen[i]);
+			jq_encode_keypair(buf1, &jk[i]);
+			jq_encode_keypair(buf2, &jk2);
+			if (memcmp(buf1, buf2, 64) != 0) {
+				fprintf(stderr, "ERR: KEYGEN BATCH: key %lu/%lu\n",
+					(unsigned long)i, (unsigned long)n);
+				exit(EXIT_FAILURE);
+			}
+
+			/* The public point must be usable as well. */
+			if (i == 0 && jq_decode_keypair(&jk2, buf1, 64) != 1) {
+				fprintf(stderr, "ERR: KEYGEN BATCH: decode\n");
+				exit(EXIT_FAILURE);
+			}
+
+			/*
+			 * The stored point (not only its encoding) must be
+			 * correct: use it for ECDH and signature verification.
+			 */
+			if (jq_ECDH(k1, &jk_peer, &jk[i].public_key) != 1
+				|| jq_ECDH(k2, &jk_peer, &jk2.public_key) != 1
+				|| memcmp(k1, k2, 32) != 0)
+			{
+				fprintf(stderr, "ERR: KEYGEN BATCH: ECDH %lu/%lu\n",
+					(unsigned long)i, (unsigned long)n);
+				exit(EXIT_FAILURE);
+			}
+			sig_len = jq_sign(sig, &jk2, "", k1, 32);
+			if (jq_verify(sig, sig_len, &jk[i].public_key,
+				"", k1, 32) != 1)
+			{
+				fprintf(stderr, "ERR: KEYGEN BATCH: verify %lu/%lu\n",
+					(unsigned long)i, (unsigned long)n);
+				exit(EXIT_FAILURE);
+			}
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#define KEYPOOL_CAP   32
+
+static void
+test_keypool(void)
+{
+	static jq_keypool_slot slots[KEYPOOL_CAP];
+	jq_keypool pool;
+	uint8_t seed[20], ks[40];
+	blake2s_context bc;
+	uint64_t ctr;
+
+	printf("Test keypool: ");
+	fflush(stdout);
+
+	if (jq_keypool_init(&pool, slots, 0)
+		|| jq_keypool_init(&pool, slots, 1)
+		|| jq_keypool_init(&pool, slots, 24))
+	{
+		fprintf(stderr, "ERR: KEYPOOL: bad capacity accepted\n");
+		exit(EXIT_FAILURE);
+	}
+	if (jq_keypool_init(&pool, slots, KEYPOOL_CAP) != 1) {
+		fprintf(stderr, "ERR: KEYPOOL: init\n");
+		exit(EXIT_FAILURE);
+	}
+
+	ctr = 0;
+	for (int k = 0; k < 6; k ++) {
+		jq_keypair jk;
+		size_t n, r;
+
+		/* Refill partially, or beyond the capacity. */
+		memset(seed, k, sizeof seed);
+		n = (size_t)(k * 11);
+		r = jq_keypool_refill(&pool, seed, sizeof seed, n);
+		if (n > KEYPOOL_CAP) {
+			n = KEYPOOL_CAP;
+		}
+		if (r != n || jq_keypool_count(&pool) != n) {
+			fprintf(stderr, "ERR: KEYPOOL: refill %lu -> %lu\n",
+				(unsigned long)n, (unsigned long)r);
+			exit(EXIT_FAILURE);
+		}
+
+		/* Keys come out in order, and match their derivation. */
+		blake2s_init(&bc, 32);
+		blake2s_update(&bc, seed, sizeof seed);
+		blake2s_final(&bc, ks);
+		for (size_t i = 0; i < n; i ++) {
+			jq_keypair jk2;
+			uint8_t buf1[64], buf2[64];
+
+			if (jq_keypool_pop(&pool, &jk) != 1) {
+				fprintf(stderr, "ERR: KEYPOOL: pop\n");
+				exit(EXIT_FAILURE);
+			}
+			for (int j = 0; j < 8; j ++) {
+				ks[32 + j] = (uint8_t)(ctr >> (8 * j));
+			}
+			ctr ++;
+			jq_generate_keypair(&jk2, ks, sizeof ks);
+			jq_encode_keypair(buf1, &jk);
+			jq_encode_keypair(buf2, &jk2);
+			if (memcmp(buf1, buf2, 64) != 0) {
+				fprintf(stderr, "ERR: KEYPOOL: key %d/%lu\n",
+					k, (unsigned long)i);
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		/* Empty pool; the popped keys must have been cleared. */
+		memset(&jk, 0xA5, sizeof jk);
+		if (jq_keypool_pop(&pool, &jk) != 0
+			|| jq_keypool_count(&pool) != 0
+			|| ((uint8_t *)&jk)[0] != 0xA5)
+		{
+			fprintf(stderr, "ERR: KEYPOOL: empty pool\n");
+			exit(EXIT_FAILURE);
+		}
+		for (int i = 0; i < KEYPOOL_CAP; i ++) {
+			const uint8_t *z = (const uint8_t *)&slots[i];
+
+			for (size_t u = 0; u < sizeof(jq_keypair); u ++) {
+				if (z[u] != 0) {
+					fprintf(stderr, "ERR: KEYPOOL:"
+						" slot %d not cleared\n", i);
+					exit(EXIT_FAILURE);
+				}
+			}
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	/* Reusing a refill seed still yields distinct keys. */
+	{
+		jq_keypair jk1, jk2;
+
+		jq_keypool_refill(&pool, seed, sizeof seed, 1);
+		jq_keypool_refill(&pool, seed, sizeof seed, 1);
+		if (jq_keypool_pop(&pool, &jk1) != 1
+			|| jq_keypool_pop(&pool, &jk2) != 1
+			|| memcmp(&jk1, &jk2, sizeof jk1) == 0)
+		{
+			fprintf(stderr, "ERR: KEYPOOL: seed reuse\n");
+			exit(EXIT_FAILURE);
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 static void
 test_keypair_decode(void)
 {
@@ -1066,51 +1630,1501 @@ test_sign(void)
 }
 
 static void
-test_ECDH(void)
+test_signer(void)
 {
-	printf("Test ECDH: ");
+	printf("Test signer: ");
 	fflush(stdout);
 
-	for (int i = 0; KAT_ECDH[i] != NULL; i += 5) {
-		uint8_t buf_sk_self[32];
-		uint8_t buf_pk1_peer[32], buf_sec1[32];
-		uint8_t buf_pk2_peer[32], buf_sec2[32];
-		uint8_t tmp[32];
+	for (int i = 0; KAT_SIGN[i] != NULL; i += 5) {
+		uint8_t buf_key[64], buf_seed[20], buf_msg[32], buf_sig[48];
+		uint8_t tmp[48];
+		size_t seed_len;
 		jq_keypair jk;
-		jq_public_key pk_peer;
+		jq_signer sg;
 
-		HEXTOBIN(buf_sk_self, KAT_ECDH[i]);
-		HEXTOBIN(buf_pk1_peer, KAT_ECDH[i + 1]);
-		HEXTOBIN(buf_sec1, KAT_ECDH[i + 2]);
-		HEXTOBIN(buf_pk2_peer, KAT_ECDH[i + 3]);
-		HEXTOBIN(buf_sec2, KAT_ECDH[i + 4]);
-		if (jq_decode_private_key(&jk.private_key, buf_sk_self, 32) != 1) {
-			fprintf(stderr, "ERR: ECDH: decode privkey\n");
+		hextobin(buf_key, 32, KAT_SIGN[i + 0]);
+		hextobin(buf_key + 32, 32, KAT_SIGN[i + 1]);
+		seed_len = hextobin(buf_seed, sizeof buf_seed, KAT_SIGN[i + 2]);
+		HEXTOBIN(buf_msg, KAT_SIGN[i + 3]);
+		HEXTOBIN(buf_sig, KAT_SIGN[i + 4]);
+		jq_decode_keypair(&jk, buf_key, 64);
+		jq_signer_init(&sg, &jk);
+		for (int j = 0; j < 2; j ++) {
+			if (jq_signer_sign(tmp, &sg,
+				JQ255_HASHNAME_BLAKE2S, buf_msg, 32,
+				buf_seed, seed_len) != 48)
+			{
+				fprintf(stderr, "ERR: SIGNER: sig length\n");
+				exit(EXIT_FAILURE);
+			}
+			if (memcmp(tmp, buf_sig, 48) != 0) {
+				fprintf(stderr, "ERR: SIGNER: sig value\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	/*
+	 * BLAKE2s with an early-processed block must match the plain
+	 * computation, for any split point.
+	 */
+	for (size_t len = 1; len <= 200; len ++) {
+		uint8_t buf[200], h1[32], h2[32];
+		blake2s_context bc;
+
+		for (size_t u = 0; u < len; u ++) {
+			buf[u] = (uint8_t)(u * 3 + len);
+		}
+		blake2s(h1, 32, NULL, 0, buf, len);
+		for (size_t cut = 0; cut < len; cut += 32) {
+			blake2s_init(&bc, 32);
+			blake2s_update(&bc, buf, cut);
+			blake2s_flush(&bc);
+			blake2s_flush(&bc);
+			blake2s_update(&bc, buf + cut, len - cut);
+			blake2s_final(&bc, h2);
+			if (memcmp(h1, h2, 32) != 0) {
+				fprintf(stderr, "ERR: SIGNER: blake2s flush\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+	printf(".");
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_sign_stream(void)
+{
+	static uint8_t msg[3001];
+
+	printf("Test sign stream: ");
+	fflush(stdout);
+
+	for (size_t u = 0; u < sizeof msg; u ++) {
+		msg[u] = (uint8_t)(u * 7 + (u >> 8));
+	}
+	for (int i = 0; KAT_SIGN[i] != NULL; i += 5) {
+		uint8_t buf_key[64], buf_seed[20], hv[32];
+		uint8_t sig1[48], sig2[48];
+		size_t seed_len, msg_len;
+		jq_keypair jk;
+		jq_sign_ctx sc;
+		jq_verify_ctx vc;
+
+		hextobin(buf_key, 32, KAT_SIGN[i + 0]);
+		hextobin(buf_key + 32, 32, KAT_SIGN[i + 1]);
+		seed_len = hextobin(buf_seed, sizeof buf_seed, KAT_SIGN[i + 2]);
+		jq_decode_keypair(&jk, buf_key, 64);
+		jq_sign_init(&sc, &jk);
+		jq_verify_init(&vc, &jk.public_key);
+
+		/*
+		 * Two messages per key (the contexts are reused), injected
+		 * in chunks of various sizes.
+		 */
+		for (int j = 0; j < 2; j ++) {
+			size_t chunk;
+
+			msg_len = sizeof msg - (size_t)((i / 5) * 37 + j * 1000);
+			chunk = (size_t)(i / 5) * 13 + 1;
+			for (size_t u = 0; u < msg_len; u += chunk) {
+				size_t clen = msg_len - u;
+				if (clen > chunk) {
+					clen = chunk;
+				}
+				jq_sign_update(&sc, msg + u, clen);
+				jq_verify_update(&vc, msg + u, clen);
+			}
+			if (jq_sign_final(&sc, sig1, buf_seed, seed_len) != 48) {
+				fprintf(stderr, "ERR: SIGN STREAM: sig length\n");
+				exit(EXIT_FAILURE);
+			}
+			blake2s(hv, 32, NULL, 0, msg, msg_len);
+			jq_sign_seeded(sig2, &jk, JQ255_HASHNAME_BLAKE2S, hv, 32,
+				buf_seed, seed_len);
+			if (memcmp(sig1, sig2, 48) != 0) {
+				fprintf(stderr, "ERR: SIGN STREAM: sig value\n");
+				exit(EXIT_FAILURE);
+			}
+			if (jq_verify_final(&vc, sig1, 48) != 1) {
+				fprintf(stderr, "ERR: SIGN STREAM: verify (1)\n");
+				exit(EXIT_FAILURE);
+			}
+
+			/* Modified message must be rejected. */
+			jq_verify_update(&vc, msg, msg_len - 1);
+			if (jq_verify_final(&vc, sig1, 48) != 0) {
+				fprintf(stderr, "ERR: SIGN STREAM: verify (2)\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_verify_expanded(void)
+{
+	printf("Test verify expanded: ");
+	fflush(stdout);
+
+	for (int i = 0; KAT_SIGN[i] != NULL; i += 5) {
+		uint8_t buf_key[64], buf_msg[32], buf_sig[48];
+		jq_keypair jk;
+		jq_public_key_expanded epk;
+
+		hextobin(buf_key, 32, KAT_SIGN[i + 0]);
+		hextobin(buf_key + 32, 32, KAT_SIGN[i + 1]);
+		HEXTOBIN(buf_msg, KAT_SIGN[i + 3]);
+		HEXTOBIN(buf_sig, KAT_SIGN[i + 4]);
+		if (jq_decode_keypair(&jk, buf_key, 64) != 1) {
+			fprintf(stderr, "ERR: VEXP: decode keypair\n");
 			exit(EXIT_FAILURE);
 		}
-		jq_make_public(&jk.public_key, &jk.private_key);
-		if (jq_decode_public_key(&pk_peer, buf_pk1_peer, 32) != 1) {
-			fprintf(stderr, "ERR: ECDH: decode pubkey (1)\n");
+		jq_expand_public_key(&epk, &jk.public_key);
+		if (jq_verify_expanded(buf_sig, 48, &epk,
+			JQ255_HASHNAME_BLAKE2S, buf_msg, 32) != 1)
+		{
+			fprintf(stderr, "ERR: VEXP: verify (1)\n");
 			exit(EXIT_FAILURE);
 		}
-		if (jq_ECDH(tmp, &jk, &pk_peer) != 1) {
-			fprintf(stderr, "ERR: ECDH: status (1)\n");
+		buf_msg[11] ^= 0x01;
+		if (jq_verify_expanded(buf_sig, 48, &epk,
+			JQ255_HASHNAME_BLAKE2S, buf_msg, 32) != 0)
+		{
+			fprintf(stderr, "ERR: VEXP: verify (2)\n");
 			exit(EXIT_FAILURE);
 		}
-		if (memcmp(tmp, buf_sec1, 32) != 0) {
-			fprintf(stderr, "ERR: ECDH: output (1)\n");
+		buf_msg[11] ^= 0x01;
+		buf_sig[20] ^= 0x01;
+		if (jq_verify_expanded(buf_sig, 48, &epk,
+			JQ255_HASHNAME_BLAKE2S, buf_msg, 32) != 0)
+		{
+			fprintf(stderr, "ERR: VEXP: verify (3)\n");
 			exit(EXIT_FAILURE);
 		}
-		if (jq_decode_public_key(&pk_peer, buf_pk2_peer, 32) != 0) {
-			fprintf(stderr, "ERR: ECDH: decode pubkey (2)\n");
+		buf_sig[20] ^= 0x01;
+		buf_key[63] |= 0x80;
+		jq_decode_public_key(&jk.public_key, buf_key + 32, 32);
+		jq_expand_public_key(&epk, &jk.public_key);
+		if (jq_verify_expanded(buf_sig, 48, &epk,
+			JQ255_HASHNAME_BLAKE2S, buf_msg, 32) != 0)
+		{
+			fprintf(stderr, "ERR: VEXP: verify (4)\n");
+			exit(EXIT_FAILURE);
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+/*
+ * Test executor: it runs all tasks in reverse order, to check that
+ * batch functions do not depend on the task scheduling.
+ */
+static void
+test_executor_run(void *pool, size_t num_tasks,
+	void (*task)(void *arg, size_t index), void *arg)
+{
+	size_t *count = pool;
+
+	for (size_t i = num_tasks; i > 0; i --) {
+		task(arg, i - 1);
+		(*count) ++;
+	}
+}
+
+#define NUM_SIGN_MANY   37
+
+static void
+test_sign_many(void)
+{
+	uint8_t buf_key[64], msg[NUM_SIGN_MANY][40];
+	uint8_t sigs[NUM_SIGN_MANY * 48], tmp[48];
+	const void *hv[NUM_SIGN_MANY];
+	size_t hv_len[NUM_SIGN_MANY];
+	size_t count;
+	jq_keypair jk;
+	jq255_executor ex;
+
+	printf("Test sign many: ");
+	fflush(stdout);
+
+	hextobin(buf_key, 32, KAT_SIGN[0]);
+	hextobin(buf_key + 32, 32, KAT_SIGN[1]);
+	if (jq_decode_keypair(&jk, buf_key, 64) != 1) {
+		fprintf(stderr, "ERR: SMANY: decode keypair\n");
+		exit(EXIT_FAILURE);
+	}
+	for (int i = 0; i < NUM_SIGN_MANY; i ++) {
+		for (int j = 0; j < (int)sizeof msg[i]; j ++) {
+			msg[i][j] = (uint8_t)(i * 7 + j);
+		}
+		hv[i] = msg[i];
+		hv_len[i] = 1 + (size_t)i % sizeof msg[i];
+	}
+
+	for (int k = 0; k < 2; k ++) {
+		count = 0;
+		ex.run = &test_executor_run;
+		ex.pool = &count;
+		memset(sigs, 0, sizeof sigs);
+		if (jq_sign_many(sigs, &jk, k ? "" : JQ255_HASHNAME_SHA256,
+			hv, hv_len, NUM_SIGN_MANY, k ? &ex : NULL)
+			!= sizeof sigs)
+		{
+			fprintf(stderr, "ERR: SMANY: output length\n");
+			exit(EXIT_FAILURE);
+		}
+		if (k && count < 2) {
+			fprintf(stderr, "ERR: SMANY: executor not used\n");
+			exit(EXIT_FAILURE);
+		}
+		for (int i = 0; i < NUM_SIGN_MANY; i ++) {
+			jq_sign(tmp, &jk, k ? "" : JQ255_HASHNAME_SHA256,
+				hv[i], hv_len[i]);
+			if (memcmp(tmp, sigs + 48 * i, 48) != 0) {
+				fprintf(stderr, "ERR: SMANY: sig value\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#define NUM_BATCH   20
+
+static void
+test_verify_batch(void)
+{
+	uint8_t buf_msg[NUM_BATCH][32], buf_sig[NUM_BATCH][48];
+	jq_keypair jk[NUM_BATCH];
+	jq_verify_item items[NUM_BATCH];
+	uint8_t results[(NUM_BATCH + 7) >> 3];
+	size_t n;
+
+	printf("Test verify batch: ");
+	fflush(stdout);
+
+	n = 0;
+	for (int i = 0; KAT_SIGN[i] != NULL && n < NUM_BATCH; i += 5) {
+		uint8_t buf_key[64];
+
+		hextobin(buf_key, 32, KAT_SIGN[i + 0]);
+		hextobin(buf_key + 32, 32, KAT_SIGN[i + 1]);
+		HEXTOBIN(buf_msg[n], KAT_SIGN[i + 3]);
+		HEXTOBIN(buf_sig[n], KAT_SIGN[i + 4]);
+		if (jq_decode_keypair(&jk[n], buf_key, 64) != 1) {
+			fprintf(stderr, "ERR: VBATCH: decode keypair\n");
+			exit(EXIT_FAILURE);
+		}
+		items[n].sig = buf_sig[n];
+		items[n].sig_len = 48;
+		items[n].pk = &jk[n].public_key;
+		items[n].hash_name = JQ255_HASHNAME_BLAKE2S;
+		items[n].hv = buf_msg[n];
+		items[n].hv_len = 32;
+		n ++;
+	}
+
+	if (jq_verify_batch(results, items, n) != 1) {
+		fprintf(stderr, "ERR: VBATCH: verify (1)\n");
+		exit(EXIT_FAILURE);
+	}
+	for (size_t j = 0; j < n; j ++) {
+		if (((results[j >> 3] >> (j & 7)) & 1) != 1) {
+			fprintf(stderr, "ERR: VBATCH: bitmap (1)\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	printf(".");
+	fflush(stdout);
+
+	/* Alter some messages and signatures; only the altered entries
+	   must be reported as invalid. */
+	buf_msg[1][11] ^= 0x01;
+	buf_sig[6][3] ^= 0x40;
+	items[9].sig_len = 47;
+	items[17].pk = &jk[16].public_key;
+	if (jq_verify_batch(results, items, n) != 0) {
+		fprintf(stderr, "ERR: VBATCH: verify (2)\n");
+		exit(EXIT_FAILURE);
+	}
+	for (size_t j = 0; j < n; j ++) {
+		int bad = (j == 1 || j == 6 || j == 9 || j == 17);
+		if (((results[j >> 3] >> (j & 7)) & 1) != !bad) {
+			fprintf(stderr, "ERR: VBATCH: bitmap (2)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (jq_verify(items[j].sig, items[j].sig_len, items[j].pk,
+			items[j].hash_name, items[j].hv, items[j].hv_len) != !bad)
+		{
+			fprintf(stderr, "ERR: VBATCH: single verify\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	printf(".");
+	fflush(stdout);
+
+	/* A NULL bitmap is allowed, and so is an empty batch. */
+	if (jq_verify_batch(NULL, items, n) != 0
+		|| jq_verify_batch(NULL, items, 0) != 1)
+	{
+		fprintf(stderr, "ERR: VBATCH: verify (3)\n");
+		exit(EXIT_FAILURE);
+	}
+	printf(".");
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+/*
+ * Verification queue callback: record the result (plus one) and count
+ * the calls.
+ */
+static void
+vqueue_done(void *ctx, int ok)
+{
+	int *r = ctx;
+
+	*r += 2 + ok;
+}
+
+static void
+test_verify_queue(void)
+{
+	uint8_t buf_msg[NUM_BATCH][32], buf_sig[NUM_BATCH][48];
+	jq_keypair jk[NUM_BATCH];
+	jq_verify_job jobs[NUM_BATCH];
+	jq_verify_queue vq;
+	jq_verify_queue_slot slots[16];
+	int res[NUM_BATCH];
+	size_t n;
+
+	printf("Test verify queue: ");
+	fflush(stdout);
+
+	n = 0;
+	for (int i = 0; KAT_SIGN[i] != NULL && n < NUM_BATCH; i += 5) {
+		uint8_t buf_key[64];
+
+		hextobin(buf_key, 32, KAT_SIGN[i + 0]);
+		hextobin(buf_key + 32, 32, KAT_SIGN[i + 1]);
+		HEXTOBIN(buf_msg[n], KAT_SIGN[i + 3]);
+		HEXTOBIN(buf_sig[n], KAT_SIGN[i + 4]);
+		if (jq_decode_keypair(&jk[n], buf_key, 64) != 1) {
+			fprintf(stderr, "ERR: VQUEUE: decode keypair\n");
+			exit(EXIT_FAILURE);
+		}
+		jobs[n].sig = buf_sig[n];
+		jobs[n].sig_len = 48;
+		jobs[n].pk = &jk[n].public_key;
+		jobs[n].hash_name = JQ255_HASHNAME_BLAKE2S;
+		jobs[n].hv = buf_msg[n];
+		jobs[n].hv_len = 32;
+		jobs[n].done = &vqueue_done;
+		jobs[n].ctx = &res[n];
+		res[n] = 0;
+		n ++;
+	}
+	if (n < 17) {
+		fprintf(stderr, "ERR: VQUEUE: not enough test vectors\n");
+		exit(EXIT_FAILURE);
+	}
+	buf_msg[1][11] ^= 0x01;
+	buf_sig[6][3] ^= 0x40;
+
+	if (jq_verify_queue_init(&vq, slots, 12, 4, 100) != 0
+		|| jq_verify_queue_init(&vq, slots, 16, 0, 100) != 0
+		|| jq_verify_queue_init(&vq, slots, 16, 17, 100) != 0
+		|| jq_verify_queue_init(&vq, slots, 16, 4, 100) != 1)
+	{
+		fprintf(stderr, "ERR: VQUEUE: init\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* A partial batch waits until the delay has expired. */
+	for (size_t j = 0; j < 3; j ++) {
+		if (jq_verify_submit(&vq, &jobs[j], 1000) != 1) {
+			fprintf(stderr, "ERR: VQUEUE: submit (1)\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (jq_verify_poll(&vq, 1050) != 0 || res[0] != 0
+		|| jq_verify_poll(&vq, 900) != 0 || res[0] != 0)
+	{
+		fprintf(stderr, "ERR: VQUEUE: early poll\n");
+		exit(EXIT_FAILURE);
+	}
+	if (jq_verify_poll(&vq, 1100) != 3) {
+		fprintf(stderr, "ERR: VQUEUE: poll (1)\n");
+		exit(EXIT_FAILURE);
+	}
+	if (res[0] != 3 || res[1] != 2 || res[2] != 3) {
+		fprintf(stderr, "ERR: VQUEUE: results (1)\n");
+		exit(EXIT_FAILURE);
+	}
+	printf(".");
+	fflush(stdout);
+
+	/* Complete batches are processed immediately; the remaining
+	   requests stay in the queue. */
+	for (size_t j = 3; j < 9; j ++) {
+		if (jq_verify_submit(&vq, &jobs[j], 2000) != 1) {
+			fprintf(stderr, "ERR: VQUEUE: submit (2)\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (jq_verify_poll(&vq, 2000) != 4 || res[7] != 0) {
+		fprintf(stderr, "ERR: VQUEUE: poll (2)\n");
+		exit(EXIT_FAILURE);
+	}
+	if (jq_verify_flush(&vq) != 2 || jq_verify_flush(&vq) != 0) {
+		fprintf(stderr, "ERR: VQUEUE: flush (1)\n");
+		exit(EXIT_FAILURE);
+	}
+	for (size_t j = 3; j < 9; j ++) {
+		if (res[j] != (j == 6 ? 2 : 3)) {
+			fprintf(stderr, "ERR: VQUEUE: results (2)\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	printf(".");
+	fflush(stdout);
+
+	/* A full queue rejects submissions. */
+	for (size_t j = 0; j < 16; j ++) {
+		res[j] = 0;
+		if (jq_verify_submit(&vq, &jobs[j], 3000) != 1) {
+			fprintf(stderr, "ERR: VQUEUE: submit (3)\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (jq_verify_submit(&vq, &jobs[16], 3000) != 0) {
+		fprintf(stderr, "ERR: VQUEUE: full queue\n");
+		exit(EXIT_FAILURE);
+	}
+	if (jq_verify_flush(&vq) != 16) {
+		fprintf(stderr, "ERR: VQUEUE: flush (2)\n");
+		exit(EXIT_FAILURE);
+	}
+	for (size_t j = 0; j < 16; j ++) {
+		if (res[j] != 2 + jq_verify(jobs[j].sig, jobs[j].sig_len,
+			jobs[j].pk, jobs[j].hash_name, jobs[j].hv, jobs[j].hv_len))
+		{
+			fprintf(stderr, "ERR: VQUEUE: results (3)\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	printf(".");
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_ECDH(void)
+{
+	printf("Test ECDH: ");
+	fflush(stdout);
+
+	for (int i = 0; KAT_ECDH[i] != NULL; i += 5) {
+		uint8_t buf_sk_self[32];
+		uint8_t buf_pk1_peer[32], buf_sec1[32];
+		uint8_t buf_pk2_peer[32], buf_sec2[32];
+		uint8_t tmp[32];
+		jq_keypair jk;
+		jq_public_key pk_peer;
+
+		HEXTOBIN(buf_sk_self, KAT_ECDH[i]);
+		HEXTOBIN(buf_pk1_peer, KAT_ECDH[i + 1]);
+		HEXTOBIN(buf_sec1, KAT_ECDH[i + 2]);
+		HEXTOBIN(buf_pk2_peer, KAT_ECDH[i + 3]);
+		HEXTOBIN(buf_sec2, KAT_ECDH[i + 4]);
+		if (jq_decode_private_key(&jk.private_key, buf_sk_self, 32) != 1) {
+			fprintf(stderr, "ERR: ECDH: decode privkey\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_make_public(&jk.public_key, &jk.private_key);
+		if (jq_decode_public_key(&pk_peer, buf_pk1_peer, 32) != 1) {
+			fprintf(stderr, "ERR: ECDH: decode pubkey (1)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (jq_ECDH(tmp, &jk, &pk_peer) != 1) {
+			fprintf(stderr, "ERR: ECDH: status (1)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (memcmp(tmp, buf_sec1, 32) != 0) {
+			fprintf(stderr, "ERR: ECDH: output (1)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (jq_decode_public_key(&pk_peer, buf_pk2_peer, 32) != 0) {
+			fprintf(stderr, "ERR: ECDH: decode pubkey (2)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (jq_ECDH(tmp, &jk, &pk_peer) != 0) {
+			fprintf(stderr, "ERR: ECDH: status (2)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (memcmp(tmp, buf_sec2, 32) != 0) {
+			fprintf(stderr, "ERR: ECDH: output (2)\n");
+			exit(EXIT_FAILURE);
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#define NUM_ECDH_MANY   21
+
+static void
+test_ECDH_many(void)
+{
+	jq_keypair jk, jk_peer;
+	jq_public_key pk[NUM_ECDH_MANY];
+	uint8_t keys[NUM_ECDH_MANY][32], tmp[32], ok[(NUM_ECDH_MANY + 7) >> 3];
+	uint8_t bad_enc[32];
+
+	printf("Test ECDH (many): ");
+	fflush(stdout);
+
+	jq_generate_keypair(&jk, "self", 4);
+	memset(bad_enc, 0xFF, sizeof bad_enc);
+	for (int i = 0; i < NUM_ECDH_MANY; i ++) {
+		uint8_t seed[1];
+
+		if (i == 3 || i == 8 || i == 20) {
+			if (jq_decode_public_key(&pk[i], bad_enc, 32) != 0) {
+				fprintf(stderr, "ERR: ECDH many: bad key\n");
+				exit(EXIT_FAILURE);
+			}
+		} else {
+			seed[0] = (uint8_t)i;
+			jq_generate_keypair(&jk_peer, seed, 1);
+			pk[i] = jk_peer.public_key;
+		}
+	}
+
+	/* Full and partial groups, and groups with valid keys only. */
+	for (size_t n = 0; n <= NUM_ECDH_MANY; n += (n < 3) ? 1 : 6) {
+		int r;
+
+		memset(keys, 0, sizeof keys);
+		memset(ok, 0xFF, sizeof ok);
+		r = jq_ECDH_many(keys, &jk, pk, n, ok);
+		if (r != (n <= 3)) {
+			fprintf(stderr, "ERR: ECDH many: status\n");
+			exit(EXIT_FAILURE);
+		}
+		for (size_t j = 0; j < n; j ++) {
+			int rj;
+
+			rj = jq_ECDH(tmp, &jk, &pk[j]);
+			if (memcmp(tmp, keys[j], 32) != 0) {
+				fprintf(stderr, "ERR: ECDH many: key\n");
+				exit(EXIT_FAILURE);
+			}
+			if (((ok[j >> 3] >> (j & 7)) & 1) != rj) {
+				fprintf(stderr, "ERR: ECDH many: bitmap\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	/* A NULL bitmap is allowed. */
+	if (jq_ECDH_many(keys, &jk, pk + 4, 4, NULL) != 1) {
+		fprintf(stderr, "ERR: ECDH many: NULL bitmap\n");
+		exit(EXIT_FAILURE);
+	}
+	printf(".");
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_ECDH_prepared(void)
+{
+	printf("Test ECDH (prepared): ");
+	fflush(stdout);
+
+	for (int i = 0; KAT_ECDH[i] != NULL; i += 5) {
+		uint8_t buf_sk_self[32];
+		uint8_t buf_pk1_peer[32], buf_sec1[32];
+		uint8_t buf_pk2_peer[32], buf_sec2[32];
+		uint8_t tmp[32];
+		jq_keypair jk;
+		jq_public_key pk_peer;
+		jq_ECDH_self es;
+		jq_ECDH_peer ep;
+
+		HEXTOBIN(buf_sk_self, KAT_ECDH[i]);
+		HEXTOBIN(buf_pk1_peer, KAT_ECDH[i + 1]);
+		HEXTOBIN(buf_sec1, KAT_ECDH[i + 2]);
+		HEXTOBIN(buf_pk2_peer, KAT_ECDH[i + 3]);
+		HEXTOBIN(buf_sec2, KAT_ECDH[i + 4]);
+		jq_decode_private_key(&jk.private_key, buf_sk_self, 32);
+		jq_make_public(&jk.public_key, &jk.private_key);
+		jq_ECDH_prepare_self(&es, &jk);
+
+		jq_decode_public_key(&pk_peer, buf_pk1_peer, 32);
+		jq_ECDH_prepare_peer(&ep, &pk_peer);
+		if (jq_ECDH_prepared(tmp, &es, &ep) != 1) {
+			fprintf(stderr, "ERR: ECDH prepared: status (1)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (memcmp(tmp, buf_sec1, 32) != 0) {
+			fprintf(stderr, "ERR: ECDH prepared: output (1)\n");
+			exit(EXIT_FAILURE);
+		}
+
+		jq_decode_public_key(&pk_peer, buf_pk2_peer, 32);
+		jq_ECDH_prepare_peer(&ep, &pk_peer);
+		if (jq_ECDH_prepared(tmp, &es, &ep) != 0) {
+			fprintf(stderr, "ERR: ECDH prepared: status (2)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (memcmp(tmp, buf_sec2, 32) != 0) {
+			fprintf(stderr, "ERR: ECDH prepared: output (2)\n");
+			exit(EXIT_FAILURE);
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	/*
+	 * Random key pairs: each prepared peer is used with several
+	 * prepared local keys, in both directions.
+	 */
+	for (int i = 0; i < 20; i ++) {
+		uint8_t seed[2], tmp1[32], tmp2[32], tmp3[32];
+		jq_keypair jk1, jk2;
+		jq_ECDH_self es1, es2;
+		jq_ECDH_peer ep1, ep2;
+
+		seed[0] = 0xEC;
+		seed[1] = (uint8_t)i;
+		jq_generate_keypair(&jk1, seed, 2);
+		seed[0] = 0xED;
+		jq_generate_keypair(&jk2, seed, 2);
+		jq_ECDH_prepare_self(&es1, &jk1);
+		jq_ECDH_prepare_self(&es2, &jk2);
+		jq_ECDH_prepare_peer(&ep1, &jk1.public_key);
+		jq_ECDH_prepare_peer(&ep2, &jk2.public_key);
+		if (jq_ECDH(tmp1, &jk1, &jk2.public_key) != 1
+			|| jq_ECDH_prepared(tmp2, &es1, &ep2) != 1
+			|| jq_ECDH_prepared(tmp3, &es2, &ep1) != 1)
+		{
+			fprintf(stderr, "ERR: ECDH prepared: status (3)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (memcmp(tmp1, tmp2, 32) != 0
+			|| memcmp(tmp1, tmp3, 32) != 0)
+		{
+			fprintf(stderr, "ERR: ECDH prepared: output (3)\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_ECDH(tmp1, &jk1, &jk1.public_key);
+		jq_ECDH_prepared(tmp2, &es1, &ep1);
+		if (memcmp(tmp1, tmp2, 32) != 0) {
+			fprintf(stderr, "ERR: ECDH prepared: output (4)\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	printf(".");
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static uint8_t tables_buf[128 * 1024];
+
+/*
+ * Reference field arithmetic for test_field_inv(), over eight 32-bit
+ * limbs (little-endian order), modulo q = 2^255 - FIELD_MQ. This is
+ * deliberately simple and independent from jq255.c.
+ */
+#if JQ == JQ255E
+#define FIELD_MQ   18651
+#else
+#define FIELD_MQ   3957
+#endif
+
+static const uint32_t field_q[8] = {
+	(uint32_t)-FIELD_MQ, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+	0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x7FFFFFFF
+};
+
+static int
+field_ref_ge_q(const uint32_t *x)
+{
+	for (int i = 7; i >= 0; i --) {
+		if (x[i] != field_q[i]) {
+			return x[i] > field_q[i];
+		}
+	}
+	return 1;
+}
+
+static void
+field_ref_sub_q(uint32_t *x)
+{
+	uint64_t b = 0;
+
+	for (int i = 0; i < 8; i ++) {
+		uint64_t t = (uint64_t)x[i] - field_q[i] - b;
+		x[i] = (uint32_t)t;
+		b = (t >> 63) & 1;
+	}
+}
+
+/* d <- a*b mod q (fully reduced); inputs may be up to 2^256-1. */
+static void
+field_ref_mul(uint32_t *d, const uint32_t *a, const uint32_t *b)
+{
+	uint32_t r[16];
+	uint64_t t, cc;
+
+	memset(r, 0, sizeof r);
+	for (int i = 0; i < 8; i ++) {
+		cc = 0;
+		for (int j = 0; j < 8; j ++) {
+			t = (uint64_t)a[i] * b[j] + r[i + j] + cc;
+			r[i + j] = (uint32_t)t;
+			cc = t >> 32;
+		}
+		r[i + 8] = (uint32_t)cc;
+	}
+
+	/* 2^256 = 2*MQ mod q */
+	cc = 0;
+	for (int i = 0; i < 8; i ++) {
+		t = (uint64_t)r[i + 8] * (2 * FIELD_MQ) + r[i] + cc;
+		d[i] = (uint32_t)t;
+		cc = t >> 32;
+	}
+	while (cc != 0) {
+		t = cc * (2 * FIELD_MQ);
+		for (int i = 0; i < 8; i ++) {
+			t += d[i];
+			d[i] = (uint32_t)t;
+			t >>= 32;
+		}
+		cc = t;
+	}
+	while (field_ref_ge_q(d)) {
+		field_ref_sub_q(d);
+	}
+}
+
+/* d <- 1/a mod q, with Fermat's little theorem (d = 0 if a = 0 mod q). */
+static void
+field_ref_inv(uint32_t *d, const uint32_t *a)
+{
+	uint32_t e[8], x[8];
+
+	/* e = q - 2 */
+	memcpy(e, field_q, sizeof e);
+	e[0] -= 2;
+	memset(x, 0, sizeof x);
+	x[0] = 1;
+	for (int i = 254; i >= 0; i --) {
+		field_ref_mul(x, x, x);
+		if ((e[i >> 5] >> (i & 31)) & 1) {
+			field_ref_mul(x, x, a);
+		}
+	}
+	memcpy(d, x, sizeof x);
+}
+
+/*
+ * Test the field inversion (safegcd with W64 = 1, Fermat's little
+ * theorem otherwise), through point encoding: for the point with
+ * coordinates (E:Z:U:T) = (1:a:1:0), the encoding is that of u = 1/a
+ * or -1/a (the sign follows that of e = 1/a). The point is written
+ * directly into the public type, whose layout is the internal one
+ * (field elements as 256-bit integers, on a little-endian host).
+ */
+static void
+test_field_inv(void)
+{
+	static const uint32_t special[][8] = {
+		{ 0, 0, 0, 0, 0, 0, 0, 0 },
+		{ 1, 0, 0, 0, 0, 0, 0, 0 },
+		{ 2, 0, 0, 0, 0, 0, 0, 0 },
+		{ (uint32_t)-FIELD_MQ - 1, 0xFFFFFFFF, 0xFFFFFFFF,
+		  0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x7FFFFFFF },
+		{ (uint32_t)-FIELD_MQ, 0xFFFFFFFF, 0xFFFFFFFF,
+		  0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x7FFFFFFF },
+		{ (uint32_t)-FIELD_MQ + 1, 0xFFFFFFFF, 0xFFFFFFFF,
+		  0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x7FFFFFFF },
+		{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+		  0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x7FFFFFFF },
+		{ 0, 0, 0, 0, 0, 0, 0, 0x80000000 },
+		{ (uint32_t)-2 * FIELD_MQ, 0xFFFFFFFF, 0xFFFFFFFF,
+		  0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+		{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+		  0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+		{ 0, 0, 0, 0, 0, 0, 0, 0x40000000 },
+		{ 0xFFFFFFFF, 0, 0, 0, 0, 0, 0, 0 }
+	};
+	const int num_special = (int)((sizeof special) / sizeof special[0]);
+
+	printf("Test field inversion: ");
+	fflush(stdout);
+
+	for (int k = 0; k < num_special + 100; k ++) {
+		uint32_t a[8], w[32], r[8];
+		uint8_t enc[32], ref[32];
+		jq_point P;
+
+		if (k < num_special) {
+			memcpy(a, special[k], sizeof a);
+		} else {
+			uint8_t seed[4], tmp[32];
+
+			seed[0] = (uint8_t)k;
+			seed[1] = (uint8_t)(k >> 8);
+			seed[2] = 'i';
+			seed[3] = 'v';
+			blake2s(tmp, 32, NULL, 0, seed, 4);
+			for (int i = 0; i < 8; i ++) {
+				a[i] = (uint32_t)tmp[4 * i]
+					| ((uint32_t)tmp[4 * i + 1] << 8)
+					| ((uint32_t)tmp[4 * i + 2] << 16)
+					| ((uint32_t)tmp[4 * i + 3] << 24);
+			}
+		}
+
+		/* P = (1:a:1:0) */
+		memset(w, 0, sizeof w);
+		w[0] = 1;
+		memcpy(w + 8, a, sizeof a);
+		w[16] = 1;
+		memcpy(&P, w, sizeof w);
+		jq_point_encode(enc, &P);
+
+		/* Expected: u = 1/a, negated if 1/a is odd. */
+		field_ref_inv(r, a);
+		if ((r[0] & 1) != 0) {
+			uint32_t z[8];
+
+			memcpy(z, r, sizeof z);
+			memcpy(r, field_q, sizeof r);
+			for (int i = 0, b = 0; i < 8; i ++) {
+				uint64_t t = (uint64_t)r[i] - z[i] - (uint64_t)b;
+				r[i] = (uint32_t)t;
+				b = (int)((t >> 63) & 1);
+			}
+		}
+		for (int i = 0; i < 8; i ++) {
+			ref[4 * i] = (uint8_t)r[i];
+			ref[4 * i + 1] = (uint8_t)(r[i] >> 8);
+			ref[4 * i + 2] = (uint8_t)(r[i] >> 16);
+			ref[4 * i + 3] = (uint8_t)(r[i] >> 24);
+		}
+		if (memcmp(enc, ref, 32) != 0) {
+			fprintf(stderr, "ERR: FIELD INV: value %d\n", k);
+			exit(EXIT_FAILURE);
+		}
+		if (k % 10 == 0) {
+			printf(".");
+			fflush(stdout);
+		}
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_tables(void)
+{
+	const jq_tables *t;
+	jq_keypair jk;
+	uint8_t epk1[32], epk2[32], sig1[48], sig2[48];
+	size_t len;
+
+	printf("Test tables: ");
+	fflush(stdout);
+
+	len = jq_tables_size();
+	if (len + 1 > sizeof tables_buf) {
+		fprintf(stderr, "ERR: TABLES: size\n");
+		exit(EXIT_FAILURE);
+	}
+	if (jq_tables_clone(tables_buf + 1, len - 1) != NULL) {
+		fprintf(stderr, "ERR: TABLES: short buffer\n");
+		exit(EXIT_FAILURE);
+	}
+	jq_generate_keypair(&jk, "tables", 6);
+	jq_encode_public_key(epk1, &jk.public_key);
+	jq_sign(sig1, &jk, "", "msg", 3);
+	printf(".");
+	fflush(stdout);
+
+	/*
+	 * Use an unaligned start, to exercise the internal alignment.
+	 */
+	t = jq_tables_clone(tables_buf + 1, len);
+	if (t == NULL) {
+		fprintf(stderr, "ERR: TABLES: clone\n");
+		exit(EXIT_FAILURE);
+	}
+	jq_tables_use(t);
+	jq_generate_keypair(&jk, "tables", 6);
+	jq_encode_public_key(epk2, &jk.public_key);
+	jq_sign(sig2, &jk, "", "msg", 3);
+	if (memcmp(epk1, epk2, 32) != 0 || memcmp(sig1, sig2, 48) != 0) {
+		fprintf(stderr, "ERR: TABLES: output (copy)\n");
+		exit(EXIT_FAILURE);
+	}
+	if (jq_verify(sig2, 48, &jk.public_key, "", "msg", 3) != 1) {
+		fprintf(stderr, "ERR: TABLES: verify (copy)\n");
+		exit(EXIT_FAILURE);
+	}
+	printf(".");
+	fflush(stdout);
+
+	/*
+	 * Destroying the copy must change the results (this checks that
+	 * the copy is actually used), until the built-in tables are
+	 * selected again. The first 128 bytes hold the table pointers
+	 * (in the first 64 bytes after the aligned start) and are kept.
+	 */
+	memset(tables_buf + 128, 0, sizeof tables_buf - 128);
+	jq_generate_keypair(&jk, "tables", 6);
+	jq_encode_public_key(epk2, &jk.public_key);
+	if (memcmp(epk1, epk2, 32) == 0) {
+		fprintf(stderr, "ERR: TABLES: copy not used\n");
+		exit(EXIT_FAILURE);
+	}
+	jq_tables_use(NULL);
+	jq_generate_keypair(&jk, "tables", 6);
+	jq_encode_public_key(epk2, &jk.public_key);
+	jq_sign(sig2, &jk, "", "msg", 3);
+	if (memcmp(epk1, epk2, 32) != 0 || memcmp(sig1, sig2, 48) != 0) {
+		fprintf(stderr, "ERR: TABLES: output (built-in)\n");
+		exit(EXIT_FAILURE);
+	}
+	printf(".");
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_stats(void)
+{
+	jq255_stats st;
+	jq_keypair jk;
+	jq_public_key pk;
+	uint8_t epk[32], sig[48], tmp[32];
+	int enabled;
+
+	printf("Test stats: ");
+	fflush(stdout);
+
+	jq_generate_keypair(&jk, "stats", 5);
+	jq_encode_public_key(epk, &jk.public_key);
+	jq_sign(sig, &jk, "", "msg", 3);
+
+	jq_stats_reset();
+	enabled = jq_stats_snapshot(&st);
+	for (int i = 0; i < JQ255_STAT_NUM; i ++) {
+		if (st.count[i] != 0 || st.cycles[i] != 0) {
+			fprintf(stderr, "ERR: STATS: reset\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	printf(".");
+	fflush(stdout);
+
+	jq_decode_public_key(&pk, epk, 32);
+	if (jq_verify(sig, 48, &pk, "", "msg", 3) != 1) {
+		fprintf(stderr, "ERR: STATS: verify\n");
+		exit(EXIT_FAILURE);
+	}
+	jq_ECDH(tmp, &jk, &pk);
+	if (jq_stats_snapshot(&st) != enabled) {
+		fprintf(stderr, "ERR: STATS: status\n");
+		exit(EXIT_FAILURE);
+	}
+	if (enabled) {
+		if (st.count[JQ255_STAT_POINT_DECODE] != 1
+			|| st.count[JQ255_STAT_RECODE_WNAF] != 2
+			|| st.count[JQ255_STAT_VERIFY_LOOP] != 1
+			|| st.count[JQ255_STAT_CHALLENGE] != 1
+			|| st.count[JQ255_STAT_ECDH_MUL] != 1)
+		{
+			fprintf(stderr, "ERR: STATS: counts\n");
+			exit(EXIT_FAILURE);
+		}
+	} else {
+		for (int i = 0; i < JQ255_STAT_NUM; i ++) {
+			if (st.count[i] != 0 || st.cycles[i] != 0) {
+				fprintf(stderr, "ERR: STATS: disabled\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+	printf(".");
+
+	printf(" done%s.\n", enabled ? "" : " (disabled)");
+	fflush(stdout);
+}
+
+static void
+test_point_vartime(void)
+{
+	jq_scalar one, zero, s;
+	jq_point G, P, Q, R;
+	uint8_t buf[64], enc1[32], enc2[32];
+
+	printf("Test point vartime: ");
+	fflush(stdout);
+
+	/* Scalar decoding. */
+	memset(buf, 0xFF, 32);
+	if (jq_scalar_decode(&s, buf, 32) != 0
+		|| jq_scalar_decode(&s, buf, 31) != 0)
+	{
+		fprintf(stderr, "ERR: POINT VARTIME: scalar decode\n");
+		exit(EXIT_FAILURE);
+	}
+	jq_scalar_encode(enc1, &s);
+	memset(buf, 0, 32);
+	if (memcmp(enc1, buf, 32) != 0
+		|| jq_scalar_decode(&zero, buf, 32) != 1)
+	{
+		fprintf(stderr, "ERR: POINT VARTIME: scalar zero\n");
+		exit(EXIT_FAILURE);
+	}
+	buf[0] = 1;
+	jq_scalar_decode(&one, buf, 32);
+
+	/* Neutral element. */
+	jq_point_mulgen_vartime(&P, &zero);
+	jq_point_encode(enc1, &P);
+	memset(buf, 0, 32);
+	if (memcmp(enc1, buf, 32) != 0
+		|| jq_point_decode(&Q, buf, 32) != 1)
+	{
+		fprintf(stderr, "ERR: POINT VARTIME: neutral\n");
+		exit(EXIT_FAILURE);
+	}
+	jq_point_mul_vartime(&R, &Q, &one);
+	jq_point_encode(enc1, &R);
+	if (memcmp(enc1, buf, 32) != 0) {
+		fprintf(stderr, "ERR: POINT VARTIME: neutral mul\n");
+		exit(EXIT_FAILURE);
+	}
+	printf(".");
+	fflush(stdout);
+
+	jq_point_mulgen_vartime(&G, &one);
+	for (int i = 0; i < 40; i ++) {
+		uint8_t ba[32], bb[32], bc[32];
+		jq_scalar a, b, c;
+		jq_private_key sk;
+		jq_public_key pk;
+		unsigned cc;
+
+		/* s*G, against key pair generation. */
+		for (int j = 0; j < 64; j ++) {
+			buf[j] = (uint8_t)(i * 17 + j * 5 + (j >> 3));
+		}
+		jq_scalar_decode_reduce(&s, buf, 64);
+		jq_scalar_encode(enc1, &s);
+		if (jq_decode_private_key(&sk, enc1, 32) != 1) {
+			fprintf(stderr, "ERR: POINT VARTIME: scalar\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_make_public(&pk, &sk);
+		jq_encode_public_key(enc1, &pk);
+		jq_point_mulgen_vartime(&P, &s);
+		jq_point_encode(enc2, &P);
+		if (memcmp(enc1, enc2, 32) != 0) {
+			fprintf(stderr, "ERR: POINT VARTIME: mulgen\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_point_mul_vartime(&Q, &G, &s);
+		jq_point_encode(enc2, &Q);
+		if (memcmp(enc1, enc2, 32) != 0) {
+			fprintf(stderr, "ERR: POINT VARTIME: mul G\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_point_from_public_key(&R, &pk);
+		jq_point_encode(enc2, &R);
+		if (memcmp(enc1, enc2, 32) != 0
+			|| jq_point_decode(&R, enc1, 32) != 1)
+		{
+			fprintf(stderr, "ERR: POINT VARTIME: from public key\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/* a*P + b*P = (a+b)*P, with a + b < r. */
+		for (int j = 0; j < 32; j ++) {
+			ba[j] = buf[j] ^ buf[j + 32];
+			bb[j] = (uint8_t)(buf[j] * 3 + i);
+		}
+		ba[31] &= 0x1F;
+		bb[31] &= 0x1F;
+		if (i == 0) {
+			memset(bb, 0, 32);
+		}
+		cc = 0;
+		for (int j = 0; j < 32; j ++) {
+			cc += (unsigned)ba[j] + (unsigned)bb[j];
+			bc[j] = (uint8_t)cc;
+			cc >>= 8;
+		}
+		jq_scalar_decode(&a, ba, 32);
+		jq_scalar_decode(&b, bb, 32);
+		jq_scalar_decode(&c, bc, 32);
+		jq_point_mul_vartime(&Q, &P, &a);
+		jq_point_mul_vartime(&R, &P, &b);
+		jq_point_add(&Q, &Q, &R);
+		jq_point_encode(enc1, &Q);
+		jq_point_mul_vartime(&P, &P, &c);
+		jq_point_encode(enc2, &P);
+		if (memcmp(enc1, enc2, 32) != 0) {
+			fprintf(stderr, "ERR: POINT VARTIME: mul (%d)\n", i);
+			exit(EXIT_FAILURE);
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#define NUM_MSM   1040
+
+static void
+test_point_msm(void)
+{
+	static jq_point pp[NUM_MSM];
+	static jq_scalar ss[NUM_MSM];
+	/*
+	 * Straus chunk boundaries, then the smallest Pippenger size for
+	 * each digit width: 5 bits (n = 64), 6 (121), 7 (331), 8 (692).
+	 */
+	static const size_t sizes[] = {
+		0, 1, 2, 7, 8, 9, 17, 63, 64, 120, 121, 331, 692, NUM_MSM
+	};
+	static jq_point ref[NUM_MSM + 1];
+
+	printf("Test point MSM: ");
+	fflush(stdout);
+
+	for (int i = 0; i < NUM_MSM; i ++) {
+		uint8_t buf[64];
+
+		for (int j = 0; j < 64; j ++) {
+			buf[j] = (uint8_t)(i * 29 + j * 7 + (j >> 2));
+		}
+		jq_scalar_decode_reduce(&ss[i], buf, 64);
+		jq_point_mulgen_vartime(&pp[i], &ss[i]);
+		buf[0] ^= 0x55;
+		jq_scalar_decode_reduce(&ss[i], buf, 64);
+
+		/* A few special cases: zero and small scalars, repeated
+		   points. */
+		if (i % 31 == 3) {
+			jq_scalar_decode_reduce(&ss[i], buf, 0);
+		} else if (i % 31 == 5) {
+			jq_scalar_decode_reduce(&ss[i], buf, 1);
+		} else if (i % 31 == 7) {
+			pp[i] = pp[i - 1];
+		}
+	}
+
+	/* ref[n] = \sum_{i<n} ss[i]*pp[i] */
+	memset(ref[0].w32, 0, sizeof ref[0]);
+	jq_point_decode(&ref[0], ref[0].w32, 32);
+	for (int i = 0; i < NUM_MSM; i ++) {
+		jq_point t;
+
+		jq_point_mul_vartime(&t, &pp[i], &ss[i]);
+		jq_point_add(&ref[i + 1], &ref[i], &t);
+	}
+
+	for (size_t k = 0; k < (sizeof sizes) / sizeof(sizes[0]); k ++) {
+		size_t n = sizes[k];
+		jq_point r;
+		uint8_t enc1[32], enc2[32];
+
+		jq_point_msm_vartime(&r, pp, ss, n);
+		jq_point_encode(enc1, &r);
+		jq_point_encode(enc2, &ref[n]);
+		if (memcmp(enc1, enc2, 32) != 0) {
+			fprintf(stderr, "ERR: POINT MSM: n = %lu\n",
+				(unsigned long)n);
+			exit(EXIT_FAILURE);
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_point_ops(void)
+{
+	printf("Test point ops: ");
+	fflush(stdout);
+
+	for (int i = 0; i < 20; i ++) {
+		uint8_t buf[64], enc1[32], enc2[32];
+		jq_scalar a, b, c, d, zero;
+		jq_point G, P, Q, R;
+		jq_keypair jk;
+		jq_private_key sk;
+		jq_public_key pk;
+
+		for (int j = 0; j < 64; j ++) {
+			buf[j] = (uint8_t)(i * 23 + j * 11 + (j >> 4));
+		}
+		jq_scalar_decode_reduce(&a, buf, 32);
+		jq_scalar_decode_reduce(&b, buf + 32, 32);
+		jq_scalar_decode_reduce(&zero, buf, 0);
+		buf[0] = 1;
+		jq_scalar_decode_reduce(&c, buf, 1);
+		jq_point_mulgen(&G, &c);
+
+		/* Scalar arithmetic. */
+		jq_scalar_add(&c, &a, &b);
+		jq_scalar_sub(&c, &c, &b);
+		jq_scalar_neg(&d, &a);
+		jq_scalar_add(&d, &d, &a);
+		if (memcmp(&c, &a, sizeof a) != 0
+			|| memcmp(&d, &zero, sizeof d) != 0)
+		{
+			fprintf(stderr, "ERR: POINT OPS: scalar add/sub\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_scalar_neg(&d, &zero);
+		if (memcmp(&d, &zero, sizeof d) != 0) {
+			fprintf(stderr, "ERR: POINT OPS: scalar neg 0\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/* (a*b)*G = a*(b*G), constant-time and vartime. */
+		jq_scalar_mul(&c, &a, &b);
+		jq_point_mulgen(&P, &c);
+		jq_point_mulgen_vartime(&Q, &b);
+		jq_point_mulgen(&R, &b);
+		if (!jq_point_equals(&Q, &R)) {
+			fprintf(stderr, "ERR: POINT OPS: mulgen\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_point_mul(&R, &R, &a);
+		jq_point_mul_vartime(&Q, &Q, &a);
+		if (!jq_point_equals(&P, &R) || !jq_point_equals(&P, &Q)) {
+			fprintf(stderr, "ERR: POINT OPS: mul\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/* Double, negation, subtraction. */
+		jq_point_add(&Q, &P, &P);
+		jq_point_double(&R, &P);
+		if (!jq_point_equals(&Q, &R) || jq_point_equals(&P, &R)
+			|| jq_point_is_neutral(&R))
+		{
+			fprintf(stderr, "ERR: POINT OPS: double\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_point_sub(&R, &R, &P);
+		jq_point_neg(&Q, &P);
+		jq_point_add(&Q, &Q, &P);
+		if (!jq_point_equals(&P, &R) || !jq_point_is_neutral(&Q)) {
+			fprintf(stderr, "ERR: POINT OPS: sub/neg\n");
+			exit(EXIT_FAILURE);
+		}
+		if (jq_point_to_public_key(&pk, &Q) != 0) {
+			fprintf(stderr, "ERR: POINT OPS: neutral public key\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/*
+		 * Key derivation: with sk' = sk + a, pk' = pk + a*G. The
+		 * public key obtained from the point must be the same as
+		 * with the usual key pair functions.
+		 */
+		jq_generate_keypair(&jk, buf, 32);
+		jq_scalar_from_private_key(&c, &jk.private_key);
+		jq_scalar_add(&c, &c, &a);
+		if (jq_private_key_from_scalar(&sk, &c) != 1) {
+			fprintf(stderr, "ERR: POINT OPS: private key\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_make_public(&pk, &sk);
+		jq_encode_public_key(enc1, &pk);
+		jq_point_from_public_key(&P, &jk.public_key);
+		jq_point_mul(&Q, &G, &a);
+		jq_point_add(&P, &P, &Q);
+		if (jq_point_to_public_key(&pk, &P) != 1) {
+			fprintf(stderr, "ERR: POINT OPS: public key\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_encode_public_key(enc2, &pk);
+		if (memcmp(enc1, enc2, 32) != 0) {
+			fprintf(stderr, "ERR: POINT OPS: derivation\n");
+			exit(EXIT_FAILURE);
+		}
+		if (jq_private_key_from_scalar(&sk, &zero) != 0) {
+			fprintf(stderr, "ERR: POINT OPS: zero private key\n");
+			exit(EXIT_FAILURE);
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_public_key_compact(void)
+{
+	printf("Test compact public key: ");
+	fflush(stdout);
+
+	for (int i = 0; KAT_SIGN[i] != NULL; i += 5) {
+		uint8_t buf_key[64], buf_msg[32], buf_sig[48], tmp[32];
+		jq_keypair jk;
+		jq_public_key_compact cpk, cpk2;
+
+		hextobin(buf_key, 32, KAT_SIGN[i + 0]);
+		hextobin(buf_key + 32, 32, KAT_SIGN[i + 1]);
+		HEXTOBIN(buf_msg, KAT_SIGN[i + 3]);
+		HEXTOBIN(buf_sig, KAT_SIGN[i + 4]);
+		if (jq_decode_keypair(&jk, buf_key, 64) != 1) {
+			fprintf(stderr, "ERR: CPK: decode keypair\n");
+			exit(EXIT_FAILURE);
+		}
+		if (jq_decode_public_key_compact(&cpk, buf_key + 32, 32) != 1) {
+			fprintf(stderr, "ERR: CPK: decode (1)\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_compact_public_key(&cpk2, &jk.public_key);
+		if (memcmp(&cpk, &cpk2, sizeof cpk) != 0) {
+			fprintf(stderr, "ERR: CPK: compact (1)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (jq_encode_public_key_compact(tmp, &cpk) != 32
+			|| memcmp(tmp, buf_key + 32, 32) != 0)
+		{
+			fprintf(stderr, "ERR: CPK: encode (1)\n");
+			exit(EXIT_FAILURE);
+		}
+		if (jq_verify_compact(buf_sig, 48, &cpk,
+			JQ255_HASHNAME_BLAKE2S, buf_msg, 32) != 1)
+		{
+			fprintf(stderr, "ERR: CPK: verify (1)\n");
+			exit(EXIT_FAILURE);
+		}
+		buf_msg[11] ^= 0x01;
+		if (jq_verify_compact(buf_sig, 48, &cpk,
+			JQ255_HASHNAME_BLAKE2S, buf_msg, 32) != 0)
+		{
+			fprintf(stderr, "ERR: CPK: verify (2)\n");
+			exit(EXIT_FAILURE);
+		}
+		buf_msg[11] ^= 0x01;
+
+		/* Invalid key: both creation paths must agree, and the
+		   key must encode as zeros and verify nothing. */
+		buf_key[63] |= 0x80;
+		if (jq_decode_public_key_compact(&cpk, buf_key + 32, 32) != 0) {
+			fprintf(stderr, "ERR: CPK: decode (2)\n");
+			exit(EXIT_FAILURE);
+		}
+		jq_decode_public_key(&jk.public_key, buf_key + 32, 32);
+		jq_compact_public_key(&cpk2, &jk.public_key);
+		if (memcmp(&cpk, &cpk2, sizeof cpk) != 0) {
+			fprintf(stderr, "ERR: CPK: compact (2)\n");
+			exit(EXIT_FAILURE);
+		}
+		memset(tmp, 'T', sizeof tmp);
+		jq_encode_public_key_compact(tmp, &cpk);
+		for (int j = 0; j < 32; j ++) {
+			if (tmp[j] != 0) {
+				fprintf(stderr, "ERR: CPK: encode (2)\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		if (jq_verify_compact(buf_sig, 48, &cpk,
+			JQ255_HASHNAME_BLAKE2S, buf_msg, 32) != 0)
+		{
+			fprintf(stderr, "ERR: CPK: verify (3)\n");
+			exit(EXIT_FAILURE);
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" ");
+	fflush(stdout);
+
+	for (int i = 0; KAT_ECDH[i] != NULL; i += 5) {
+		uint8_t buf_sk_self[32];
+		uint8_t buf_pk1_peer[32], buf_sec1[32], buf_pk2_peer[32];
+		uint8_t tmp[32];
+		jq_keypair jk;
+		jq_public_key_compact cpk_peer;
+
+		HEXTOBIN(buf_sk_self, KAT_ECDH[i]);
+		HEXTOBIN(buf_pk1_peer, KAT_ECDH[i + 1]);
+		HEXTOBIN(buf_sec1, KAT_ECDH[i + 2]);
+		HEXTOBIN(buf_pk2_peer, KAT_ECDH[i + 3]);
+		jq_decode_private_key(&jk.private_key, buf_sk_self, 32);
+		jq_make_public(&jk.public_key, &jk.private_key);
+		jq_decode_public_key_compact(&cpk_peer, buf_pk1_peer, 32);
+		if (jq_ECDH_compact(tmp, &jk, &cpk_peer) != 1) {
+			fprintf(stderr, "ERR: CPK: ECDH status (1)\n");
 			exit(EXIT_FAILURE);
 		}
-		if (jq_ECDH(tmp, &jk, &pk_peer) != 0) {
-			fprintf(stderr, "ERR: ECDH: status (2)\n");
+		if (memcmp(tmp, buf_sec1, 32) != 0) {
+			fprintf(stderr, "ERR: CPK: ECDH output (1)\n");
 			exit(EXIT_FAILURE);
 		}
-		if (memcmp(tmp, buf_sec2, 32) != 0) {
-			fprintf(stderr, "ERR: ECDH: output (2)\n");
+		jq_decode_public_key_compact(&cpk_peer, buf_pk2_peer, 32);
+		if (jq_ECDH_compact(tmp, &jk, &cpk_peer) != 0) {
+			fprintf(stderr, "ERR: CPK: ECDH status (2)\n");
 			exit(EXIT_FAILURE);
 		}
 
@@ -1235,6 +3249,96 @@ speed_keygen(void)
 #undef NUM
 }
 
+static uint32_t
+speed_keygen_batch(void)
+{
+	size_t u;
+	uint64_t tt[100];
+	unsigned char tmp[32];
+	uint8_t seeds[100][32];
+	const void *sp[100];
+	size_t slen[100];
+	jq_keypair jk[100];
+
+#define NUM   ((sizeof tt) / (sizeof tt[0]))
+
+	init_buf_cycles(tmp);
+	for (int i = 0; i < 100; i ++) {
+		memcpy(seeds[i], tmp, 32);
+		seeds[i][0] = (uint8_t)i;
+		sp[i] = seeds[i];
+		slen[i] = 32;
+	}
+	for (u = 0; u < 2 * NUM; u ++) {
+		uint64_t begin, end;
+
+		begin = core_cycles();
+		jq_generate_keypairs(jk, sp, slen, 100);
+		end = core_cycles();
+		seeds[0][1] ^= jk[0].public_key.w32[0];
+		if (u >= NUM) {
+			tt[u - NUM] = end - begin;
+		}
+	}
+	qsort(tt, (sizeof tt) / sizeof(tt[0]), sizeof tt[0], &cmp_u64);
+	printf("keygen (batch):         %9.2f (%.2f .. %.2f)\n",
+		(double)tt[NUM / 2] / 100.0,
+		(double)tt[NUM / 10] / 100.0,
+		(double)tt[(9 * NUM) / 10] / 100.0);
+	fflush(stdout);
+	return seeds[0][1];
+
+#undef NUM
+}
+
+static uint32_t
+speed_pubkey_decode(int batch)
+{
+	size_t u;
+	uint64_t tt[100];
+	unsigned char tmp[32];
+	uint8_t src[100 * 32], ok[(100 + 7) >> 3];
+	jq_keypair jk;
+	jq_public_key pk[100];
+
+#define NUM   ((sizeof tt) / (sizeof tt[0]))
+
+	init_buf_cycles(tmp);
+	for (int i = 0; i < 100; i ++) {
+		tmp[0] = i;
+		jq_generate_keypair(&jk, tmp, 32);
+		jq_encode_public_key(src + 32 * i, &jk.public_key);
+	}
+	for (u = 0; u < 2 * NUM; u ++) {
+		uint64_t begin, end;
+		int i;
+
+		begin = core_cycles();
+		if (batch) {
+			tmp[1] += jq_decode_public_keys(pk, src, 100, ok);
+		} else {
+			for (i = 0; i < 100; i ++) {
+				tmp[1] += jq_decode_public_key(&pk[i],
+					src + 32 * i, 32);
+			}
+		}
+		end = core_cycles();
+		if (u >= NUM) {
+			tt[u - NUM] = end - begin;
+		}
+	}
+	qsort(tt, (sizeof tt) / sizeof(tt[0]), sizeof tt[0], &cmp_u64);
+	printf("%s%9.2f (%.2f .. %.2f)\n",
+		batch ? "pubkey decode (batch):  " : "pubkey decode:          ",
+		(double)tt[NUM / 2] / 100.0,
+		(double)tt[NUM / 10] / 100.0,
+		(double)tt[(9 * NUM) / 10] / 100.0);
+	fflush(stdout);
+	return tmp[1];
+
+#undef NUM
+}
+
 static uint32_t
 speed_sign(void)
 {
@@ -1271,6 +3375,85 @@ speed_sign(void)
 #undef NUM
 }
 
+static uint32_t
+speed_signer(void)
+{
+	size_t u;
+	uint64_t tt[100];
+	unsigned char tmp[48];
+	jq_keypair jk;
+	jq_signer sg;
+
+#define NUM   ((sizeof tt) / (sizeof tt[0]))
+
+	init_buf_cycles(tmp);
+	jq_generate_keypair(&jk, tmp, 32);
+	jq_signer_init(&sg, &jk);
+	for (u = 0; u < 2 * NUM; u ++) {
+		uint64_t begin, end;
+		int i;
+
+		begin = core_cycles();
+		for (i = 0; i < 100; i ++) {
+			jq_signer_sign(tmp, &sg, "", tmp, 32, NULL, 0);
+		}
+		end = core_cycles();
+		if (u >= NUM) {
+			tt[u - NUM] = end - begin;
+		}
+	}
+	qsort(tt, (sizeof tt) / sizeof(tt[0]), sizeof tt[0], &cmp_u64);
+	printf("sign (signer):          %9.2f (%.2f .. %.2f)\n",
+		(double)tt[NUM / 2] / 100.0,
+		(double)tt[NUM / 10] / 100.0,
+		(double)tt[(9 * NUM) / 10] / 100.0);
+	fflush(stdout);
+	return tmp[0];
+
+#undef NUM
+}
+
+static uint32_t
+speed_sign_many(void)
+{
+	size_t u;
+	uint64_t tt[100];
+	unsigned char tmp[32];
+	uint8_t sigs[100 * 48];
+	const void *hv[100];
+	size_t hv_len[100];
+	jq_keypair jk;
+
+#define NUM   ((sizeof tt) / (sizeof tt[0]))
+
+	init_buf_cycles(tmp);
+	jq_generate_keypair(&jk, tmp, 32);
+	for (int i = 0; i < 100; i ++) {
+		hv[i] = tmp;
+		hv_len[i] = 32;
+	}
+	for (u = 0; u < 2 * NUM; u ++) {
+		uint64_t begin, end;
+
+		begin = core_cycles();
+		jq_sign_many(sigs, &jk, "", hv, hv_len, 100, NULL);
+		end = core_cycles();
+		tmp[0] ^= sigs[0];
+		if (u >= NUM) {
+			tt[u - NUM] = end - begin;
+		}
+	}
+	qsort(tt, (sizeof tt) / sizeof(tt[0]), sizeof tt[0], &cmp_u64);
+	printf("sign many:              %9.2f (%.2f .. %.2f)\n",
+		(double)tt[NUM / 2] / 100.0,
+		(double)tt[NUM / 10] / 100.0,
+		(double)tt[(9 * NUM) / 10] / 100.0);
+	fflush(stdout);
+	return tmp[0];
+
+#undef NUM
+}
+
 static uint32_t
 speed_verify(void)
 {
@@ -1316,6 +3499,102 @@ speed_verify(void)
 #undef NUM
 }
 
+static uint32_t
+speed_verify_batch(void)
+{
+	size_t u;
+	uint64_t tt[100];
+	unsigned char tmp[32];
+	uint8_t sigs[100][48];
+	jq_keypair jk;
+	uint8_t epk[32];
+	jq_public_key pk[100];
+	jq_verify_item items[100];
+
+#define NUM   ((sizeof tt) / (sizeof tt[0]))
+
+	init_buf_cycles(tmp);
+	jq_generate_keypair(&jk, tmp, 32);
+	jq_encode_public_key(epk, &jk.public_key);
+	for (int i = 0; i < 100; i ++) {
+		tmp[0] = i;
+		jq_sign(sigs[i], &jk, "", tmp, 32);
+		items[i].sig = sigs[i];
+		items[i].sig_len = 48;
+		items[i].pk = &pk[i];
+		items[i].hash_name = "";
+		items[i].hv = tmp;
+		items[i].hv_len = 32;
+	}
+	for (u = 0; u < 2 * NUM; u ++) {
+		uint64_t begin, end;
+		int i;
+
+		begin = core_cycles();
+		for (i = 0; i < 100; i ++) {
+			jq_decode_public_key(&pk[i], epk, 32);
+		}
+		tmp[1] += jq_verify_batch(NULL, items, 100);
+		end = core_cycles();
+		if (u >= NUM) {
+			tt[u - NUM] = end - begin;
+		}
+	}
+	qsort(tt, (sizeof tt) / sizeof(tt[0]), sizeof tt[0], &cmp_u64);
+	printf("verify batch (pubdec):  %9.2f (%.2f .. %.2f)\n",
+		(double)tt[NUM / 2] / 100.0,
+		(double)tt[NUM / 10] / 100.0,
+		(double)tt[(9 * NUM) / 10] / 100.0);
+	fflush(stdout);
+	return tmp[1];
+
+#undef NUM
+}
+
+static uint32_t
+speed_verify_expanded(void)
+{
+	size_t u;
+	uint64_t tt[100];
+	unsigned char tmp[32];
+	uint8_t sigs[100][48];
+	jq_keypair jk;
+	jq_public_key_expanded epk;
+
+#define NUM   ((sizeof tt) / (sizeof tt[0]))
+
+	init_buf_cycles(tmp);
+	jq_generate_keypair(&jk, tmp, 32);
+	jq_expand_public_key(&epk, &jk.public_key);
+	for (int i = 0; i < 100; i ++) {
+		tmp[0] = i;
+		jq_sign(sigs[i], &jk, "", tmp, 32);
+	}
+	for (u = 0; u < 2 * NUM; u ++) {
+		uint64_t begin, end;
+		int i;
+
+		begin = core_cycles();
+		for (i = 0; i < 100; i ++) {
+			tmp[0] += jq_verify_expanded(sigs[i], 48, &epk,
+				"", tmp, 32);
+		}
+		end = core_cycles();
+		if (u >= NUM) {
+			tt[u - NUM] = end - begin;
+		}
+	}
+	qsort(tt, (sizeof tt) / sizeof(tt[0]), sizeof tt[0], &cmp_u64);
+	printf("verify (expanded key):  %9.2f (%.2f .. %.2f)\n",
+		(double)tt[NUM / 2] / 100.0,
+		(double)tt[NUM / 10] / 100.0,
+		(double)tt[(9 * NUM) / 10] / 100.0);
+	fflush(stdout);
+	return tmp[0];
+
+#undef NUM
+}
+
 static uint32_t
 speed_ECDH(void)
 {
@@ -1364,15 +3643,88 @@ speed_ECDH(void)
 #undef NUM
 }
 
+static uint32_t
+speed_ECDH_prepared(int peer)
+{
+	size_t u;
+	uint64_t tt[100];
+	unsigned char tmp[32];
+	jq_public_key pks[100];
+	jq_keypair jk;
+	jq_ECDH_self es;
+	jq_ECDH_peer ep;
+	uint32_t rv;
+
+#define NUM   ((sizeof tt) / (sizeof tt[0]))
+
+	init_buf_cycles(tmp);
+	jq_generate_keypair(&jk, tmp, 32);
+	for (int i = 0; i < 100; i ++) {
+		jq_keypair jk_peer;
+		tmp[0] = i;
+		jq_generate_keypair(&jk_peer, tmp, 32);
+		pks[i] = jk_peer.public_key;
+	}
+	jq_ECDH_prepare_self(&es, &jk);
+	jq_ECDH_prepare_peer(&ep, &pks[0]);
+	rv = tmp[2];
+	for (u = 0; u < 2 * NUM; u ++) {
+		uint64_t begin, end;
+		int i;
+
+		begin = core_cycles();
+		for (i = 0; i < 100; i ++) {
+			if (peer) {
+				jq_ECDH_prepare_peer(&ep, &pks[i]);
+			}
+			rv += jq_ECDH_prepared(tmp, &es, &ep);
+			rv += tmp[0];
+		}
+		end = core_cycles();
+		if (u >= NUM) {
+			tt[u - NUM] = end - begin;
+		}
+	}
+	qsort(tt, (sizeof tt) / sizeof(tt[0]), sizeof tt[0], &cmp_u64);
+	printf("ECDH (prepared%s): %9.2f (%.2f .. %.2f)\n",
+		peer ? ", +peer" : ", reuse",
+		(double)tt[NUM / 2] / 100.0,
+		(double)tt[NUM / 10] / 100.0,
+		(double)tt[(9 * NUM) / 10] / 100.0);
+	fflush(stdout);
+	return rv;
+
+#undef NUM
+}
+
 #endif
 
 int
 main(void)
 {
 	test_pubkey_decode();
+	test_pubkey_decode_batch();
+	test_keydir();
 	test_keypair_decode();
+	test_keygen_batch();
+	test_keypool();
 	test_sign();
+	test_signer();
+	test_sign_stream();
+	test_sign_many();
+	test_verify_batch();
+	test_verify_queue();
+	test_verify_expanded();
 	test_ECDH();
+	test_ECDH_many();
+	test_ECDH_prepared();
+	test_public_key_compact();
+	test_point_vartime();
+	test_point_msm();
+	test_point_ops();
+	test_field_inv();
+	test_tables();
+	test_stats();
 
 #if defined SPEED_X86
 	uint32_t rv;
@@ -1382,9 +3734,18 @@ main(void)
 	fflush(stdout);
 	rv = 0;
 	rv ^= speed_keygen();
+	rv ^= speed_keygen_batch();
+	rv ^= speed_pubkey_decode(0);
+	rv ^= speed_pubkey_decode(1);
 	rv ^= speed_sign();
+	rv ^= speed_signer();
+	rv ^= speed_sign_many();
 	rv ^= speed_verify();
+	rv ^= speed_verify_batch();
+	rv ^= speed_verify_expanded();
 	rv ^= speed_ECDH();
+	rv ^= speed_ECDH_prepared(1);
+	rv ^= speed_ECDH_prepared(0);
 	printf("%u\n", (unsigned)(rv & 0xFF));
 #endif
 